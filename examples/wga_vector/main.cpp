@@ -0,0 +1,240 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *      * Neither the name of Texas Instruments Incorporated nor the
+ *        names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *  THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+* Work-item loop vectorization benchmark
+*
+* The vecadd and sgemm kernels below are written one element per work-item.
+* Each is built twice, as is and with the clocl option -wga-vector-width=<n>,
+* which vectorizes the loop over the work-items of a work-group. Both builds
+* run on the same data; the results are checked against the host and the
+* kernel times compared.
+*
+* Usage: wga_vector [vector width, default 4]
+*----------------------------------------------------------------------------*/
+#define __CL_ENABLE_EXCEPTIONS
+#include <CL/cl.hpp>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+#include "ocl_util.h"
+
+using namespace cl;
+using namespace std;
+
+const char * kernelStr =
+    "kernel void VectorAdd(global const float* a, \n"
+    "                      global const float* b, \n"
+    "                      global float* c) \n"
+    "{\n"
+    "    int id = get_global_id(0);\n"
+    "    c[id] = a[id] + b[id];\n"
+    "}\n"
+    "\n"
+    "kernel void Sgemm(global const float* a, \n"
+    "                  global const float* b, \n"
+    "                  global float* c, int n) \n"
+    "{\n"
+    "    int col = get_global_id(0);\n"
+    "    int row = get_global_id(1);\n"
+    "    float sum = 0.0f;\n"
+    "    for (int k = 0; k < n; ++k)\n"
+    "        sum += a[row * n + k] * b[k * n + col];\n"
+    "    c[row * n + col] = sum;\n"
+    "}\n";
+
+const int NumElements   = 4*1024*1024;
+const int VecAddWGSize  = 1024;
+const int MatDim        = 256;
+const int SgemmWGSize   = 64;             // work-items along dimension 0
+const int NumRuns       = 5;
+
+/******************************************************************************
+* Best of NumRuns kernel executions, in microseconds
+******************************************************************************/
+static double run_kernel(CommandQueue &Q, Kernel &kernel,
+                         const NDRange &global, const NDRange &local)
+{
+    double best = 0;
+
+    for (int run = 0; run < NumRuns; ++run)
+    {
+        Event ev;
+        Q.enqueueNDRangeKernel(kernel, NullRange, global, local, NULL, &ev);
+        ev.wait();
+
+        cl_ulong start = ev.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        cl_ulong end   = ev.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+        double   us    = (end - start) / 1000.0;
+        if (run == 0 || us < best) best = us;
+    }
+
+    return best;
+}
+
+static bool check(const float *result, const float *golden, int n)
+{
+    for (int i = 0; i < n; ++i)
+        if (fabs(result[i] - golden[i]) > 1e-3f * fabs(golden[i]) + 1e-3f)
+        {
+            cout << "Failed at element " << i << ": "
+                 << golden[i] << " != " << result[i] << endl;
+            return false;
+        }
+    return true;
+}
+
+static void report(const char *name, double scalar_us, double vector_us)
+{
+    cout << setw(10) << name
+         << setw(14) << fixed << setprecision(1) << scalar_us
+         << setw(14) << vector_us
+         << setw(10) << setprecision(2) << scalar_us / vector_us << "x"
+         << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int width = (argc > 1) ? atoi(argv[1]) : 4;
+
+    int vsize = sizeof(float) * NumElements;
+    int msize = sizeof(float) * MatDim * MatDim;
+
+    float *srcA   = (float *)__malloc_ddr(vsize);
+    float *srcB   = (float *)__malloc_ddr(vsize);
+    float *dst    = (float *)__malloc_ddr(vsize);
+    float *golden = (float *)__malloc_ddr(vsize);
+    assert(srcA != NULL && srcB != NULL && dst != NULL && golden != NULL);
+
+    for (int i = 0; i < NumElements; ++i)
+    {
+        srcA[i]   = (float) (i & 0xffff);
+        srcB[i]   = (float) ((i * 7) & 0xfff);
+        golden[i] = srcA[i] + srcB[i];
+    }
+
+    float *matA   = (float *)__malloc_ddr(msize);
+    float *matB   = (float *)__malloc_ddr(msize);
+    float *matC   = (float *)__malloc_ddr(msize);
+    float *matRef = (float *)__malloc_ddr(msize);
+    assert(matA != NULL && matB != NULL && matC != NULL && matRef != NULL);
+
+    for (int i = 0; i < MatDim * MatDim; ++i)
+    {
+        matA[i] = (float) (i % 13) / 13.0f;
+        matB[i] = (float) (i % 7)  / 7.0f;
+    }
+    for (int r = 0; r < MatDim; ++r)
+        for (int c = 0; c < MatDim; ++c)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < MatDim; ++k)
+                sum += matA[r * MatDim + k] * matB[k * MatDim + c];
+            matRef[r * MatDim + c] = sum;
+        }
+
+    bool ok = true;
+
+    try
+    {
+        Context context(CL_DEVICE_TYPE_ACCELERATOR);
+        std::vector<Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
+        CommandQueue Q(context, devices[0], CL_QUEUE_PROFILING_ENABLE);
+
+        Buffer bufA(context, CL_MEM_READ_ONLY  | CL_MEM_USE_HOST_PTR, vsize, srcA);
+        Buffer bufB(context, CL_MEM_READ_ONLY  | CL_MEM_USE_HOST_PTR, vsize, srcB);
+        Buffer bufC(context, CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR, vsize, dst);
+        Buffer matBufA(context, CL_MEM_READ_ONLY  | CL_MEM_USE_HOST_PTR, msize, matA);
+        Buffer matBufB(context, CL_MEM_READ_ONLY  | CL_MEM_USE_HOST_PTR, msize, matB);
+        Buffer matBufC(context, CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR, msize, matC);
+
+        Program::Sources source(1, std::make_pair(kernelStr, strlen(kernelStr)));
+
+        double times[2][2];                 // [scalar, vector][vecadd, sgemm]
+        for (int v = 0; v < 2 && ok; ++v)
+        {
+            std::ostringstream options;
+            if (v == 1) options << "-wga-vector-width=" << width;
+
+            Program program(context, source);
+            program.build(devices, options.str().c_str());
+
+            memset(dst, 0, vsize);
+            Kernel vecadd(program, "VectorAdd");
+            vecadd.setArg(0, bufA);
+            vecadd.setArg(1, bufB);
+            vecadd.setArg(2, bufC);
+            times[v][0] = run_kernel(Q, vecadd, NDRange(NumElements),
+                                     NDRange(VecAddWGSize));
+            ok &= check(dst, golden, NumElements);
+
+            memset(matC, 0, msize);
+            Kernel sgemm(program, "Sgemm");
+            sgemm.setArg(0, matBufA);
+            sgemm.setArg(1, matBufB);
+            sgemm.setArg(2, matBufC);
+            sgemm.setArg(3, MatDim);
+            times[v][1] = run_kernel(Q, sgemm, NDRange(MatDim, MatDim),
+                                     NDRange(SgemmWGSize, 1));
+            ok &= check(matC, matRef, MatDim * MatDim);
+        }
+
+        if (ok)
+        {
+            cout << "Vector width " << width << ", best of " << NumRuns
+                 << " runs (us)" << endl;
+            cout << setw(10) << "kernel" << setw(14) << "scalar"
+                 << setw(14) << "vector" << setw(11) << "speedup" << endl;
+            report("vecadd", times[0][0], times[1][0]);
+            report("sgemm",  times[0][1], times[1][1]);
+        }
+    }
+    catch (Error& err)
+    {
+        cerr << "ERROR: " << err.what() << "(" << err.err() << ", "
+             << ocl_decode_error(err.err()) << ")" << endl;
+        ok = false;
+    }
+
+    __free_ddr(srcA);
+    __free_ddr(srcB);
+    __free_ddr(dst);
+    __free_ddr(golden);
+    __free_ddr(matA);
+    __free_ddr(matB);
+    __free_ddr(matC);
+    __free_ddr(matRef);
+
+    if (!ok) return -1;
+    cout << "Success!" << endl;
+    return 0;
+}
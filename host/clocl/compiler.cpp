@@ -119,8 +119,10 @@ bool Compiler::compile(const std::string &options,
     diag_opts.MessageLength = 0;
 
     // Set frontend options
+    // Inside the OpenCL runtime the process outlives the compilation, the
+    // frontend has to release what it allocated
     frontend_opts.ProgramAction = clang::frontend::EmitLLVMOnly;
-    frontend_opts.DisableFree = true;
+    frontend_opts.DisableFree = false;
 
     // Set header search options
     header_opts.Verbose = false;
@@ -141,7 +143,16 @@ bool Compiler::compile(const std::string &options,
 
     // Set target options
     // For 6X, use the 'c6000' target as it implements opencl specs
-    target_opts.Triple = "c6000-unknown-unknown-unknown";
+    // For the CPU device, compile for the host. The host targets have no
+    // OpenCL address space map, use the fake one to keep them distinct.
+    if (opt_host)
+    {
+        target_opts.Triple = llvm::sys::getProcessTriple();
+        lang_opts.FakeAddressSpaceMap = true;
+        use_pch = false;
+    }
+    else
+        target_opts.Triple = "c6000-unknown-unknown-unknown";
 
     // Currently, llp6x does not handle fused multiply and add
     // llvm intrinsics (llvm.fmuladd.*). Disable generating these
@@ -250,8 +261,13 @@ bool Compiler::compile(const std::string &options,
         }
         else prep_opts.Includes.push_back("clc.h");
 
-        prep_opts.Includes.push_back("dsp_c.h");
-        prep_opts.Includes.push_back("dsp.h");
+        if (opt_host)
+            prep_opts.Includes.push_back("cpu.h");
+        else
+        {
+            prep_opts.Includes.push_back("dsp_c.h");
+            prep_opts.Includes.push_back("dsp.h");
+        }
     }
 
     add_macrodefs_for_supported_opencl_extensions(prep_opts);
@@ -269,9 +285,10 @@ bool Compiler::compile(const std::string &options,
 
     p_compiler.getDiagnostics().setWarningsAsErrors(Werror);
 
-    // Feed the compiler with source
+    // Feed the compiler with source, the file itself may not exist when the
+    // runtime hands the source over in memory
     frontend_opts.Inputs.push_back(clang::FrontendInputFile(filename.c_str(), clang::IK_OpenCL));
-    //prep_opts.addRemappedFile(filename.c_str(), source);
+    prep_opts.addRemappedFile(filename.c_str(), source);
 
     // Compile
     std::unique_ptr<clang::CodeGenAction> act(
@@ -291,9 +308,6 @@ bool Compiler::compile(const std::string &options,
     // uncomment to debug the llvm IR
     // p_module->dump();
 
-    // Cleanup
-    //prep_opts.eraseRemappedFile(prep_opts.remapped_file_buffer_end());
-
     return true;
 }
 
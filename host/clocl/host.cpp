@@ -0,0 +1,381 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <memory>
+
+#include <llvm/PassManager.h>
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormattedStream.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+
+#include "host.h"
+#include "file_manip.h"
+#include "options.h"
+
+using namespace std;
+using namespace llvm;
+
+/******************************************************************************
+* Address spaces: the host targets have no OpenCL address space map, clang
+* then uses its fake one (global 1, local 2, constant 3). The runtime reads
+* the argument address spaces from the bitcode with the c6000 numbering
+* (global 1, constant 2, local 3).
+******************************************************************************/
+static unsigned ti_address_space(unsigned as)
+{
+    switch (as)
+    {
+        case 2:  return 3;
+        case 3:  return 2;
+        default: return as;
+    }
+}
+
+/******************************************************************************
+* Offset of an argument in the argument image, see CPUKernel::typeOffset()
+******************************************************************************/
+static size_t arg_size(const DataLayout &dl, Type *type)
+{
+    if (type->isPointerTy()) return dl.getPointerSize();
+
+    if (type->isVectorTy())
+    {
+        VectorType *vtype = cast<VectorType>(type);
+        return (vtype->getElementType()->getPrimitiveSizeInBits() / 8) *
+                vtype->getNumElements();
+    }
+
+    return dl.getTypeStoreSize(type);
+}
+
+static size_t arg_offset(size_t &offset, size_t size)
+{
+    size_t align = 1;
+    while (align < size) align <<= 1;
+
+    size_t rs = (offset + align - 1) & ~(align - 1);
+    offset = rs + align;
+
+    return rs;
+}
+
+/******************************************************************************
+* Kernels listed in the opencl.kernels metadata
+******************************************************************************/
+static void get_kernels(Module *module, vector<Function *> &kernels)
+{
+    NamedMDNode *kern_meta = module->getNamedMetadata("opencl.kernels");
+
+    for (unsigned i = 0; kern_meta && i < kern_meta->getNumOperands(); ++i)
+    {
+        MDNode *node  = kern_meta->getOperand(i);
+        Value  *value = cast<ValueAsMetadata>(node->getOperand(0))->getValue();
+        if (isa<Function>(value)) kernels.push_back(cast<Function>(value));
+    }
+}
+
+/******************************************************************************
+* add_launchers: void __ocl_launch_<kernel>(i8 *args)
+******************************************************************************/
+static void add_launchers(Module *module, const vector<Function *> &kernels)
+{
+    LLVMContext &ctx = module->getContext();
+    DataLayout   dl(module);
+    FunctionType *launch_type = FunctionType::get(Type::getVoidTy(ctx),
+                                        Type::getInt8PtrTy(ctx), false);
+
+    for (Function *kernel : kernels)
+    {
+        Function *launcher = Function::Create(launch_type,
+                                Function::ExternalLinkage,
+                                "__ocl_launch_" + kernel->getName().str(),
+                                module);
+        BasicBlock *entry = BasicBlock::Create(ctx, "entry", launcher);
+        IRBuilder<> builder(entry);
+        Value *args = &*launcher->arg_begin();
+
+        vector<Value *> call_args;
+        size_t offset = 0;
+        FunctionType *ktype = kernel->getFunctionType();
+
+        for (unsigned i = 0; i < ktype->getNumParams(); ++i)
+        {
+            Type  *type = ktype->getParamType(i);
+            size_t pos  = arg_offset(offset, arg_size(dl, type));
+
+            Value *addr = builder.CreateConstInBoundsGEP1_64(args, pos);
+            addr = builder.CreateBitCast(addr, type->getPointerTo());
+            call_args.push_back(builder.CreateAlignedLoad(addr, 1));
+        }
+
+        CallInst *call = builder.CreateCall(kernel, call_args);
+        call->setCallingConv(kernel->getCallingConv());
+        builder.CreateRetVoid();
+    }
+}
+
+/******************************************************************************
+* add_builtin_table: route the external functions through __ocl_builtins
+******************************************************************************/
+static void add_builtin_table(Module *module)
+{
+    LLVMContext &ctx = module->getContext();
+    vector<Function *> externals;
+
+    for (Module::iterator f = module->begin(), e = module->end(); f != e; ++f)
+    {
+        if (!f->isDeclaration() || f->isIntrinsic() || f->use_empty())
+            continue;
+
+        // Variadic functions (printf) are resolved by the dynamic linker
+        if (f->isVarArg()) continue;
+
+        externals.push_back(&*f);
+    }
+
+    Type          *ptr_type   = Type::getInt8PtrTy(ctx);
+    ArrayType     *table_type = ArrayType::get(ptr_type, externals.size());
+    GlobalVariable *table = new GlobalVariable(*module, table_type, false,
+                                GlobalValue::ExternalLinkage,
+                                ConstantAggregateZero::get(table_type),
+                                "__ocl_builtins");
+
+    vector<Constant *> names;
+    Constant *zero = ConstantInt::get(Type::getInt32Ty(ctx), 0);
+    Constant *indices[] = { zero, zero };
+
+    for (unsigned i = 0; i < externals.size(); ++i)
+    {
+        Function *f = externals[i];
+
+        Constant *name = ConstantDataArray::getString(ctx, f->getName());
+        GlobalVariable *name_var = new GlobalVariable(*module,
+                                name->getType(), true,
+                                GlobalValue::PrivateLinkage, name);
+        names.push_back(ConstantExpr::getInBoundsGetElementPtr(name_var,
+                                                               indices));
+
+        // The declaration becomes a forwarder calling through the table
+        BasicBlock *entry = BasicBlock::Create(ctx, "entry", f);
+        IRBuilder<> builder(entry);
+
+        Value *callee = builder.CreateLoad(
+                            builder.CreateConstInBoundsGEP2_32(table, 0, i));
+        callee = builder.CreateBitCast(callee, f->getType());
+
+        vector<Value *> args;
+        for (Function::arg_iterator a = f->arg_begin(); a != f->arg_end(); ++a)
+            args.push_back(&*a);
+
+        CallInst *call = builder.CreateCall(callee, args);
+        call->setCallingConv(f->getCallingConv());
+
+        if (f->getReturnType()->isVoidTy()) builder.CreateRetVoid();
+        else                                builder.CreateRet(call);
+
+        f->removeFnAttr(Attribute::ReadNone);
+        f->removeFnAttr(Attribute::ReadOnly);
+        f->setLinkage(GlobalValue::InternalLinkage);
+    }
+
+    ArrayType *names_type = ArrayType::get(ptr_type, names.size());
+    new GlobalVariable(*module, names_type, true, GlobalValue::ExternalLinkage,
+                       ConstantArray::get(names_type, names),
+                       "__ocl_builtin_names");
+
+    new GlobalVariable(*module, Type::getInt32Ty(ctx), true,
+                       GlobalValue::ExternalLinkage,
+                       ConstantInt::get(Type::getInt32Ty(ctx), names.size()),
+                       "__ocl_num_builtins");
+}
+
+/******************************************************************************
+* kernel_signatures: bitcode of the kernel declarations and their metadata,
+* the part of the module the runtime inspects
+******************************************************************************/
+static string kernel_signatures(Module *module, const vector<Function *> &kernels)
+{
+    LLVMContext &ctx = module->getContext();
+    Module *sig = new Module(module->getModuleIdentifier(), ctx);
+
+    sig->setTargetTriple(module->getTargetTriple());
+    sig->setDataLayout(module->getDataLayout());
+
+    NamedMDNode *kern_meta = module->getNamedMetadata("opencl.kernels");
+    NamedMDNode *sig_meta  = sig->getOrInsertNamedMetadata("opencl.kernels");
+
+    for (unsigned i = 0; kern_meta && i < kern_meta->getNumOperands(); ++i)
+    {
+        MDNode *node  = kern_meta->getOperand(i);
+        Value  *value = cast<ValueAsMetadata>(node->getOperand(0))->getValue();
+        if (!isa<Function>(value)) continue;
+
+        Function     *kernel = cast<Function>(value);
+        FunctionType *ktype  = kernel->getFunctionType();
+        vector<Type *> params;
+
+        for (unsigned p = 0; p < ktype->getNumParams(); ++p)
+        {
+            Type *type = ktype->getParamType(p);
+            if (PointerType *ptype = dyn_cast<PointerType>(type))
+                type = PointerType::get(ptype->getElementType(),
+                               ti_address_space(ptype->getAddressSpace()));
+            params.push_back(type);
+        }
+
+        Function *decl = Function::Create(
+                            FunctionType::get(ktype->getReturnType(), params,
+                                              false),
+                            Function::ExternalLinkage, kernel->getName(), sig);
+        decl->setAttributes(kernel->getAttributes());
+        decl->setCallingConv(kernel->getCallingConv());
+
+        vector<Metadata *> operands;
+        operands.push_back(ValueAsMetadata::get(decl));
+        for (unsigned op = 1; op < node->getNumOperands(); ++op)
+            operands.push_back(node->getOperand(op));
+
+        sig_meta->addOperand(MDNode::get(ctx, operands));
+    }
+
+    string bitcode;
+    raw_string_ostream str_ostream(bitcode);
+    WriteBitcodeToFile(sig, str_ostream);
+    str_ostream.flush();
+
+    delete sig;
+    return bitcode;
+}
+
+/******************************************************************************
+* emit_object: host code generation
+******************************************************************************/
+static bool emit_object(Module *module, const string &obj_file)
+{
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+
+    string triple = module->getTargetTriple();
+    string error;
+    const Target *target = TargetRegistry::lookupTarget(triple, error);
+    if (!target)
+    { cout << "clocl: no host target for " << triple << ": " << error << endl;
+      return false; }
+
+    TargetOptions options;
+    CodeGenOpt::Level level = opt_debug ? CodeGenOpt::None
+                                        : CodeGenOpt::Aggressive;
+
+    unique_ptr<TargetMachine> machine(target->createTargetMachine(triple,
+                            sys::getHostCPUName(), "", options,
+                            Reloc::PIC_, CodeModel::Default, level));
+    if (!machine)
+    { cout << "clocl: cannot create a target machine for " << triple << endl;
+      return false; }
+
+    std::error_code err_info;
+    raw_fd_ostream out(obj_file.c_str(), err_info, sys::fs::F_None);
+    if (err_info)
+    { cout << "clocl: cannot write " << obj_file << endl; return false; }
+
+    formatted_raw_ostream fout(out);
+    PassManager manager;
+    manager.add(new DataLayoutPass());
+
+    if (machine->addPassesToEmitFile(manager, fout,
+                                     TargetMachine::CGFT_ObjectFile))
+    { cout << "clocl: host target cannot emit objects" << endl; return false; }
+
+    manager.run(*module);
+    fout.flush();
+
+    return true;
+}
+
+/******************************************************************************
+* host_compile
+******************************************************************************/
+bool host_compile(const string &bc_file, Module *module)
+{
+    vector<Function *> kernels;
+    get_kernels(module, kernels);
+
+    LLVMContext &ctx = module->getContext();
+    string bitcode = kernel_signatures(module, kernels);
+
+    add_launchers(module, kernels);
+    add_builtin_table(module);
+
+    Constant *ir = ConstantDataArray::getString(ctx, bitcode, false);
+    GlobalVariable *ir_var = new GlobalVariable(*module, ir->getType(), true,
+                                GlobalValue::ExternalLinkage, ir,
+                                "__ocl_llvmir");
+    ir_var->setSection(".llvmir");
+
+    string obj_file(fs_replace_extension(bc_file, ".o"));
+    string so_file (fs_replace_extension(bc_file, ".so"));
+
+    if (!emit_object(module, obj_file)) return false;
+
+    const char *cc = getenv("CC");
+    string command(cc ? cc : "cc");
+    command += " -shared -o ";
+    command += so_file;
+    command += " ";
+    command += obj_file;
+    command += " -lm";
+
+    if (opt_verbose) cout << command << endl;
+    int x = run_command(command);
+
+    if (!opt_keep)
+    {
+        fs_remove_file(obj_file);
+        fs_remove_file(bc_file);
+    }
+
+    return x == 0;
+}
@@ -0,0 +1,48 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#ifndef _HOST_H_
+#define _HOST_H_
+
+#include <string>
+
+namespace llvm { class Module; }
+
+/*-----------------------------------------------------------------------------
+* host_compile: build a shared object the CPU device loads with dlopen().
+*
+* For every kernel, an "__ocl_launch_<kernel>(char *args)" launcher reads the
+* arguments from the image built by the runtime and calls the kernel. The
+* external functions the kernels call (work-item functions, barrier, image
+* accessors) are reached through the "__ocl_builtins" table, filled by the
+* runtime from the "__ocl_builtin_names" array when the object is loaded.
+* The kernel signatures are kept in bitcode, in the ".llvmir" section, with
+* the TI address space numbering the runtime expects.
+*----------------------------------------------------------------------------*/
+bool host_compile(const std::string &bc_file, llvm::Module *module);
+
+#endif // _HOST_H_
@@ -0,0 +1,65 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#ifndef _LIBCLOCL_H_
+#define _LIBCLOCL_H_
+
+/*-----------------------------------------------------------------------------
+* libclocl: the clocl front end (clang and the LLVM transformations) as a
+* shared library, so that the OpenCL runtime compiles programs in-process.
+* The library keeps the LLVM context and the registered passes between
+* builds. Only the C6000 code generation (cl6x) runs as a separate process.
+*
+* The library is loaded with dlopen(), it holds its own copy of LLVM and does
+* not export it.
+*----------------------------------------------------------------------------*/
+#define CLOCL_LIBRARY     "libclocl.so"
+#define CLOCL_RUN_SYMBOL  "clocl_run"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------------------------
+* clocl_run: same as running "clocl" with argv, argv[0] is ignored.
+*
+* If source is not NULL, it is used as the content of the OpenCL C file named
+* in argv, that file is not read. On return, *log points to the output of the
+* compilation, it is released by the caller with free(). Returns the clocl
+* exit status, 0 on success. Calls from several threads overlap, except
+* for the front end which runs one build at a time.
+*----------------------------------------------------------------------------*/
+int clocl_run(int argc, char *argv[], const char *source, char **log);
+
+typedef int (*clocl_run_fn)(int argc, char *argv[], const char *source,
+                            char **log);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LIBCLOCL_H_
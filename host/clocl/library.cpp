@@ -0,0 +1,129 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/PassRegistry.h>
+#include <llvm/InitializePasses.h>
+
+#include "libclocl.h"
+#include "options.h"
+
+using namespace std;
+
+/******************************************************************************
+* Output of clocl goes to cout. While a thread runs clocl_run, what it writes
+* to cout is collected in its build log, other output goes to the original
+* cout buffer.
+******************************************************************************/
+static thread_local string *thread_log = NULL;
+
+class LogBuf : public streambuf
+{
+    public:
+        LogBuf(streambuf *out) : p_out(out) {}
+
+    protected:
+        int overflow(int c)
+        {
+            if (c == EOF)   return 0;
+            if (!thread_log) return p_out->sputc(c);
+
+            thread_log->push_back(c);
+            return c;
+        }
+
+        streamsize xsputn(const char *s, streamsize n)
+        {
+            if (!thread_log) return p_out->sputn(s, n);
+
+            thread_log->append(s, n);
+            return n;
+        }
+
+        int sync()
+        {
+            return thread_log ? 0 : p_out->pubsync();
+        }
+
+    private:
+        streambuf *p_out;
+};
+
+/******************************************************************************
+* Register the passes and create the global context once, when the library is
+* loaded, rather than in the first build
+******************************************************************************/
+__attribute__((constructor)) static void clocl_warm_up()
+{
+    llvm::PassRegistry &registry = *llvm::PassRegistry::getPassRegistry();
+    llvm::initializeCore(registry);
+    llvm::initializeScalarOpts(registry);
+    llvm::initializeIPO(registry);
+    llvm::initializeAnalysis(registry);
+    llvm::initializeIPA(registry);
+    llvm::initializeTransformUtils(registry);
+    llvm::initializeInstCombine(registry);
+    llvm::initializeTarget(registry);
+
+    (void) llvm::getGlobalContext();
+
+    static LogBuf log_buf(cout.rdbuf());
+    cout.rdbuf(&log_buf);
+}
+
+/******************************************************************************
+* clocl_run
+******************************************************************************/
+extern "C" int clocl_run(int argc, char *argv[], const char *source,
+                         char **log)
+{
+    string output;
+    thread_log = &output;
+
+    int ret_code;
+    try
+    {
+        ret_code = clocl_main(argc, argv, source);
+    }
+    catch (...)
+    {
+        cout << "clocl: internal compiler error" << endl;
+        ret_code = -1;
+    }
+
+    cout.flush();
+    thread_log = NULL;
+
+    if (log) *log = strdup(output.c_str());
+    return ret_code;
+}
@@ -37,6 +37,11 @@
 #include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Constants.h>
 
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
 
 using namespace llvm;
 
@@ -111,6 +116,162 @@ bool isReqdWGSize111(llvm::Function &F)
     return (wgsizes[0] == 1 && wgsizes[1] == 1 && wgsizes[2] == 1);
 }
 
+/******************************************************************************
+* constantFromBytes(Type *type, const unsigned char *bytes, size_t size)
+*
+* Constant of type whose little endian memory image is bytes. NULL for the
+* types that cannot be folded (pointers, aggregates).
+******************************************************************************/
+static Constant *constantFromBytes(Type *type, const unsigned char *bytes,
+                                     size_t size, const DataLayout &DL)
+{
+    uint64_t type_size = DL.getTypeStoreSize(type);
+    if (type_size > size) return NULL;
+
+    if (VectorType *vtype = dyn_cast<VectorType>(type))
+    {
+        Type    *etype = vtype->getElementType();
+        uint64_t esize = DL.getTypeStoreSize(etype);
+
+        std::vector<Constant *> elements;
+        for (unsigned int i = 0; i < vtype->getNumElements(); ++i)
+        {
+            Constant *element = constantFromBytes(etype, bytes + i * esize,
+                                                    esize, DL);
+            if (!element) return NULL;
+            elements.push_back(element);
+        }
+        return ConstantVector::get(elements);
+    }
+
+    if (type_size > 8) return NULL;
+
+    uint64_t bits = 0;
+    for (uint64_t i = type_size; i > 0; --i)
+        bits = (bits << 8) | bytes[i - 1];
+
+    if (type->isIntegerTy())
+        return ConstantInt::get(type, bits);
+    if (type->isFloatTy())
+        return ConstantFP::get(type->getContext(),
+                               APFloat(APFloat::IEEEsingle, APInt(32, bits)));
+    if (type->isDoubleTy())
+        return ConstantFP::get(type->getContext(),
+                               APFloat(APFloat::IEEEdouble, APInt(64, bits)));
+    return NULL;
+}
+
+/******************************************************************************
+* setReqdWGSize(Function &F, const int wgsizes[3])
+*
+* Add, or replace, the reqd_work_group_size node of kernel F
+******************************************************************************/
+static void setReqdWGSize(llvm::Function &F, const int wgsizes[3])
+{
+    LLVMContext       &ctx   = F.getContext();
+    llvm::Type        *Int32 = llvm::IntegerType::getInt32Ty(ctx);
+    llvm::NamedMDNode *ks    = F.getParent()->getNamedMetadata("opencl.kernels");
+
+    Metadata *reqd_ops[] = {
+        MDString::get(ctx, "reqd_work_group_size"),
+        ConstantAsMetadata::get(ConstantInt::get(Int32, wgsizes[0])),
+        ConstantAsMetadata::get(ConstantInt::get(Int32, wgsizes[1])),
+        ConstantAsMetadata::get(ConstantInt::get(Int32, wgsizes[2])) };
+    MDNode *reqd = MDNode::get(ctx, reqd_ops);
+
+    /*-------------------------------------------------------------------------
+    * Kernel nodes are uniqued, the named node is rebuilt with a new one for F
+    *------------------------------------------------------------------------*/
+    std::vector<MDNode *> kernels;
+    for (unsigned int i = 0; i < ks->getNumOperands(); ++i)
+    {
+        MDNode *ker = ks->getOperand(i);
+        llvm::Value *value =
+                   cast<llvm::ValueAsMetadata>(ker->getOperand(0))->getValue();
+
+        if (value == &F)
+        {
+            std::vector<Metadata *> ops;
+            for (unsigned int j = 0; j < ker->getNumOperands(); j++)
+            {
+                MDNode *meta = dyn_cast<MDNode>(ker->getOperand(j));
+                if (meta && meta->getNumOperands() == 4 &&
+                    isa<MDString>(meta->getOperand(0)) &&
+                    cast<MDString>(meta->getOperand(0))->getString() ==
+                                                      "reqd_work_group_size")
+                    continue;
+                ops.push_back(ker->getOperand(j));
+            }
+            ops.push_back(reqd);
+            ker = MDNode::get(ctx, ops);
+        }
+        kernels.push_back(ker);
+    }
+
+    ks->dropAllReferences();
+    for (MDNode *ker : kernels) ks->addOperand(ker);
+}
+
+/******************************************************************************
+* specializeKernel(Module &M, const std::string &spec)
+*
+* spec is <kernel>:<x>,<y>,<z>[:<arg index>=<hex bytes>]..., see the runtime
+* Coal::Kernel::specialized(). Uses of the listed arguments of the kernel are
+* replaced by their values, given as hex bytes in memory order, and a non
+* zero work-group size becomes its reqd_work_group_size. The signature of the
+* kernel is unchanged, the host still passes every argument.
+******************************************************************************/
+bool specializeKernel(llvm::Module &M, const std::string &spec)
+{
+    std::vector<std::string> fields;
+    size_t start = 0, end;
+    do
+    {
+        end = spec.find(':', start);
+        fields.push_back(spec.substr(start, end - start));
+        start = end + 1;
+    } while (end != std::string::npos);
+
+    if (fields.size() < 2) return false;
+
+    llvm::Function *F = M.getFunction(fields[0]);
+    if (!F || !isKernelFunction(*F)) return false;
+
+    int wgsizes[3];
+    if (sscanf(fields[1].c_str(), "%d,%d,%d",
+               &wgsizes[0], &wgsizes[1], &wgsizes[2]) != 3)
+        return false;
+
+    DataLayout DL(&M);
+    for (size_t i = 2; i < fields.size(); ++i)
+    {
+        const std::string &field = fields[i];
+        size_t eq = field.find('=');
+        if (eq == std::string::npos) return false;
+
+        unsigned int index = atoi(field.c_str());
+        if (index >= F->arg_size()) return false;
+
+        std::vector<unsigned char> bytes;
+        for (size_t j = eq + 1; j + 1 < field.size(); j += 2)
+            bytes.push_back(strtoul(field.substr(j, 2).c_str(), NULL, 16));
+
+        Function::arg_iterator arg = F->arg_begin();
+        std::advance(arg, index);
+
+        Constant *value = constantFromBytes(arg->getType(), bytes.data(),
+                                              bytes.size(), DL);
+        if (!value) return false;
+
+        arg->replaceAllUsesWith(value);
+    }
+
+    if (wgsizes[0] > 0 && wgsizes[1] > 0 && wgsizes[2] > 0)
+        setReqdWGSize(*F, wgsizes);
+
+    return true;
+}
+
 /******************************************************************************
 * getDebugInfo(Function &F, unsigned int &scope_line_num)
 ******************************************************************************/
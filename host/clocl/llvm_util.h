@@ -34,6 +34,8 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/DebugInfo.h>
 
+#include <string>
+
 #ifndef _UTIL_H
 #define _UTIL_H
 
@@ -41,6 +43,7 @@
 bool          isKernelFunction(llvm::Function &F);
 bool          getReqdWGSize(llvm::Function &F, int wgsizes[3]);
 bool          isReqdWGSize111(llvm::Function &F);
+bool          specializeKernel(llvm::Module &M, const std::string &spec);
 bool          containsBarrierCall(llvm::Module &M);
 bool          canLocalsFitInReg(llvm::BasicBlock *bb);
 bool          canLocalsFitInReg(llvm::Function &F);
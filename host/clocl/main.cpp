@@ -32,6 +32,8 @@
 #include <sstream>
 #include <cstdlib>
 #include <sys/stat.h>
+#include <memory>
+#include <mutex>
 
 #include <llvm/Bitcode/ReaderWriter.h>
 #include <llvm/PassManager.h>
@@ -60,6 +62,7 @@
 #include "llvm_util.h"
 #include "file_manip.h"
 #include "options.h"
+#include "host.h"
 
 #include <WorkitemHandlerChooser.h>
 #include <BreakConstantGEPs.h>
@@ -121,10 +124,34 @@ void write_bitcode(string bc_file, Module* module)
 }
 
 /******************************************************************************
-* main
+* clocl_main
 ******************************************************************************/
-int main(int argc, char *argv[])
+static int compile_and_link(int argc, char *argv[], const char *src);
+
+int clocl_main(int argc, char *argv[], const char *source)
+{
+    try
+    {
+        return compile_and_link(argc, argv, source);
+    }
+    catch (const clocl_exit &e)
+    {
+        return e.code;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+* Option parsing (getopt) and the front end (clang and the LLVM passes) are not
+* reentrant: when the OpenCL runtime builds on several threads, they take
+* turns. The C6000 tools, most of the build time, run concurrently.
+*----------------------------------------------------------------------------*/
+static std::mutex frontend_mutex;
+
+static int compile_and_link(int argc, char *argv[], const char *src)
 {
+    std::unique_lock<std::mutex> frontend_lock(frontend_mutex);
+
+    reset_options();
     process_options(argc, argv);
 
     /* Process library creation mode */
@@ -134,7 +161,8 @@ int main(int argc, char *argv[])
         files_c.empty()   &&
         opt_ar_lib)
     {
-        if (!run_ar6x(files_a, files_other))                           exit(-1);
+        frontend_lock.unlock();
+        if (!run_ar6x(files_a, files_other))                           return -1;
         return 0;
     }
 
@@ -144,7 +172,8 @@ int main(int argc, char *argv[])
         files_c.empty()    &&
         opt_link)
     {
-        if (!run_cl6x_link(files_out, files_other, files_a))           exit(-1);
+        frontend_lock.unlock();
+        if (!run_cl6x_link(files_out, files_other, files_a))           return -1;
         return 0;
     }
 
@@ -152,22 +181,47 @@ int main(int argc, char *argv[])
 
     string    filename = files_clc[0];
     string    bc_file  = bc_filename(filename); // intermediate bit code file
-    string    source;  // OpenCL C program source
-    string    binary;  // Untransformed LLVM bitcode (still per workitem)
     string    xformed_binary; // transformed LLVM bitcode (per workgroup)
-    Module   *module;  // module, evolves during transformation
-    Compiler  compiler;
 
-    if (!prepend_headers(filename, source))                            exit(-1);
-    if (!run_clang      (filename, source, compiler, &module))         exit(-1);
-    if (!llvm_xforms    (module, compiler.optimize()))                 exit(-1);
+    {
+        string    source;  // OpenCL C program source
+        Module   *module;  // module, evolves during transformation
+        Compiler  compiler;
+
+        if (src) source = src;
+        else if (!prepend_headers(filename, source))                   return -1;
+        if (!run_clang  (filename, source, compiler, &module))         return -1;
+
+        // The module lives in the global context, which outlives this build
+        std::unique_ptr<Module> module_owner(module);
+
+        if (!opt_specialize.empty() && !specializeKernel(*module, opt_specialize))
+        {
+            cout << "clocl: cannot specialize " << opt_specialize << endl;
+            return -1;
+        }
 
-    write_bitcode(bc_file, module);
+        if (!llvm_xforms(module, compiler.optimize()))                 return -1;
 
-    llvm::raw_string_ostream str_ostream(xformed_binary);
-    llvm::WriteBitcodeToFile(module, str_ostream);
-    str_ostream.flush();
-    if (!cl6x (bc_file, xformed_binary))                               exit(-1);
+        write_bitcode(bc_file, module);
+
+        /*---------------------------------------------------------------------
+        * CPU device: the per work-item kernels are compiled for the host
+        *--------------------------------------------------------------------*/
+        if (opt_host)
+        {
+            if (!host_compile(bc_file, module))                        return -1;
+            return 0;
+        }
+
+        llvm::raw_string_ostream str_ostream(xformed_binary);
+        llvm::WriteBitcodeToFile(module, str_ostream);
+        str_ostream.flush();
+    }
+
+    frontend_lock.unlock();
+
+    if (!cl6x (bc_file, xformed_binary))                               return -1;
 
     if (opt_txt) write_text(filename);
 
@@ -271,7 +325,8 @@ bool llvm_xforms(Module *module, bool optimize)
     manager->add(llvm::createAlwaysInlinerPass());
 
     // pocl barrier transformation
-    if (hasBarrier)
+    // On the host, barrier() switches between work-item contexts instead
+    if (hasBarrier && !opt_host)
     {
         manager->add(    llvm::createPromoteMemoryToRegisterPass());
         manager->add(new llvm::DominatorTreeWrapperPass());
@@ -332,12 +387,25 @@ bool llvm_xforms(Module *module, bool optimize)
     }
 
     /*-------------------------------------------------------------------------
-    * Builtins will not have workitem functions and do not need wga
+    * Builtins will not have workitem functions and do not need wga. The CPU
+    * device runtime iterates over the work-items of host kernels itself.
     *------------------------------------------------------------------------*/
-    if (!opt_builtin)
+    if (!opt_builtin && !opt_host)
     {
         manager->add(llvm::createUnifyFunctionExitNodesPass());
-        manager->add(llvm::createTIOpenclWorkGroupAggregationPass(hasBarrier));
+
+        /*---------------------------------------------------------------------
+        * Vectorizing the work-item loop starts from the uniform values
+        *--------------------------------------------------------------------*/
+        if (!hasBarrier && opt_vector_width > 1)
+        {
+            manager->add(new llvm::DominatorTreeWrapperPass());
+            manager->add(new llvm::PostDominatorTree());
+            manager->add(new pocl::VariableUniformityAnalysis());
+        }
+
+        manager->add(llvm::createTIOpenclWorkGroupAggregationPass(hasBarrier,
+                                                         opt_vector_width));
 
         /*---------------------------------------------------------------------
         * Borrow the pocl alloca hoister for the TI simplistic WGA pass as well
@@ -346,7 +414,8 @@ bool llvm_xforms(Module *module, bool optimize)
             manager->add(new pocl::AllocasToEntry());
     }
 
-    manager->add(new tiocl::TIOpenCLSimplifyShuffleBIFCall());
+    if (!opt_host)
+        manager->add(new tiocl::TIOpenCLSimplifyShuffleBIFCall());
     manager->add(llvm::createGlobalDCEPass());
     manager->add(llvm::createCFGSimplificationPass());
     manager->add(llvm::createLoopSimplifyPass());  // for llp6x loop.parallel
@@ -16,6 +16,7 @@
 #include <algorithm>
 
 #include "file_manip.h"
+#include "options.h"
 
 using std::cout;
 using std::endl;
@@ -23,33 +24,35 @@ using std::string;
 using std::vector;
 using std::ostream_iterator;
 
-int opt_help      = 0;
-int opt_verbose   = 0;
-int opt_keep      = 0;
-int opt_debug     = 0;
-int opt_symbols   = 0;
-int opt_lib       = 0;
-int opt_link      = 0;
-int opt_expsyms   = 0;
-int opt_ar_lib    = 0;
-int opt_link_opts = 0;
-int opt_txt       = 0;
-int opt_w         = 0;
-int opt_Werror    = 0;
-int opt_builtin   = 0;
-int opt_tmpdir    = 0;
-int opt_version   = 0;
-int opt_alias     = 0;
-
-string cl_options;
-string cl_incdef;
-string opts_other;
-vector<string> files_clc;
-vector<string> files_c;
-string         files_a;
-string         files_out;
-string         files_other;
-string         file_expsyms;
+thread_local int opt_help      = 0;
+thread_local int opt_verbose   = 0;
+thread_local int opt_keep      = 0;
+thread_local int opt_debug     = 0;
+thread_local int opt_symbols   = 0;
+thread_local int opt_lib       = 0;
+thread_local int opt_link      = 0;
+thread_local int opt_expsyms   = 0;
+thread_local int opt_ar_lib    = 0;
+thread_local int opt_link_opts = 0;
+thread_local int opt_txt       = 0;
+thread_local int opt_w         = 0;
+thread_local int opt_Werror    = 0;
+thread_local int opt_builtin   = 0;
+thread_local int opt_tmpdir    = 0;
+thread_local int opt_version   = 0;
+thread_local int opt_alias     = 0;
+thread_local int opt_host      = 0;
+thread_local int opt_vector_width = 1;
+
+thread_local string cl_options;
+thread_local string cl_incdef;
+thread_local string opts_other;
+thread_local vector<string> files_clc;
+thread_local vector<string> files_c;
+thread_local string         files_a;
+thread_local string         files_out;
+thread_local string         files_other;
+thread_local string         file_expsyms;
 
 #define STRINGIZE(x) #x
 #define STRINGIZE2(x) STRINGIZE(x)
@@ -80,6 +83,11 @@ void print_options()
     if (opt_Werror)    printf ("Option Werror     : on\n");
     if (opt_alias)     printf ("Option alias      : on\n");
     if (opt_symbols)   printf ("Option symbols    : on\n");
+    if (opt_host)      printf ("Option host       : on\n");
+    if (opt_vector_width > 1)
+                       printf ("Option vector width: %d\n", opt_vector_width);
+    if (!opt_specialize.empty())
+                       printf ("Option specialize : %s\n", opt_specialize.c_str());
     //if (opt_builtin) printf ("Option builtin: on\n");
     //if (opt_tmpdir)  printf ("Option tmpdir : on\n");
 
@@ -126,6 +134,11 @@ void print_help()
     cout << "   -l, --lib     : Do not link. Stop after compilation." << endl;
     cout << "   -s, --symbols : Keep Symbols." << endl;
     cout << "   -a, --alias   : Assume kernel buffers alias each other" << endl;
+    cout << "   --host        : Build a shared object for the CPU device" << endl;
+    cout << "   --wga-vector-width=<n>" << endl;
+    cout << "                 : Vectorize the work-item loop by n (2,4,8,16)" << endl;
+    cout << "   --specialize=<kernel>:<x>,<y>,<z>[:<arg>=<hex>]..." << endl;
+    cout << "                 : Fold argument values and work-group size" << endl;
     cout << "   --version     : Print OpenCL product." << endl;
     cout << endl;
     cout << "The OpenCL 1.2 build options. Refer to 1.2 spec for desc:" << endl;
@@ -145,7 +158,49 @@ void print_help()
     cout << "   -cl-std=<val>" << endl;
     cout << "   -cl-kernel-arg-info" << endl;
     cout << endl;
-    exit(-1);
+    throw clocl_exit(-1);
+}
+
+/******************************************************************************
+* void reset_options()
+*
+* Return to the initial state before processing the options of another
+* invocation in the same process.
+******************************************************************************/
+void reset_options()
+{
+    opt_help      = 0;
+    opt_verbose   = 0;
+    opt_keep      = 0;
+    opt_debug     = 0;
+    opt_symbols   = 0;
+    opt_lib       = 0;
+    opt_link      = 0;
+    opt_expsyms   = 0;
+    opt_ar_lib    = 0;
+    opt_link_opts = 0;
+    opt_txt       = 0;
+    opt_w         = 0;
+    opt_Werror    = 0;
+    opt_builtin   = 0;
+    opt_tmpdir    = 0;
+    opt_version   = 0;
+    opt_alias     = 0;
+    opt_host      = 0;
+    opt_vector_width = 1;
+
+    cl_options.clear();
+    cl_incdef.clear();
+    opts_other.clear();
+    files_clc.clear();
+    files_c.clear();
+    files_a.clear();
+    files_out.clear();
+    files_other.clear();
+    file_expsyms.clear();
+    opt_specialize.clear();
+
+    optind = 0; // getopt restarts its scan from scratch
 }
 
 /******************************************************************************
@@ -157,7 +212,8 @@ void process_options(int argc, char **argv)
 
     while (1)
     {
-        static struct option long_options[] = {
+        // Not static, the flag addresses are those of the calling thread
+        struct option long_options[] = {
 
             /*-----------------------------------------------------------------
             * clocl options
@@ -173,8 +229,11 @@ void process_options(int argc, char **argv)
             {"builtin",     no_argument,        &opt_builtin, 'b' },
             {"tmpdir",      no_argument,        &opt_tmpdir,  'd' },
             {"alias",       no_argument,        &opt_alias,   'a' },
+            {"host",        no_argument,        &opt_host,     1  },
             {"version",     no_argument,        &opt_version,  1  },
             {"export-syms", required_argument,  &opt_expsyms,  0  },
+            {"wga-vector-width", required_argument, 0,         0  },
+            {"specialize",  required_argument,  0,             0  },
 
             /*-----------------------------------------------------------------
             * opencl 1.2 options
@@ -215,7 +274,8 @@ void process_options(int argc, char **argv)
                     name == "lib"     || name == "txt"       ||
                     name == "link"    ||
                     name == "builtin" || name == "tmpdir"    ||
-                    name == "alias"   || name == "symbols"
+                    name == "alias"   || name == "symbols"   ||
+                    name == "host"
                    ) break;
 
                 if (name == "cl-std")
@@ -225,6 +285,27 @@ void process_options(int argc, char **argv)
                     break;
                 }
 
+                if (name == "wga-vector-width")
+                {
+                    /*---------------------------------------------------------
+                    * Vector widths are powers of 2, anything else leaves the
+                    * work-item loops scalar
+                    *--------------------------------------------------------*/
+                    int width = atoi(optarg);
+                    if (width > 1 && width <= 16 && (width & (width - 1)) == 0)
+                        opt_vector_width = width;
+                    else
+                        cout << "clocl: ignoring --wga-vector-width=" << optarg
+                             << ", not one of 2, 4, 8 or 16" << endl;
+                    break;
+                }
+
+                if (name == "specialize")
+                {
+                    opt_specialize = optarg;
+                    break;
+                }
+
                 if (name == "export-syms")
                 {
                     file_expsyms += optarg;
@@ -2,34 +2,65 @@
 #define _OPTIONS_H_
 
 #include <string>
+#include <vector>
 
-extern int opt_help;
-extern int opt_verbose;
-extern int opt_version;
-extern int opt_keep;
-extern int opt_debug;
-extern int opt_symbols;
-extern int opt_lib;
-extern int opt_link;
-extern int opt_expsyms;
-extern int opt_ar_lib;
-extern int opt_link_opts;
-extern int opt_txt;
-extern int opt_w;
-extern int opt_Werror;
-extern int opt_builtin;
-extern int opt_tmpdir;
-extern int opt_alias;
-
-extern std::string cl_options;
-extern std::string cl_incdef;
-extern std::vector<std::string> files_clc;
-extern std::vector<std::string> files_c;
-extern std::string              files_a;
-extern std::string              files_out;
-extern std::string              files_other;
-extern std::string              file_expsyms;
+/*-----------------------------------------------------------------------------
+* The options are per thread: inside the OpenCL runtime, builds on several
+* threads run the C6000 tools concurrently (see clocl_main)
+*----------------------------------------------------------------------------*/
+extern thread_local int opt_help;
+extern thread_local int opt_verbose;
+extern thread_local int opt_version;
+extern thread_local int opt_keep;
+extern thread_local int opt_debug;
+extern thread_local int opt_symbols;
+extern thread_local int opt_lib;
+extern thread_local int opt_link;
+extern thread_local int opt_expsyms;
+extern thread_local int opt_ar_lib;
+extern thread_local int opt_link_opts;
+extern thread_local int opt_txt;
+extern thread_local int opt_w;
+extern thread_local int opt_Werror;
+extern thread_local int opt_builtin;
+extern thread_local int opt_tmpdir;
+extern thread_local int opt_alias;
+extern thread_local int opt_host;
+extern thread_local int opt_vector_width;
+
+extern thread_local std::string cl_options;
+extern thread_local std::string cl_incdef;
+extern thread_local std::vector<std::string> files_clc;
+extern thread_local std::vector<std::string> files_c;
+extern thread_local std::string              files_a;
+extern thread_local std::string              files_out;
+extern thread_local std::string              files_other;
+extern thread_local std::string              file_expsyms;
+extern thread_local std::string              opt_specialize;
 
 void process_options(int argc, char **argv);
+void reset_options();
+
+/*-----------------------------------------------------------------------------
+* clocl may run inside the OpenCL runtime (see libclocl.h), where exit() would
+* terminate the application. Fatal errors throw clocl_exit instead, it is
+* caught by clocl_main.
+*----------------------------------------------------------------------------*/
+struct clocl_exit
+{
+    clocl_exit(int c) : code(c) {}
+    int code;
+};
+
+/*-----------------------------------------------------------------------------
+* Compile or link as described by argv. If source is not NULL, it is the
+* content of the OpenCL C file named in argv, which does not have to exist.
+*----------------------------------------------------------------------------*/
+int clocl_main(int argc, char *argv[], const char *source);
+
+/*-----------------------------------------------------------------------------
+* Run an external tool (cl6x, strip6x, ...), its output is copied to cout
+*----------------------------------------------------------------------------*/
+int run_command(const std::string &command);
 
 #endif //_OPTIONS_H_
@@ -49,6 +49,27 @@
 
 using namespace std;
 
+#if defined(_MSC_VER)
+#define popen  _popen
+#define pclose _pclose
+#endif
+
+/******************************************************************************
+* Run a tool through the shell. Its standard output goes to cout, so that it
+* ends up in the build log when clocl runs inside the OpenCL runtime.
+******************************************************************************/
+int run_command(const string &command)
+{
+    FILE *output = popen(command.c_str(), "r");
+    if (!output) return -1;
+
+    char line[256];
+    while (fgets(line, sizeof(line), output)) cout << line;
+    cout.flush();
+
+    return pclose(output);
+}
+
 /******************************************************************************
 * Find the C6000 CGT installation
 ******************************************************************************/
@@ -66,7 +87,7 @@ const char *get_cgt_install()
         {
             std::cout << "\n The C6000 compiler installation specified by TI_OCL_CGT_INSTALL"
                          " does not exist: " << install << std::endl;
-            exit(EXIT_FAILURE);
+            throw clocl_exit(EXIT_FAILURE);
         }
     }
     else
@@ -74,7 +95,7 @@ const char *get_cgt_install()
         #if defined(_MSC_VER)
         std::cout << "\n TI_OCL_CGT_INSTALL must point to a C6000 compiler installation."
                   << std::endl;
-        exit(EXIT_FAILURE);
+        throw clocl_exit(EXIT_FAILURE);
         #endif
     }
 
@@ -90,7 +111,7 @@ const char *get_cgt_install()
        "Use the environment variable TI_OCL_CGT_INSTALL to specify an alternate\n"
        "installation path.\n"  << std::endl;
 
-       exit(EXIT_FAILURE);
+       throw clocl_exit(EXIT_FAILURE);
     }
     else
        install = const_cast<char*>(DEFAULT_TI_CGT_INSTALL_PATH);
@@ -126,7 +147,7 @@ std::string get_ocl_dsp()
     std::cout << "The OpenCL DSP directory " << stdpath
               << " does not exist !"         << std::endl;
 
-    exit(EXIT_FAILURE);
+    throw clocl_exit(EXIT_FAILURE);
 }
 
 
@@ -154,7 +175,7 @@ bool run_cl6x_link(string& outfile, string& obj_files, string& lib_files)
 
     if (opt_verbose) cout << command << endl;
 
-    int x = system(command.c_str());
+    int x = run_command(command);
     if (x != 0) return false;
 
     if (!opt_debug && !opt_symbols)
@@ -162,7 +183,7 @@ bool run_cl6x_link(string& outfile, string& obj_files, string& lib_files)
         string strip_command("strip6x -p ");
         strip_command += outfile;
         if (opt_verbose) cout << strip_command << endl;
-        x = system(strip_command.c_str());
+        x = run_command(strip_command);
         if (x != 0) return false;
     }
 
@@ -181,7 +202,7 @@ bool run_ar6x(string& liboutfile, string& obj_files)
 
     if (opt_verbose) cout << command << endl;
 
-    int ret_code = system(command.c_str());
+    int ret_code = run_command(command);
     if (ret_code != 0) return false;
 
     return true;
@@ -248,7 +269,7 @@ int run_cl6x(string filename, string* llvm_bitcode, string addl_files)
     if (opt_lib)
     {
         if (opt_verbose) cout << command << endl;
-        int x = system(command.c_str());
+        int x = run_command(command);
         // checking (return code != 0) works on both Linux and Windows
         if (x != 0) return false;
         return true;
@@ -275,7 +296,7 @@ int run_cl6x(string filename, string* llvm_bitcode, string addl_files)
     command += " -ldsp.syms ";
 
     if (opt_verbose) cout << command << endl;
-    int x = system(command.c_str());
+    int x = run_command(command);
     if (x != 0) return false;
 
     if (!opt_debug && !opt_symbols)
@@ -283,7 +304,7 @@ int run_cl6x(string filename, string* llvm_bitcode, string addl_files)
         string strip_command("strip6x -p ");
         strip_command += outfile;
         if (opt_verbose) cout << strip_command << endl;
-        x = system(strip_command.c_str());
+        x = run_command(strip_command);
         if (x != 0) return false;
     }
 
@@ -48,6 +48,7 @@
 #include <llvm/IR/Dominators.h>
 #include <llvm/Analysis/LoopInfo.h>
 #include "llvm_util.h"
+#include "VariableUniformityAnalysis.h"
 #include <stdio.h>
 
 using namespace std;
@@ -58,18 +59,21 @@ namespace llvm
 /******************************************************************************
 * createTIOpenclWorkGroupAggregation
 ******************************************************************************/
-Pass *createTIOpenclWorkGroupAggregationPass(bool is_pocl_mode) 
+Pass *createTIOpenclWorkGroupAggregationPass(bool is_pocl_mode,
+                                             unsigned int vector_width)
 {
     TIOpenclWorkGroupAggregation *fp = new TIOpenclWorkGroupAggregation(
-                                                                 is_pocl_mode);
+                                                   is_pocl_mode, vector_width);
     return fp;
 }
 
 /**************************************************************************
 * Constructor
 **************************************************************************/
-TIOpenclWorkGroupAggregation::TIOpenclWorkGroupAggregation(bool pocl_mode) : 
-    FunctionPass(ID), is_pocl_mode(pocl_mode), di_function(NULL)
+TIOpenclWorkGroupAggregation::TIOpenclWorkGroupAggregation(bool pocl_mode,
+                                                  unsigned int width) :
+    FunctionPass(ID), is_pocl_mode(pocl_mode),
+    vector_width(pocl_mode ? 1 : width), di_function(NULL)
 {
     for (unsigned int i = 0; i < MAX_DIMENSIONS; ++i) IVPhi[i] = 0;
 }
@@ -121,6 +125,11 @@ bool TIOpenclWorkGroupAggregation::runOnFunction(Function &F)
 
     add_kernel_local_size_attr(F);
 
+    /*-------------------------------------------------------------------------
+    * Record the work-group uniform values before the function is rewritten
+    *------------------------------------------------------------------------*/
+    if (vector_width > 1)  mark_uniform_values(F);
+
     /*-------------------------------------------------------------------------
     * Obtain Debug Information (func scope line number) (when debug is on)
     *------------------------------------------------------------------------*/
@@ -181,6 +190,11 @@ bool TIOpenclWorkGroupAggregation::runOnFunction(Function &F)
     *------------------------------------------------------------------------*/
     changed |= hoist_wg_invariant_code(F);
 
+    /*-------------------------------------------------------------------------
+    * Vectorize the innermost (dimension 0) work-item loop
+    *------------------------------------------------------------------------*/
+    if (vector_width > 1)  changed |= vectorize_wi_loop(F);
+
     return changed; 
 }
 
@@ -194,6 +208,9 @@ void TIOpenclWorkGroupAggregation::getAnalysisUsage(AnalysisUsage &Info) const
     * our WGA loop generation algorithm depends on.
     *------------------------------------------------------------------------*/
     Info.addRequired<UnifyFunctionExitNodes>();
+
+    if (vector_width > 1)
+        Info.addRequired<pocl::VariableUniformityAnalysis>();
 }
 
 /******************************************************************************
@@ -45,7 +45,8 @@ class TIOpenclWorkGroupAggregation : public FunctionPass
   public:
     static char ID;
 
-    TIOpenclWorkGroupAggregation(bool pocl_mode = false);
+    TIOpenclWorkGroupAggregation(bool pocl_mode = false,
+                                 unsigned int vector_width = 1);
     virtual bool runOnFunction(Function &F);
     virtual void getAnalysisUsage(AnalysisUsage &Info) const;
 
@@ -53,6 +54,7 @@ class TIOpenclWorkGroupAggregation : public FunctionPass
     Value                 *IVPhi[MAX_DIMENSIONS];
     int                    wgsizes[MAX_DIMENSIONS];
     bool                   is_pocl_mode;
+    unsigned int           vector_width;
     llvm::MDNode          *di_function;
     unsigned int           di_scope_line_num;
     unsigned int           di_end_scope_line;
@@ -77,9 +79,12 @@ class TIOpenclWorkGroupAggregation : public FunctionPass
     void                add_loop_mem_metadata(Function &F);
     bool                implicit_long_conv_use_bif(Function &F);
     bool                add_kernel_local_size_attr(Function &F);
+    void                mark_uniform_values(Function &F);
+    bool                vectorize_wi_loop(Function &F);
 };
 
-Pass *createTIOpenclWorkGroupAggregationPass(bool is_pocl_mode = false);
+Pass *createTIOpenclWorkGroupAggregationPass(bool is_pocl_mode = false,
+                                             unsigned int vector_width = 1);
 
 }
 
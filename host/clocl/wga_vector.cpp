@@ -0,0 +1,842 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+/*-----------------------------------------------------------------------------
+* Vectorization of the work-item loop added by the TI WGA pass
+*
+* The dimension 0 loop, innermost in the loop nest, is copied. The copy steps
+* by the vector width W and computes W work-items per iteration:
+*
+*   .entry:         br (ub > 0) ? .vector.check : .exit
+*   .vector.check:  n = ub & -W;  br (n > 0) ? .bodyTop.vec : .scalar.ph
+*   .bodyTop.vec:   iv = phi [0, .vector.check], [iv + W, latch] ...
+*   .scalar.ph:     start = phi [0, .vector.check], [n, latch]
+*                   br (start < ub) ? .bodyTop : .exit
+*   .bodyTop:       the original scalar loop, from start, handles the tail
+*
+* Work-group uniform values (pocl VariableUniformityAnalysis, recorded on the
+* instructions before WGA rewrites the function) and values that do not
+* depend on the dimension 0 id stay scalar. The other values are varying:
+* arithmetic on scalar ints and floats becomes vector arithmetic, accesses to
+* consecutive elements become vector loads and stores, everything else
+* (pointers, calls, OpenCL vector types, scattered accesses) is replicated
+* once per work-item.
+*
+* The work-items of a vector run in lockstep, so the loop is only vectorized
+* when its control flow is uniform: every branch in the body depends on
+* uniform values only. Kernels with private arrays, atomics or calls that
+* may write memory are left scalar.
+*----------------------------------------------------------------------------*/
+#include "wga.h"
+#include <map>
+#include <set>
+#include <vector>
+#include <functional>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Operator.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/Local.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
+#include "VariableUniformityAnalysis.h"
+
+using namespace std;
+
+#define UNIFORM_MD_KIND  "wga.uniform"
+
+namespace llvm
+{
+
+namespace
+{
+
+class WILoopVectorizer
+{
+  public:
+    WILoopVectorizer(Function &F, PHINode *iv, unsigned int width);
+
+    bool analyze();
+    void transform(std::vector<Metadata*> &loop_mdnodes);
+
+  private:
+    typedef std::vector<Value*> Lanes;
+
+    bool find_loop();
+    bool find_varying();
+    bool check_instruction(Instruction *I);
+    bool is_uniform_tagged(Instruction *I) const;
+    bool is_varying(Value *v) const { return varying.count(v) != 0; }
+    bool widenable(Type *type) const
+        { return type->isIntegerTy() || type->isFloatingPointTy(); }
+
+    Value* splat       (Value *v, IRBuilder<> &B);
+    Value* vector_of   (Value *v, IRBuilder<> &B);
+    Value* lane_of     (Value *v, unsigned int k, IRBuilder<> &B);
+    bool   stride_of   (Value *v, int64_t &stride) const;
+    bool   consecutive (Value *ptr, Type *elem_type) const;
+    unsigned int alignment(unsigned int align, Type *type) const;
+
+    void   widen       (Instruction *I);
+    void   widen_phi   (PHINode *phi);
+    void   replicate   (Instruction *I, IRBuilder<> &B);
+    void   set_stride  (Instruction *I);
+
+    Function                  &F;
+    DataLayout                 DL;
+    unsigned int               width;
+    unsigned int               uniform_kind;
+
+    // The scalar loop
+    PHINode                   *iv;
+    Instruction               *inc;
+    CmpInst                   *cmp;
+    Value                     *ub;
+    BasicBlock                *preheader;
+    BasicBlock                *header;
+    BasicBlock                *latch;
+    BasicBlock                *exit;
+    std::vector<BasicBlock*>   blocks;          // reverse post order
+    std::set<BasicBlock*>      block_set;
+
+    // Varying values, of the scalar loop then of its vector copy
+    std::set<Value*>           varying;
+
+    // Widened values of the vector copy
+    std::map<Value*, Value*>   vectors;
+    std::map<Value*, Lanes>    lanes;
+    std::map<Value*, int64_t>  strides;
+    std::vector<PHINode*>      phis;
+    std::vector<Instruction*>  replaced;
+};
+
+/******************************************************************************
+* Constructor
+******************************************************************************/
+WILoopVectorizer::WILoopVectorizer(Function &F, PHINode *iv,
+                                   unsigned int width) :
+    F(F), DL(F.getParent()), width(width), iv(iv),
+    inc(NULL), cmp(NULL), ub(NULL),
+    preheader(NULL), header(NULL), latch(NULL), exit(NULL)
+{
+    uniform_kind = F.getContext().getMDKindID(UNIFORM_MD_KIND);
+}
+
+/******************************************************************************
+* analyze: true if the work-item loop can be vectorized
+******************************************************************************/
+bool WILoopVectorizer::analyze()
+{
+    if (!find_loop())    return false;
+    if (!find_varying()) return false;
+
+    for (unsigned int b = 0; b < blocks.size(); ++b)
+        for (BasicBlock::iterator I = blocks[b]->begin(),
+                                  E = blocks[b]->end(); I != E; ++I)
+            if (!check_instruction(&*I))  return false;
+
+    return true;
+}
+
+/******************************************************************************
+* find_loop: recognize the loop built by add_loop() for dimension 0
+******************************************************************************/
+bool WILoopVectorizer::find_loop()
+{
+    header = iv->getParent();
+    if (iv->getNumIncomingValues() != 2)     return false;
+    if (&header->front() != iv)              return false;
+    if (isa<PHINode>(iv->getNextNode()))     return false;
+
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        BinaryOperator *add = dyn_cast<BinaryOperator>(iv->getIncomingValue(i));
+        if (add && add->getOpcode() == Instruction::Add &&
+            add->getOperand(0) == iv && add->getOperand(1) ==
+                                  ConstantInt::get(iv->getType(), 1))
+        {
+            latch = iv->getIncomingBlock(i);
+            inc   = add;
+        }
+        else
+        {
+            ConstantInt *start = dyn_cast<ConstantInt>(iv->getIncomingValue(i));
+            if (!start || !start->isZero())  return false;
+            preheader = iv->getIncomingBlock(i);
+        }
+    }
+    if (!latch || !preheader)  return false;
+
+    /*-------------------------------------------------------------------------
+    * Latch:     br (iv + 1 < ub) ? header : exit
+    * Preheader: br (ub > 0)      ? header : exit
+    *------------------------------------------------------------------------*/
+    BranchInst *br = dyn_cast<BranchInst>(latch->getTerminator());
+    if (!br || !br->isConditional() || br->getSuccessor(0) != header)
+        return false;
+    exit = br->getSuccessor(1);
+
+    cmp = dyn_cast<ICmpInst>(br->getCondition());
+    if (!cmp || cmp->getPredicate() != CmpInst::ICMP_SLT ||
+                cmp->getOperand(0)  != inc)
+        return false;
+    ub = cmp->getOperand(1);
+
+    if (ConstantInt *bound = dyn_cast<ConstantInt>(ub))
+        if (bound->getSExtValue() < (int64_t) width)  return false;
+
+    BranchInst *pre_br = dyn_cast<BranchInst>(preheader->getTerminator());
+    if (!pre_br || !pre_br->isConditional() ||
+        pre_br->getSuccessor(0) != header || pre_br->getSuccessor(1) != exit)
+        return false;
+
+    if (isa<PHINode>(exit->front()))  return false;
+
+    /*-------------------------------------------------------------------------
+    * The body: blocks reached from the header before the exit, in reverse
+    * post order so that definitions come before their uses
+    *------------------------------------------------------------------------*/
+    std::vector<BasicBlock*> post;
+    std::function<void(BasicBlock*)> visit = [&](BasicBlock *bb)
+    {
+        block_set.insert(bb);
+        for (succ_iterator S = succ_begin(bb), E = succ_end(bb); S != E; ++S)
+            if (*S != exit && block_set.count(*S) == 0)  visit(*S);
+        post.push_back(bb);
+    };
+    visit(header);
+    blocks.assign(post.rbegin(), post.rend());
+
+    if (block_set.count(preheader))  return false;
+
+    /*-------------------------------------------------------------------------
+    * Single entry: only the header is reached from outside the body
+    *------------------------------------------------------------------------*/
+    for (unsigned int b = 0; b < blocks.size(); ++b)
+        for (pred_iterator P = pred_begin(blocks[b]), E = pred_end(blocks[b]);
+             P != E; ++P)
+            if (block_set.count(*P) == 0 &&
+                !(blocks[b] == header && *P == preheader))
+                return false;
+
+    return true;
+}
+
+/******************************************************************************
+* is_uniform_tagged: work-group uniform according to VariableUniformityAnalysis
+******************************************************************************/
+bool WILoopVectorizer::is_uniform_tagged(Instruction *I) const
+{
+    return I->getMetadata(uniform_kind) != NULL;
+}
+
+/******************************************************************************
+* find_varying: values depending on the dimension 0 id
+******************************************************************************/
+bool WILoopVectorizer::find_varying()
+{
+    varying.insert(iv);
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (unsigned int b = 0; b < blocks.size(); ++b)
+            for (BasicBlock::iterator I = blocks[b]->begin(),
+                                      E = blocks[b]->end(); I != E; ++I)
+            {
+                Instruction *instr = &*I;
+                if (instr == inc || instr == cmp)                   continue;
+                if (is_varying(instr) || is_uniform_tagged(instr))  continue;
+
+                for (unsigned int op = 0; op < instr->getNumOperands(); ++op)
+                    if (is_varying(instr->getOperand(op)))
+                    {
+                        varying.insert(instr);
+                        changed = true;
+                        break;
+                    }
+            }
+    }
+
+    return true;
+}
+
+/******************************************************************************
+* check_instruction: can I be part of a vectorized body
+******************************************************************************/
+bool WILoopVectorizer::check_instruction(Instruction *I)
+{
+    if (isa<DbgInfoIntrinsic>(I))  return true;
+
+    /*-------------------------------------------------------------------------
+    * Uniform control flow only, the work-items of a vector run in lockstep
+    *------------------------------------------------------------------------*/
+    if (TerminatorInst *term = dyn_cast<TerminatorInst>(I))
+    {
+        if (BranchInst *br = dyn_cast<BranchInst>(term))
+            return !br->isConditional() || !is_varying(br->getCondition());
+        if (SwitchInst *sw = dyn_cast<SwitchInst>(term))
+            return !is_varying(sw->getCondition());
+        return isa<UnreachableInst>(term);
+    }
+
+    /*-------------------------------------------------------------------------
+    * Private objects are shared by the work-items of a WGA loop, the
+    * work-items of a vector would overwrite each other's data.
+    *------------------------------------------------------------------------*/
+    if (isa<AllocaInst>(I))  return false;
+    if (I->isAtomic() || isa<FenceInst>(I) || isa<VAArgInst>(I) ||
+        isa<LandingPadInst>(I) || isa<ExtractValueInst>(I) ||
+        isa<InsertValueInst>(I))
+        return false;
+
+    if (LoadInst *load = dyn_cast<LoadInst>(I))
+    {
+        if (load->isVolatile())  return false;
+        if (isa<AllocaInst>(GetUnderlyingObject(load->getPointerOperand())))
+            return false;
+    }
+    else if (StoreInst *store = dyn_cast<StoreInst>(I))
+    {
+        if (store->isVolatile())  return false;
+        if (isa<AllocaInst>(GetUnderlyingObject(store->getPointerOperand())))
+            return false;
+    }
+    else if (CallInst *call = dyn_cast<CallInst>(I))
+    {
+        if (!call->onlyReadsMemory() || call->isInlineAsm())  return false;
+    }
+    else if (I->mayHaveSideEffects())  return false;
+
+    /*-------------------------------------------------------------------------
+    * A value found uniform by the analysis but computed from the id would
+    * lose its operand in the vector copy
+    *------------------------------------------------------------------------*/
+    if (!is_varying(I))
+    {
+        if (I == inc || I == cmp)  return true;
+        for (unsigned int op = 0; op < I->getNumOperands(); ++op)
+            if (is_varying(I->getOperand(op)))  return false;
+        return true;
+    }
+
+    Type *type = I->getType();
+    if (type->isVoidTy())  return isa<StoreInst>(I);
+    return widenable(type) || type->isPointerTy() || type->isVectorTy();
+}
+
+/******************************************************************************
+* splat: W copies of a uniform value
+******************************************************************************/
+Value* WILoopVectorizer::splat(Value *v, IRBuilder<> &B)
+{
+    if (Constant *c = dyn_cast<Constant>(v))
+        return ConstantVector::getSplat(width, c);
+    return B.CreateVectorSplat(width, v);
+}
+
+/******************************************************************************
+* vector_of: v as a <W x type> value
+******************************************************************************/
+Value* WILoopVectorizer::vector_of(Value *v, IRBuilder<> &B)
+{
+    if (!is_varying(v))  return splat(v, B);
+
+    std::map<Value*, Value*>::iterator vec = vectors.find(v);
+    if (vec != vectors.end())  return vec->second;
+
+    Lanes &l = lanes[v];
+    Value *result = UndefValue::get(VectorType::get(v->getType(), width));
+    for (unsigned int k = 0; k < width; ++k)
+        result = B.CreateInsertElement(result, l[k], B.getInt32(k));
+    return result;
+}
+
+/******************************************************************************
+* lane_of: the value of v for work-item k of the vector
+******************************************************************************/
+Value* WILoopVectorizer::lane_of(Value *v, unsigned int k, IRBuilder<> &B)
+{
+    if (!is_varying(v))  return v;
+
+    std::map<Value*, Lanes>::iterator l = lanes.find(v);
+    if (l != lanes.end())  return l->second[k];
+
+    return B.CreateExtractElement(vectors[v], B.getInt32(k));
+}
+
+/******************************************************************************
+* stride_of: difference of v between consecutive work-items, when known
+******************************************************************************/
+bool WILoopVectorizer::stride_of(Value *v, int64_t &stride) const
+{
+    if (!is_varying(v))  { stride = 0; return true; }
+
+    std::map<Value*, int64_t>::const_iterator s = strides.find(v);
+    if (s == strides.end())  return false;
+    stride = s->second;
+    return true;
+}
+
+/******************************************************************************
+* consecutive: work-item k accesses element k of an array of elem_type
+******************************************************************************/
+bool WILoopVectorizer::consecutive(Value *ptr, Type *elem_type) const
+{
+    if (!widenable(elem_type))  return false;
+
+    GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(ptr);
+    if (!gep || is_varying(gep->getPointerOperand()))  return false;
+    if (cast<PointerType>(gep->getType())->getElementType() != elem_type)
+        return false;
+
+    unsigned int last = gep->getNumOperands() - 1;
+    for (unsigned int op = 1; op < last; ++op)
+        if (is_varying(gep->getOperand(op)))  return false;
+
+    int64_t stride;
+    return stride_of(gep->getOperand(last), stride) && stride == 1;
+}
+
+/******************************************************************************
+* alignment: explicit alignment of a scalar access, also for its vector form
+******************************************************************************/
+unsigned int WILoopVectorizer::alignment(unsigned int align, Type *type) const
+{
+    return align ? align : DL.getABITypeAlignment(type);
+}
+
+/******************************************************************************
+* set_stride: propagate the strides of the operands through integer arithmetic
+******************************************************************************/
+void WILoopVectorizer::set_stride(Instruction *I)
+{
+    int64_t s0, s1;
+
+    if (BinaryOperator *bin = dyn_cast<BinaryOperator>(I))
+    {
+        if (!stride_of(bin->getOperand(0), s0) ||
+            !stride_of(bin->getOperand(1), s1))
+            return;
+
+        ConstantInt *c0 = dyn_cast<ConstantInt>(bin->getOperand(0));
+        ConstantInt *c1 = dyn_cast<ConstantInt>(bin->getOperand(1));
+
+        switch (bin->getOpcode())
+        {
+            case Instruction::Add: strides[I] = s0 + s1; break;
+            case Instruction::Sub: strides[I] = s0 - s1; break;
+            case Instruction::Mul:
+                if (c1)       strides[I] = s0 * c1->getSExtValue();
+                else if (c0)  strides[I] = s1 * c0->getSExtValue();
+                break;
+            case Instruction::Shl:
+                if (c1)       strides[I] = s0 << c1->getZExtValue();
+                break;
+            default: break;
+        }
+    }
+
+    /*-------------------------------------------------------------------------
+    * Extensions keep the stride when the narrow value cannot wrap
+    *------------------------------------------------------------------------*/
+    else if (isa<SExtInst>(I) || isa<ZExtInst>(I))
+    {
+        Value *src = I->getOperand(0);
+        if (!stride_of(src, s0))  return;
+
+        OverflowingBinaryOperator *obo = dyn_cast<OverflowingBinaryOperator>(src);
+        bool no_wrap = (src == iv) ||
+                       (obo && (isa<SExtInst>(I) ? obo->hasNoSignedWrap()
+                                                 : obo->hasNoUnsignedWrap()));
+        if (no_wrap)  strides[I] = s0;
+    }
+}
+
+/******************************************************************************
+* replicate: one copy of I per work-item
+******************************************************************************/
+void WILoopVectorizer::replicate(Instruction *I, IRBuilder<> &B)
+{
+    Lanes &l = lanes[I];
+    l.resize(width);
+
+    for (unsigned int k = 0; k < width; ++k)
+    {
+        Instruction *copy = I->clone();
+        for (unsigned int op = 0; op < I->getNumOperands(); ++op)
+            copy->setOperand(op, lane_of(I->getOperand(op), k, B));
+        l[k] = B.Insert(copy, I->getName());
+    }
+}
+
+/******************************************************************************
+* widen_phi: vector or per work-item phis, incoming values are added later
+******************************************************************************/
+void WILoopVectorizer::widen_phi(PHINode *phi)
+{
+    unsigned int n = phi->getNumIncomingValues();
+
+    if (widenable(phi->getType()))
+        vectors[phi] = PHINode::Create(VectorType::get(phi->getType(), width),
+                                       n, phi->getName(), phi);
+    else
+    {
+        Lanes &l = lanes[phi];
+        for (unsigned int k = 0; k < width; ++k)
+            l.push_back(PHINode::Create(phi->getType(), n, phi->getName(), phi));
+    }
+
+    phis.push_back(phi);
+    replaced.push_back(phi);
+}
+
+/******************************************************************************
+* widen: compute the varying instruction I for W work-items
+******************************************************************************/
+void WILoopVectorizer::widen(Instruction *I)
+{
+    IRBuilder<> B(I);
+    Type       *type = I->getType();
+    Value      *vec  = NULL;
+
+    replaced.push_back(I);
+
+    if (LoadInst *load = dyn_cast<LoadInst>(I))
+    {
+        Value *ptr = load->getPointerOperand();
+        if (consecutive(ptr, type))
+        {
+            Type *vtype = VectorType::get(type, width);
+            Value *vptr = B.CreateBitCast(lane_of(ptr, 0, B),
+                 PointerType::get(vtype, load->getPointerAddressSpace()));
+            LoadInst *vload = B.CreateLoad(vptr, load->getName());
+            vload->setAlignment(alignment(load->getAlignment(), type));
+            vectors[I] = vload;
+        }
+        else replicate(I, B);
+        return;
+    }
+
+    if (StoreInst *store = dyn_cast<StoreInst>(I))
+    {
+        Value *ptr   = store->getPointerOperand();
+        Value *val   = store->getValueOperand();
+        unsigned int align = alignment(store->getAlignment(), val->getType());
+
+        /*---------------------------------------------------------------------
+        * Same location for every work-item: the last one wins
+        *--------------------------------------------------------------------*/
+        if (!is_varying(ptr))
+            B.CreateAlignedStore(lane_of(val, width - 1, B), ptr, align);
+
+        else if (consecutive(ptr, val->getType()))
+        {
+            Type *vtype = VectorType::get(val->getType(), width);
+            Value *vptr = B.CreateBitCast(lane_of(ptr, 0, B),
+                 PointerType::get(vtype, store->getPointerAddressSpace()));
+            B.CreateAlignedStore(vector_of(val, B), vptr, align);
+        }
+        else
+            for (unsigned int k = 0; k < width; ++k)
+                B.CreateAlignedStore(lane_of(val, k, B), lane_of(ptr, k, B),
+                                     align);
+        return;
+    }
+
+    if (!widenable(type))  { replicate(I, B); return; }
+
+    if (BinaryOperator *bin = dyn_cast<BinaryOperator>(I))
+    {
+        vec = B.CreateBinOp(bin->getOpcode(), vector_of(bin->getOperand(0), B),
+                            vector_of(bin->getOperand(1), B), I->getName());
+        if (BinaryOperator *vbin = dyn_cast<BinaryOperator>(vec))
+            vbin->copyIRFlags(bin);
+    }
+    else if (CmpInst *cmp = dyn_cast<CmpInst>(I))
+    {
+        if (widenable(cmp->getOperand(0)->getType()))
+        {
+            Value *a = vector_of(cmp->getOperand(0), B);
+            Value *b = vector_of(cmp->getOperand(1), B);
+            vec = isa<ICmpInst>(cmp)
+                ? B.CreateICmp(cmp->getPredicate(), a, b, I->getName())
+                : B.CreateFCmp(cmp->getPredicate(), a, b, I->getName());
+        }
+    }
+    else if (CastInst *cast = dyn_cast<CastInst>(I))
+    {
+        if (widenable(cast->getSrcTy()))
+            vec = B.CreateCast(cast->getOpcode(),
+                               vector_of(cast->getOperand(0), B),
+                               VectorType::get(type, width), I->getName());
+    }
+    else if (SelectInst *sel = dyn_cast<SelectInst>(I))
+    {
+        Value *cond = sel->getCondition();
+        if (is_varying(cond))  cond = vector_of(cond, B);
+        vec = B.CreateSelect(cond, vector_of(sel->getTrueValue(), B),
+                             vector_of(sel->getFalseValue(), B), I->getName());
+    }
+
+    if (vec)  vectors[I] = vec;
+    else      replicate(I, B);
+
+    if (type->isIntegerTy())  set_stride(I);
+}
+
+/******************************************************************************
+* transform: build the vector loop in front of the scalar one
+******************************************************************************/
+void WILoopVectorizer::transform(std::vector<Metadata*> &loop_mdnodes)
+{
+    LLVMContext &ctx   = F.getContext();
+    Type        *Int32 = iv->getType();
+
+    /*-------------------------------------------------------------------------
+    * Copy the body, the copies of the varying values are varying
+    *------------------------------------------------------------------------*/
+    ValueToValueMapTy vmap;
+    std::vector<BasicBlock*> vblocks;
+    for (unsigned int b = 0; b < blocks.size(); ++b)
+    {
+        BasicBlock *vbb = CloneBasicBlock(blocks[b], vmap, ".vec", &F);
+        vmap[blocks[b]] = vbb;
+        vblocks.push_back(vbb);
+    }
+    for (unsigned int b = 0; b < vblocks.size(); ++b)
+        for (BasicBlock::iterator I = vblocks[b]->begin(),
+                                  E = vblocks[b]->end(); I != E; ++I)
+            RemapInstruction(&*I, vmap,
+                             RF_IgnoreMissingEntries | RF_NoModuleLevelChanges);
+
+    std::set<Value*> scalar_varying;
+    scalar_varying.swap(varying);
+    for (std::set<Value*>::iterator V = scalar_varying.begin(),
+                                    E = scalar_varying.end(); V != E; ++V)
+        varying.insert(vmap[*V]);
+
+    PHINode     *viv    = cast<PHINode>(vmap[iv]);
+    Instruction *vinc   = cast<Instruction>(vmap[inc]);
+    Instruction *vcmp   = cast<Instruction>(vmap[cmp]);
+    BasicBlock  *vlatch = cast<BasicBlock>(vmap[latch]);
+    BasicBlock  *vheader= cast<BasicBlock>(vmap[header]);
+
+    /*-------------------------------------------------------------------------
+    * .vector.check: whole vectors to compute?
+    *------------------------------------------------------------------------*/
+    BasicBlock *vcheck = BasicBlock::Create(ctx, ".vector.check", &F, vheader);
+    BasicBlock *resume = BasicBlock::Create(ctx, ".scalar.ph",    &F, header);
+
+    IRBuilder<> B(vcheck);
+    Value *nvec = B.CreateAnd(ub, ConstantInt::get(Int32, -(int) width));
+    B.CreateCondBr(B.CreateICmpSGT(nvec, ConstantInt::get(Int32, 0)),
+                   vheader, resume);
+
+    BranchInst *pre_br = cast<BranchInst>(preheader->getTerminator());
+    pre_br->setSuccessor(0, vcheck);
+    viv->setIncomingBlock(viv->getBasicBlockIndex(preheader), vcheck);
+
+    /*-------------------------------------------------------------------------
+    * Vector latch: iv += W while iv + W < n
+    *------------------------------------------------------------------------*/
+    vinc->setOperand(1, ConstantInt::get(Int32, width));
+    vcmp->setOperand(1, nvec);
+    cast<BranchInst>(vlatch->getTerminator())->setSuccessor(1, resume);
+
+    /*-------------------------------------------------------------------------
+    * .scalar.ph: the scalar loop handles the remaining work-items
+    *------------------------------------------------------------------------*/
+    B.SetInsertPoint(resume);
+    PHINode *start = B.CreatePHI(Int32, 2);
+    start->addIncoming(ConstantInt::get(Int32, 0), vcheck);
+    start->addIncoming(nvec, vlatch);
+    B.CreateCondBr(B.CreateICmpSLT(start, ub), header, exit);
+
+    unsigned int pre_idx = iv->getBasicBlockIndex(preheader);
+    iv->setIncomingBlock(pre_idx, resume);
+    iv->setIncomingValue(pre_idx, start);
+
+    /*-------------------------------------------------------------------------
+    * The work-item ids of a vector: iv + <0, 1, ..., W-1>
+    *------------------------------------------------------------------------*/
+    B.SetInsertPoint(vheader, vheader->getFirstInsertionPt());
+    std::vector<Constant*> ids;
+    Lanes &iv_lanes = lanes[viv];
+    for (unsigned int k = 0; k < width; ++k)
+    {
+        ids.push_back(ConstantInt::get(Int32, k));
+        iv_lanes.push_back(k == 0 ? (Value*) viv
+                                  : B.CreateAdd(viv, ids.back()));
+    }
+    vectors[viv] = B.CreateAdd(splat(viv, B), ConstantVector::get(ids));
+    strides[viv] = 1;
+
+    /*-------------------------------------------------------------------------
+    * Widen the varying instructions, then complete the phis
+    *------------------------------------------------------------------------*/
+    for (unsigned int b = 0; b < vblocks.size(); ++b)
+    {
+        std::vector<Instruction*> instrs;
+        for (BasicBlock::iterator I = vblocks[b]->begin(),
+                                  E = vblocks[b]->end(); I != E; ++I)
+            instrs.push_back(&*I);
+
+        for (unsigned int i = 0; i < instrs.size(); ++i)
+        {
+            Instruction *I = instrs[i];
+            if (isa<DbgInfoIntrinsic>(I))  { I->eraseFromParent(); continue; }
+            if (I == viv || !is_varying(I))  continue;
+
+            if (PHINode *phi = dyn_cast<PHINode>(I))  widen_phi(phi);
+            else                                      widen(I);
+        }
+    }
+
+    for (unsigned int p = 0; p < phis.size(); ++p)
+    {
+        PHINode *phi = phis[p];
+        for (unsigned int i = 0; i < phi->getNumIncomingValues(); ++i)
+        {
+            BasicBlock *in = phi->getIncomingBlock(i);
+            Value      *v  = phi->getIncomingValue(i);
+            IRBuilder<> IB(in->getTerminator());
+
+            if (vectors.count(phi))
+                cast<PHINode>(vectors[phi])->addIncoming(vector_of(v, IB), in);
+            else
+                for (unsigned int k = 0; k < width; ++k)
+                    cast<PHINode>(lanes[phi][k])->addIncoming(
+                                                  lane_of(v, k, IB), in);
+        }
+    }
+
+    for (unsigned int i = 0; i < replaced.size(); ++i)
+        if (!replaced[i]->use_empty())
+            replaced[i]->replaceAllUsesWith(
+                                  UndefValue::get(replaced[i]->getType()));
+    for (unsigned int i = 0; i < replaced.size(); ++i)
+        replaced[i]->eraseFromParent();
+
+    /*-------------------------------------------------------------------------
+    * Drop the lanes and vectors nobody ended up using
+    *------------------------------------------------------------------------*/
+    bool erased = true;
+    while (erased)
+    {
+        erased = false;
+        for (unsigned int b = 0; b < vblocks.size(); ++b)
+            for (BasicBlock::iterator I = vblocks[b]->begin(),
+                                      E = vblocks[b]->end(); I != E; )
+            {
+                Instruction *instr = &*I++;
+                if (isInstructionTriviallyDead(instr))
+                {
+                    instr->eraseFromParent();
+                    erased = true;
+                }
+            }
+    }
+
+    /*-------------------------------------------------------------------------
+    * The vector loop is a parallel loop as well
+    *------------------------------------------------------------------------*/
+    if (loop_mdnodes.empty())  return;
+
+    MDNode *dummy = MDNode::getTemporary(ctx, ArrayRef<Metadata*>());
+    MDNode *loopmeta = MDNode::get(ctx, dummy);
+    loopmeta->replaceOperandWith(0, loopmeta);
+    MDNode::deleteTemporary(dummy);
+
+    vlatch->getTerminator()->setMetadata("llvm.loop", loopmeta);
+    loop_mdnodes.push_back(loopmeta);
+
+    MDNode *mem_mdnode = MDNode::get(ctx, loop_mdnodes);
+    for (unsigned int b = 0; b < vblocks.size(); ++b)
+        for (BasicBlock::iterator I = vblocks[b]->begin(),
+                                  E = vblocks[b]->end(); I != E; ++I)
+            if (I->mayReadOrWriteMemory())
+                I->setMetadata(LLVMContext::MD_mem_parallel_loop_access,
+                               mem_mdnode);
+}
+
+} // anonymous namespace
+
+/******************************************************************************
+* mark_uniform_values(Function &F)
+*
+* The uniformity analysis runs on the function as written. Its results are
+* kept on the instructions, they survive the rewriting of the function by
+* WGA, and are dropped by vectorize_wi_loop().
+******************************************************************************/
+void TIOpenclWorkGroupAggregation::mark_uniform_values(Function &F)
+{
+    pocl::VariableUniformityAnalysis &VUA =
+                             getAnalysis<pocl::VariableUniformityAnalysis>();
+    LLVMContext &ctx  = F.getContext();
+    unsigned int kind = ctx.getMDKindID(UNIFORM_MD_KIND);
+    MDNode *uniform   = MDNode::get(ctx, ArrayRef<Metadata*>());
+
+    for (inst_iterator I = inst_begin(&F), E = inst_end(&F); I != E; ++I)
+        if (!I->getType()->isVoidTy() && VUA.isUniform(&F, &*I))
+            I->setMetadata(kind, uniform);
+}
+
+/******************************************************************************
+* vectorize_wi_loop(Function &F)
+******************************************************************************/
+bool TIOpenclWorkGroupAggregation::vectorize_wi_loop(Function &F)
+{
+    bool changed = false;
+    PHINode *iv = dyn_cast_or_null<PHINode>(IVPhi[0]);
+
+    if (iv != NULL && iv->getParent()->getParent() == &F)
+    {
+        WILoopVectorizer vectorizer(F, iv, vector_width);
+        if (vectorizer.analyze())
+        {
+            vectorizer.transform(loop_mdnodes);
+            changed = true;
+        }
+    }
+
+    unsigned int kind = F.getContext().getMDKindID(UNIFORM_MD_KIND);
+    for (inst_iterator I = inst_begin(&F), E = inst_end(&F); I != E; ++I)
+        I->setMetadata(kind, NULL);
+
+    return changed;
+}
+
+}
@@ -215,6 +215,158 @@ extern CL_API_ENTRY cl_int CL_API_CALL
 __ti_set_kernel_timeout_ms(cl_kernel d_kernel, cl_uint timeout_in_ms)
                            CL_EXT_SUFFIX__VERSION_1_1;
 
+/* __ti_set_kernel_wg_schedule selects how the work-groups of an NDRange
+ * launch are spread over the DSP cores: one fixed contiguous chunk per core,
+ * or claimed by the cores at run time in decreasing chunks, which evens out
+ * work-groups of uneven cost */
+#define CL_WG_SCHEDULE_STATIC_TI                    0
+#define CL_WG_SCHEDULE_DYNAMIC_TI                   1
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_set_kernel_wg_schedule(cl_kernel d_kernel, cl_uint schedule)
+                            CL_EXT_SUFFIX__VERSION_1_1;
+
+/* Specialization constants: launches of a kernel whose marked arguments, and
+ * work-group size if one is set, are fixed run a variant of the kernel
+ * rebuilt with those values folded in.  Variants are cached per device and
+ * values.  Only kernels of programs built from source are specialized */
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_set_kernel_arg_specialized(cl_kernel d_kernel, cl_uint arg_index,
+                                cl_bool specialized) CL_EXT_SUFFIX__VERSION_1_1;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_set_kernel_specialized_shape(cl_kernel d_kernel, cl_uint work_dim,
+                                  const size_t *local_work_size)
+                                  CL_EXT_SUFFIX__VERSION_1_1;
+
+/* __ti_set_core_scheduler selects how out-of-order tasks are placed on the
+ * DSP cores of a device, and how many tasks may be outstanding per core */
+#define CL_CORE_SCHEDULER_LEAST_LOADED_TI           0
+#define CL_CORE_SCHEDULER_EARLIEST_FINISH_TI        1
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_set_core_scheduler(cl_device_id d_device, cl_uint policy,
+                        cl_uint depth_per_core) CL_EXT_SUFFIX__VERSION_1_1;
+
+/* __ti_get_buffer_pool_stats reports how small buffers of a context were
+ * suballocated from the pool for a device's shared memory.  Fragmentation
+ * is 1 - used_bytes / slab_bytes */
+typedef struct _cl_buffer_pool_stats_ti
+{
+    cl_ulong requests;      /* buffer allocations routed to the pool        */
+    cl_ulong hits;          /* allocations served without growing the pool  */
+    cl_ulong slab_bytes;    /* bytes the pool holds from the device heap    */
+    cl_ulong slot_bytes;    /* bytes in slots held by live buffers          */
+    cl_ulong used_bytes;    /* bytes requested by live buffers              */
+} cl_buffer_pool_stats_ti;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_get_buffer_pool_stats(cl_context d_context, cl_device_id d_device,
+                           cl_buffer_pool_stats_ti *stats)
+                           CL_EXT_SUFFIX__VERSION_1_1;
+
+/* __ti_get_mem_object_location reports where a buffer currently lives on a
+ * device.  With TI_OCL_MSMC_AUTO_PLACEMENT, the runtime may move frequently
+ * launched buffers to MSMC and back */
+#define CL_MEM_LOCATION_DDR_TI                      0
+#define CL_MEM_LOCATION_MSMC_TI                     1
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_get_mem_object_location(cl_mem d_memobj, cl_device_id d_device,
+                             cl_uint *location) CL_EXT_SUFFIX__VERSION_1_1;
+
+/* __ti_get_event_pool_stats reports how the memory of events, and of their
+ * device-specific data, was recycled since the process started */
+typedef struct _cl_event_pool_stats_ti
+{
+    cl_ulong event_hits;          /* events allocated from a free list      */
+    cl_ulong event_misses;        /* events allocated from the heap         */
+    cl_ulong device_data_hits;    /* device data allocated from a free list */
+    cl_ulong device_data_misses;  /* device data allocated from the heap    */
+    cl_ulong free_bytes;          /* bytes held in free lists               */
+} cl_event_pool_stats_ti;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_get_event_pool_stats(cl_event_pool_stats_ti *stats)
+                          CL_EXT_SUFFIX__VERSION_1_1;
+
+/* Command graphs: commands enqueued on a queue between
+ * __ti_begin_command_graph and __ti_end_command_graph are recorded instead of
+ * executed, and __ti_enqueue_command_graph replays all of them as a single
+ * command.  Events returned while recording can only be waited on by other
+ * commands of the same recording.  Commands are numbered from 0 in recording
+ * order; __ti_set_command_graph_kernel_arg changes a by-value or global
+ * buffer argument of a recorded kernel command for the following replays.  It
+ * returns CL_INVALID_OPERATION while a replay of the graph is queued or
+ * running.  Several threads may enqueue on a recording queue; a command whose
+ * enqueue races with __ti_end_command_graph fails with CL_INVALID_OPERATION */
+typedef struct _cl_command_graph_ti * cl_command_graph_ti;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_begin_command_graph(cl_command_queue d_command_queue)
+                         CL_EXT_SUFFIX__VERSION_1_1;
+
+extern CL_API_ENTRY cl_command_graph_ti CL_API_CALL
+__ti_end_command_graph(cl_command_queue d_command_queue,
+                       cl_int *errcode_ret) CL_EXT_SUFFIX__VERSION_1_1;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_enqueue_command_graph(cl_command_queue    d_command_queue,
+                           cl_command_graph_ti d_graph,
+                           cl_uint             num_events_in_wait_list,
+                           const cl_event *    event_wait_list,
+                           cl_event *          event)
+                           CL_EXT_SUFFIX__VERSION_1_1;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_set_command_graph_kernel_arg(cl_command_graph_ti d_graph,
+                                  cl_uint             command_index,
+                                  cl_uint             arg_index,
+                                  size_t              arg_size,
+                                  const void *        arg_value)
+                                  CL_EXT_SUFFIX__VERSION_1_1;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_release_command_graph(cl_command_graph_ti d_graph)
+                           CL_EXT_SUFFIX__VERSION_1_1;
+
+/* Streams: __ti_create_stream allocates depth input and depth output buffers
+ * for the global buffer arguments input_arg_index and output_arg_index of
+ * kernel.  Each __ti_submit_stream copies input into the next input buffer,
+ * runs the kernel on it, and reads its output buffer back into output, the
+ * copies overlapping with the kernels of the neighbouring submissions.  It
+ * returns once input is copied; event completes when output is written.
+ * The other arguments of kernel keep the values set with clSetKernelArg. */
+typedef struct _cl_stream_ti * cl_stream_ti;
+
+extern CL_API_ENTRY cl_stream_ti CL_API_CALL
+__ti_create_stream(cl_command_queue d_command_queue,
+                   cl_kernel        d_kernel,
+                   cl_uint          input_arg_index,
+                   size_t           input_size,
+                   cl_uint          output_arg_index,
+                   size_t           output_size,
+                   cl_uint          depth,
+                   cl_int *         errcode_ret) CL_EXT_SUFFIX__VERSION_1_1;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_submit_stream(cl_stream_ti   d_stream,
+                   const void *   input,
+                   void *         output,
+                   cl_uint        work_dim,
+                   const size_t * global_work_offset,
+                   const size_t * global_work_size,
+                   const size_t * local_work_size,
+                   cl_event *     event) CL_EXT_SUFFIX__VERSION_1_1;
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_release_stream(cl_stream_ti d_stream) CL_EXT_SUFFIX__VERSION_1_1;
+
+/* __ti_export_trace writes the timeline recorded so far, when TI_OCL_TRACE
+ * is set, as a Chrome trace event file */
+extern CL_API_ENTRY cl_int CL_API_CALL
+__ti_export_trace(const char *file_name) CL_EXT_SUFFIX__VERSION_1_1;
+
 /* __malloc_ddr and __malloc_msmc return pointers to 128-byte aligned memory */
 extern CL_API_ENTRY void*  CL_API_CALL
 __malloc_ddr(size_t size)  CL_EXT_SUFFIX__VERSION_1_1;
@@ -0,0 +1,289 @@
+/******************************************************************************
+ * Copyright (c) 2016, Texas Instruments Incorporated - http://www.ti.com/
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *      * Neither the name of Texas Instruments Incorporated nor the
+ *        names of its contributors may be used to endorse or promote products
+ *        derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *  THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include "heap_manager.h"
+#include "heap_manager_policy_process.h"
+#include "heap_manager_policy_thread.h"
+
+/******************************************************************************
+* Replay a trace of buffer allocations and releases against the HeapManager
+* first fit and segregated fit engines and report the time spent in each.
+*
+* Traces are the AllocateGlobal/AllocateMSMC and FreeGlobal/FreeMSMC/
+* FreeMSMCorGlobal lines written to stderr by the OpenCL runtime when it is
+* built with TRACE_ENABLED (see core/error_report.h), e.g. the
+* clCreateBuffer/clReleaseMemObject activity of an application:
+*
+*    TIOCL Trace: (1234) AllocateGlobal (0x8a000000, 4096, 0)
+*    TIOCL Trace: (1234) FreeGlobal(0x8a000000)
+*
+* Lines that are not allocation or free records are ignored.  Without a trace
+* file, a synthetic trace of mixed small and large buffers is replayed.
+******************************************************************************/
+namespace BIP = boost::interprocess;
+
+struct TraceOp
+{
+    bool     alloc;
+    uint32_t id;     // index of the allocation this op creates or releases
+    uint64_t size;
+};
+
+const uint64_t BENCH_HEAP_BASE  = 0x80000000ULL;
+const uint64_t BENCH_BLOCK_SIZE = 128;
+
+uint64_t option_heap_size  = (512ULL << 20);
+int      option_iterations = 10;
+bool     option_process    = false;
+bool     option_help       = false;
+
+/*-----------------------------------------------------------------------------
+* read_trace - Convert the recorded addresses to allocation ids, so the 
+*    replay does not depend on where the recorded heap placed each buffer.
+*----------------------------------------------------------------------------*/
+static bool read_trace(const char *file, std::vector<TraceOp>& ops)
+{
+    std::ifstream in(file);
+    if (!in) return false;
+
+    std::unordered_map<uint64_t, uint32_t> live;
+    uint32_t next_id = 0;
+    std::string line;
+
+    while (std::getline(in, line))
+    {
+        unsigned long long addr, size;
+        const char *p;
+
+        if      ((p = strstr(line.c_str(), "AllocateGlobal (")) != nullptr)
+            p += strlen("AllocateGlobal (");
+        else if ((p = strstr(line.c_str(), "AllocateMSMC (")) != nullptr)
+            p += strlen("AllocateMSMC (");
+
+        if (p != nullptr)
+        {
+            if (sscanf(p, "%llx, %llu", &addr, &size) != 2 || addr == 0)
+                continue;
+            live[addr] = next_id;
+            ops.push_back({true, next_id++, size});
+            continue;
+        }
+
+        if ((p = strstr(line.c_str(), "Free")) == nullptr) continue;
+        if ((p = strchr(p, '(')) == nullptr) continue;
+        if (sscanf(p + 1, "%llx", &addr) != 1) continue;
+
+        auto it = live.find(addr);
+        if (it == live.end()) continue;
+        ops.push_back({false, it->second, 0});
+        live.erase(it);
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+* synthetic_trace - Mostly small, short lived buffers with a few large ones
+*    that stay live, which is what fragments a shared heap.
+*----------------------------------------------------------------------------*/
+static void synthetic_trace(std::vector<TraceOp>& ops)
+{
+    std::vector<uint32_t> live;
+    uint32_t next_id = 0;
+
+    srand(1);
+    for (int i = 0; i < 200000; i++)
+    {
+        if (live.empty() || (rand() % 100) < 52)
+        {
+            uint64_t size = (rand() % 16 == 0) ? (rand() % (4 << 20)) + 1
+                                               : (rand() % 16384) + 1;
+            live.push_back(next_id);
+            ops.push_back({true, next_id++, size});
+        }
+        else
+        {
+            size_t k = rand() % live.size();
+            ops.push_back({false, live[k], 0});
+            live[k] = live.back();
+            live.pop_back();
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+* replay - Returns seconds per pass; failed allocations are counted and the 
+*    matching release is skipped.
+*----------------------------------------------------------------------------*/
+template <typename Heap>
+static double replay(Heap* heap, const std::vector<TraceOp>& ops,
+                     uint32_t num_ids, uint64_t& failures)
+{
+    std::vector<uint64_t> addrs(num_ids, 0);
+    failures = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int iter = 0; iter < option_iterations; iter++)
+    {
+        for (const auto& op : ops)
+        {
+            if (op.alloc)
+            {
+                addrs[op.id] = heap->malloc(op.size, true);
+                if (addrs[op.id] == 0) failures++;
+            }
+            else if (addrs[op.id] != 0)
+            {
+                heap->free(addrs[op.id]);
+                addrs[op.id] = 0;
+            }
+        }
+
+        for (auto& addr : addrs)
+            if (addr != 0) { heap->free(addr); addr = 0; }
+    }
+    std::chrono::duration<double> elapsed = 
+                                     std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / option_iterations;
+}
+
+template <typename Heap>
+static void report(const char *name, Heap* heap, 
+                   const std::vector<TraceOp>& ops, uint32_t num_ids)
+{
+    uint64_t failures;
+
+    heap->configure(BENCH_HEAP_BASE, option_heap_size, BENCH_BLOCK_SIZE);
+    double secs = replay(heap, ops, num_ids, failures);
+
+    std::cout << std::setw(16) << std::left << name
+              << std::fixed << std::setprecision(3) << secs * 1000 << " ms/pass"
+              << std::setprecision(1) << std::setw(10) << std::right
+              << secs * 1e9 / ops.size() << " ns/op"
+              << std::setw(10) << failures / option_iterations << " failed"
+              << std::endl;
+}
+
+/*-----------------------------------------------------------------------------
+* main 
+*----------------------------------------------------------------------------*/
+int main (int argc, char *argv[])
+{
+    int c;
+    while ((c = getopt(argc, argv, "i:s:ph")) != -1)
+    {
+       switch (c)
+       { 
+          case 'i': option_iterations = atoi(optarg);              break;
+          case 's': option_heap_size  = strtoull(optarg, NULL, 0); break;
+          case 'p': option_process    = true;                      break;
+          case 'h': option_help       = true;                      break;
+          default:  
+             std::cout << "Unknown option specified: " << c << std::endl; break;
+       }
+    }
+
+    if (option_help || option_iterations <= 0)
+    {
+        std::cout << argv[0] << " [option] [trace file]" << std::endl;
+        std::cout << "  -h: Print help screen" << std::endl;
+        std::cout << "  -i: Number of replays of the trace (10)" << std::endl;
+        std::cout << "  -s: Heap size in bytes (512MB)" << std::endl;
+        std::cout << "  -p: Heaps in shared memory, as used by ti-mctd" 
+                  << std::endl;
+        return 0;
+    }
+
+    std::vector<TraceOp> ops;
+    if (optind < argc)
+    {
+        if (!read_trace(argv[optind], ops))
+        {
+            std::cout << "Cannot read trace " << argv[optind] << std::endl;
+            return 1;
+        }
+    }
+    else synthetic_trace(ops);
+
+    uint32_t num_ids = 0;
+    for (const auto& op : ops) if (op.alloc) num_ids++;
+
+    std::cout << ops.size() << " operations, " << num_ids << " allocations"
+              << std::endl;
+
+    if (option_process)
+    {
+        typedef utility::MultiProcess<uint64_t, uint64_t> Scope;
+        typedef utility::HeapManager<uint64_t, uint64_t, Scope,
+                                     utility::FirstFit>     FirstFitHeap;
+        typedef utility::HeapManager<uint64_t, uint64_t, Scope,
+                                     utility::SegregatedFit> SegregatedFitHeap;
+
+        BIP::shared_memory_object::remove("HeapManagerBench");
+        try
+        {
+            BIP::managed_shared_memory segment(BIP::create_only, 
+                                    "HeapManagerBench", (64 << 20));
+
+            report("first fit", segment.construct<FirstFitHeap>
+                                  ("first_fit")(segment), ops, num_ids);
+            report("segregated fit", segment.construct<SegregatedFitHeap>
+                                  ("segregated_fit")(segment), ops, num_ids);
+        }
+        catch (BIP::interprocess_exception &ex)
+            { std::cout << ex.what() << std::endl; }
+        BIP::shared_memory_object::remove("HeapManagerBench");
+    }
+    else
+    {
+        typedef utility::MultiThread<uint64_t, uint64_t> Scope;
+        typedef utility::HeapManager<uint64_t, uint64_t, Scope,
+                                     utility::FirstFit>     FirstFitHeap;
+        typedef utility::HeapManager<uint64_t, uint64_t, Scope,
+                                     utility::SegregatedFit> SegregatedFitHeap;
+
+        FirstFitHeap      first_fit;
+        SegregatedFitHeap segregated_fit;
+        report("first fit",      &first_fit,      ops, num_ids);
+        report("segregated fit", &segregated_fit, ops, num_ids);
+    }
+
+    return 0;
+}
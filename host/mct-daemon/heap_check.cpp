@@ -70,7 +70,8 @@ int main (int argc, char *argv[])
        * Create a named shared memory segment 
        *---------------------------------------------------------------------*/
         boost::interprocess::managed_shared_memory segment 
-                              (boost::interprocess::open_only, "HeapManager");
+                              (boost::interprocess::open_only, 
+                               HEAP_MANAGER_SHM_NAME);
 
         Heap64* ddr_heap1 = segment.find_or_construct<Heap64>("ddr_heap1")
                                                              (segment);
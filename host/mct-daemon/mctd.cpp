@@ -89,7 +89,8 @@ int main(int argc, char* argv[])
     {
        BIP::permissions perm_reg_user_can_access;
        perm_reg_user_can_access.set_unrestricted();
-       BIP::managed_shared_memory segment (BIP::create_only, "HeapManager",
+       BIP::managed_shared_memory segment (BIP::create_only,
+                                           HEAP_MANAGER_SHM_NAME,
                                            heap_size_bytes, nullptr,
                                            perm_reg_user_can_access);
        ddr_heap1 = segment.find_or_construct<Heap64>("ddr_heap1")(segment);
@@ -142,7 +143,7 @@ int main(int argc, char* argv[])
         if (graceful_exit)
         {
             syslog (LOG_INFO, "Graceful exit");
-            BIP::shared_memory_object::remove("HeapManager");
+            BIP::shared_memory_object::remove(HEAP_MANAGER_SHM_NAME);
             if (reset_dsps) reset_dsps(oclcfg.GetCompUnits());
             closelog();
             exit(EXIT_SUCCESS);
@@ -183,7 +184,8 @@ static void print_usage()
     printf("  -h, --help : Print this help screen\n");
     printf("               Config is in /etc/ti-mctd/ti_mctd_config.json\n");
     printf("               Modifying config will require a ti-mctd restart\n");
-    printf("               Heap is created in /dev/shm/HeapManager\n");
+    printf("               Heap is created in /dev/shm/%s\n",
+                                                     HEAP_MANAGER_SHM_NAME);
     printf("               For log, grep ti-mctd /var/log/daemon.log\n");
     printf("                or, systemctl status ti-mct-daemon.service\n\n");
 }
@@ -349,3 +349,37 @@ clReleaseDevice(cl_device_id d_device)
 
     return CL_SUCCESS;
 }
+
+cl_int
+__ti_set_core_scheduler(cl_device_id d_device,
+                        cl_uint      policy,
+                        cl_uint      depth_per_core)
+{
+    auto device = pobj(d_device);
+
+    if (!device->isA(Coal::Object::T_Device))
+        return CL_INVALID_DEVICE;
+
+    /* Only DSP devices place tasks on cores */
+    if (!device->IsDeviceType(Coal::DeviceInterface::T_C66x) &&
+        !device->IsDeviceType(Coal::DeviceInterface::T_SubDevice))
+        return CL_INVALID_DEVICE;
+
+    if (depth_per_core == 0)
+        return CL_INVALID_VALUE;
+
+    CoreScheduler::Policy sched_policy;
+    switch (policy)
+    {
+        case CL_CORE_SCHEDULER_LEAST_LOADED_TI:
+            sched_policy = CoreScheduler::Policy::LEAST_LOADED;    break;
+        case CL_CORE_SCHEDULER_EARLIEST_FINISH_TI:
+            sched_policy = CoreScheduler::Policy::EARLIEST_FINISH; break;
+        default:
+            return CL_INVALID_VALUE;
+    }
+
+    static_cast<Coal::DSPDevice*>(device)->setCoreScheduler(sched_policy,
+                                                            depth_per_core);
+    return CL_SUCCESS;
+}
@@ -36,6 +36,9 @@
 #include <core/memobject.h>
 #include <core/kernel.h>
 #include <core/commandqueue.h>
+#include <core/command_graph.h>
+#include <core/stream.h>
+#include <core/trace.h>
 
 #include <cstdlib>
 #include <stdio.h>
@@ -50,6 +53,15 @@ static inline cl_int queueEvent(Coal::CommandQueue *queue,
     cl_int rs;
     Coal::Event *old_event = NULL;
 
+    /*------------------------------------------------------------------------
+    * A recorded command only runs when its graph is replayed
+    *-----------------------------------------------------------------------*/
+    if (blocking && command->isGraphCommand())
+    {
+        delete command;
+        return CL_INVALID_OPERATION;
+    }
+
     if (event)
     {
         /*---------------------------------------------------------------------
@@ -104,6 +116,7 @@ clEnqueueReadBuffer(cl_command_queue    d_command_queue,
                     const cl_event *    event_wait_list,
                     cl_event *          event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto buffer = pobj(d_buffer);
@@ -138,6 +151,7 @@ clEnqueueWriteBuffer(cl_command_queue   d_command_queue,
                      const cl_event *   event_wait_list,
                      cl_event *         event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto buffer = pobj(d_buffer);
@@ -177,6 +191,7 @@ clEnqueueReadBufferRect(cl_command_queue    d_command_queue,
                         const cl_event *    event_wait_list,
                         cl_event *          event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto buffer = pobj(d_buffer);
@@ -217,6 +232,7 @@ clEnqueueWriteBufferRect(cl_command_queue   d_command_queue,
                         const cl_event *    event_wait_list,
                         cl_event *          event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto buffer = pobj(d_buffer);
@@ -252,6 +268,7 @@ clEnqueueFillBuffer(cl_command_queue   d_command_queue,
                     const cl_event *   event_wait_list,
                     cl_event *         event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto buffer = pobj(d_buffer);
@@ -286,6 +303,7 @@ clEnqueueFillImage(cl_command_queue    d_command_queue,
                    const cl_event *    event_wait_list,
                    cl_event *          event)
 {
+    TRACE_API_CALL();
     auto command_queue = pobj(d_command_queue);
 
     if (!command_queue->isA(Coal::Object::T_CommandQueue))
@@ -309,6 +327,7 @@ clEnqueueCopyBufferRect(cl_command_queue    d_command_queue,
                         const cl_event *    event_wait_list,
                         cl_event *          event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto src_buffer = pobj(d_src_buffer);
@@ -346,6 +365,7 @@ clEnqueueCopyBuffer(cl_command_queue    d_command_queue,
                     const cl_event *    event_wait_list,
                     cl_event *          event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto src_buffer = pobj(d_src_buffer);
@@ -384,6 +404,7 @@ clEnqueueReadImage(cl_command_queue     d_command_queue,
                    const cl_event *     event_wait_list,
                    cl_event *           event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto image = pobj(d_image);
@@ -424,6 +445,7 @@ clEnqueueWriteImage(cl_command_queue    d_command_queue,
                     const cl_event *    event_wait_list,
                     cl_event *          event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto image = pobj(d_image);
@@ -458,6 +480,7 @@ clEnqueueCopyImage(cl_command_queue     d_command_queue,
                    const cl_event *     event_wait_list,
                    cl_event *           event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto src_image = pobj(d_src_image);
@@ -493,6 +516,7 @@ clEnqueueCopyImageToBuffer(cl_command_queue d_command_queue,
                            const cl_event * event_wait_list,
                            cl_event *       event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto src_image = pobj(d_src_image);
@@ -528,6 +552,7 @@ clEnqueueCopyBufferToImage(cl_command_queue d_command_queue,
                            const cl_event * event_wait_list,
                            cl_event *       event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto src_buffer = pobj(d_src_buffer);
@@ -564,6 +589,7 @@ clEnqueueMapBuffer(cl_command_queue d_command_queue,
                    cl_event *       event,
                    cl_int *         errcode_ret)
 {
+    TRACE_API_CALL();
     cl_int dummy_errcode;
     auto command_queue = pobj(d_command_queue);
     auto buffer = pobj(d_buffer);
@@ -629,6 +655,7 @@ clEnqueueMapImage(cl_command_queue  d_command_queue,
                   cl_event *        event,
                   cl_int *          errcode_ret)
 {
+    TRACE_API_CALL();
     cl_int rs;
     auto command_queue = pobj(d_command_queue);
     auto image = pobj(d_image);
@@ -696,6 +723,7 @@ clEnqueueUnmapMemObject(cl_command_queue d_command_queue,
                         const cl_event *  event_wait_list,
                         cl_event *        event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
     auto memobj = pobj(d_memobj);
@@ -730,6 +758,7 @@ clEnqueueMigrateMemObjects(cl_command_queue       d_command_queue,
                            const cl_event *       event_wait_list,
                            cl_event *             event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
 
@@ -790,6 +819,7 @@ clEnqueueNDRangeKernel(cl_command_queue d_command_queue,
                        const cl_event * event_wait_list,
                        cl_event *       event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto kernel = pobj(d_kernel);
     auto command_queue = pobj(d_command_queue);
@@ -822,6 +852,7 @@ clEnqueueTask(cl_command_queue  d_command_queue,
               const cl_event *  event_wait_list,
               cl_event *        event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto kernel = pobj(d_kernel);
     auto command_queue = pobj(d_command_queue);
@@ -858,6 +889,7 @@ clEnqueueNativeKernel(cl_command_queue  d_command_queue,
                       const cl_event *  event_wait_list,
                       cl_event *        event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
 
@@ -884,6 +916,7 @@ cl_int
 clEnqueueMarker(cl_command_queue    d_command_queue,
                 cl_event *          event)
 {
+    TRACE_API_CALL();
     return clEnqueueMarkerWithWaitList(d_command_queue, 0, NULL, event);
 }
 
@@ -893,6 +926,7 @@ clEnqueueMarkerWithWaitList(cl_command_queue    d_command_queue,
                             const cl_event *    event_wait_list,
                             cl_event *          event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
 
@@ -909,7 +943,8 @@ clEnqueueMarkerWithWaitList(cl_command_queue    d_command_queue,
     unsigned int count = 0;
     Coal::Event  **events = nullptr;
     cl_event *e_wait_list = nullptr;
-    if (num_events_in_wait_list == 0)
+    // While recording, the graph makes the marker wait for recorded commands
+    if (num_events_in_wait_list == 0 && !command_queue->isRecordingGraph())
     {
         // Get the events in command_queue
         events = command_queue->events(count, false);
@@ -960,6 +995,7 @@ clEnqueueWaitForEvents(cl_command_queue d_command_queue,
                        cl_uint          num_events,
                        const cl_event * event_list)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
 
@@ -982,6 +1018,7 @@ clEnqueueWaitForEvents(cl_command_queue d_command_queue,
 cl_int
 clEnqueueBarrier(cl_command_queue d_command_queue)
 {
+    TRACE_API_CALL();
     cl_event ev;
     return clEnqueueBarrierWithWaitList(d_command_queue, 0, NULL, &ev);
 }
@@ -992,6 +1029,7 @@ clEnqueueBarrierWithWaitList(cl_command_queue  d_command_queue,
                              const cl_event *  event_wait_list,
                              cl_event *        event)
 {
+    TRACE_API_CALL();
     cl_int rs = CL_SUCCESS;
     auto command_queue = pobj(d_command_queue);
 
@@ -1010,7 +1048,8 @@ clEnqueueBarrierWithWaitList(cl_command_queue  d_command_queue,
     unsigned int count = 0;
     Coal::Event  **events = nullptr;
     cl_event *e_wait_list = nullptr;
-    if (num_events_in_wait_list == 0)
+    /* While recording, the graph makes the barrier wait for recorded ones */
+    if (num_events_in_wait_list == 0 && !command_queue->isRecordingGraph())
     {
         /* Get the events in command_queue */
         events = command_queue->events(count, false);
@@ -1055,3 +1094,208 @@ clEnqueueBarrierWithWaitList(cl_command_queue  d_command_queue,
 
     return queueEvent(command_queue, command, event, false);
 }
+
+// Command graph APIs
+cl_int
+__ti_begin_command_graph(cl_command_queue d_command_queue)
+{
+    auto command_queue = pobj(d_command_queue);
+
+    if (!command_queue->isA(Coal::Object::T_CommandQueue))
+        return CL_INVALID_COMMAND_QUEUE;
+
+    return command_queue->beginGraph();
+}
+
+cl_command_graph_ti
+__ti_end_command_graph(cl_command_queue d_command_queue,
+                       cl_int *         errcode_ret)
+{
+    cl_int dummy_errcode;
+    auto command_queue = pobj(d_command_queue);
+
+    if (!errcode_ret)
+        errcode_ret = &dummy_errcode;
+
+    if (!command_queue->isA(Coal::Object::T_CommandQueue))
+    {
+        *errcode_ret = CL_INVALID_COMMAND_QUEUE;
+        return 0;
+    }
+
+    Coal::CommandGraph *graph = command_queue->endGraph(errcode_ret);
+    if (graph == NULL)
+        return 0;
+
+    return desc(graph);
+}
+
+cl_int
+__ti_enqueue_command_graph(cl_command_queue    d_command_queue,
+                           cl_command_graph_ti d_graph,
+                           cl_uint             num_events_in_wait_list,
+                           const cl_event *    event_wait_list,
+                           cl_event *          event)
+{
+    cl_int rs = CL_SUCCESS;
+    auto command_queue = pobj(d_command_queue);
+    auto graph = pobj(d_graph);
+
+    if (!command_queue->isA(Coal::Object::T_CommandQueue))
+        return CL_INVALID_COMMAND_QUEUE;
+
+    if (!graph->isA(Coal::Object::T_CommandGraph))
+        return CL_INVALID_VALUE;
+
+    // The recorded commands belong to the queue they were recorded on
+    if (graph->queue() != command_queue)
+        return CL_INVALID_COMMAND_QUEUE;
+
+    if (command_queue->isRecordingGraph())
+        return CL_INVALID_OPERATION;
+
+    if (!event_wait_list && num_events_in_wait_list)
+        return CL_INVALID_EVENT_WAIT_LIST;
+
+    /*------------------------------------------------------------------------
+    * Replays of a graph share the recorded commands, so a replay waits for
+    * the previous one in addition to its own wait list
+    *-----------------------------------------------------------------------*/
+    Coal::Event *previous = graph->lastReplay();
+    std::vector<cl_event> wait_list(event_wait_list,
+                                    event_wait_list + num_events_in_wait_list);
+    if (previous != NULL)
+        wait_list.push_back(desc(previous));
+
+    Coal::CommandGraphEvent *command = new Coal::CommandGraphEvent(
+        command_queue, graph,
+        wait_list.size(), wait_list.empty() ? NULL : wait_list.data(), &rs
+    );
+
+    if (previous != NULL)
+        clReleaseEvent(desc(previous));
+
+    if (rs != CL_SUCCESS)
+    {
+        delete command;
+        return rs;
+    }
+
+    graph->setLastReplay(command);
+
+    return queueEvent(command_queue, command, event, false);
+}
+
+cl_int
+__ti_set_command_graph_kernel_arg(cl_command_graph_ti d_graph,
+                                  cl_uint             command_index,
+                                  cl_uint             arg_index,
+                                  size_t              arg_size,
+                                  const void *        arg_value)
+{
+    auto graph = pobj(d_graph);
+
+    if (!graph->isA(Coal::Object::T_CommandGraph))
+        return CL_INVALID_VALUE;
+
+    return graph->setKernelArg(command_index, arg_index, arg_size, arg_value);
+}
+
+cl_int
+__ti_release_command_graph(cl_command_graph_ti d_graph)
+{
+    auto graph = pobj(d_graph);
+
+    if (!graph->isA(Coal::Object::T_CommandGraph))
+        return CL_INVALID_VALUE;
+
+    if (graph->dereference())
+        delete graph;
+
+    return CL_SUCCESS;
+}
+
+cl_stream_ti
+__ti_create_stream(cl_command_queue d_command_queue,
+                   cl_kernel        d_kernel,
+                   cl_uint          input_arg_index,
+                   size_t           input_size,
+                   cl_uint          output_arg_index,
+                   size_t           output_size,
+                   cl_uint          depth,
+                   cl_int *         errcode_ret)
+{
+    cl_int dummy_errcode;
+    auto command_queue = pobj(d_command_queue);
+    auto kernel = pobj(d_kernel);
+
+    if (!errcode_ret)
+        errcode_ret = &dummy_errcode;
+
+    if (!command_queue->isA(Coal::Object::T_CommandQueue))
+    {
+        *errcode_ret = CL_INVALID_COMMAND_QUEUE;
+        return 0;
+    }
+
+    if (!kernel->isA(Coal::Object::T_Kernel))
+    {
+        *errcode_ret = CL_INVALID_KERNEL;
+        return 0;
+    }
+
+    *errcode_ret = CL_SUCCESS;
+    Coal::Stream *stream = new Coal::Stream(command_queue, kernel,
+                                            input_arg_index, input_size,
+                                            output_arg_index, output_size,
+                                            depth, errcode_ret);
+
+    if (*errcode_ret != CL_SUCCESS)
+    {
+        delete stream;
+        return 0;
+    }
+
+    return desc(stream);
+}
+
+cl_int
+__ti_submit_stream(cl_stream_ti   d_stream,
+                   const void *   input,
+                   void *         output,
+                   cl_uint        work_dim,
+                   const size_t * global_work_offset,
+                   const size_t * global_work_size,
+                   const size_t * local_work_size,
+                   cl_event *     event)
+{
+    TRACE_API_CALL();
+    auto stream = pobj(d_stream);
+
+    if (!stream->isA(Coal::Object::T_Stream))
+        return CL_INVALID_VALUE;
+
+    Coal::Event *command = NULL;
+    cl_int rs = stream->submit(input, output, work_dim, global_work_offset,
+                               global_work_size, local_work_size,
+                               event ? &command : NULL);
+
+    if (event)
+        *event = command ? desc(command) : 0;
+
+    return rs;
+}
+
+cl_int
+__ti_release_stream(cl_stream_ti d_stream)
+{
+    auto stream = pobj(d_stream);
+
+    if (!stream->isA(Coal::Object::T_Stream))
+        return CL_INVALID_VALUE;
+
+    if (stream->dereference())
+        delete stream;
+
+    return CL_SUCCESS;
+}
@@ -35,6 +35,8 @@
 #include <core/commandqueue.h>
 #include <core/events.h>
 #include <core/context.h>
+#include <core/object_pool.h>
+#include <core/trace.h>
 #include <stdio.h>
 
 using namespace Coal;
@@ -44,6 +46,7 @@ cl_int
 clWaitForEvents(cl_uint             num_events,
                 const cl_event *    event_list)
 {
+    TRACE_API_CALL();
     if (!num_events || !event_list)
         return CL_INVALID_VALUE;
 
@@ -212,3 +215,22 @@ clSetUserEventStatus(cl_event   d_event,
 
     return CL_SUCCESS;
 }
+
+cl_int
+__ti_get_event_pool_stats(cl_event_pool_stats_ti *stats)
+{
+    if (!stats)
+        return CL_INVALID_VALUE;
+
+    Coal::ObjectPool::Stats events, device_data;
+    Coal::ObjectPool::stats(Coal::ObjectPool::Events,     events);
+    Coal::ObjectPool::stats(Coal::ObjectPool::DeviceData, device_data);
+
+    stats->event_hits         = events.hits;
+    stats->event_misses       = events.misses;
+    stats->device_data_hits   = device_data.hits;
+    stats->device_data_misses = device_data.misses;
+    stats->free_bytes         = events.free_bytes + device_data.free_bytes;
+
+    return CL_SUCCESS;
+}
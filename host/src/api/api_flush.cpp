@@ -32,11 +32,13 @@
 
 #include "CL/cl.h"
 #include "core/commandqueue.h"
+#include "core/trace.h"
 
 // Flush and Finish APIs
 cl_int
 clFlush(cl_command_queue d_command_queue)
 {
+    TRACE_API_CALL();
     auto command_queue = pobj(d_command_queue);
 
     if (!command_queue->isA(Coal::Object::T_CommandQueue))
@@ -50,6 +52,7 @@ clFlush(cl_command_queue d_command_queue)
 cl_int
 clFinish(cl_command_queue d_command_queue)
 {
+    TRACE_API_CALL();
     auto command_queue = pobj(d_command_queue);
 
     if (!command_queue->isA(Coal::Object::T_CommandQueue))
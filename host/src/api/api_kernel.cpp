@@ -244,3 +244,42 @@ __ti_set_kernel_timeout_ms(cl_kernel    d_kernel,
 
     return kernel->setTimeout(timeout_in_ms);
 }
+
+cl_int
+__ti_set_kernel_wg_schedule(cl_kernel    d_kernel,
+                            cl_uint      schedule)
+{
+    auto kernel = pobj(d_kernel);
+    if (!kernel->isA(Coal::Object::T_Kernel))
+        return CL_INVALID_KERNEL;
+
+    if (schedule != CL_WG_SCHEDULE_STATIC_TI &&
+        schedule != CL_WG_SCHEDULE_DYNAMIC_TI)
+        return CL_INVALID_VALUE;
+
+    return kernel->setWgSchedule(schedule);
+}
+
+cl_int
+__ti_set_kernel_arg_specialized(cl_kernel    d_kernel,
+                                cl_uint      arg_index,
+                                cl_bool      specialized)
+{
+    auto kernel = pobj(d_kernel);
+    if (!kernel->isA(Coal::Object::T_Kernel))
+        return CL_INVALID_KERNEL;
+
+    return kernel->setArgSpecialized(arg_index, specialized != CL_FALSE);
+}
+
+cl_int
+__ti_set_kernel_specialized_shape(cl_kernel     d_kernel,
+                                  cl_uint       work_dim,
+                                  const size_t *local_work_size)
+{
+    auto kernel = pobj(d_kernel);
+    if (!kernel->isA(Coal::Object::T_Kernel))
+        return CL_INVALID_KERNEL;
+
+    return kernel->setSpecializedShape(work_dim, local_work_size);
+}
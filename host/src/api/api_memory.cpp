@@ -36,6 +36,7 @@
 #include <core/context.h>
 #include <core/platform.h>
 #include <core/dsp/device.h>
+#include <core/dsp/buffer_pool.h>
 
 #include <cstring>
 
@@ -515,6 +516,69 @@ clFree(void *p, cl_context d_context)
     if (dspdevice != NULL)  dspdevice->GetSHMHandler()->clFree(p);
 }
 
+cl_int
+__ti_get_buffer_pool_stats(cl_context              d_context,
+                           cl_device_id            d_device,
+                           cl_buffer_pool_stats_ti *stats)
+{
+    auto context = pobj(d_context);
+    auto device  = pobj(d_device);
+
+    if (!context->isA(Coal::Object::T_Context))
+        return CL_INVALID_CONTEXT;
+
+    if (!device->isA(Coal::Object::T_Device) || !context->hasDevice(device))
+        return CL_INVALID_DEVICE;
+
+    if (!stats)
+        return CL_INVALID_VALUE;
+
+    std::memset(stats, 0, sizeof(cl_buffer_pool_stats_ti));
+
+    /* Devices without a pool, or with pooling disabled, report no activity */
+    tiocl::BufferPool *pool = context->bufferPool(device->GetSHMHandler());
+    if (!pool)
+        return CL_SUCCESS;
+
+    tiocl::BufferPool::Stats pool_stats;
+    pool->GetStats(pool_stats);
+
+    stats->requests   = pool_stats.requests;
+    stats->hits       = pool_stats.hits;
+    stats->slab_bytes = pool_stats.slab_bytes;
+    stats->slot_bytes = pool_stats.slot_bytes;
+    stats->used_bytes = pool_stats.used_bytes;
+
+    return CL_SUCCESS;
+}
+
+cl_int
+__ti_get_mem_object_location(cl_mem       d_memobj,
+                             cl_device_id d_device,
+                             cl_uint *    location)
+{
+    auto memobj = pobj(d_memobj);
+    auto device = pobj(d_device);
+
+    if (!memobj->isA(Coal::Object::T_MemObject))
+        return CL_INVALID_MEM_OBJECT;
+
+    if (!device->isA(Coal::Object::T_Device) ||
+        !((Coal::Context *)memobj->parent())->hasDevice(device))
+        return CL_INVALID_DEVICE;
+
+    if (!location)
+        return CL_INVALID_VALUE;
+
+    /* Not allocated on the device yet: where it will be allocated */
+    Coal::DeviceBuffer *buffer = memobj->deviceBuffer(device);
+    bool on_chip = buffer ? buffer->onChip()
+                          : (memobj->flags() & CL_MEM_USE_MSMC_TI) != 0;
+
+    *location = on_chip ? CL_MEM_LOCATION_MSMC_TI : CL_MEM_LOCATION_DDR_TI;
+    return CL_SUCCESS;
+}
+
 void *
 __malloc_ddr(size_t size)
 {
@@ -32,6 +32,7 @@
 
 #include "CL/cl.h"
 #include <core/commandqueue.h>
+#include <core/trace.h>
 
 // Profiling APIs
 cl_int
@@ -50,3 +51,17 @@ clGetEventProfilingInfo(cl_event            d_event,
                                 param_value_size_ret);
 }
 
+cl_int
+__ti_export_trace(const char *file_name)
+{
+    if (!file_name)
+        return CL_INVALID_VALUE;
+
+    if (!Coal::Trace::enabled())
+        return CL_INVALID_OPERATION;
+
+    if (!Coal::Trace::exportJson(file_name))
+        return CL_INVALID_VALUE;
+
+    return CL_SUCCESS;
+}
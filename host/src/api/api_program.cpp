@@ -36,6 +36,7 @@
 #include <core/context.h>
 #include <core/platform.h>
 #include <core/deviceinterface.h>
+#include <core/trace.h>
 
 #include <cstdlib>
 #include <set>
@@ -294,6 +295,7 @@ clBuildProgram(cl_program           d_program,
                void (*pfn_notify)(cl_program program, void * user_data),
                void *               user_data)
 {
+    TRACE_API_CALL();
     auto program = pobj(d_program);
 
     if ((!device_list && num_devices > 0) ||
@@ -392,6 +394,7 @@ clCompileProgram(cl_program           d_program,
                  void (*pfn_notify)(cl_program program, void * user_data),
                  void *               user_data)
 {
+    TRACE_API_CALL();
     auto program = pobj(d_program);
 
     if (!program->isA(Coal::Object::T_Program))
@@ -503,6 +506,7 @@ clLinkProgram(cl_context           d_context,
               void *               user_data,
               cl_int *             errcode_ret)
 {
+    TRACE_API_CALL();
     cl_uint context_num_devices = 0;
     auto context = pobj(d_context);
 
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file build_pool.cpp
+ * \brief Threads building programs in the background
+ */
+
+#include "build_pool.h"
+
+#include <unistd.h>
+
+using namespace Coal;
+
+BuildPool &BuildPool::instance()
+{
+    // Build threads may still run at exit, the pool is never destroyed
+    static BuildPool *pool = new BuildPool();
+    return *pool;
+}
+
+BuildPool::BuildPool()
+: p_num_threads(0), p_num_idle(0)
+{
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    p_max_threads = num_cpus > 2 ? num_cpus : 2;
+
+    pthread_mutex_init(&p_mutex, 0);
+    pthread_cond_init(&p_task_cond, 0);
+    pthread_cond_init(&p_done_cond, 0);
+}
+
+void BuildPool::submit(const std::function<void()> &function,
+                       BuildGroup *group)
+{
+    pthread_mutex_lock(&p_mutex);
+
+    Task task = { function, group };
+    p_tasks.push_back(task);
+    if (group) group->p_num_queued++;
+
+    if (p_num_idle == 0 && p_num_threads < p_max_threads)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, 0, &worker, this) == 0)
+        {
+            pthread_detach(thread);
+            p_num_threads++;
+        }
+    }
+    else
+        pthread_cond_signal(&p_task_cond);
+
+    pthread_mutex_unlock(&p_mutex);
+}
+
+void BuildPool::execute(Task &task)
+{
+    BuildGroup *group = task.group;
+
+    if (group)
+    {
+        group->p_num_queued--;
+        group->p_num_running++;
+    }
+
+    pthread_mutex_unlock(&p_mutex);
+    task.function();
+    pthread_mutex_lock(&p_mutex);
+
+    if (group)
+    {
+        group->p_num_running--;
+        pthread_cond_broadcast(&p_done_cond);
+    }
+}
+
+void BuildPool::wait(BuildGroup *group)
+{
+    pthread_mutex_lock(&p_mutex);
+
+    while (group->p_num_queued > 0)
+    {
+        std::list<Task>::iterator it = p_tasks.begin();
+        while (it->group != group) ++it;
+
+        Task task = *it;
+        p_tasks.erase(it);
+        execute(task);
+    }
+
+    while (group->p_num_running > 0)
+        pthread_cond_wait(&p_done_cond, &p_mutex);
+
+    pthread_mutex_unlock(&p_mutex);
+}
+
+void *BuildPool::worker(void *data)
+{
+    BuildPool *pool = (BuildPool *)data;
+
+    pthread_mutex_lock(&pool->p_mutex);
+
+    while (true)
+    {
+        while (pool->p_tasks.empty())
+        {
+            pool->p_num_idle++;
+            pthread_cond_wait(&pool->p_task_cond, &pool->p_mutex);
+            pool->p_num_idle--;
+        }
+
+        Task task = pool->p_tasks.front();
+        pool->p_tasks.pop_front();
+        pool->execute(task);
+    }
+
+    return 0;
+}
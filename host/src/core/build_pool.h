@@ -0,0 +1,124 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file build_pool.h
+ * \brief Threads building programs in the background
+ */
+
+#ifndef __BUILD_POOL_H__
+#define __BUILD_POOL_H__
+
+#include "tiocl_thread.h"
+
+#include <functional>
+#include <list>
+
+namespace Coal
+{
+
+class BuildGroup;
+
+/**
+ * \brief Threads running program builds
+ *
+ * Builds, compilations and links given a notification callback run on these
+ * threads, so that the API call returns once the build has started. The
+ * device builds of a program are run in parallel through a
+ * \c Coal::BuildGroup.
+ *
+ * Threads are created on demand, up to the number of online CPUs, and stay
+ * until the process exits. The pool is never deleted.
+ */
+class BuildPool
+{
+    public:
+        static BuildPool &instance();
+
+        /**
+         * \brief Run \p function on a build thread
+         * \param group group \p function belongs to, or NULL
+         */
+        void submit(const std::function<void()> &function, BuildGroup *group);
+
+        /**
+         * \brief Wait for the functions of \p group to complete
+         *
+         * Functions of \p group not yet started run on the calling thread, so
+         * waiting from a build thread never needs another free thread.
+         */
+        void wait(BuildGroup *group);
+
+    private:
+        BuildPool();
+
+        struct Task
+        {
+            std::function<void()> function;
+            BuildGroup *          group;
+        };
+
+        static void *worker(void *data);
+        void execute(Task &task);       // Called and returns locked
+
+        pthread_mutex_t  p_mutex;
+        pthread_cond_t   p_task_cond;   // A task was submitted
+        pthread_cond_t   p_done_cond;   // A task of a group completed
+        std::list<Task>  p_tasks;
+        unsigned int     p_num_threads;
+        unsigned int     p_max_threads;
+        unsigned int     p_num_idle;
+};
+
+/**
+ * \brief Functions run in parallel on the build threads, and waited for
+ */
+class BuildGroup
+{
+    public:
+        BuildGroup() : p_num_queued(0), p_num_running(0) {}
+        ~BuildGroup() { wait(); }
+
+        void add(const std::function<void()> &function)
+        {
+            BuildPool::instance().submit(function, this);
+        }
+
+        void wait() { BuildPool::instance().wait(this); }
+
+    private:
+        friend class BuildPool;
+
+        // Protected by the pool mutex
+        unsigned int p_num_queued;
+        unsigned int p_num_running;
+};
+
+}
+
+#endif
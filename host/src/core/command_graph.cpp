@@ -0,0 +1,506 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file command_graph.cpp
+ * \brief Recorded command graphs, replayed as a single command
+ */
+
+#include "command_graph.h"
+#include "deviceinterface.h"
+#include "events.h"
+#include "kernel.h"
+#include "memobject.h"
+
+#include <algorithm>
+
+using namespace Coal;
+
+/******************************************************************************
+* CommandGraph::CommandGraph
+******************************************************************************/
+CommandGraph::CommandGraph(CommandQueue *queue)
+: Object(Object::T_CommandGraph, queue), p_queue(queue), p_device(NULL),
+  p_recording(true), p_in_order(true), p_profiling(false), p_fence(-1),
+  p_replay(NULL), p_last_replay(NULL), p_remaining(0), p_error(CL_SUCCESS)
+{
+    cl_command_queue_properties props    = 0;
+    cl_device_id                d_device = 0;
+
+    queue->info(CL_QUEUE_PROPERTIES, sizeof(props), &props, 0);
+    queue->info(CL_QUEUE_DEVICE, sizeof(d_device), &d_device, 0);
+
+    p_device    = pobj(d_device);
+    p_in_order  = (props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) == 0;
+    p_profiling = (props & CL_QUEUE_PROFILING_ENABLE) != 0;
+
+    pthread_mutex_init(&p_mutex, 0);
+}
+
+/******************************************************************************
+* CommandGraph::~CommandGraph
+******************************************************************************/
+CommandGraph::~CommandGraph()
+{
+    // The application may still hold some of the recorded events
+    for (Command &command : p_commands)
+    {
+        command.event->p_graph = NULL;
+        clReleaseEvent(desc(command.event));
+    }
+
+    if (p_last_replay != NULL)
+        clReleaseEvent(desc(p_last_replay));
+
+    pthread_mutex_destroy(&p_mutex);
+}
+
+/******************************************************************************
+* cl_int CommandGraph::canRecord(Event *event)
+******************************************************************************/
+cl_int CommandGraph::canRecord(Event *event) const
+{
+    switch (event->type())
+    {
+        case Event::MapBuffer:
+        case Event::MapImage:
+        case Event::UnmapMemObject:
+        case Event::NativeKernel:
+        case Event::User:
+        case Event::AcquireGLObjects:
+        case Event::ReleaseGLObjects:
+        case Event::CommandGraphReplay:
+            return CL_INVALID_OPERATION;
+
+        default:
+            return CL_SUCCESS;
+    }
+}
+
+/******************************************************************************
+* cl_int CommandGraph::setPendingWaits
+******************************************************************************/
+cl_int CommandGraph::setPendingWaits(Event *event,
+                                     cl_uint num_events_in_wait_list,
+                                     const cl_event *event_wait_list)
+{
+    cl_int rs = CL_SUCCESS;
+
+    pthread_mutex_lock(&p_mutex);
+    for (cl_uint i = 0; i < num_events_in_wait_list; ++i)
+    {
+        Event *wait_event = pobj(event_wait_list[i]);
+
+        // Events outside the recording cannot be waited on by a replay
+        if (wait_event->p_graph != this)
+        {
+            rs = CL_INVALID_EVENT_WAIT_LIST;
+            break;
+        }
+        event->p_graph_waits.push_back(wait_event);
+    }
+    pthread_mutex_unlock(&p_mutex);
+
+    if (rs != CL_SUCCESS) event->p_graph_waits.clear();
+    return rs;
+}
+
+/******************************************************************************
+* void CommandGraph::addEdge
+******************************************************************************/
+void CommandGraph::addEdge(unsigned int from, unsigned int to)
+{
+    std::vector<unsigned int> &successors = p_commands[from].successors;
+
+    if (std::find(successors.begin(), successors.end(), to) != successors.end())
+        return;
+
+    successors.push_back(to);
+    p_commands[to].num_predecessors += 1;
+}
+
+/******************************************************************************
+* cl_int CommandGraph::record(Event *event)
+******************************************************************************/
+cl_int CommandGraph::record(Event *event)
+{
+    pthread_mutex_lock(&p_mutex);
+
+    if (!p_recording)
+    {
+        pthread_mutex_unlock(&p_mutex);
+        return CL_INVALID_OPERATION;
+    }
+
+    cl_int rs = p_device->recordEventDeviceData(event);
+    if (rs != CL_SUCCESS)
+    {
+        pthread_mutex_unlock(&p_mutex);
+        return rs;
+    }
+
+    unsigned int index = p_commands.size();
+
+    Command command;
+    command.event              = event;
+    command.num_predecessors   = 0;
+    command.num_waiting        = 0;
+    command.predecessor_failed = false;
+    command.armed              = true;   // just initialized by the device
+    p_commands.push_back(command);
+
+    event->p_graph       = this;
+    event->p_graph_index = index;
+
+    /*-------------------------------------------------------------------------
+    * Explicit waits
+    *------------------------------------------------------------------------*/
+    for (Event *wait_event : event->p_graph_waits)
+        addEdge(wait_event->p_graph_index, index);
+    event->p_graph_waits.clear();
+
+    /*-------------------------------------------------------------------------
+    * Implicit waits, as the command queue would add them: the previous
+    * command in order, otherwise the previous fence. A fence waits for all
+    * the commands since the previous one.
+    *------------------------------------------------------------------------*/
+    if (p_in_order)
+    {
+        if (index > 0) addEdge(index - 1, index);
+    }
+    else if (event->isFence())
+    {
+        for (unsigned int i : p_since_fence) addEdge(i, index);
+        if (p_fence >= 0) addEdge(p_fence, index);
+        p_since_fence.clear();
+        p_fence = index;
+    }
+    else
+    {
+        if (p_fence >= 0) addEdge(p_fence, index);
+        p_since_fence.push_back(index);
+    }
+
+    pthread_mutex_unlock(&p_mutex);
+
+    if (p_profiling) event->updateTiming(Event::Queue);
+
+    return CL_SUCCESS;
+}
+
+/******************************************************************************
+* void CommandGraph::endRecording()
+******************************************************************************/
+void CommandGraph::endRecording()
+{
+    pthread_mutex_lock(&p_mutex);
+    p_recording = false;
+    p_since_fence.clear();
+    pthread_mutex_unlock(&p_mutex);
+}
+
+/******************************************************************************
+* cl_int CommandGraph::setKernelArg
+******************************************************************************/
+cl_int CommandGraph::setKernelArg(cl_uint command_index, cl_uint arg_index,
+                                  size_t size, const void *value)
+{
+    if (command_index >= p_commands.size())
+        return CL_INVALID_VALUE;
+
+    Command &command = p_commands[command_index];
+    Event   *event   = command.event;
+
+    if (event->type() != Event::NDRangeKernel &&
+        event->type() != Event::TaskKernel)
+        return CL_INVALID_VALUE;
+
+    Kernel *kernel = ((KernelEvent *) event)->kernel();
+    if (arg_index >= kernel->numArgs())
+        return CL_INVALID_ARG_INDEX;
+
+    /*-------------------------------------------------------------------------
+    * Validate and convert the value the way Kernel::setArg() does
+    *------------------------------------------------------------------------*/
+    const Kernel::Arg &arg = kernel->arg(arg_index);
+    size_t     local_size = size;
+    MemObject *mem_value  = NULL;
+    const void *data      = value;
+    size_t      data_size = size;
+
+    if (arg.file() == Kernel::Arg::Local)
+    {
+        if (size == 0)  return CL_INVALID_ARG_SIZE;
+        if (value != 0) return CL_INVALID_ARG_VALUE;
+        data      = &local_size;
+        data_size = sizeof(local_size);
+    }
+    else switch (arg.kind())
+    {
+        case Kernel::Arg::Buffer:
+            if (size != sizeof(cl_mem)) return CL_INVALID_ARG_SIZE;
+            if (value && *(cl_mem *)value)
+            {
+                mem_value = pobj(*(cl_mem *)value);
+                if (!mem_value->isA(Object::T_MemObject) ||
+                    (mem_value->type() != MemObject::Buffer &&
+                     mem_value->type() != MemObject::SubBuffer) ||
+                    mem_value->parent() != p_queue->parent())
+                    return CL_INVALID_MEM_OBJECT;
+                if (!BufferEvent::isSubBufferAligned(mem_value, p_device))
+                    return CL_MISALIGNED_SUB_BUFFER_OFFSET;
+            }
+            data      = &mem_value;
+            data_size = sizeof(mem_value);
+            break;
+
+        case Kernel::Arg::Image2D:
+        case Kernel::Arg::Image3D:
+        case Kernel::Arg::Sampler:
+            return CL_INVALID_ARG_VALUE;
+
+        default:
+            if (size != arg.vecValueSize()) return CL_INVALID_ARG_SIZE;
+            if (!value)                     return CL_INVALID_ARG_VALUE;
+    }
+
+    /*-------------------------------------------------------------------------
+    * The device data of a replay cannot change under it, from when the replay
+    * is enqueued until it completes. The last replay enqueued is the only one
+    * that can be queued once the others are done: it waits for them. One that
+    * failed before launching stays the last replay, but is no longer queued.
+    *------------------------------------------------------------------------*/
+    pthread_mutex_lock(&p_mutex);
+    cl_int rs = CL_INVALID_OPERATION;
+    if (p_replay == NULL &&
+        (p_last_replay == NULL ||
+         p_last_replay->status() <= Event::Complete))
+    {
+        rs = p_device->patchEventKernelArg(event, arg_index, data, data_size);
+        if (rs == CL_SUCCESS) command.armed = false;
+    }
+    pthread_mutex_unlock(&p_mutex);
+
+    return rs;
+}
+
+/******************************************************************************
+* Replay serialization
+******************************************************************************/
+void CommandGraph::setLastReplay(Event *replay)
+{
+    replay->reference();
+
+    pthread_mutex_lock(&p_mutex);
+    Event *previous = p_last_replay;
+    p_last_replay   = replay;
+    pthread_mutex_unlock(&p_mutex);
+
+    if (previous != NULL) clReleaseEvent(desc(previous));
+}
+
+Event *CommandGraph::lastReplay()
+{
+    pthread_mutex_lock(&p_mutex);
+    Event *replay = p_last_replay;
+    if (replay != NULL) replay->reference();
+    pthread_mutex_unlock(&p_mutex);
+
+    return replay;
+}
+
+/******************************************************************************
+* void CommandGraph::launch(Event *replay)
+* Replays are serialized, none of the recorded commands is in flight here.
+******************************************************************************/
+void CommandGraph::launch(Event *replay)
+{
+    pthread_mutex_lock(&p_mutex);
+    p_replay    = replay;
+    p_remaining = p_commands.size();
+    p_error     = CL_SUCCESS;
+    pthread_mutex_unlock(&p_mutex);
+
+    if (p_profiling) replay->updateTiming(Event::Start);
+
+    for (Command &command : p_commands)
+    {
+        command.num_waiting        = command.num_predecessors;
+        command.predecessor_failed = false;
+
+        Event *event = command.event;
+        pthread_mutex_lock(&event->p_state_mutex);
+        event->p_status = Event::Queued;
+        pthread_mutex_unlock(&event->p_state_mutex);
+    }
+    __sync_synchronize();
+
+    if (p_commands.empty())
+    {
+        p_remaining = 1;
+        commandCompleted(NULL, CL_SUCCESS);
+        return;
+    }
+
+    // Only the commands without predecessors, the others are pushed by the
+    // last of their predecessors to complete
+    for (Command &command : p_commands)
+        if (command.num_predecessors == 0) submit(command);
+}
+
+/******************************************************************************
+* void CommandGraph::submit(Command &command)
+******************************************************************************/
+void CommandGraph::submit(Command &command)
+{
+    Event *event = command.event;
+    cl_int rs    = CL_SUCCESS;
+
+    // The device data of the first replay is the one built when recording
+    if (!command.armed)
+        rs = p_device->rearmEventDeviceData(event);
+    command.armed = false;
+
+    if (rs != CL_SUCCESS)
+    {
+        event->setStatus((Event::Status) rs);
+        return;
+    }
+
+    if (p_profiling)
+    {
+        event->updateTiming(Event::Queue);
+        event->updateTiming(Event::Submit);
+    }
+
+    if (event->isInstantaneous())
+    {
+        event->setStatus(Event::Complete);
+        return;
+    }
+
+    event->setStatus(Event::Submitted);
+    p_device->pushEvent(event);
+}
+
+/******************************************************************************
+* void CommandGraph::commandCompleted(Event *command, cl_int status)
+* Called by whichever thread completes the command. The successor whose last
+* predecessor this was is pushed by this thread, exactly one thread sees a
+* wait count drop to zero.
+******************************************************************************/
+void CommandGraph::commandCompleted(Event *command, cl_int status)
+{
+    if (command != NULL)
+    {
+        Command &completed = p_commands[command->p_graph_index];
+
+        if (status < 0)
+            __sync_bool_compare_and_swap(&p_error, CL_SUCCESS, status);
+
+        for (unsigned int i : completed.successors)
+        {
+            Command &next = p_commands[i];
+
+            if (status < 0) next.predecessor_failed = true;
+            if (__sync_sub_and_fetch(&next.num_waiting, 1) != 0) continue;
+
+            if (next.predecessor_failed)
+                next.event->setStatus((Event::Status)
+                                  CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST);
+            else
+                submit(next);
+        }
+    }
+
+    if (__sync_sub_and_fetch(&p_remaining, 1) != 0) return;
+
+    /*-------------------------------------------------------------------------
+    * Last command of the replay
+    *------------------------------------------------------------------------*/
+    pthread_mutex_lock(&p_mutex);
+    Event *replay = p_replay;
+    cl_int error  = p_error;
+    bool   last   = (p_last_replay == replay);
+    p_replay = NULL;
+    if (last) p_last_replay = NULL;
+    pthread_mutex_unlock(&p_mutex);
+
+    if (p_profiling) replay->updateTiming(Event::End);
+
+    replay->setStatus(error == CL_SUCCESS ? Event::Complete
+                                          : (Event::Status) error);
+
+    if (last) p_queue->releaseEvent(replay);
+}
+
+/******************************************************************************
+* DeviceInterface defaults for replaying recorded commands
+******************************************************************************/
+cl_int DeviceInterface::recordEventDeviceData(Event *event)
+{
+    return CL_SUCCESS;
+}
+
+cl_int DeviceInterface::rearmEventDeviceData(Event *event)
+{
+    freeEventDeviceData(event);
+    event->setDeviceData(0);
+    return initEventDeviceData(event);
+}
+
+cl_int DeviceInterface::patchEventKernelArg(Event *event, cl_uint index,
+                                            const void *value, size_t size)
+{
+    return CL_INVALID_OPERATION;
+}
+
+/******************************************************************************
+* CommandGraphEvent
+******************************************************************************/
+CommandGraphEvent::CommandGraphEvent(CommandQueue *parent,
+                                     CommandGraph *graph,
+                                     cl_uint num_events_in_wait_list,
+                                     const cl_event *event_wait_list,
+                                     cl_int *errcode_ret)
+: Event(parent, Queued, num_events_in_wait_list, event_wait_list, errcode_ret),
+  p_graph_replayed(graph)
+{
+    p_graph_replayed->reference();
+}
+
+CommandGraphEvent::~CommandGraphEvent()
+{
+    if (p_graph_replayed->dereference())
+        delete p_graph_replayed;
+}
+
+Event::Type CommandGraphEvent::type() const
+{
+    return Event::CommandGraphReplay;
+}
@@ -0,0 +1,210 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file command_graph.h
+ * \brief Recorded command graphs, replayed as a single command
+ */
+
+#ifndef __COMMAND_GRAPH_H__
+#define __COMMAND_GRAPH_H__
+
+#include "commandqueue.h"
+
+#include <vector>
+
+namespace Coal
+{
+  class CommandGraph;
+}
+struct _cl_command_graph_ti: public Coal::descriptor<Coal::CommandGraph, _cl_command_graph_ti> {};
+
+namespace Coal
+{
+
+class DeviceInterface;
+
+/**
+ * \brief Immutable sequence of commands recorded on a command queue
+ *
+ * While a \c Coal::CommandQueue records a graph, the events it is given are
+ * initialized by the device as usual (kernel arguments are marshalled, device
+ * messages are built), then kept by the graph instead of being queued. Their
+ * dependencies, from the event wait lists, the in-order property of the queue
+ * and the fences of an out-of-order queue, are resolved once into successor
+ * lists.
+ *
+ * A replay is a single \c Coal::CommandGraphEvent in the queue. When it is
+ * dispatched, \c launch() re-arms the recorded events and pushes those
+ * without predecessors on the device. Each completing command, through
+ * \c commandCompleted(), pushes the successors it releases; the last one
+ * completes the replay. No event is allocated and the command queue lists are
+ * not involved for the recorded commands.
+ *
+ * Replays of a graph never overlap: each waits for the previous one.
+ */
+class CommandGraph : public _cl_command_graph_ti, public Object
+{
+    public:
+        CommandGraph(CommandQueue *queue);
+        ~CommandGraph();
+
+        CommandQueue *queue() const { return p_queue; }
+        unsigned int  numCommands() const { return p_commands.size(); }
+
+        /**
+         * \brief Check whether \p event can be recorded
+         *
+         * Called before the device initializes \p event. Commands that hand
+         * memory to the host (map, unmap), user and native kernel events and
+         * replays of other graphs cannot be recorded.
+         */
+        cl_int canRecord(Event *event) const;
+
+        /**
+         * \brief Set the wait list \p event is recorded with
+         *
+         * Called by the \c Coal::Event constructor while recording, in place
+         * of registering with the waited events. All of them must have been
+         * recorded in this graph.
+         */
+        cl_int setPendingWaits(Event *event, cl_uint num_events_in_wait_list,
+                               const cl_event *event_wait_list);
+
+        /**
+         * \brief Add \p event to the graph, the graph owns the queue reference
+         *
+         * Fails with \c CL_INVALID_OPERATION once recording has ended.
+         * Commands may be recorded from several threads.
+         */
+        cl_int record(Event *event);
+
+        /**
+         * \brief Stop recording, the graph becomes immutable
+         */
+        void endRecording();
+
+        /**
+         * \brief Change an argument of a recorded kernel command
+         *
+         * The value is validated like \c Coal::Kernel::setArg() and handed to
+         * the device, it takes effect at the next replay. By-value and
+         * global buffer arguments can be changed. The kernel object itself
+         * is left untouched. Fails with \c CL_INVALID_OPERATION while a
+         * replay of the graph is queued or running.
+         */
+        cl_int setKernelArg(cl_uint command_index, cl_uint arg_index,
+                            size_t size, const void *value);
+
+        /**
+         * \brief Make \p replay the replay the next one has to wait for
+         *
+         * The graph holds a reference on it until it completes.
+         */
+        void   setLastReplay(Event *replay);
+        Event *lastReplay();   /*!< \brief Retained, or NULL */
+
+        /**
+         * \brief Start a replay
+         *
+         * Called by the command queue, without its lock held, when \p replay
+         * is dispatched.
+         */
+        void launch(Event *replay);
+
+        /**
+         * \brief A recorded command reached \p status
+         *
+         * Called by \c Coal::Event::setStatus() when a recorded command is
+         * complete or failed.
+         */
+        void commandCompleted(Event *command, cl_int status);
+
+    private:
+        struct Command
+        {
+            Event *                    event;
+            std::vector<unsigned int>  successors;
+            unsigned int               num_predecessors;
+            unsigned int               num_waiting;      // during a replay
+            bool                       predecessor_failed;
+            bool                       armed;            // device data ready
+        };
+
+        void addEdge(unsigned int from, unsigned int to);
+        void submit(Command &command);
+
+        CommandQueue *         p_queue;
+        DeviceInterface *      p_device;
+        bool                   p_recording;
+        bool                   p_in_order;
+        bool                   p_profiling;
+        std::vector<Command>   p_commands;
+
+        // Recording, out-of-order queues: last fence and the commands since
+        int                        p_fence;
+        std::vector<unsigned int>  p_since_fence;
+
+        // Recording: p_recording, p_commands, p_fence and p_since_fence are
+        // protected by p_mutex until recording ends, immutable after.
+        // Replay state: p_replay and p_last_replay are protected by p_mutex,
+        // the wait counts and p_remaining are updated atomically
+        pthread_mutex_t        p_mutex;
+        Event *                p_replay;
+        Event *                p_last_replay;
+        unsigned int           p_remaining;
+        cl_int                 p_error;
+};
+
+/**
+ * \brief Replay of a \c Coal::CommandGraph
+ *
+ * Queued like any other command: it waits for its event wait list and, on an
+ * in-order queue, for the previous commands. Commands queued after it wait
+ * until every recorded command of the replay has completed.
+ */
+class CommandGraphEvent : public Event
+{
+    public:
+        CommandGraphEvent(CommandQueue *parent,
+                          CommandGraph *graph,
+                          cl_uint num_events_in_wait_list,
+                          const cl_event *event_wait_list,
+                          cl_int *errcode_ret);
+        ~CommandGraphEvent();
+
+        Type type() const;       /*!< \brief Say the event is a \c Coal::Event::CommandGraphReplay one */
+        CommandGraph *graph() const { return p_graph_replayed; }
+
+    private:
+        CommandGraph *p_graph_replayed;
+};
+
+}
+
+#endif
@@ -33,16 +33,20 @@
  */
 
 #include "commandqueue.h"
+#include "command_graph.h"
 #include "context.h"
 #include "deviceinterface.h"
 #include "propertylist.h"
 #include "events.h"
+#include "object_pool.h"
+#include "trace.h"
 #include "util.h"
 
 #include <cstring>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
+#include <iterator>
 #include <stdio.h>
 
 #ifdef _SYS_BIOS
@@ -54,7 +58,6 @@
 using namespace Coal;
 
 #define ONLY_MAIN_THREAD_CAN_RELEASE_EVENT	0
-#define OOO_QUEUE_PUSH_EVENTS_THRESHOLD		64
 
 /******************************************************************************
 * CommandQueue::CommandQueue
@@ -65,8 +68,7 @@ CommandQueue::CommandQueue(Context *ctx,
                            cl_int *errcode_ret)
 : Object(Object::T_CommandQueue, ctx), p_device(device),
   p_num_events_on_device(0),
-  p_num_events_completed(0),
-  p_properties(properties), p_flushed(true)
+  p_properties(properties), p_fence(NULL), p_recording_graph(NULL)
 {
     // Initialize the locking machinery
     pthread_mutex_init(&p_event_list_mutex, 0);
@@ -219,10 +221,6 @@ void CommandQueue::flush()
 ******************************************************************************/
 void CommandQueue::finish()
 {
-    // As pushEventsOnDevice doesn't remove SUCCESS events, we may need
-    // to do that here in order not to be stuck.
-    cleanEvents();
-
     // All the queued events must have completed. When they are, they get
     // deleted from the command queue, so simply wait for it to become empty.
     pthread_mutex_lock(&p_event_list_mutex);
@@ -240,27 +238,88 @@ void CommandQueue::finish()
 ******************************************************************************/
 cl_int CommandQueue::queueEvent(Event *event)
 {
+    cl_int rs;
+
+    // Created while recording a graph: the device initializes the event as
+    // usual but the graph keeps it instead of the queue. The graph may have
+    // ended since, record() then fails.
+    CommandGraph *graph = event->p_graph_recording;
+    if (graph != NULL)
+    {
+        rs = graph->canRecord(event);
+        if (rs == CL_SUCCESS) rs = p_device->initEventDeviceData(event);
+        if (rs == CL_SUCCESS) rs = graph->record(event);
+        if (rs == CL_SUCCESS)
+        {
+            event->p_graph_recording = NULL;
+            if (graph->dereference()) delete graph;
+        }
+        return rs;
+    }
+
     // Let the device initialize the event (for instance, a pointer at which
     // memory would be mapped)
-    cl_int rs = p_device->initEventDeviceData(event);
+    rs = p_device->initEventDeviceData(event);
 
     if (rs != CL_SUCCESS)
         return rs;
 
+    // Timing info if needed
+    if (p_properties & CL_QUEUE_PROFILING_ENABLE)
+        event->updateTiming(Event::Queue);
+    Trace::commandQueued(event);
+
+    bool is_ooo = (p_properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) != 0;
+
     // Append the event at the end of the list
     pthread_mutex_lock(&p_event_list_mutex);
 
-    p_events.push_back(event);
-    p_flushed = false;
+    // A wait event already failed, nothing left to do for this event
+    if (event->status() < 0)
+    {
+        releaseQueueReference(event);
+        pthread_mutex_unlock(&p_event_list_mutex);
+        cleanReleasedEvents();
+        return CL_SUCCESS;
+    }
 
-    pthread_mutex_unlock(&p_event_list_mutex);
+    // Add the queue gate, if any, before the event becomes visible
+    if (!is_ooo && !p_events.empty())
+        event->p_queue_gate = Event::InOrderGate;
+    else if (is_ooo && p_fence != NULL)
+        event->p_queue_gate = Event::FenceGate;
 
-    // Timing info if needed
-    if (p_properties & CL_QUEUE_PROFILING_ENABLE)
-        event->updateTiming(Event::Queue);
+    if (event->p_queue_gate != Event::NoGate)
+    {
+        pthread_mutex_lock(&event->p_state_mutex);
+        event->p_num_wait_events += 1;
+        pthread_mutex_unlock(&event->p_state_mutex);
+    }
 
-    // Explore the list for events we can push on the device
-    pushEventsOnDevice();
+    event->p_queue_pos = p_events.insert(p_events.end(), event);
+    event->p_in_queue  = true;
+
+    if (event->p_queue_gate == Event::FenceGate)
+    {
+        // Hold a reference, the event may fail and leave p_events while gated
+        event->reference();
+        p_gated_events.push_back(event);
+    }
+    else if (is_ooo && event->isFence())
+        p_fence = event;
+
+    // Drop the "not yet queued" wait set up by the Event constructor
+    if (event->removeWaitEvent(NULL))
+        p_ready_events.push_back(event);
+    else if (!is_ooo)
+        chainEvent(event);
+
+    std::vector<Event *> instantaneous_events;
+    dispatchReadyEvents(instantaneous_events);
+
+    pthread_mutex_unlock(&p_event_list_mutex);
+
+    completeInstantaneousEvents(instantaneous_events);
 
     cleanReleasedEvents();
 
@@ -282,70 +341,20 @@ void CommandQueue::releaseEvent(Event *e)
 }
 
 /******************************************************************************
-* void CommandQueue::cleanEvents()
+* void CommandQueue::releaseQueueReference()
+* Called with p_event_list_mutex held.
 ******************************************************************************/
-void CommandQueue::cleanEvents()
+void CommandQueue::releaseQueueReference(Event *event)
 {
-    bool is_inorder =
-                  (p_properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) == 0;
-
-    pthread_mutex_lock(&p_event_list_mutex);
-
-    // No need to cleanEvents() every time an event finishes, so that we can
-    // save on the event traversal time.  16 is a number that can be tuned
-    // (e.g. using ooo example).
-    if (p_num_events_completed < 16 && p_num_events_on_device > 0 &&
-        p_events.size() - p_num_events_completed > 0)
-    {
-        pthread_mutex_unlock(&p_event_list_mutex);
-        return;
-    }
-
-    std::list<Event *>::iterator it = p_events.begin(), oldit;
-
-    while (it != p_events.end())
-    {
-        Event *event = *it;
-
-        if (event->status() == Event::Complete)
-        {
-            // We cannot be deleted from inside us
-            event->setReleaseParent(false);
-            oldit = it;
-            ++it;
-
-            p_num_events_completed -= 1;
-            p_events.erase(oldit);
-            // put Completed events into another list
-            // let main thread release/delete them
+    // We cannot be deleted from inside us
+    event->setReleaseParent(false);
+    // put Completed events into another list
+    // let main thread release/delete them
 #if ONLY_MAIN_THREAD_CAN_RELEASE_EVENT
-            p_released_events.push_back(event);
+    p_released_events.push_back(event);
 #else
-            clReleaseEvent(desc(event));
+    clReleaseEvent(desc(event));
 #endif
-        }
-        else if (is_inorder)
-        {
-            // In Order Queue events are dispatched and completed in Order
-            break;
-        }
-        else
-        {
-            ++it;
-        }
-    }
-
-    // We have cleared the list, so wake up the sleeping threads
-    if (p_events.size() == 0)
-        pthread_cond_broadcast(&p_event_list_cond);
-
-    pthread_mutex_unlock(&p_event_list_mutex);
-
-    // Check now if we have to be deleted
-    if (references() == 0)
-    {
-        delete this;
-    }
 }
 
 /******************************************************************************
@@ -370,168 +379,210 @@ void CommandQueue::cleanReleasedEvents()
 }
 
 /******************************************************************************
-* void CommandQueue::pushEventsOnDevice()
-* Who is calling this function:
-* (ready_event, one_event_completed_on_device)
-* (not NULL, *    ): worker thread, push till this one ready event
-* (    NULL, true ): worker thread, one completes, push rest on this queue
-* (    NULL, false): main thread, queued a new event, push this queue
+* void CommandQueue::releaseQueueGate()
+* Called with p_event_list_mutex held.
 ******************************************************************************/
-void CommandQueue::pushEventsOnDevice(Event *ready_event,
-                                      bool one_event_completed_on_device)
+void CommandQueue::releaseQueueGate(Event *event)
 {
-    int non_complete_events_traversed = 0;
-    bool is_ooo = (p_properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) != 0;
-    bool do_profile = (p_properties & CL_QUEUE_PROFILING_ENABLE) != 0;
-
-    pthread_mutex_lock(&p_event_list_mutex);
-
-    if (one_event_completed_on_device)
-    {
-        p_num_events_on_device -= 1;
-        p_num_events_completed += 1;
-    }
-
-    // No need to push more events on Device if 1) device has already got
-    // enough to work on, and 2) not pushing won't cause starvation of this
-    // commandqueue.  Not pushing can save p_event_list traversal time.
-    // 2 is a QoS number, set to 2 for the time being
-    // imagine there are multiple commandqueues on same device
-    if(is_ooo && ready_event == NULL &&
-       p_num_events_on_device > 2 && p_device->gotEnoughToWorkOn())
-    {
-        pthread_mutex_unlock(&p_event_list_mutex);
-        return;
-    }
-
-    // Explore the events in p_events and push on the device all of them that
-    // are :
-    //
-    // - Not already pushed (in Event::Queued state)
-    // - Not after a barrier, except if we begin with a barrier
-    // - If we are in-order, only the first event in Event::Queued state can
-    //   be pushed
+    event->p_queue_gate = Event::NoGate;
+    if (event->removeWaitEvent(NULL))
+        p_ready_events.push_back(event);
+}
 
-    std::list<Event *>::iterator it = p_events.begin();
-    std::list<Event *>::iterator oldit;
-    bool first = true;
+/******************************************************************************
+* void CommandQueue::chainEvent()
+* Called with p_event_list_mutex held, on an in-order queue. The gate of event
+* is released when it is its last unmet wait, the event ahead of it is on the
+* device and the device takes care of running them in order.
+******************************************************************************/
+void CommandQueue::chainEvent(Event *event)
+{
+    if (event->p_queue_gate != Event::InOrderGate) return;
+
+    pthread_mutex_lock(&event->p_state_mutex);
+    bool gate_only = (event->p_num_wait_events == 1);
+    pthread_mutex_unlock(&event->p_state_mutex);
+    if (!gate_only) return;
+
+    // Gated, so not at the head of p_events
+    Event *predecessor = *std::prev(event->p_queue_pos);
+    if (predecessor->p_on_device &&
+        p_device->chainEvents(predecessor, event))
+        releaseQueueGate(event);
+}
 
-    // We assume that we will flush the command queue (submit all the events)
-    // This will be changed in the while() when we know that not all events
-    // are submitted.
-    p_flushed = true;
+/******************************************************************************
+* void CommandQueue::releaseGatedEvents()
+* Called with p_event_list_mutex held, when p_fence completes. Gated events
+* are released in queue order up to the next fence, which becomes p_fence.
+******************************************************************************/
+void CommandQueue::releaseGatedEvents()
+{
+    p_fence = NULL;
 
-    while (it != p_events.end())
+    while (!p_gated_events.empty() && p_fence == NULL)
     {
-        Event *event = *it;
+        Event *event = p_gated_events.front();
+        p_gated_events.pop_front();
 
-        cl_int e_status = (cl_int) event->status();
-        // If the event is completed, remove it
-        if (e_status == Event::Complete || e_status < 0)
+        // A gated event that already failed has left p_events, only our
+        // reference keeps it alive. It does not hold the others back.
+        if (event->p_in_queue)
         {
-            event->setReleaseParent(false);
-            oldit = it;
-            ++it;
-
-            p_num_events_completed -= 1;
-            p_events.erase(oldit);
-            // put Completed events into another list
-            // let main thread release/delete them
-#if ONLY_MAIN_THREAD_CAN_RELEASE_EVENT
-            p_released_events.push_back(event);
-#else
-            clReleaseEvent(desc(event));
-#endif
-            continue;
+            if (event->isFence())
+                p_fence = event;
+            releaseQueueGate(event);
         }
+        releaseQueueReference(event);
+    }
+}
 
-        // If OOO queue threshold is met, skip examining the rest of events
-        if(ready_event == NULL &&
-           non_complete_events_traversed > OOO_QUEUE_PUSH_EVENTS_THRESHOLD)
-            break;
-        non_complete_events_traversed += 1;
-
-        // We cannot do out-of-order, so we can only push the first event.
-        if (!is_ooo && !first)
-        {
-            p_flushed = false; // There are remaining events.
-            break;
-        }
+/******************************************************************************
+* void CommandQueue::dispatchReadyEvents()
+* Called with p_event_list_mutex held.
+******************************************************************************/
+void CommandQueue::dispatchReadyEvents(std::vector<Event *> &instantaneous_events)
+{
+    bool is_ooo = (p_properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) != 0;
+    bool do_profile = (p_properties & CL_QUEUE_PROFILING_ENABLE) != 0;
 
-        // Stop if we encounter a barrier that isn't the first event in the list.
-        if (event->type() == Event::Barrier && !first)
-        {
-            // We have events to wait, stop
-            p_flushed = false;
+    while (!p_ready_events.empty())
+    {
+        // No need to push more events on Device if 1) device has already got
+        // enough to work on, and 2) not pushing won't cause starvation of
+        // this commandqueue, the remaining ready events are pushed when one
+        // of ours completes. 2 is a QoS number, set to 2 for the time being
+        // imagine there are multiple commandqueues on same device
+        if (is_ooo && p_num_events_on_device > 2 &&
+            p_device->gotEnoughToWorkOn())
             break;
-        }
 
-        // Completed events and first barriers are out, it remains real events
-        // that have to block in-order execution.
-        first = false;
-
-        // If the event is not "pushable" (in Event::Queued state), skip it
-        // It is either Submitted or Running.
-        if (event->status() != Event::Queued)
-        {
-            // Intended event is scheduled, skip the rest in queue
-            if (event == ready_event) break;
+        Event *event = p_ready_events.front();
+        p_ready_events.pop_front();
 
-            ++it;
+        // Failed (dependency in error status) while waiting
+        if (!event->p_in_queue || event->status() != Event::Queued)
             continue;
-        }
 
-        // Check that all the waiting-on events of this event are finished
-        if (! event->waitEventsAllCompleted())
+        if (event->isInstantaneous())
         {
-            p_flushed = false;
-            // If we encounter a WaitForEvents event that is not "finished",
-            // don't push events after it.
-            if (event->type() == Event::WaitForEvents ||
-                event->type() == Event::Barrier       ||
-                event->type() == Event::Marker)
-                break;
-
-            // The event has its dependencies not already met.
-            ++it;
+            // Set the event as completed once the lock is released, this will
+            // call eventCompleted() again.
+            instantaneous_events.push_back(event);
             continue;
         }
 
-        if (event->isInstantaneous())
+        // A graph replay pushes its recorded commands itself, once the lock
+        // is released. It counts as one event on the device until complete.
+        if (event->type() == Event::CommandGraphReplay)
         {
-            // Remove event from the queue, otherwise, another thread may
-            // come in and try to set the event status to Complete again
-            p_events.erase(it);
-            p_flushed = (p_events.size() == 0);
-            // Pretend begin pushed to device, to maintain proper counting
+            if (do_profile) event->updateTiming(Event::Submit);
+            Trace::commandSubmitted(event);
+            event->setStatus(Event::Submitted);
+            event->p_on_device = true;
             p_num_events_on_device += 1;
-
-            // Set the event as completed. This will call pushEventsOnDevice,
-            // again, so release the lock to avoid a deadlock. We also return
-            // because the recursive call will continue our work.
-            if (p_flushed)
-                pthread_cond_broadcast(&p_event_list_cond);
-            pthread_mutex_unlock(&p_event_list_mutex);
-            event->setStatus(Event::Complete);
-            clReleaseEvent(desc(event));
-            return;
+            instantaneous_events.push_back(event);
+            continue;
         }
 
         // The event can be pushed, if we need to
         if (do_profile) event->updateTiming(Event::Submit);
+        Trace::commandSubmitted(event);
 
         event->setStatus(Event::Submitted);
+        event->p_on_device = true;
         p_num_events_on_device += 1;
         p_device->pushEvent(event);
+
+        // In order: the next event may follow this one on the device
+        if (!is_ooo)
+        {
+            std::list<Event *>::iterator next = std::next(event->p_queue_pos);
+            if (next != p_events.end()) chainEvent(*next);
+        }
     }
+}
 
-    if (ready_event != NULL && p_flushed)
-        p_flushed = (p_events.size() == 0);
+/******************************************************************************
+* void CommandQueue::completeInstantaneousEvents()
+* Called without p_event_list_mutex held.
+******************************************************************************/
+void CommandQueue::completeInstantaneousEvents(std::vector<Event *> &events)
+{
+    for (Event *event : events)
+    {
+        if (event->type() == Event::CommandGraphReplay)
+            ((CommandGraphEvent *) event)->graph()->launch(event);
+        else
+            event->setStatus(Event::Complete);
+    }
+}
 
-    if (p_flushed)
+/******************************************************************************
+* void CommandQueue::pushEventsOnDevice()
+* Who is calling this function:
+* (not NULL): worker or main thread, the waits of this event are all met
+* (    NULL): worker or main thread, push the remaining ready events
+******************************************************************************/
+void CommandQueue::pushEventsOnDevice(Event *ready_event)
+{
+    std::vector<Event *> instantaneous_events;
+
+    pthread_mutex_lock(&p_event_list_mutex);
+
+    if (ready_event != NULL)
+        p_ready_events.push_back(ready_event);
+    dispatchReadyEvents(instantaneous_events);
+
+    pthread_mutex_unlock(&p_event_list_mutex);
+
+    completeInstantaneousEvents(instantaneous_events);
+}
+
+/******************************************************************************
+* void CommandQueue::eventCompleted()
+* Called by the thread completing the event, after its dependent events have
+* been notified.
+******************************************************************************/
+void CommandQueue::eventCompleted(Event *event)
+{
+    std::vector<Event *> instantaneous_events;
+
+    pthread_mutex_lock(&p_event_list_mutex);
+
+    if (event->p_on_device)
+    {
+        event->p_on_device = false;
+        p_num_events_on_device -= 1;
+    }
+
+    if (event->p_in_queue)
+    {
+        event->p_in_queue = false;
+
+        // In order: the next event reaches the head of the queue
+        bool was_head = (event->p_queue_pos == p_events.begin());
+        p_events.erase(event->p_queue_pos);
+        if (was_head && !p_events.empty() &&
+            p_events.front()->p_queue_gate == Event::InOrderGate)
+            releaseQueueGate(p_events.front());
+
+        // Out of order: the events behind this fence can go
+        if (event == p_fence)
+            releaseGatedEvents();
+
+        releaseQueueReference(event);
+    }
+
+    dispatchReadyEvents(instantaneous_events);
+
+    // We have cleared the list, so wake up the sleeping threads
+    if (p_events.size() == 0)
         pthread_cond_broadcast(&p_event_list_cond);
 
     pthread_mutex_unlock(&p_event_list_mutex);
+
+    completeInstantaneousEvents(instantaneous_events);
 }
 
 /******************************************************************************
@@ -588,6 +639,70 @@ Event **CommandQueue::events(unsigned int &count,
     return result;
 }
 
+/******************************************************************************
+* cl_int CommandQueue::beginGraph()
+******************************************************************************/
+cl_int CommandQueue::beginGraph()
+{
+    pthread_mutex_lock(&p_event_list_mutex);
+
+    cl_int rs = CL_INVALID_OPERATION;
+    if (p_recording_graph == NULL)
+    {
+        p_recording_graph = new CommandGraph(this);
+        rs = CL_SUCCESS;
+    }
+
+    pthread_mutex_unlock(&p_event_list_mutex);
+    return rs;
+}
+
+/******************************************************************************
+* CommandGraph *CommandQueue::endGraph()
+******************************************************************************/
+CommandGraph *CommandQueue::endGraph(cl_int *errcode_ret)
+{
+    pthread_mutex_lock(&p_event_list_mutex);
+    CommandGraph *graph = p_recording_graph;
+    p_recording_graph   = NULL;
+    pthread_mutex_unlock(&p_event_list_mutex);
+
+    if (graph == NULL)
+    {
+        *errcode_ret = CL_INVALID_OPERATION;
+        return NULL;
+    }
+
+    graph->endRecording();
+    *errcode_ret = CL_SUCCESS;
+    return graph;
+}
+
+/******************************************************************************
+* CommandGraph *CommandQueue::recordingGraph()
+******************************************************************************/
+CommandGraph *CommandQueue::recordingGraph()
+{
+    pthread_mutex_lock(&p_event_list_mutex);
+    CommandGraph *graph = p_recording_graph;
+    if (graph != NULL) graph->reference();
+    pthread_mutex_unlock(&p_event_list_mutex);
+
+    return graph;
+}
+
+/******************************************************************************
+* bool CommandQueue::isRecordingGraph()
+******************************************************************************/
+bool CommandQueue::isRecordingGraph()
+{
+    pthread_mutex_lock(&p_event_list_mutex);
+    bool recording = (p_recording_graph != NULL);
+    pthread_mutex_unlock(&p_event_list_mutex);
+
+    return recording;
+}
+
 /******************************************************************************
 * Event::Event
 ******************************************************************************/
@@ -597,7 +712,9 @@ Event::Event(CommandQueue *parent,
              const cl_event *event_wait_list,
              cl_int *errcode_ret)
 : Object(Object::T_Event, parent),
-  p_status(status), p_device_data(0)
+  p_status(status), p_device_data(0), p_num_wait_events(1),
+  p_queue_gate(NoGate), p_in_queue(false), p_on_device(false),
+  p_graph(NULL), p_graph_index(0), p_graph_recording(NULL)
 {
     // Initialize the locking machinery
     pthread_cond_init(&p_state_change_cond, 0);
@@ -634,6 +751,17 @@ Event::Event(CommandQueue *parent,
         }
     }
 
+    // While a graph is recorded, waits become edges of the graph, added
+    // when the queue records the event
+    p_graph_recording = parent ? parent->recordingGraph() : NULL;
+    if (p_graph_recording != NULL)
+    {
+        *errcode_ret = p_graph_recording->setPendingWaits(this,
+                                                    num_events_in_wait_list,
+                                                    event_wait_list);
+        return;
+    }
+
     if (parent && num_events_in_wait_list > 0)
     {
         bool wait_events_in_error_status = false;
@@ -644,7 +772,7 @@ Event::Event(CommandQueue *parent,
             Event *wait_event = pobj(event_wait_list[i]);
             int added = wait_event->addDependentEvent((Event *) this);
             if (added > 0)
-                p_wait_events.push_back(wait_event);
+                p_num_wait_events += 1;
             else if (added < 0)
                 wait_events_in_error_status = true;
         }
@@ -675,10 +803,38 @@ void Event::freeDeviceData()
 ******************************************************************************/
 Event::~Event()
 {
+    // Created while recording, but not recorded
+    if (p_graph_recording != NULL && p_graph_recording->dereference())
+        delete p_graph_recording;
+
     pthread_mutex_destroy(&p_state_mutex);
     pthread_cond_destroy(&p_state_change_cond);
 }
 
+/******************************************************************************
+* Event::operator new / delete
+*   Every subclass of Event is allocated from one pool, with a free list for
+*   each size. The pool outlives events released during static destruction.
+******************************************************************************/
+#define EVENT_POOL_MAX_SIZE     2048
+
+static ObjectPool &event_pool()
+{
+    static ObjectPool *pool = new ObjectPool(ObjectPool::Events,
+                                             EVENT_POOL_MAX_SIZE);
+    return *pool;
+}
+
+void *Event::operator new(size_t size)
+{
+    return event_pool().allocate(size);
+}
+
+void Event::operator delete(void *ptr, size_t size)
+{
+    event_pool().release(ptr, size);
+}
+
 /******************************************************************************
 * bool Event::isInstantaneous()
 ******************************************************************************/
@@ -700,6 +856,23 @@ bool Event::isInstantaneous() const
     }
 }
 
+/******************************************************************************
+* bool Event::isFence()
+******************************************************************************/
+bool Event::isFence() const
+{
+    switch (type())
+    {
+        case Marker:
+        case Barrier:
+        case WaitForEvents:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 /******************************************************************************
 * void Event::setStatus
 ******************************************************************************/
@@ -731,9 +904,12 @@ void Event::setStatus(Status status)
 {
     std::list<CallbackData> callbacks;
 
+    if (status == Complete || status < 0)
+        Trace::commandCompleted(this);
+
     /*---------------------------------------------------------------------
-    * CQ.pushEventsOnDevice() needs to access internal data structure of CQ.
-    * To prevent CQ from being deleted from within pushEventsOnDevice() call,
+    * CQ.eventCompleted() needs to access internal data structure of CQ.
+    * To prevent CQ from being deleted from within eventCompleted() call,
     * for example when the completed event is the last event in the queue,
     * we retain CQ beforehand and release CQ afterwards.
     *--------------------------------------------------------------------*/
@@ -741,35 +917,33 @@ void Event::setStatus(Status status)
     {
         CommandQueue *cq = (CommandQueue *) parent();
         if (cq != NULL)  clRetainCommandQueue(desc(cq));
-        bool already_pushed = false;
 
         int num_dependent_events = setStatusHelper(status, callbacks);
         /*---------------------------------------------------------------------
-        * From this point on, the event could be dereferenced to 0 and deleted!
-        * Thus we cannot call flushQueues(). Need to save these queues.
+        * The queue still holds its reference on this event until
+        * eventCompleted(), the dependent events hold theirs until
+        * removeWaitEvent().
         *--------------------------------------------------------------------*/
 
         /*---------------------------------------------------------------------
-        * Notify dependent events, remove dependence, and push them if possible
+        * Notify dependent events, remove dependence, and push the ones that
+        * just became ready. Only successors are visited, never the queues.
         *--------------------------------------------------------------------*/
         for (int i = 0; i < num_dependent_events; i += 1)
         {
             Event *d_event = p_dependent_events[i];
             CommandQueue *q = (CommandQueue *) d_event->parent();
             if (d_event->removeWaitEvent(this) && q != NULL)  // order!
-            {
-                q->pushEventsOnDevice(d_event, (cq == q));
-                if (cq == q)  already_pushed = true;
-            }
+                q->pushEventsOnDevice(d_event);
         }
 
         /*---------------------------------------------------------------------
-        * Inform our parent to push other events to the device if haven't done
-        * so already.  UserEvent's parent is NULL.
+        * Inform our parent, it releases the events gated behind us and
+        * pushes the remaining ready events.  UserEvent's parent is NULL.
         *--------------------------------------------------------------------*/
         if (cq != NULL)
         {
-            if (!already_pushed)  cq->pushEventsOnDevice(NULL, true);
+            cq->eventCompleted(this);
             clReleaseCommandQueue(desc(cq));
         }
     }
@@ -800,12 +974,17 @@ void Event::setStatus(Status status)
 
             if (cq != NULL)
             {
-                cq->pushEventsOnDevice(NULL, true);
+                cq->eventCompleted(this);
                 clReleaseCommandQueue(desc(cq));
             }
         }
     }
 
+    // A recorded command reports to its graph, which pushes its successors
+    // and completes the replay
+    if (p_graph != NULL && (status == Complete || status < 0))
+        p_graph->commandCompleted(this, status);
+
     // Call the callbacks, release event afterwards
     if (!callbacks.empty())
     {
@@ -840,30 +1019,27 @@ bool Event::removeWaitEvent(Event *event)
     bool empty;
 
     pthread_mutex_lock(&p_state_mutex);
-    p_wait_events.remove(event);
-    empty = p_wait_events.empty();
+    p_num_wait_events -= 1;
+    empty = (p_num_wait_events == 0);
     pthread_mutex_unlock(&p_state_mutex);
 
-    CommandQueue *q = (CommandQueue *) event->parent();
-    if (q != NULL) q->releaseEvent(event);
+    if (event != NULL)
+    {
+        CommandQueue *q = (CommandQueue *) event->parent();
+        if (q != NULL) q->releaseEvent(event);
+    }
     return empty;
 }
 
 bool Event::waitEventsAllCompleted()
 {
-// YUAN TODO: p_wait_events is always shrinking, is lock necessary?
-//            it is a little bit faster without having to lock!!!
-#if 1
     bool empty;
 
     pthread_mutex_lock(&p_state_mutex);
-    empty = p_wait_events.empty();
+    empty = (p_num_wait_events == 0);
     pthread_mutex_unlock(&p_state_mutex);
 
     return empty;
-#else
-    return p_wait_events.empty();
-#endif
 }
 
 /******************************************************************************
@@ -1147,6 +1323,7 @@ const char* Event::name()
         case User:              return "User";
         case Barrier:           return "Barrier";
         case WaitForEvents:     return "WaitForEvents";
+        case CommandGraphReplay: return "CommandGraphReplay";
         default:                return "UnknownCLCommand";
     }
 }
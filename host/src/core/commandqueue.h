@@ -43,6 +43,7 @@
 
 #include <map>
 #include <list>
+#include <deque>
 #include <vector>
 
 namespace Coal
@@ -59,6 +60,7 @@ namespace Coal
 class Context;
 class DeviceInterface;
 class Event;
+class CommandGraph;
 
 /**
  * \brief Command queue
@@ -118,64 +120,61 @@ class CommandQueue : public _cl_command_queue, public Object
          * This function implements a big part of what is described in
          * \ref events .
          *
-         * It is called by \c Coal::Event::setStatus() when an event is
-         * completed, or by \c queueEvent(). Its purpose is to explore the list
-         * of queued events (\c p_events) and to call
-         * \c Coal::DeviceInterface::pushEvent() for each event meeting its push
-         * conditions.
+         * It is called by \c Coal::Event::setStatus() when an event completes
+         * and one of its successors becomes ready, by \c queueEvent() and by
+         * \c eventCompleted(). Events are never searched for: an event is
+         * only handed to this function once it is known to be ready, so the
+         * cost is proportional to the number of ready events, not to the
+         * number of events in the queue.
          *
-         * \param ready_event is know to be pushable, push events in the
-         * queue till this point, skip the events after this one.
-         *
-         * \param one_event_completed_on_device can be used to differentiate
-         * whether this function is called by worker thread when an event is
-         * completed, or by main thread's queueEvent().
+         * \param ready_event event whose wait count just dropped to zero, or
+         *        NULL to only dispatch the events already on the ready list.
          *
          * \section conditions Conditions
          *
-         * If the command queue has the \c CL_OUT_OF_ORDER_EXEC_MODE_ENABLE
-         * property disabled, an event can be pushed only if all the previous
-         * ones in the list are completed with success. This way, an event
-         * must be completed before any other can be pushed. This ensures
-         * in-order execution.
+         * Every event keeps a count of unmet waits (see
+         * \c Coal::Event::removeWaitEvent()). Besides its event wait list,
+         * the command queue adds at most one implicit wait, the "queue gate":
          *
-         * If this property is enable, more complex heuristics are used.
+         * - If the command queue has the \c CL_OUT_OF_ORDER_EXEC_MODE_ENABLE
+         *   property disabled, an event is gated until it reaches the head of
+         *   \c p_events, i.e. until all the previous ones are completed. This
+         *   ensures in-order execution.
+         * - If this property is enabled, an event queued behind an incomplete
+         *   \c Coal::BarrierEvent, \c Coal::MarkerEvent or
+         *   \c Coal::WaitForEventsEvent (a "fence") is gated until the fence
+         *   completes. Gated events are kept in \c p_gated_events in queue
+         *   order and released up to the next fence.
          *
-         * The event list \c p_events is explored from top to bottom. At each
-         * loop iteration, checks are performed to see if the event can be pushed.
+         * On an in-order queue, the device may also be able to run an event
+         * right behind the one ahead of it, once that one is on the device
+         * (see \c Coal::DeviceInterface::chainEvents()). Its queue gate is
+         * then released early.
          *
-         * - When a \c Coal::BarrierEvent is encountered, no more events can be
-         *   pushed, except if the \c Coal::BarrierEvent is the first in the list,
-         *   as that means there are no other events that can be pushed, so the
-         *   barrier can go away
-         * - All events that are already pushed or finished are skipped
-         * - The wait list of the event is then explored to ensure that all its
-         *   dependencies are met.
-         * - Finally, if the events passes all the tests, it is either pushed on
-         *   the device, or simply set to \c Coal::Event::Complete if it's a
-         *   dummy event (see \c Coal::Event::isInstantaneous()).
+         * Once the count drops to zero, the event is either pushed on the
+         * device, or simply set to \c Coal::Event::Complete if it's a
+         * dummy event (see \c Coal::Event::isInstantaneous()).
          */
-        void pushEventsOnDevice(Event *ready_event = NULL,
-                                bool one_event_completed_on_device = false);
+        void pushEventsOnDevice(Event *ready_event = NULL);
 
         /**
-         * \brief Push an event onto p_release_event list
+         * \brief Remove a completed event from the command queue
          *
-         * Later main thread will perform release event action.
+         * Called by \c Coal::Event::setStatus() once the event is
+         * \c Coal::Event::Complete or in an error state. Releases the queue
+         * gate of the events that were waiting behind it, drops the event
+         * from \c p_events and dispatches the ready events.
+         *
+         * \param event event that just completed
          */
-        void releaseEvent(Event *e);
+        void eventCompleted(Event *event);
 
         /**
-         * \brief Remove from the event list completed events
-         *
-         * This function is called periodically to clean the event list from
-         * completed events.
+         * \brief Push an event onto p_release_event list
          *
-         * It is needed to do that out of \c pushEventsOnDevice() as deleting
-         * event may \c dereference() this command queue, and also delete it. It
-         * would produce crashes.
+         * Later main thread will perform release event action.
          */
-        void cleanEvents();
+        void releaseEvent(Event *e);
 
         /**
          * \brief Release events on the released event list
@@ -214,6 +213,29 @@ class CommandQueue : public _cl_command_queue, public Object
         Event **events(unsigned int &count,
                        bool include_completed_events = true);
 
+        /**
+         * \brief Start recording a \c Coal::CommandGraph
+         *
+         * Until \c endGraph(), \c queueEvent() adds the events to the graph
+         * instead of queueing them.
+         */
+        cl_int beginGraph();
+
+        /**
+         * \brief Stop recording and return the recorded graph
+         */
+        CommandGraph *endGraph(cl_int *errcode_ret);
+
+        /**
+         * \brief Graph being recorded, retained, or NULL if not recording
+         */
+        CommandGraph *recordingGraph();
+
+        /**
+         * \brief Whether a graph is being recorded
+         */
+        bool isRecordingGraph();
+
 #if defined(_SYS_BIOS)
         /**
          * \brief Return host frequency
@@ -221,17 +243,66 @@ class CommandQueue : public _cl_command_queue, public Object
         cl_ulong getFreq() { return p_freq; }
 #endif
 
+    private:
+        /**
+         * \brief Dispatch the events of \c p_ready_events
+         *
+         * Called with \c p_event_list_mutex held. Instantaneous events
+         * cannot be completed with the lock held, they are returned in
+         * \p instantaneous_events for the caller to complete.
+         */
+        void dispatchReadyEvents(std::vector<Event *> &instantaneous_events);
+
+        /**
+         * \brief Complete the instantaneous events returned by
+         *        \c dispatchReadyEvents(), and launch the command graph
+         *        replays it returned with them
+         */
+        void completeInstantaneousEvents(std::vector<Event *> &events);
+
+        /**
+         * \brief Release the queue gate of \p event
+         *
+         * Called with \c p_event_list_mutex held. If this was the last unmet
+         * wait of \p event, it is appended to \c p_ready_events.
+         */
+        void releaseQueueGate(Event *event);
+
+        /**
+         * \brief Release the queue gate of \p event early, if the device can
+         *        chain it to the event ahead of it
+         *
+         * Called with \c p_event_list_mutex held, on an in-order queue.
+         */
+        void chainEvent(Event *event);
+
+        /**
+         * \brief Release the gated events up to, and including, the next fence
+         */
+        void releaseGatedEvents();
+
+        /**
+         * \brief Drop a reference to \p event held by the command queue
+         */
+        void releaseQueueReference(Event *event);
+
     private:
         DeviceInterface *p_device;
         cl_int p_num_events_on_device;
-        cl_int p_num_events_completed;
         cl_command_queue_properties p_properties;
 
-        std::list<Event *> p_events;
+        // p_events:        queued events that are not completed yet
+        // p_ready_events:  events whose waits are all met, not yet dispatched
+        // p_gated_events:  out-of-order only, events queued behind p_fence
+        std::list<Event *>  p_events;
+        std::deque<Event *> p_ready_events;
+        std::deque<Event *> p_gated_events;
+        Event *p_fence;
+
         std::list<Event *> p_released_events;
+        CommandGraph *p_recording_graph;   // protected by p_event_list_mutex
         pthread_mutex_t p_event_list_mutex;
         pthread_cond_t p_event_list_cond;
-        bool p_flushed;
 #if defined(_SYS_BIOS)
         cl_ulong p_freq;  // in Hz
 #endif
@@ -282,7 +353,8 @@ class Event : public _cl_event, public Object
             User = CL_COMMAND_USER,
             FillBuffer = CL_COMMAND_FILL_BUFFER,
             Barrier = CL_COMMAND_BARRIER,
-            WaitForEvents
+            WaitForEvents,
+            CommandGraphReplay
         };
 
         /**
@@ -343,6 +415,13 @@ class Event : public _cl_event, public Object
         void freeDeviceData();      /*!< \brief Call \c Coal::DeviceInterface::freeEventDeviceData() */
         virtual ~Event();           /*!< \brief Destructor */
 
+        /**
+         * \brief Events are created at every enqueue, their memory is
+         *        recycled through a \c Coal::ObjectPool
+         */
+        static void *operator new(size_t size);
+        static void  operator delete(void *ptr, size_t size);
+
         /**
          * \brief Type of the event
          * \return type of the event
@@ -443,11 +522,17 @@ class Event : public _cl_event, public Object
                              size_t *param_value_size_ret) const;
 
         /**
-         * \brief Call \c Coal::CommandQueue::pushEventsOnDevice() for each command queue
-         * in which this event is queued or each queue with an event waiting on this event
+         * \brief Event behaving like a barrier on an out-of-order queue
+         *
+         * Events queued after an incomplete \c Barrier, \c Marker or
+         * \c WaitForEvents event are held back until it completes.
          */
-        void flushQueues();
+        bool isFence() const;
 
+        /**
+         * \brief Event created while its queue was recording a graph
+         */
+        bool isGraphCommand() const { return p_graph_recording != NULL; }
 
         /**
          * \brief Add event to p_dependent_events, which will be notified when
@@ -459,10 +544,12 @@ class Event : public _cl_event, public Object
         int addDependentEvent(Event *event);
 
         /**
-         * \brief Remove event from p_wait_events, which should be waited on
-         * before current event can start. When p_wait_events becomes empty,
-         * return true to indicate that current event is ready to be pushed.
-         * \param event the event to be removed from p_wait_events
+         * \brief Decrement the count of unmet waits of the current event.
+         * When it drops to zero, return true to indicate that current event
+         * is ready to be pushed.
+         * \param event the completed event that was waited on, NULL for a
+         *        wait that is not backed by an event (queue gate, not yet
+         *        queued)
          */
         bool removeWaitEvent(Event *event);
 
@@ -473,12 +560,25 @@ class Event : public _cl_event, public Object
         bool waitEventsAllCompleted();
 
     private:
+        friend class CommandQueue;
+        friend class CommandGraph;
+
         /**
          * \brief Helper function for setStatus()
          * return number of dependent events
          */
         int setStatusHelper(Status status, std::list<CallbackData> &callbacks);
 
+        /**
+         * \brief Implicit wait added by the parent \c Coal::CommandQueue
+         */
+        enum QueueGate
+        {
+            NoGate,                  /*!< Only waits on its event wait list */
+            InOrderGate,             /*!< Waits to reach the head of the queue */
+            FenceGate                /*!< Waits for the previous fence */
+        };
+
     private:
         pthread_cond_t p_state_change_cond;
         pthread_mutex_t p_state_mutex;
@@ -489,10 +589,27 @@ class Event : public _cl_event, public Object
 
         cl_ulong p_timing[Max];
 
-        // p_wait_events: I should wait after these events complete
+        // p_num_wait_events: I should wait after this many events complete,
+        //                    plus one until queued, plus one if gated
         // p_dependent_events: when I complete, I should notify these events
-        std::list<const Event *>   p_wait_events;
+        cl_uint              p_num_wait_events;
         std::vector<Event *> p_dependent_events;
+
+        // Owned by the parent CommandQueue, protected by p_event_list_mutex
+        std::list<Event *>::iterator p_queue_pos;
+        QueueGate p_queue_gate;
+        bool p_in_queue;
+        bool p_on_device;
+
+        // Set when the event is a recorded command of a graph, which then
+        // tracks its dependencies instead of the fields above
+        CommandGraph *p_graph;
+        unsigned int  p_graph_index;
+
+        // Graph the queue was recording when the event was created, retained
+        // until the event is recorded in it, and the wait list to record
+        CommandGraph *        p_graph_recording;
+        std::vector<Event *>  p_graph_waits;
 };
 
 }
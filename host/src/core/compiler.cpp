@@ -36,23 +36,52 @@
 
 #include <cstring>
 #include <cstdio>
+#include <cstdlib>
 #include <string>
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <vector>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <pthread.h>
 
 #include "dsp/genfile_cache.h"
+#include "util.h"
+#include "../../clocl/libclocl.h"
 
 using namespace Coal;
+using namespace std;
+
+/*-----------------------------------------------------------------------------
+* The clocl library, loaded once and kept for the life of the process so that
+* its LLVM state is reused by every build. When it is not installed, clocl is
+* run as a separate process.
+*----------------------------------------------------------------------------*/
+static clocl_run_fn   clocl_library      = NULL;
+static pthread_once_t clocl_library_once = PTHREAD_ONCE_INIT;
+
+static void LoadCloclLibrary()
+{
+    void *handle = dlopen(CLOCL_LIBRARY, RTLD_NOW | RTLD_LOCAL);
+    if (handle)
+        clocl_library = (clocl_run_fn) dlsym(handle, CLOCL_RUN_SYMBOL);
+}
 
 Compiler::Compiler(DeviceInterface *device)
 : p_device(device)
 {
+    pthread_once(&clocl_library_once, LoadCloclLibrary);
+
     do_cache_kernels = (getenv("TI_OCL_CACHE_KERNELS")  != NULL);
     do_keep_files    = (getenv("TI_OCL_KEEP_FILES")     != NULL);
     do_debug         = (getenv("TI_OCL_DEBUG")          != NULL);
     do_symbols       = (getenv("TI_OCL_DEVICE_PROGRAM_INFO") != NULL);
+
+    // Debug builds are not cached, the program removes them when released
+    if (do_debug) do_cache_kernels = false;
 }
 
 Compiler::~Compiler()
@@ -112,9 +141,10 @@ bool Compiler::CompileAndLink(const string &source,
     cl_device_type devtype;
     p_device->info(CL_DEVICE_TYPE, sizeof(devtype), &devtype, 0);
 
-    // No support for CPU (ARM) kernel compile - will be added later
     if (devtype & CL_DEVICE_TYPE_ACCELERATOR)
         return CompileAndLinkForDSP(source, options, outfile);
+    else if (devtype & CL_DEVICE_TYPE_CPU)
+        return RunClocl(source, options, "--host ", ".so", outfile);
     else
         return false;
 }
@@ -173,8 +203,7 @@ void RemoveIHPaths(const vector<string>& ih_file_paths)
     }
 }
 
-// Online compile for Acccelerator device (DSP) implemented via
-// system call of clocl
+// Online compile for Acccelerator device (DSP) implemented via clocl
 bool Compiler::CompileForDSP(const string &source,
                              const map<string, string> &input_header_src,
                              const string &options,
@@ -212,7 +241,7 @@ bool Compiler::CompileForDSP(const string &source,
     }
 
     // Begin clocl compilation
-    string clocl_command("clocl -d -l ");
+    string clocl_command("-d -l ");
     clocl_command += "-I";
     clocl_command += ih_dir;
     clocl_command += " -I. ";
@@ -240,37 +269,12 @@ bool Compiler::CompileForDSP(const string &source,
     objfile     += ".obj";
     bc_objfile  += "_bc.obj";
 
-    string logfile(name_out);
-    logfile.reserve(name_out_size + 5);
-    logfile += ".log";
-
     clocl_command +=  srcfile;
-    clocl_command +=  " > ";
-    clocl_command += logfile;
-
-    // put source in a tmp file, run clocl, read tmp output in
-    ofstream src_out(srcfile.c_str());
-    src_out << source;
-    src_out.close();
 
-    int ret_code = system(clocl_command.c_str());
-
-    ifstream log_in(logfile.c_str());
-    string log_line;
-    if (log_in.is_open())
-    {
-        while (getline(log_in, log_line))
-        {
-            appendLog(log_line);
-            appendLog("\n");
-            cout << log_line << endl;
-        }
-        log_in.close();
-    }
+    bool success = InvokeClocl(clocl_command, srcfile, source, name_out);
     close(fOutfile);
 
     if (!do_keep_files && !do_debug) unlink(srcfile.c_str());
-    unlink(logfile.c_str());
     unlink(name_out);
 
     RemoveIHPaths(ih_file_paths);
@@ -279,10 +283,7 @@ bool Compiler::CompileForDSP(const string &source,
     unlink(fIhOutDir);
     rmdir(ih_dir.c_str());
 
-    // Check for system() call failure or clocl compile failure
-    if (ret_code != 0) return false;
-
-    return true;
+    return success;
 }
 
 
@@ -353,8 +354,7 @@ bool CreateExportSymbolsFile(const string& export_symbols,
     return true;
 }
 
-// Online link for Acccelerator device (DSP) implemented via
-// system call of clocl
+// Online link for Acccelerator device (DSP) implemented via clocl
 bool Compiler::LinkForDSP(const vector<string>& input_obj_files,
                           const vector<string>& input_libs,
                           const string& options,
@@ -409,7 +409,7 @@ bool Compiler::LinkForDSP(const vector<string>& input_obj_files,
     }
 
     // Begin clocl link
-    string clocl_command("clocl ");
+    string clocl_command;
     clocl_command.reserve(options.size() + 64);
 
     char name_out[] = "/tmp/openclXXXXXX";
@@ -442,29 +442,9 @@ bool Compiler::LinkForDSP(const vector<string>& input_obj_files,
         clocl_command += obj_file_binary_path;
     }
 
-    string logfile(name_out);
-    logfile       += ".log";
-    clocl_command +=  " > ";
-    clocl_command += logfile;
-
-    // put source in a tmp file, run clocl, read tmp output in
-    int ret_code = system(clocl_command.c_str());
-
-    ifstream log_in(logfile.c_str());
-    string log_line;
-    if (log_in.is_open())
-    {
-        while (getline(log_in, log_line))
-        {
-            appendLog(log_line);
-            appendLog("\n");
-            cout << log_line << endl;
-        }
-        log_in.close();
-    }
+    bool success = InvokeClocl(clocl_command, "", "", name_out);
     close(fOutfile);
 
-    unlink(logfile.c_str());
     for (const string& obj_file_binary_path : obj_file_binary_paths)
     {
         unlink(obj_file_binary_path.c_str());
@@ -476,33 +456,46 @@ bool Compiler::LinkForDSP(const vector<string>& input_obj_files,
     close(fExpSymfile);
     unlink(exp_sym_name_out);
 
-    // Check for system() call failure or clocl compile failure
-    if (ret_code != 0) return false;
-
-    return true;
+    return success;
 }
 #endif // #ifndef _SYS_BIOS
 
 
-// Online compile for Acccelerator device (DSP) implemented via
-// system call of clocl
+// Online compile for Acccelerator device (DSP) implemented via clocl
 bool Compiler::CompileAndLinkForDSP(const string &source,
                                     const string &options,
                                           string &outfile)
 {
+    return RunClocl(source, options, "", ".out", outfile);
+}
 
-#define STRINGIZE(x) #x
-#define STRINGIZE2(x) STRINGIZE(x)
-    const string product_version(STRINGIZE2(_PRODUCT_VERSION));
-    string options_with_version(options);
-    options_with_version += product_version;
+// Run clocl on source. target_flags select the device clocl builds for, the
+// generated binary is named after the temporary source with out_ext.
+bool Compiler::RunClocl(const string &source,
+                        const string &options,
+                        const string &target_flags,
+                        const char   *out_ext,
+                              string &outfile)
+{
+
+    // Flags that change the generated binary are part of the cache key
+    string clocl_flags(target_flags);
+    if (do_debug)      clocl_flags += "-g ";
+    if (do_symbols)    clocl_flags += "-s ";
+
+    string cache_options(options);
+    cache_options += " ";
+    cache_options += clocl_flags;
+
+    char device_name[256] = "";
+    p_device->info(CL_DEVICE_NAME, sizeof(device_name), device_name, 0);
 
     // Check if the kernel has already been compiled and cached with the same
-    // options and compiler version
+    // options, for the same device and with the same compiler version
     if (do_cache_kernels)
     {
         string cached_file = genfile_cache::instance()->lookup(
-            source, options_with_version);
+            source, cache_options, device_name);
         if (! cached_file.empty())
         {
             outfile = cached_file;
@@ -511,7 +504,7 @@ bool Compiler::CompileAndLinkForDSP(const string &source,
     }
 
     // Begin clocl compilation
-    string clocl_command("clocl -d -I. ");
+    string clocl_command("-d -I. ");
     clocl_command.reserve(options.size() + 64);
 
     // Add in options
@@ -519,8 +512,7 @@ bool Compiler::CompileAndLinkForDSP(const string &source,
     clocl_command += " ";
 
     if (do_keep_files) clocl_command += "-k ";
-    if (do_debug)      clocl_command += "-g ";
-    if (do_symbols)    clocl_command += "-s ";
+    clocl_command += clocl_flags;
 
     char  name_out[] = "/tmp/openclXXXXXX";
     int  fOutfile = mkstemp(name_out);
@@ -528,49 +520,103 @@ bool Compiler::CompileAndLinkForDSP(const string &source,
     string srcfile(name_out);
     srcfile += ".cl";
     outfile = name_out;
-    outfile += ".out";
-    string logfile(name_out);
-    logfile += ".log";
+    outfile += out_ext;
 
     clocl_command +=  srcfile;
-    clocl_command +=  " > ";
-    clocl_command += logfile;
-
-    // put source in a tmp file, run clocl, read tmp output in
-    ofstream src_out(srcfile.c_str());
-    src_out << source;
-    src_out.close();
-
-    int ret_code = system(clocl_command.c_str());
 
-    ifstream log_in(logfile.c_str());
-    string log_line;
-    if (log_in.is_open())
-    {
-        while (getline(log_in, log_line))
-        {
-            appendLog(log_line);
-            appendLog("\n");
-            cout << log_line << endl;
-        }
-        log_in.close();
-    }
+    bool success = InvokeClocl(clocl_command, srcfile, source, name_out);
     close(fOutfile);
     if (! do_keep_files && !do_debug) unlink(srcfile.c_str());
-    unlink(logfile.c_str());
     unlink(name_out);
 
-    // Check for system() call failure or clocl compile failure
-    if (ret_code != 0)
+    if (!success)
         return false;
 
+    // The program loads the cached copy, the compiler output is removed
     if (do_cache_kernels)
-        genfile_cache::instance()->remember(outfile.c_str(), source,
-                                            options_with_version);
+    {
+        string cached_file = genfile_cache::instance()->remember(
+            outfile.c_str(), source, cache_options, device_name);
+        if (cached_file != outfile && ! do_keep_files)
+            unlink(outfile.c_str());
+        outfile = cached_file;
+    }
 
     return true;
 }
 
+// Run clocl with args, in-process through the clocl library if available.
+// srcfile, when not empty, is the OpenCL C file named in args and source its
+// content: the library compiles source from memory, the file is only written
+// when clocl runs as a process or is asked to keep it. Output of clocl is
+// appended to the log. args are split like the shell of the process path
+// does; args that need a shell to run take the process path.
+bool Compiler::InvokeClocl(const string &args,
+                           const string &srcfile,
+                           const string &source,
+                           const string &tmp_name)
+{
+    vector<string> tokens(1, "clocl");
+    bool in_process = clocl_library && split_shell_words(args, tokens);
+
+    if (!srcfile.empty() && (!in_process || do_keep_files || do_debug))
+    {
+        ofstream src_out(srcfile.c_str());
+        src_out << source;
+        src_out.close();
+    }
+
+    string output;
+    int    ret_code;
+
+    if (in_process)
+    {
+        vector<char *> argv;
+        for (string &t : tokens) argv.push_back(&t[0]);
+        argv.push_back(NULL);
+
+        char *log = NULL;
+        ret_code = clocl_library(tokens.size(), argv.data(),
+                                 srcfile.empty() ? NULL : source.c_str(),
+                                 &log);
+        if (log)
+        {
+            output = log;
+            free(log);
+        }
+    }
+    else
+    {
+        string logfile(tmp_name);
+        logfile += ".log";
+
+        string clocl_command("clocl ");
+        clocl_command += args;
+        clocl_command += " > ";
+        clocl_command += logfile;
+
+        ret_code = system(clocl_command.c_str());
+
+        ifstream log_in(logfile.c_str());
+        output.assign(istreambuf_iterator<char>(log_in),
+                      istreambuf_iterator<char>());
+        log_in.close();
+        unlink(logfile.c_str());
+    }
+
+    istringstream log_in(output);
+    string log_line;
+    while (getline(log_in, log_line))
+    {
+        appendLog(log_line);
+        appendLog("\n");
+        cout << log_line << endl;
+    }
+
+    // Check for system() call failure or clocl compile failure
+    return ret_code == 0;
+}
+
 const string &Compiler::log() const
 {
     return p_log;
@@ -118,6 +118,17 @@ class Compiler
                                   const std::string &options,
                                         std::string &outfile);
 
+        bool RunClocl(const std::string &source,
+                      const std::string &options,
+                      const std::string &target_flags,
+                      const char        *out_ext,
+                            std::string &outfile);
+
+        bool InvokeClocl(const std::string &args,
+                         const std::string &srcfile,
+                         const std::string &source,
+                         const std::string &tmp_name);
+
 #ifndef _SYS_BIOS
         bool CompileForDSP(const std::string &source,
                            const std::map<std::string,
@@ -35,6 +35,8 @@
 #include "deviceinterface.h"
 #include "propertylist.h"
 #include "platform.h"
+#include "oclenv.h"
+#include "dsp/buffer_pool.h"
 
 #include <cstring>
 #include <cstdlib>
@@ -159,6 +161,25 @@ Context::Context(const cl_context_properties *properties,
         // Add the device to the list
         p_devices[i] = device;
     }
+
+    // Small buffers on DSP devices are suballocated from per-context pools,
+    // one for each shared memory in use by the devices of this context
+    tiocl::EnvVar& env = tiocl::EnvVar::Instance();
+    cl_int pool_size = env.GetEnv<
+                         tiocl::EnvVar::Var::TI_OCL_BUFFER_POOL_SIZE>(
+                         BUFFER_POOL_DEFAULT_MAX_SIZE);
+    if (pool_size <= 0) return;
+
+    for (cl_uint i=0; i<num_devices; ++i)
+    {
+        if (!p_devices[i]->IsDeviceType(DeviceInterface::T_C66x) &&
+            !p_devices[i]->IsDeviceType(DeviceInterface::T_SubDevice))
+            continue;
+
+        tiocl::SharedMemory *shm = p_devices[i]->GetSHMHandler();
+        if (shm != 0 && p_buffer_pools.count(shm) == 0)
+            p_buffer_pools[shm] = new tiocl::BufferPool(shm, pool_size);
+    }
 }
 
 Context::~Context()
@@ -168,6 +189,15 @@ Context::~Context()
 
     if (p_devices)
         std::free((void *)p_devices);
+
+    for (auto &pool : p_buffer_pools)
+        delete pool.second;
+}
+
+tiocl::BufferPool *Context::bufferPool(tiocl::SharedMemory *shm) const
+{
+    auto it = p_buffer_pools.find(shm);
+    return (it != p_buffer_pools.end()) ? it->second : 0;
 }
 
 cl_int Context::info(cl_context_info param_name,
@@ -37,6 +37,13 @@
 #include "icd.h"
 
 #include <CL/cl.h>
+#include <map>
+
+namespace tiocl
+{
+  class SharedMemory;
+  class BufferPool;
+}
 
 namespace Coal
 {
@@ -94,6 +101,13 @@ class Context : public _cl_context, public Object
          */
         bool hasDevice(DeviceInterface *device) const;
 
+        /**
+         * \brief Pool for small buffers allocated from \p shm
+         * \param shm shared memory of a DSP device in this context
+         * \return the pool, or 0 if buffers from \p shm are not pooled
+         */
+        tiocl::BufferPool *bufferPool(tiocl::SharedMemory *shm) const;
+
     private:
         cl_context_properties *p_properties;
         void (CL_CALLBACK *p_pfn_notify)(const char *, const void *,
@@ -103,6 +117,8 @@ class Context : public _cl_context, public Object
         DeviceInterface **p_devices;
         unsigned int p_num_devices, p_props_len;
         cl_platform_id p_platform;
+
+        std::map<tiocl::SharedMemory *, tiocl::BufferPool *> p_buffer_pools;
 };
 
 }
@@ -0,0 +1,239 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file copy_engine.cpp
+ * \brief Threads running the host copies of buffer commands
+ */
+
+#include "copy_engine.h"
+#include "oclenv.h"
+#include "trace.h"
+
+#include <cstring>
+#include <stdint.h>
+#include <unistd.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace Coal;
+
+#define COPY_ENGINE_DEFAULT_THREADS    4
+#define COPY_ENGINE_DEFAULT_THRESHOLD  (256 * 1024)
+#define COPY_ENGINE_MIN_CHUNK_SIZE     (64 * 1024)
+
+CopyEngine &CopyEngine::instance()
+{
+    // Copy threads may still run at exit, the engine is never destroyed
+    static CopyEngine *engine = new CopyEngine();
+    return *engine;
+}
+
+CopyEngine::CopyEngine()
+: p_num_threads(0), p_max_threads(0), p_num_idle(0), p_threshold(0)
+{
+    pthread_mutex_init(&p_mutex, 0);
+    pthread_cond_init(&p_chunk_cond, 0);
+    pthread_cond_init(&p_done_cond, 0);
+
+#if !defined(_SYS_BIOS)
+    tiocl::EnvVar& env = tiocl::EnvVar::Instance();
+
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cl_int threads = num_cpus < COPY_ENGINE_DEFAULT_THREADS ? num_cpus
+                                              : COPY_ENGINE_DEFAULT_THREADS;
+    threads = env.GetEnv<tiocl::EnvVar::Var::TI_OCL_COPY_ENGINE_THREADS>(
+                                                                 threads);
+    cl_int threshold = env.GetEnv<
+                         tiocl::EnvVar::Var::TI_OCL_COPY_ENGINE_THRESHOLD>(
+                                              COPY_ENGINE_DEFAULT_THRESHOLD);
+
+    p_max_threads = threads > 0 ? threads : 0;
+    p_threshold   = threshold > 0 ? threshold : 0;
+#endif
+}
+
+void CopyEngine::submit(void *dst, const void *src, size_t size,
+                        const std::function<void()> &done, CopyGroup *group)
+{
+    /*-------------------------------------------------------------------------
+    * One chunk per thread, rounded up to whole pages, unless that makes the
+    * chunks too small to be worth a thread switch
+    *------------------------------------------------------------------------*/
+    size_t chunk_size = (size + p_max_threads - 1) / p_max_threads;
+    chunk_size = (chunk_size + 4095) & ~(size_t)4095;
+    if (chunk_size < COPY_ENGINE_MIN_CHUNK_SIZE)
+        chunk_size = COPY_ENGINE_MIN_CHUNK_SIZE;
+    unsigned int num_chunks = (size + chunk_size - 1) / chunk_size;
+    if (num_chunks == 0) num_chunks = 1;
+
+    Copy *copy = new Copy;
+    copy->dst        = (char *)dst;
+    copy->src        = (const char *)src;
+    copy->done       = done;
+    copy->group      = group;
+    copy->num_chunks = num_chunks;
+
+    pthread_mutex_lock(&p_mutex);
+
+    if (group) group->p_num_copies++;
+
+    for (unsigned int i = 0; i < num_chunks; i++)
+    {
+        size_t offset = i * chunk_size;
+        Chunk chunk = { copy, offset,
+                        size - offset < chunk_size ? size - offset
+                                                   : chunk_size };
+        p_chunks.push_back(chunk);
+    }
+
+    unsigned int num_wakeups = num_chunks;
+    while (num_wakeups > p_num_idle && p_num_threads < p_max_threads)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, 0, &worker, this) != 0) break;
+        pthread_detach(thread);
+        p_num_threads++;
+        num_wakeups--;
+    }
+
+    if (num_wakeups > 1) pthread_cond_broadcast(&p_chunk_cond);
+    else                 pthread_cond_signal(&p_chunk_cond);
+
+    pthread_mutex_unlock(&p_mutex);
+}
+
+void CopyEngine::wait(CopyGroup *group)
+{
+    pthread_mutex_lock(&p_mutex);
+
+    while (group->p_num_copies > 0)
+        pthread_cond_wait(&p_done_cond, &p_mutex);
+
+    pthread_mutex_unlock(&p_mutex);
+}
+
+void *CopyEngine::worker(void *data)
+{
+    CopyEngine *engine = (CopyEngine *)data;
+    Trace::nameThread("copy engine");
+
+    pthread_mutex_lock(&engine->p_mutex);
+
+    while (true)
+    {
+        while (engine->p_chunks.empty())
+        {
+            engine->p_num_idle++;
+            pthread_cond_wait(&engine->p_chunk_cond, &engine->p_mutex);
+            engine->p_num_idle--;
+        }
+
+        Chunk chunk = engine->p_chunks.front();
+        engine->p_chunks.pop_front();
+        pthread_mutex_unlock(&engine->p_mutex);
+
+        Copy *copy = chunk.copy;
+        uint64_t start = Trace::enabled() ? Trace::now() : 0;
+        CopyEngine::copy(copy->dst + chunk.offset, copy->src + chunk.offset,
+                         chunk.size);
+        if (start != 0) Trace::span("copy chunk", start);
+
+        pthread_mutex_lock(&engine->p_mutex);
+        if (--copy->num_chunks > 0) continue;
+        pthread_mutex_unlock(&engine->p_mutex);
+
+        // Last chunk: complete the copy outside of the lock
+        copy->done();
+
+        pthread_mutex_lock(&engine->p_mutex);
+        if (copy->group)
+        {
+            copy->group->p_num_copies--;
+            pthread_cond_broadcast(&engine->p_done_cond);
+        }
+        delete copy;
+    }
+
+    return 0;
+}
+
+void CopyEngine::copy(void *dst, const void *src, size_t size)
+{
+    uint8_t *       d = (uint8_t *)dst;
+    const uint8_t * s = (const uint8_t *)src;
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    /*-------------------------------------------------------------------------
+    * 64 bytes per iteration through the NEON registers, prefetching the
+    * source a few cache lines ahead
+    *------------------------------------------------------------------------*/
+    for (; size >= 64; size -= 64, s += 64, d += 64)
+    {
+        __builtin_prefetch(s + 256);
+        uint8x16_t a = vld1q_u8(s);
+        uint8x16_t b = vld1q_u8(s + 16);
+        uint8x16_t c = vld1q_u8(s + 32);
+        uint8x16_t e = vld1q_u8(s + 48);
+        vst1q_u8(d,      a);
+        vst1q_u8(d + 16, b);
+        vst1q_u8(d + 32, c);
+        vst1q_u8(d + 48, e);
+    }
+#elif defined(__SSE2__)
+    /*-------------------------------------------------------------------------
+    * Align the destination, then stream 64 bytes per iteration around the
+    * caches
+    *------------------------------------------------------------------------*/
+    size_t head = (16 - ((uintptr_t)d & 15)) & 15;
+    if (size >= head + 64)
+    {
+        memcpy(d, s, head);
+        d += head; s += head; size -= head;
+
+        for (; size >= 64; size -= 64, s += 64, d += 64)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)s);
+            __m128i b = _mm_loadu_si128((const __m128i *)(s + 16));
+            __m128i c = _mm_loadu_si128((const __m128i *)(s + 32));
+            __m128i e = _mm_loadu_si128((const __m128i *)(s + 48));
+            _mm_stream_si128((__m128i *)d,        a);
+            _mm_stream_si128((__m128i *)(d + 16), b);
+            _mm_stream_si128((__m128i *)(d + 32), c);
+            _mm_stream_si128((__m128i *)(d + 48), e);
+        }
+        _mm_sfence();
+    }
+#endif
+
+    memcpy(d, s, size);
+}
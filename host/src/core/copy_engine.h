@@ -0,0 +1,152 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file copy_engine.h
+ * \brief Threads running the host copies of buffer commands
+ */
+
+#ifndef __COPY_ENGINE_H__
+#define __COPY_ENGINE_H__
+
+#include "tiocl_thread.h"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+
+namespace Coal
+{
+
+class CopyGroup;
+
+/**
+ * \brief Threads copying buffer contents for the device workers
+ *
+ * Read, write and copy buffer commands are executed on the host by a memcpy
+ * between the application memory and the shared memory of the device. When
+ * the device dispatch thread does it, kernels queued behind a large
+ * transfer are not dispatched until the copy is done. Transfers of at least
+ * \c TI_OCL_COPY_ENGINE_THRESHOLD bytes are instead split in chunks, copied
+ * in parallel by the threads of this pool, while the dispatch thread moves
+ * on. The command completes once its last chunk is copied.
+ *
+ * Threads are created on demand, up to \c TI_OCL_COPY_ENGINE_THREADS, and
+ * stay until the process exits. The pool is never deleted.
+ */
+class CopyEngine
+{
+    public:
+        static CopyEngine &instance();
+
+        /**
+         * \brief Whether a transfer of \p size bytes should be submitted
+         *
+         * Smaller transfers cost less to copy on the calling thread than to
+         * hand over.
+         */
+        bool offload(size_t size) const
+        {
+            return p_max_threads > 0 && size >= p_threshold;
+        }
+
+        /**
+         * \brief Copy \p size bytes from \p src to \p dst on the copy threads
+         * \param done run once the copy is complete, on the copy thread that
+         *        copied the last chunk
+         * \param group group the copy belongs to, or NULL
+         */
+        void submit(void *dst, const void *src, size_t size,
+                    const std::function<void()> &done, CopyGroup *group);
+
+        /**
+         * \brief Wait for the copies of \p group, and their \c done, to
+         *        complete
+         */
+        void wait(CopyGroup *group);
+
+        /**
+         * \brief memcpy for large transfers
+         *
+         * Uses NEON loads and stores on ARM, and non-temporal stores on x86,
+         * so that a transfer does not evict the working set of the host from
+         * its caches.
+         */
+        static void copy(void *dst, const void *src, size_t size);
+
+    private:
+        CopyEngine();
+
+        struct Copy
+        {
+            char *                 dst;
+            const char *           src;
+            std::function<void()>  done;
+            CopyGroup *            group;
+            unsigned int           num_chunks;   // Not yet copied
+        };
+
+        struct Chunk
+        {
+            Copy * copy;
+            size_t offset;
+            size_t size;
+        };
+
+        static void *worker(void *data);
+
+        pthread_mutex_t    p_mutex;
+        pthread_cond_t     p_chunk_cond;  // A chunk was submitted
+        pthread_cond_t     p_done_cond;   // A copy of a group completed
+        std::deque<Chunk>  p_chunks;
+        unsigned int       p_num_threads;
+        unsigned int       p_max_threads;
+        unsigned int       p_num_idle;
+        size_t             p_threshold;
+};
+
+/**
+ * \brief Copies submitted by one thread, waited for before it exits
+ */
+class CopyGroup
+{
+    public:
+        CopyGroup() : p_num_copies(0) {}
+        ~CopyGroup() { wait(); }
+
+        void wait() { CopyEngine::instance().wait(this); }
+
+    private:
+        friend class CopyEngine;
+
+        unsigned int p_num_copies;  // Protected by the engine mutex
+};
+
+}
+
+#endif
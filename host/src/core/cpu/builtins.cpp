@@ -29,9 +29,9 @@
  * \file cpu/builtins.cpp
  * \brief Native OpenCL C built-in functions
  *
- * All these built-ins are directly called by kernels. When the LLVM JIT
- * sees a function name it doesn't know, it calls \c getBuiltin() with this
- * name as parameter. This function then returns the address of an actual
+ * All these built-ins are directly called by kernels. When a program is
+ * loaded, \c getBuiltin() is called with the name of each function its
+ * kernels call. This function then returns the address of an actual
  * function implementation, that finally gets called by the kernel when
  * it is run.
  */
@@ -104,7 +104,7 @@ cl_uint CPUKernelWorkGroup::getWorkDim() const
 
 size_t CPUKernelWorkGroup::getGlobalId(cl_uint dimindx) const
 {
-    if (dimindx > p_work_dim)
+    if (dimindx >= p_work_dim)
         return 0;
 
     return p_global_id_start_offset[dimindx] + p_current_context->local_id[dimindx];
@@ -112,7 +112,7 @@ size_t CPUKernelWorkGroup::getGlobalId(cl_uint dimindx) const
 
 size_t CPUKernelWorkGroup::getGlobalSize(cl_uint dimindx) const
 {
-    if (dimindx >p_work_dim)
+    if (dimindx >= p_work_dim)
         return 1;
 
     return p_event->global_work_size(dimindx);
@@ -120,7 +120,7 @@ size_t CPUKernelWorkGroup::getGlobalSize(cl_uint dimindx) const
 
 size_t CPUKernelWorkGroup::getLocalSize(cl_uint dimindx) const
 {
-    if (dimindx > p_work_dim)
+    if (dimindx >= p_work_dim)
         return 1;
 
     return p_event->local_work_size(dimindx);
@@ -128,7 +128,7 @@ size_t CPUKernelWorkGroup::getLocalSize(cl_uint dimindx) const
 
 size_t CPUKernelWorkGroup::getLocalID(cl_uint dimindx) const
 {
-    if (dimindx > p_work_dim)
+    if (dimindx >= p_work_dim)
         return 0;
 
     return p_current_context->local_id[dimindx];
@@ -136,7 +136,7 @@ size_t CPUKernelWorkGroup::getLocalID(cl_uint dimindx) const
 
 size_t CPUKernelWorkGroup::getNumGroups(cl_uint dimindx) const
 {
-    if (dimindx > p_work_dim)
+    if (dimindx >= p_work_dim)
         return 1;
 
     return (p_event->global_work_size(dimindx) /
@@ -145,7 +145,7 @@ size_t CPUKernelWorkGroup::getNumGroups(cl_uint dimindx) const
 
 size_t CPUKernelWorkGroup::getGroupID(cl_uint dimindx) const
 {
-    if (dimindx > p_work_dim)
+    if (dimindx >= p_work_dim)
         return 0;
 
     return p_index[dimindx];
@@ -153,7 +153,7 @@ size_t CPUKernelWorkGroup::getGroupID(cl_uint dimindx) const
 
 size_t CPUKernelWorkGroup::getGlobalOffset(cl_uint dimindx) const
 {
-    if (dimindx > p_work_dim)
+    if (dimindx >= p_work_dim)
         return 0;
 
     return p_event->global_work_offset(dimindx);
@@ -192,7 +192,23 @@ void CPUKernelWorkGroup::barrier(unsigned int flags)
             p_contexts = mmap(0, needed_size, PROT_EXEC | PROT_READ | PROT_WRITE, /* People say a stack must be executable */
                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 
-            setWorkItemsData(p_contexts, contexts_size);
+            if (p_contexts == MAP_FAILED)
+            {
+                p_contexts = 0;
+                setWorkItemsData(0, 0);
+                std::cerr << "*** Cannot allocate the work-item stacks of "
+                          << p_kernel->function()->getName().str()
+                          << std::endl;
+                return;
+            }
+
+            setWorkItemsData(p_contexts, needed_size);
+        }
+        else
+        {
+            // Reused from a previous work-group
+            for (unsigned int i=0; i<p_num_work_items; ++i)
+                getContextAddr(i)->initialized = 0;
         }
 
         // Now that we have a real main context, initialize it
@@ -248,13 +264,6 @@ void CPUKernelWorkGroup::barrier(unsigned int flags)
     // a barrier and that we returned to this one. We can continue.
 }
 
-void CPUKernelWorkGroup::builtinNotFound(const std::string &name) const
-{
-    std::cout << "OpenCL: Non-existant builtin function " << name
-              << " found in kernel " << p_kernel->function()->getName().str()
-              << '.' << std::endl;
-}
-
 /*
  * Built-in functions
  */
@@ -407,12 +416,8 @@ static void read_imageuif(uint32_t *result, Image2D *image, float x, float y,
 #include <runtime/builtins_impl.h>
 
 /*
- * Bridge between LLVM and us
+ * Bridge between the kernels and us
  */
-static void unimplemented_stub()
-{
-}
-
 void *getBuiltin(const std::string &name)
 {
     if (name == "get_global_id")
@@ -474,7 +479,5 @@ void *getBuiltin(const std::string &name)
         return (void *)&printf;
 
     // Function not found
-    g_work_group->builtinNotFound(name);
-
-    return (void *)&unimplemented_stub;
+    return 0;
 }
@@ -47,6 +47,7 @@ void setThreadLocalWorkGroup(Coal::CPUKernelWorkGroup *current);
 /**
  * \brief Return the address of a built-in function given its name
  * \param name name of the built-in whose address is requested
+ * \return the address, or NULL if \p name is not a built-in
  */
 void *getBuiltin(const std::string &name);
 
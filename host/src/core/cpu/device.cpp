@@ -49,6 +49,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <unistd.h>
+#include <algorithm>
 
 #include <iostream>
 #include <fstream>
@@ -58,8 +59,8 @@ using namespace Coal;
 
 
 CPUDevice::CPUDevice()
-: DeviceInterface(DeviceInterface::T_CPU), p_cores(0), p_num_events(0),
-p_workers(0), p_stop(false),
+: DeviceInterface(DeviceInterface::T_CPU), p_cores(0), p_num_tasks(0),
+  p_next_queue(0), p_num_workers(0), p_workers(0), p_stop(false),
   p_initialized(false)
 {
     // Get info about the system
@@ -114,6 +115,14 @@ void CPUDevice::init()
     pthread_cond_init(&p_events_cond, 0);
     pthread_mutex_init(&p_events_mutex, 0);
 
+    // One task queue per worker thread
+    for (unsigned int i=0; i<numCPUs(); ++i)
+    {
+        WorkerQueue *queue = new WorkerQueue;
+        pthread_mutex_init(&queue->mutex, 0);
+        p_queues.push_back(queue);
+    }
+
     // Create worker threads
     p_workers = (pthread_t *)std::malloc(numCPUs() * sizeof(pthread_t));
 
@@ -145,6 +154,13 @@ CPUDevice::~CPUDevice()
 
     // Free allocated memory
     std::free((void *)p_workers);
+
+    for (size_t i=0; i<p_queues.size(); ++i)
+    {
+        pthread_mutex_destroy(&p_queues[i]->mutex);
+        delete p_queues[i];
+    }
+
     pthread_mutex_destroy(&p_events_mutex);
     pthread_cond_destroy(&p_events_cond);
 }
@@ -207,16 +223,24 @@ cl_int CPUDevice::initEventDeviceData(Event *event)
         case Event::NDRangeKernel:
         case Event::TaskKernel:
         {
-            // Instantiate the JIT for the CPU program
+            // Load the shared object of the CPU program
             KernelEvent *e = (KernelEvent *)event;
             Program *p = (Program *)e->kernel()->parent();
             CPUProgram *prog = (CPUProgram *)p->deviceDependentProgram(this);
 
-            if (!prog->initJIT())
+            if (!prog->load())
                 return CL_INVALID_PROGRAM_EXECUTABLE;
 
             // Set device-specific data
-            CPUKernelEvent *cpu_e = new CPUKernelEvent(this, e);
+            cl_int errcode;
+            CPUKernelEvent *cpu_e = new CPUKernelEvent(this, e, &errcode);
+
+            if (errcode != CL_SUCCESS)
+            {
+                delete cpu_e;
+                return errcode;
+            }
+
             e->setDeviceData((void *)cpu_e);
 
             break;
@@ -247,63 +271,136 @@ void CPUDevice::freeEventDeviceData(Event *event)
 
 void CPUDevice::pushEvent(Event *event)
 {
-    // Add an event in the list
-    pthread_mutex_lock(&p_events_mutex);
+    // Kernels are split in ranges of work-groups, at most a few per worker
+    // thread: they start on every worker and the ranges are split further
+    // when the workers run out of work and steal
+    size_t num_work_groups = 1, num_tasks = 1;
 
-    p_events.push_back(event);
-    p_num_events++;                 // Way faster than STL list::size() !
+    if (event->type() == Event::NDRangeKernel ||
+        event->type() == Event::TaskKernel)
+    {
+        CPUKernelEvent *ke = (CPUKernelEvent *)event->deviceData();
+
+        num_work_groups = ke->numWorkGroups();
+        num_tasks = std::min(num_work_groups, (size_t)numCPUs() * 4);
+    }
+
+    __sync_add_and_fetch(&p_num_tasks, num_tasks);
+
+    unsigned int queue = __sync_fetch_and_add(&p_next_queue, num_tasks);
 
+    for (size_t i=0; i<num_tasks; ++i)
+    {
+        CPUTask task;
+        task.event            = event;
+        task.first_work_group = num_work_groups * i / num_tasks;
+        task.num_work_groups  = num_work_groups * (i + 1) / num_tasks
+                                - task.first_work_group;
+
+        WorkerQueue *q = p_queues[(queue + i) % p_queues.size()];
+
+        pthread_mutex_lock(&q->mutex);
+        q->tasks.push_back(task);
+        pthread_mutex_unlock(&q->mutex);
+    }
+
+    // Wake up the workers
+    pthread_mutex_lock(&p_events_mutex);
     pthread_cond_broadcast(&p_events_cond);
     pthread_mutex_unlock(&p_events_mutex);
 }
 
-Event *CPUDevice::getEvent(bool &stop)
+unsigned int CPUDevice::registerWorker()
 {
-    // Return the first event in the list, if any. Remove it if it is a
-    // single-shot event.
-    pthread_mutex_lock(&p_events_mutex);
+    return __sync_fetch_and_add(&p_num_workers, 1) % p_queues.size();
+}
+
+bool CPUDevice::popTask(unsigned int worker, CPUTask &task)
+{
+    WorkerQueue *q = p_queues[worker];
+    bool found = false;
 
-    while (p_num_events == 0 && !p_stop)
-        pthread_cond_wait(&p_events_cond, &p_events_mutex);
+    pthread_mutex_lock(&q->mutex);
 
-    if (p_stop)
+    if (!q->tasks.empty())
     {
-        pthread_mutex_unlock(&p_events_mutex);
-        stop = true;
-        return 0;
+        task = q->tasks.back();
+        q->tasks.pop_back();
+        found = true;
     }
 
-    Event *event = p_events.front();
+    pthread_mutex_unlock(&q->mutex);
 
-    // If the run of this event will finish it, remove it from the list
-    bool last_slot = true;
+    return found;
+}
 
-    if (event->type() == Event::NDRangeKernel ||
-        event->type() == Event::TaskKernel)
+bool CPUDevice::stealTask(unsigned int worker, CPUTask &task)
+{
+    for (size_t i=1; i<p_queues.size(); ++i)
     {
-        CPUKernelEvent *ke = (CPUKernelEvent *)event->deviceData();
-        last_slot = ke->reserve();
+        WorkerQueue *q = p_queues[(worker + i) % p_queues.size()];
+        bool found = false;
+
+        pthread_mutex_lock(&q->mutex);
+
+        if (!q->tasks.empty())
+        {
+            CPUTask &victim = q->tasks.front();
+            task = victim;
+            found = true;
+
+            if (victim.num_work_groups > 1)
+            {
+                // Take the first half of the range, one more task exists
+                task.num_work_groups = victim.num_work_groups / 2;
+                victim.first_work_group += task.num_work_groups;
+                victim.num_work_groups  -= task.num_work_groups;
+                __sync_add_and_fetch(&p_num_tasks, 1);
+            }
+            else
+                q->tasks.pop_front();
+        }
+
+        pthread_mutex_unlock(&q->mutex);
+
+        if (found) return true;
     }
 
-    if (last_slot)
+    return false;
+}
+
+bool CPUDevice::getTask(unsigned int worker, CPUTask &task)
+{
+    while (true)
     {
-        p_num_events--;
-        p_events.pop_front();
-    }
+        if (popTask(worker, task) || stealTask(worker, task))
+        {
+            __sync_sub_and_fetch(&p_num_tasks, 1);
+            return true;
+        }
 
-    pthread_mutex_unlock(&p_events_mutex);
+        // Wait for more tasks. p_num_tasks may be non-zero while the tasks
+        // are being queued, look again then.
+        pthread_mutex_lock(&p_events_mutex);
+
+        while (p_num_tasks == 0 && !p_stop)
+            pthread_cond_wait(&p_events_cond, &p_events_mutex);
 
-    return event;
+        bool stop = p_stop;
+        pthread_mutex_unlock(&p_events_mutex);
+
+        if (stop) return false;
+    }
 }
 
 /******************************************************************************
 * Device's decision about whether CommandQueue should push more events over
-* This number could be tuned (e.g. using ooo example).  Note that p_num_events
-* are in device's queue, but not yet executed.
+* This number could be tuned (e.g. using ooo example).  Note that p_num_tasks
+* are in the worker queues, but not yet executed.
 ******************************************************************************/
 bool CPUDevice::gotEnoughToWorkOn()
 {
-    return p_num_events > 0;
+    return p_num_tasks > 0;
 }
 
 unsigned int CPUDevice::numCPUs() const
@@ -36,7 +36,8 @@
 #include "../deviceinterface.h"
 
 #include "../tiocl_thread.h"
-#include <list>
+#include <deque>
+#include <vector>
 #include <string>
 
 namespace Coal
@@ -47,6 +48,19 @@ class Event;
 class Program;
 class Kernel;
 
+/**
+ * \brief Work for a worker thread
+ *
+ * The \p event to run or, for kernel events, \p num_work_groups of its
+ * work-groups starting at \p first_work_group.
+ */
+struct CPUTask
+{
+    Event *event;
+    size_t first_work_group;
+    size_t num_work_groups;
+};
+
 /**
  * \brief CPU device
  *
@@ -54,9 +68,15 @@ class Kernel;
  * creates and manages subclasses such as \c Coal::DeviceBuffer,
  * \c Coal::DeviceProgram and \c Coal::DeviceKernel.
  *
- * This class and the aforementioned ones work together to compile and run
- * kernels using the LLVM JIT, manage buffers, provide built-in functions
- * and do all of this in a multithreaded fashion using worker threads.
+ * This class and the aforementioned ones work together to run kernels
+ * compiled for the host by \c clocl, manage buffers, provide built-in
+ * functions and do all of this in a multithreaded fashion using worker
+ * threads.
+ *
+ * Each worker thread has its own queue of \c Coal::CPUTask. Kernel events are
+ * split into ranges of work-groups spread over the queues. A worker takes its
+ * tasks from the back of its queue, and when it is empty, steals from the
+ * front of the others, taking half of the work-groups of a range.
  *
  * \see \ref events
  */
@@ -92,9 +112,19 @@ class CPUDevice : public DeviceInterface
         void freeEventDeviceData(Event *event);
 
         void pushEvent(Event *event);
-        Event *getEvent(bool &stop);
         bool gotEnoughToWorkOn();
 
+        /**
+         * \brief Index of the calling worker thread, called once by each
+         */
+        unsigned int registerWorker();
+
+        /**
+         * \brief Get the next task of \p worker, blocking until there is one
+         * \return false if the worker has to stop
+         */
+        bool getTask(unsigned int worker, CPUTask &task);
+
         unsigned int numCPUs() const;   /*!< \brief Number of logical CPU cores on the system */
         float cpuMhz() const;           /*!< \brief Speed of the CPU in Mhz */
 
@@ -107,12 +137,21 @@ class CPUDevice : public DeviceInterface
         const DeviceInterface* GetRootDevice() const override { return this; }
 
     private:
-        unsigned int p_cores, p_num_events;
+        struct WorkerQueue
+        {
+            pthread_mutex_t     mutex;
+            std::deque<CPUTask> tasks;
+        };
+
+        bool popTask(unsigned int worker, CPUTask &task);
+        bool stealTask(unsigned int worker, CPUTask &task);
+
+        unsigned int p_cores, p_num_tasks, p_next_queue, p_num_workers;
         float       p_cpu_mhz;
         std::string p_device_name;
         pthread_t *p_workers;
 
-        std::list<Event *> p_events;
+        std::vector<WorkerQueue *> p_queues;
         pthread_cond_t p_events_cond;
         pthread_mutex_t p_events_mutex;
         bool p_stop, p_initialized;
@@ -41,12 +41,8 @@
 #include "../events.h"
 #include "../program.h"
 
-//#include <llvm/IR/Function.h>
-//#include <llvm/IR/Constants.h>
-//#include <llvm/IR/Instructions.h>
-//#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Function.h>
 #include <llvm/IR/Module.h>
-//#include <llvm/ExecutionEngine/ExecutionEngine.h>
 
 #include <cstdlib>
 #include <cstring>
@@ -56,17 +52,14 @@ using namespace Coal;
 
 CPUKernel::CPUKernel(CPUDevice *device, Kernel *kernel, llvm::Function *function)
 : DeviceKernel(), p_device(device), p_kernel(kernel), p_function(function),
-  p_call_function(0)
+  p_launcher(0)
 {
-    pthread_mutex_init(&p_call_function_mutex, 0);
+    pthread_mutex_init(&p_launcher_mutex, 0);
 }
 
 CPUKernel::~CPUKernel()
 {
-    if (p_call_function)
-        p_call_function->eraseFromParent();
-
-    pthread_mutex_destroy(&p_call_function_mutex);
+    pthread_mutex_destroy(&p_launcher_mutex);
 }
 
 size_t CPUKernel::workGroupSize() const
@@ -108,11 +101,12 @@ size_t CPUKernel::guessWorkGroupSize(cl_uint num_dims, cl_uint dim,
     unsigned int cpus = p_device->numCPUs();
 
     // Don't break in too small parts
-    if (k_exp(global_work_size, num_dims) > 64)
+    if (k_exp(global_work_size, num_dims) <= 64)
         return global_work_size;
 
-    // Find the divisor of global_work_size the closest to cpus but >= than it
-    unsigned int divisor = cpus;
+    // Find the divisor of global_work_size the closest to cpus * 4 but >= than
+    // it: the workers balance their load by stealing work-groups
+    unsigned int divisor = cpus * 4;
 
     while (true)
     {
@@ -123,9 +117,15 @@ size_t CPUKernel::guessWorkGroupSize(cl_uint num_dims, cl_uint dim,
         // too huge
         if (divisor > global_work_size || divisor > cpus * 32)
         {
-            divisor = 1;  // Not parallel but has no CommandQueue overhead
+            // Then the divisor the closest to cpus * 4 below it, or 1: not
+            // parallel but has no CommandQueue overhead
+            for (divisor = cpus * 4 - 1; divisor > 1; --divisor)
+                if ((global_work_size % divisor) == 0)
+                    break;
             break;
         }
+
+        divisor++;
     }
 
     // Return the size
@@ -166,7 +166,7 @@ size_t CPUKernel::typeOffset(size_t &offset, size_t type_len)
     type_len = next_power_of_two(type_len);
     size_t mask = ~(type_len - 1);
 
-    while (rs & mask != rs)
+    while ((rs & mask) != rs)
         rs++;
 
     // Where to try to place the next value
@@ -175,213 +175,183 @@ size_t CPUKernel::typeOffset(size_t &offset, size_t type_len)
     return rs;
 }
 
-llvm::Function *CPUKernel::callFunction()
+CPUKernel::Launcher CPUKernel::launcher()
 {
-    return nullptr;
-#if 0
-    pthread_mutex_lock(&p_call_function_mutex);
+    pthread_mutex_lock(&p_launcher_mutex);
 
-    // If we can reuse the same function between work groups, do it
-    if (p_call_function)
+    if (!p_launcher)
     {
-        llvm::Function *rs = p_call_function;
-        pthread_mutex_unlock(&p_call_function_mutex);
+        Program *p = (Program *)p_kernel->parent();
+        CPUProgram *prog = (CPUProgram *)p->deviceDependentProgram(p_device);
 
-        return rs;
-    }
-
-    /* Create a stub function in the form of
-     *
-     * void stub(void *args) {
-     *     kernel(*(int *)((char *)args + 0),
-     *            *(float **)((char *)args + sizeof(int)),
-     *            *(sampler_t *)((char *)args + sizeof(int) + sizeof(float *)));
-     * }
-     *
-     * In LLVM, it is exprimed in the form of :
-     *
-     * @stub(i8* args) {
-     *     kernel(
-     *         load(i32* bitcast(i8* getelementptr(i8* args, i64 0), i32*)),
-     *         load(float** bitcast(i8* getelementptr(i8* args, i64 4), float**)),
-     *         ...
-     *     );
-     * }
-     */
-    llvm::FunctionType *kernel_function_type = p_function->getFunctionType();
-    llvm::FunctionType *stub_function_type = llvm::FunctionType::get(
-        p_function->getReturnType(),
-        llvm::Type::getInt8PtrTy(
-            p_function->getContext()),
-        false);
-    llvm::Function *stub_function = llvm::Function::Create(
-        stub_function_type,
-        llvm::Function::InternalLinkage,
-        "",
-        p_function->getParent());
-
-    // Insert a basic block
-    llvm::BasicBlock *basic_block = llvm::BasicBlock::Create(
-        p_function->getContext(),
-        "",
-        stub_function);
-
-    // Create the function arguments
-    llvm::Argument &stub_arg = stub_function->getArgumentList().front();
-    llvm::SmallVector<llvm::Value *, 8> args;
-    size_t args_offset = 0;
-
-    for (unsigned int i=0; i<kernel_function_type->getNumParams(); ++i)
-    {
-        llvm::Type *param_type = kernel_function_type->getParamType(i);
-        llvm::Type *param_type_ptr = param_type->getPointerTo(); // We'll use pointers to the value
-        const Kernel::Arg &arg = p_kernel->arg(i);
-
-        // Calculate the size of the arg
-        size_t arg_size = arg.valueSize() * arg.vecDim();
-
-        // Get where to place this argument
-        size_t arg_offset = typeOffset(args_offset, arg_size);
-
-        // %1 = getelementptr(args, $arg_offset);
-        llvm::Value *getelementptr = llvm::GetElementPtrInst::CreateInBounds(
-            &stub_arg,
-            llvm::ConstantInt::get(stub_function->getContext(),
-                                   llvm::APInt(64, arg_offset)),
-            "",
-            basic_block);
-
-        // %2 = bitcast(%1, $param_type_ptr)
-        llvm::Value *bitcast = new llvm::BitCastInst(
-            getelementptr,
-            param_type_ptr,
-            "",
-            basic_block);
-
-        // %3 = load(%2)
-        llvm::Value *load = new llvm::LoadInst(
-            bitcast,
-            "",
-            false,
-            arg_size,   // We ensure that an argument is always aligned on its size, it enables things like fast movaps
-            basic_block);
-
-        // We have the value, send it to the function
-        args.push_back(load);
+        p_launcher = (Launcher)prog->symbol("__ocl_launch_" +
+                                            p_function->getName().str());
     }
 
-    // Create the call instruction
-    llvm::CallInst *call_inst = llvm::CallInst::Create(
-        p_function,
-        args,
-        "",
-        basic_block);
-    call_inst->setCallingConv(p_function->getCallingConv());
-    call_inst->setTailCall();
+    pthread_mutex_unlock(&p_launcher_mutex);
 
-    // Create a return instruction to end the stub
-    llvm::ReturnInst::Create(
-        p_function->getContext(),
-        basic_block);
-
-    // Retain the function if it can be reused
-    p_call_function = stub_function;
-
-    pthread_mutex_unlock(&p_call_function_mutex);
-
-    return stub_function;
-#endif
+    return p_launcher;
 }
 
 /*
  * CPUKernelEvent
  */
-CPUKernelEvent::CPUKernelEvent(CPUDevice *device, KernelEvent *event)
-: p_device(device), p_event(event), p_current_wg(0), p_finished_wg(0),
-  p_kernel_args(0)
+CPUKernelEvent::CPUKernelEvent(CPUDevice *device, KernelEvent *event,
+                               cl_int *errcode_ret)
+: p_device(device), p_event(event), p_launcher(0), p_num_wg(1),
+  p_finished_wg(0), p_started(0), p_status(CL_SUCCESS), p_kernel_args(0),
+  p_kernel_args_size(0)
 {
-    // Mutex
-    pthread_mutex_init(&p_mutex, 0);
+    *errcode_ret = CL_SUCCESS;
+
+    // Populate p_num_work_groups
+    for (cl_uint i=0; i<event->work_dim(); ++i)
+    {
+        p_num_work_groups[i] =
+            event->global_work_size(i) / event->local_work_size(i);
 
-    // Set current work group to (0, 0, ..., 0)
-    std::memset(p_current_work_group, 0, event->work_dim() * sizeof(size_t));
+        p_num_wg *= p_num_work_groups[i];
+    }
 
-    // Populate p_max_work_groups
-    p_num_wg = 1;
+    CPUKernel *kernel = (CPUKernel *)event->deviceKernel();
+    Kernel *k = kernel->kernel();
 
-    for (cl_uint i=0; i<event->work_dim(); ++i)
+    p_launcher = kernel->launcher();
+
+    if (!p_launcher)
     {
-        p_max_work_groups[i] =
-            (event->global_work_size(i) / event->local_work_size(i)) - 1; // 0..n-1, not 1..n
+        *errcode_ret = CL_INVALID_PROGRAM_EXECUTABLE;
+        return;
+    }
 
-        p_num_wg *= p_max_work_groups[i] + 1;
+    // Build the arguments now, later clSetKernelArg() calls do not change
+    // this event
+    for (unsigned int i=0; i<k->numArgs(); ++i)
+    {
+        const Kernel::Arg &arg = k->arg(i);
+        CPUKernel::typeOffset(p_kernel_args_size, arg.valueSize() * arg.vecDim());
     }
-}
 
-CPUKernelEvent::~CPUKernelEvent()
-{
-    pthread_mutex_destroy(&p_mutex);
+    p_kernel_args = std::malloc(p_kernel_args_size ? p_kernel_args_size : 1);
 
-    if (p_kernel_args)
-        std::free(p_kernel_args);
-}
+    if (!p_kernel_args)
+    {
+        *errcode_ret = CL_OUT_OF_HOST_MEMORY;
+        return;
+    }
 
-bool CPUKernelEvent::reserve()
-{
-    // Lock, this will be unlocked in takeInstance()
-    pthread_mutex_lock(&p_mutex);
+    size_t arg_offset = 0;
 
-    // Last work group if current == max - 1
-    return (p_current_wg == p_num_wg - 1);
-}
+    for (unsigned int i=0; i<k->numArgs(); ++i)
+    {
+        const Kernel::Arg &arg = k->arg(i);
+        size_t size = arg.valueSize() * arg.vecDim();
+        size_t offset = CPUKernel::typeOffset(arg_offset, size);
 
-bool CPUKernelEvent::finished()
-{
-    bool rs;
+        // Where to place the argument
+        unsigned char *target = (unsigned char *)p_kernel_args;
+        target += offset;
+
+        // We may have to perform some changes in the values (buffers, etc)
+        switch (arg.kind())
+        {
+            case Kernel::Arg::Buffer:
+            {
+                MemObject *buffer = *(MemObject **)arg.data();
 
-    pthread_mutex_lock(&p_mutex);
+                if (arg.file() == Kernel::Arg::Local)
+                {
+                    // Allocated for each work-group, see callArgs()
+                    p_locals.push_back(std::make_pair(offset,
+                                                arg.allocAtKernelRuntime()));
+                    *(void **)target = NULL;
+                }
+                else if (!buffer)
+                {
+                    // We can do that, just send NULL
+                    *(void **)target = NULL;
+                }
+                else
+                {
+                    // Get the CPU buffer, allocate it and get its pointer
+                    CPUBuffer *cpubuf =
+                        (CPUBuffer *)buffer->deviceBuffer(device);
 
-    rs = (p_finished_wg == p_num_wg);
+                    buffer->allocate(device);
+                    *(void **)target = cpubuf->data();
+                }
 
-    pthread_mutex_unlock(&p_mutex);
+                break;
+            }
+            case Kernel::Arg::Image2D:
+            case Kernel::Arg::Image3D:
+            {
+                // We need to ensure the image is allocated
+                Image2D *image = *(Image2D **)arg.data();
+                image->allocate(device);
 
-    return rs;
+                // Fall through to the memcpy
+            }
+            default:
+                // Simply copy the arg's data into the buffer
+                std::memcpy(target, arg.data(), size);
+                break;
+        }
+    }
 }
 
-void CPUKernelEvent::workGroupFinished()
+CPUKernelEvent::~CPUKernelEvent()
 {
-    pthread_mutex_lock(&p_mutex);
+    std::free(p_kernel_args);
+}
 
-    p_finished_wg++;
+size_t CPUKernelEvent::numWorkGroups() const
+{
+    return p_num_wg;
+}
 
-    pthread_mutex_unlock(&p_mutex);
+void CPUKernelEvent::workGroupIndex(size_t linear_index,
+                                    size_t *work_group_index) const
+{
+    // Dimension 0 varies the fastest, as with incVec()
+    for (cl_uint i=0; i<p_event->work_dim(); ++i)
+    {
+        work_group_index[i] = linear_index % p_num_work_groups[i];
+        linear_index /= p_num_work_groups[i];
+    }
 }
 
-CPUKernelWorkGroup *CPUKernelEvent::takeInstance()
+void *CPUKernelEvent::kernelArgs() const
 {
-    CPUKernelWorkGroup *wg = new CPUKernelWorkGroup((CPUKernel *)p_event->deviceKernel(),
-                                                    p_event,
-                                                    this,
-                                                    p_current_work_group);
+    return p_kernel_args;
+}
 
-    // Increment current work group
-    incVec(p_event->work_dim(), p_current_work_group, p_max_work_groups);
-    p_current_wg += 1;
+size_t CPUKernelEvent::kernelArgsSize() const
+{
+    return p_kernel_args_size;
+}
 
-    // Release event
-    pthread_mutex_unlock(&p_mutex);
+const std::vector<std::pair<size_t, size_t> > &CPUKernelEvent::locals() const
+{
+    return p_locals;
+}
 
-    return wg;
+bool CPUKernelEvent::start()
+{
+    return __sync_bool_compare_and_swap(&p_started, 0, 1);
 }
 
-void *CPUKernelEvent::kernelArgs() const
+bool CPUKernelEvent::workGroupsFinished(size_t count, cl_int errcode)
 {
-    return p_kernel_args;
+    if (errcode != CL_SUCCESS)
+        __sync_bool_compare_and_swap(&p_status, CL_SUCCESS, errcode);
+
+    return __sync_add_and_fetch(&p_finished_wg, count) == p_num_wg;
 }
 
-void CPUKernelEvent::cacheKernelArgs(void *args)
+cl_int CPUKernelEvent::status() const
 {
-    p_kernel_args = args;
+    return p_status;
 }
 
 /*
@@ -391,8 +361,8 @@ CPUKernelWorkGroup::CPUKernelWorkGroup(CPUKernel *kernel, KernelEvent *event,
                                        CPUKernelEvent *cpu_event,
                                        const size_t *work_group_index)
 : p_kernel(kernel), p_cpu_event(cpu_event), p_event(event),
-  p_work_dim(event->work_dim()), p_contexts(0), p_stack_size(8192 /* TODO */),
-  p_had_barrier(false)
+  p_work_dim(event->work_dim()), p_contexts(0),
+  p_stack_size(CPU_WORK_ITEM_STACK_SIZE), p_had_barrier(false)
 {
 
     // Set index
@@ -414,125 +384,61 @@ CPUKernelWorkGroup::CPUKernelWorkGroup(CPUKernel *kernel, KernelEvent *event,
 
 CPUKernelWorkGroup::~CPUKernelWorkGroup()
 {
-    p_cpu_event->workGroupFinished();
 }
 
 void *CPUKernelWorkGroup::callArgs(std::vector<void *> &locals_to_free)
 {
-    if (p_cpu_event->kernelArgs() && !p_kernel->kernel()->hasLocals())
-    {
-        // We have cached the args and can reuse them
-        return p_cpu_event->kernelArgs();
-    }
-
-    // We need to create them from scratch
-    void *rs;
+    const std::vector<std::pair<size_t, size_t> > &locals =
+        p_cpu_event->locals();
 
-    size_t args_size = 0;
-
-    for (unsigned int i=0; i<p_kernel->kernel()->numArgs(); ++i)
-    {
-        const Kernel::Arg &arg = p_kernel->kernel()->arg(i);
-        CPUKernel::typeOffset(args_size, arg.valueSize() * arg.vecDim());
-    }
+    // The arguments built by the event can be shared by the work-groups
+    if (locals.empty())
+        return p_cpu_event->kernelArgs();
 
-    rs = std::malloc(args_size);
+    // Each work-group has its own __local buffers
+    void *rs = std::malloc(p_cpu_event->kernelArgsSize());
 
     if (!rs)
         return NULL;
 
-    size_t arg_offset = 0;
+    locals_to_free.push_back(rs);
+    std::memcpy(rs, p_cpu_event->kernelArgs(), p_cpu_event->kernelArgsSize());
 
-    for (unsigned int i=0; i<p_kernel->kernel()->numArgs(); ++i)
+    for (size_t i=0; i<locals.size(); ++i)
     {
-        const Kernel::Arg &arg = p_kernel->kernel()->arg(i);
-        size_t size = arg.valueSize() * arg.vecDim();
-        size_t offset = CPUKernel::typeOffset(arg_offset, size);
-
-        // Where to place the argument
-        unsigned char *target = (unsigned char *)rs;
-        target += offset;
-
-        // We may have to perform some changes in the values (buffers, etc)
-        switch (arg.kind())
-        {
-            case Kernel::Arg::Buffer:
-            {
-                MemObject *buffer = *(MemObject **)arg.data();
-
-                if (arg.file() == Kernel::Arg::Local)
-                {
-                    // Alloc a buffer and pass it to the kernel
-                    void *local_buffer = std::malloc(arg.allocAtKernelRuntime());
-                    locals_to_free.push_back(local_buffer);
-                    *(void **)target = local_buffer;
-                }
-                else
-                {
-                    if (!buffer)
-                    {
-                        // We can do that, just send NULL
-                        *(void **)target = NULL;
-                    }
-                    else
-                    {
-                        // Get the CPU buffer, allocate it and get its pointer
-                        CPUBuffer *cpubuf =
-                            (CPUBuffer *)buffer->deviceBuffer(p_kernel->device());
-                        void *buf_ptr = 0;
-
-                        buffer->allocate(p_kernel->device());
-                        buf_ptr = cpubuf->data();
-
-                        *(void **)target = buf_ptr;
-                    }
-                }
+        void *local_buffer = std::malloc(locals[i].second);
 
-                break;
-            }
-            case Kernel::Arg::Image2D:
-            case Kernel::Arg::Image3D:
-            {
-                // We need to ensure the image is allocated
-                Image2D *image = *(Image2D **)arg.data();
-                image->allocate(p_kernel->device());
+        if (!local_buffer)
+            return NULL;
 
-                // Fall through to the memcpy
-            }
-            default:
-                // Simply copy the arg's data into the buffer
-                std::memcpy(target, arg.data(), size);
-                break;
-        }
+        locals_to_free.push_back(local_buffer);
+        *(void **)((char *)rs + locals[i].first) = local_buffer;
     }
 
-    // Cache the arguments if we can do so
-    if (!p_kernel->kernel()->hasLocals())
-        p_cpu_event->cacheKernelArgs(rs);
-
     return rs;
 }
 
 bool CPUKernelWorkGroup::run()
 {
-    return false;
-#if 0
     // Get the kernel function to call
     std::vector<void *> locals_to_free;
-    llvm::Function *kernel_func = p_kernel->callFunction();
 
-    if (!kernel_func)
-        return false;
-
-    Program *p = (Program *)p_kernel->kernel()->parent();
-    CPUProgram *prog = (CPUProgram *)(p->deviceDependentProgram(p_kernel->device()));
+    p_kernel_func_addr = p_cpu_event->launcher();
 
-    p_kernel_func_addr =
-        (void(*)(void *))prog->jit()->getPointerToFunction(kernel_func);
+    if (!p_kernel_func_addr)
+        return false;
 
     // Get the arguments
     p_args = callArgs(locals_to_free);
 
+    if (!p_args)
+    {
+        for (size_t i=0; i<locals_to_free.size(); ++i)
+            std::free(locals_to_free[i]);
+
+        return false;
+    }
+
     // Tell the builtins this thread will run a kernel work group
     setThreadLocalWorkGroup(this);
 
@@ -540,11 +446,11 @@ bool CPUKernelWorkGroup::run()
     p_current_work_item = 0;
     p_current_context = &p_dummy_context;
 
-    std::memset(p_dummy_context.local_id, 0, p_work_dim * sizeof(size_t));
+    std::memset(p_dummy_context.local_id, 0, MAX_WORK_DIMS * sizeof(size_t));
 
     do
     {
-        // Simply call the "call function", it and the builtins will do the rest
+        // Simply call the launcher, it and the builtins will do the rest
         p_kernel_func_addr(p_args);
     } while (!p_had_barrier &&
              !incVec(p_work_dim, p_dummy_context.local_id, p_max_local_id));
@@ -563,23 +469,20 @@ bool CPUKernelWorkGroup::run()
         for (unsigned int i=1; i<p_num_work_items; ++i)
         {
             Context *ctx = getContextAddr(i);
+
+            p_current_work_item = i;
+            p_current_context = ctx;
             swapcontext(&main_context->context, &ctx->context);
         }
     }
 
-    // Free the allocated locals
-    if (p_kernel->kernel()->hasLocals())
-    {
-        for (size_t i=0; i<locals_to_free.size(); ++i)
-        {
-            std::free(locals_to_free[i]);
-        }
+    setThreadLocalWorkGroup(0);
 
-        std::free(p_args);
-    }
+    // Free the allocated locals and their arguments
+    for (size_t i=0; i<locals_to_free.size(); ++i)
+        std::free(locals_to_free[i]);
 
     return true;
-#endif
 }
 
 CPUKernelWorkGroup::Context *CPUKernelWorkGroup::getContextAddr(unsigned int index)
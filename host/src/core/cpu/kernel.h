@@ -39,6 +39,7 @@
 //#include <llvm/ExecutionEngine/GenericValue.h>
 #include <vector>
 #include <string>
+#include <utility>
 
 #include <ucontext.h>
 #include "../tiocl_thread.h"
@@ -62,9 +63,7 @@ class Image3D;
  * \brief CPU kernel
  *
  * This class holds passive information about a kernel (\c Coal::Kernel object
- * and device on which it is run) and provides the \c callFunction() function.
- *
- * This function is described at the end of \ref llvm .
+ * and device on which it is run) and provides the \c launcher() function.
  *
  * \see Coal::CPUKernelWorkGroup
  */
@@ -92,7 +91,19 @@ class CPUKernel : public DeviceKernel
         CPUDevice *device() const;  /*!< \brief device on which the kernel will be run */
 
         llvm::Function *function() const;   /*!< \brief \c llvm::Function representing the kernel but <strong>not to be run</strong> */
-        llvm::Function *callFunction();     /*!< \brief stub function used to run the kernel, see \ref llvm */
+
+        typedef void (*Launcher)(void *);
+
+        /**
+         * \brief Function running one work-item of the kernel
+         *
+         * It is the \c __ocl_launch_<kernel> function generated by
+         * \c clocl \c --host in the loaded program. It takes the address of
+         * the arguments, placed as \c typeOffset() says.
+         *
+         * \return the launcher, or NULL if the program is not loaded
+         */
+        Launcher launcher();
 
         /**
          * \brief Calculate where to place a value in an array
@@ -132,12 +143,18 @@ class CPUKernel : public DeviceKernel
     private:
         CPUDevice *p_device;
         Kernel *p_kernel;
-        llvm::Function *p_function, *p_call_function;
-        pthread_mutex_t p_call_function_mutex;
+        llvm::Function *p_function;
+        Launcher p_launcher;
+        pthread_mutex_t p_launcher_mutex;
 };
 
 class CPUKernelEvent;
 
+/**
+ * \brief Stack size of each work-item of a work-group calling \c barrier()
+ */
+#define CPU_WORK_ITEM_STACK_SIZE (64 * 1024)
+
 /**
  * \brief CPU kernel work-group
  *
@@ -163,18 +180,15 @@ class CPUKernelWorkGroup
         ~CPUKernelWorkGroup();
 
         /**
-         * \brief Build a structure of arguments
+         * \brief Arguments of the work-group
          *
-         * As C doesn't support calling functions with variable arguments
-         * unknown at the compilation, this function builds the list of
-         * arguments in memory. This array will then be passed to a LLVM stub
-         * function reading it and passing its values to the actuel kernel.
+         * The arguments are built once per kernel event by
+         * \c Coal::CPUKernelEvent. If this kernel takes \c __local
+         * arguments, they must be \c malloc()'ed for every work-group: the
+         * arguments are then copied and the copy points to them.
          *
-         * \see \ref llvm
-         * \param locals_to_free if this kernel takes \c __local arguments, they
-         *                       must be \c malloc()'ed for every work-group.
-         *                       They are placed in this vector to be
-         *                       \c free()'ed at the end of \c run().
+         * \param locals_to_free \c malloc()'ed blocks, including the copy,
+         *                       to be \c free()'ed at the end of \c run().
          * \return address of a memory location containing the arguments
          */
         void *callArgs(std::vector<void *> &locals_to_free);
@@ -230,11 +244,6 @@ class CPUKernelWorkGroup
          * @}
          */
 
-        /**
-         * \brief Function called when a built-in name cannot be found
-         */
-        void builtinNotFound(const std::string &name) const;
-
     private:
         template<typename T>
         void writeImageImpl(Image2D *image, int x, int y, int z, T *color) const;
@@ -261,7 +270,7 @@ class CPUKernelWorkGroup
                p_max_local_id[MAX_WORK_DIMS],
                p_global_id_start_offset[MAX_WORK_DIMS];
 
-        void (*p_kernel_func_addr)(void *);
+        CPUKernel::Launcher p_kernel_func_addr;
         void *p_args;
 
         // Machinery to have barrier() working
@@ -286,8 +295,10 @@ class CPUKernelWorkGroup
  * \brief CPU-specific information about a kernel event
  *
  * This class put in a \c Coal::KernelEvent device-data field
- * (see \c Coal::Event::setDeviceData()) is responsible for dispatching the
- * \c Coal::CPUKernelWorkGroup objects between the CPU worker threads.
+ * (see \c Coal::Event::setDeviceData()) holds what the worker threads share
+ * to run the work-groups of the event: the kernel arguments, built when the
+ * event is queued, and the count of finished work-groups. The work-groups are
+ * numbered linearly, the CPU device hands out ranges of them to its workers.
  */
 class CPUKernelEvent
 {
@@ -297,27 +308,53 @@ class CPUKernelEvent
          * \param device device running the kernel
          * \param event \c Coal::KernelEvent holding device-agnostic data
          *              about the event
+         * \param errcode_ret return code
          */
-        CPUKernelEvent(CPUDevice *device, KernelEvent *event);
+        CPUKernelEvent(CPUDevice *device, KernelEvent *event,
+                       cl_int *errcode_ret);
         ~CPUKernelEvent();
 
-        bool reserve();  /*!< \brief The next Work Group that will execute will be the last. Locks the event */
-        bool finished(); /*!< \brief All the work groups have finished */
-        CPUKernelWorkGroup *takeInstance(); /*!< \brief Must be called exactly one time after reserve(). Unlocks the event */
+        size_t numWorkGroups() const;       /*!< \brief Number of work-groups of the kernel */
+
+        /**
+         * \brief Index of the work-group numbered \p linear_index
+         * \param work_group_index receives one index per dimension
+         */
+        void workGroupIndex(size_t linear_index, size_t *work_group_index) const;
 
-        void *kernelArgs() const;           /*!< \brief Return the cached kernel arguments */
-        void cacheKernelArgs(void *args);   /*!< \brief Cache pre-built kernel arguments */
+        CPUKernel::Launcher launcher() const { return p_launcher; }
+        void *kernelArgs() const;           /*!< \brief Return the kernel arguments, built at construction */
+        size_t kernelArgsSize() const;      /*!< \brief Size of \c kernelArgs() */
 
-        void workGroupFinished();           /*!< \brief A work-group has just finished */
+        /**
+         * \brief \c __local arguments, as offsets in \c kernelArgs() and
+         *        sizes
+         */
+        const std::vector<std::pair<size_t, size_t> > &locals() const;
+
+        bool start();   /*!< \brief True for the first caller, which starts the event */
+
+        /**
+         * \brief \p count work-groups have just finished
+         * \param errcode CL_SUCCESS or the error with which they failed,
+         *        the first error is kept
+         * \return true if they were the last ones: the caller completes the
+         *         event with \c status()
+         */
+        bool workGroupsFinished(size_t count, cl_int errcode);
+        cl_int status() const;
 
     private:
         CPUDevice *p_device;
         KernelEvent *p_event;
-        size_t p_current_work_group[MAX_WORK_DIMS],
-               p_max_work_groups[MAX_WORK_DIMS];
-        size_t p_current_wg, p_finished_wg, p_num_wg;
-        pthread_mutex_t p_mutex;
+        CPUKernel::Launcher p_launcher;
+        size_t p_num_work_groups[MAX_WORK_DIMS];
+        size_t p_num_wg, p_finished_wg;
+        unsigned int p_started;
+        cl_int p_status;
         void *p_kernel_args;
+        size_t p_kernel_args_size;
+        std::vector<std::pair<size_t, size_t> > p_locals;
 };
 
 }
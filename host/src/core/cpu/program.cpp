@@ -36,44 +36,42 @@
 #include "builtins.h"
 
 #include "../program.h"
+#include "../oclenv.h"
 
-#if 0 // JIT compilation disabled
-#include <llvm/PassManager.h>
-#include <llvm/Analysis/Passes.h>
-#include <llvm/IR/Verifier.h>
-#include <llvm/Transforms/Scalar.h>
-#include <llvm/Transforms/IPO.h>
-#include <llvm/ExecutionEngine/ExecutionEngine.h>
-#include <llvm/ExecutionEngine/SectionMemoryManager.h>
-#include <llvm/ExecutionEngine/MCJIT.h>
-#include <llvm/ExecutionEngine/Interpreter.h>
-#include <llvm/Support/ErrorHandling.h>
-#endif
+#include <elf.h>
+#include <dlfcn.h>
+#include <unistd.h>
 
+#include <cstring>
 #include <string>
+#include <fstream>
 #include <iostream>
 
 using namespace Coal;
-using namespace llvm;
+using namespace tiocl;
 
 
 CPUProgram::CPUProgram(CPUDevice *device, Program *program)
-: DeviceProgram(), p_device(device), p_program(program), p_jit(0)
+: DeviceProgram(), p_device(device), p_program(program), p_module(0),
+  p_handle(0), p_keep_files(false)
 {
+    EnvVar& env = EnvVar::Instance();
+    if (env.GetEnv<EnvVar::Var::TI_OCL_KEEP_FILES>(nullptr))
+        p_keep_files = true;
 
+    pthread_mutex_init(&p_load_mutex, 0);
 }
 
 CPUProgram::~CPUProgram()
 {
-#if 0
-    if (p_jit)
-    {
-        // Dont delete the module
-        p_jit->removeModule(p_module);
+    if (p_handle)
+        dlclose(p_handle);
 
-        delete p_jit;
-    }
-#endif
+    // Binaries from the kernel cache are private pins of the cache entries
+    if (!p_keep_files && !p_outfile.empty())
+        unlink(p_outfile.c_str());
+
+    pthread_mutex_destroy(&p_load_mutex);
 }
 
 bool CPUProgram::linkStdLib() const
@@ -84,47 +82,141 @@ bool CPUProgram::linkStdLib() const
 bool CPUProgram::build(llvm::Module *module, std::string *binary_str,
                        char *binary_filename)
 {
-    // Nothing to build
     p_module = module;
 
-    return true;
+    if (binary_filename != NULL)
+    {
+        p_outfile = binary_filename;
+        return true;
+    }
+
+    // Program created from a binary: dlopen() needs a file
+    if (!binary_str || binary_str->empty())
+        return false;
+
+    char name_out[] = "/tmp/openclXXXXXX";
+    int  fOutfile = mkstemp(name_out);
+    if (fOutfile < 0) return false;
+
+    p_outfile = name_out;
+    p_outfile += ".so";
+
+    std::ofstream outfile(p_outfile.c_str(), std::ios::out | std::ios::binary);
+    outfile.write(binary_str->data(), binary_str->size());
+    outfile.close();
+    close(fOutfile);
+    unlink(name_out);
+
+    return !outfile.fail();
 }
 
-bool CPUProgram::initJIT()
+/**
+ * Extract the ".llvmir" section of the shared object
+ */
+template <typename Ehdr, typename Shdr>
+static bool extractSection(const std::string &binary_str, const char *name,
+                           std::string &section)
 {
-    return false;
-#if 0
-    if (p_jit)
-        return true;
+    if (binary_str.size() < sizeof(Ehdr)) return false;
+
+    Ehdr ehdr;  /* memcpy into here to guarantee proper alignment */
+    memcpy(&ehdr, binary_str.data(), sizeof(Ehdr));
 
-    if (!p_module)
+    if (ehdr.e_shoff + (size_t)ehdr.e_shnum * sizeof(Shdr) > binary_str.size()
+        || ehdr.e_shstrndx >= ehdr.e_shnum)
         return false;
 
-    // Create the JIT
-    std::string err;
-    p_jit = llvm::EngineBuilder(std::unique_ptr<Module>(p_module))
-                            .setErrorStr(&err)
-#if defined (__arm__)
-    // uncomment to try the MCJIT for ARM
-    //                        .setMCJITMemoryManager(
-    //                              llvm::make_unique<SectionMemoryManager>())
-#endif
-                            .create();
-
-    if (!p_jit)
+    Shdr shdr;
+    memcpy(&shdr, &binary_str[ehdr.e_shoff + ehdr.e_shstrndx * sizeof(Shdr)],
+           sizeof(Shdr));
+    size_t strtab = shdr.sh_offset, strtab_size = shdr.sh_size;
+
+    for (int i = 0; i < ehdr.e_shnum; i++)
     {
-        std::cout << "Unable to create a JIT: " << err << std::endl;
+        memcpy(&shdr, &binary_str[ehdr.e_shoff + i * sizeof(Shdr)],
+               sizeof(Shdr));
+
+        if (shdr.sh_name >= strtab_size ||
+            strcmp(&binary_str[strtab + shdr.sh_name], name) != 0)
+            continue;
+
+        if (shdr.sh_offset + shdr.sh_size > binary_str.size())
+            return false;
+
+        section.assign(&binary_str[shdr.sh_offset], shdr.sh_size);
+        return true;
+    }
+
+    return false;
+}
+
+bool CPUProgram::ExtractMixedBinary(const std::string &binary_str,
+                                          std::string &bitcode)
+{
+    if (binary_str.size() < EI_NIDENT) return false;
+    if (strncmp(binary_str.data(), ELFMAG, SELFMAG) != 0) return false;
+
+    bitcode.clear();
+
+    if (binary_str[EI_CLASS] == ELFCLASS64)
+        return extractSection<Elf64_Ehdr, Elf64_Shdr>(binary_str, ".llvmir",
+                                                      bitcode);
+    else
+        return extractSection<Elf32_Ehdr, Elf32_Shdr>(binary_str, ".llvmir",
+                                                      bitcode);
+}
+
+bool CPUProgram::load()
+{
+    pthread_mutex_lock(&p_load_mutex);
+
+    if (p_handle || p_outfile.empty())
+    {
+        bool loaded = (p_handle != 0);
+        pthread_mutex_unlock(&p_load_mutex);
+        return loaded;
+    }
+
+    void *handle = dlopen(p_outfile.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+    if (!handle)
+    {
+        std::cerr << "Unable to load " << p_outfile << ": " << dlerror()
+                  << std::endl;
+        pthread_mutex_unlock(&p_load_mutex);
         return false;
     }
 
-    p_jit->DisableSymbolSearching(true);    // Avoid an enormous security hole (a kernel calling system())
-    p_jit->InstallLazyFunctionCreator(&getBuiltin);
+    // Resolve the functions the kernels call
+    void       **builtins = (void **)dlsym(handle, "__ocl_builtins");
+    const char **names    = (const char **)dlsym(handle, "__ocl_builtin_names");
+    const int   *count    = (const int *)dlsym(handle, "__ocl_num_builtins");
+    bool         success  = (builtins && names && count);
 
-    return true;
-#endif
+    for (int i = 0; success && i < *count; ++i)
+    {
+        builtins[i] = getBuiltin(names[i]);
+
+        if (!builtins[i])
+        {
+            std::cerr << "OpenCL: Non-existant builtin function " << names[i]
+                      << " called by the kernels of " << p_outfile << '.'
+                      << std::endl;
+            success = false;
+        }
+    }
+
+    if (success) p_handle = handle;
+    else         dlclose(handle);
+
+    pthread_mutex_unlock(&p_load_mutex);
+
+    return success;
 }
 
-llvm::ExecutionEngine *CPUProgram::jit() const
+void *CPUProgram::symbol(const std::string &name) const
 {
-    return p_jit;
+    if (!p_handle) return 0;
+
+    return dlsym(p_handle, name.c_str());
 }
@@ -34,10 +34,12 @@
 #define __CPU_PROGRAM_H__
 
 #include "../deviceinterface.h"
+#include "../tiocl_thread.h"
+
+#include <string>
 
 namespace llvm
 {
-    class ExecutionEngine;
     class Module;
 }
 
@@ -53,8 +55,11 @@ class Program;
  * This class implements the \c Coal::DeviceProgram interface for CPU
  * acceleration.
  *
- * It's main purpose is to initialize a \c llvm::JIT object to run LLVM bitcode,
- * in \c initJIT().
+ * The program is compiled by \c clocl \c --host into a shared object that
+ * is loaded in the process with \c dlopen(), in \c load(). The shared object
+ * contains an \c __ocl_launch_<kernel> function for each kernel, reading the
+ * kernel arguments from memory, and the kernel signatures in bitcode, in a
+ * \c .llvmir section, from which the \c Coal::Kernel objects are built.
  */
 class CPUProgram : public DeviceProgram
 {
@@ -70,30 +75,40 @@ class CPUProgram : public DeviceProgram
         bool linkStdLib() const;
         bool build(llvm::Module *module, std::string *binary_str,
                    char *binary_filename=NULL);
+        bool ExtractMixedBinary(const std::string &binary_str,
+                                      std::string &bitcode);
 
         /**
-         * \brief Initialize an LLVM JIT
+         * \brief Load the shared object of the program
          *
-         * This function creates a \c llvm::JIT object to run this program on
-         * the CPU. A few implementation details :
+         * A few implementation details :
          *
-         * - The JIT is set not to resolve unknown symbols using \c dlsym().
-         *   This way, a malicious kernel cannot execute arbitrary code on
-         *   the host by declaring \c libc functions and calling them.
-         * - All the unknown function names are passed to \c getBuiltin() to
-         *   get native built-in implementations.
+         * - The kernels cannot call functions of the process directly: every
+         *   external function they use goes through the \c __ocl_builtins
+         *   table of the shared object. It is filled with the addresses
+         *   \c getBuiltin() returns for the \c __ocl_builtin_names, a kernel
+         *   calling a function that is not an OpenCL built-in cannot be
+         *   loaded.
+         * - Loading happens once, at the first kernel run.
          *
          * \return true if success, false otherwise
          */
-        bool initJIT();
-        llvm::ExecutionEngine *jit() const; /*!< \brief Current LLVM execution engine */
+        bool load();
+
+        /**
+         * \brief Address of \p name in the loaded shared object, or NULL
+         */
+        void *symbol(const std::string &name) const;
 
     private:
         CPUDevice *p_device;
         Program *p_program;
 
-        llvm::ExecutionEngine *p_jit;
         llvm::Module *p_module;
+        std::string p_outfile;
+        void *p_handle;
+        bool p_keep_files;
+        pthread_mutex_t p_load_mutex;
 };
 
 }
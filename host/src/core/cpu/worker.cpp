@@ -52,26 +52,23 @@ using namespace Coal;
 void *worker(void *data)
 {
     CPUDevice *device = (CPUDevice *)data;
-    bool stop = false;
+    unsigned int index = device->registerWorker();
     cl_int errcode;
-    Event *event;
+    CPUTask task;
 
     // Initialize TLS
     setWorkItemsData(0, 0);
 
-    while (true)
+    while (device->getTask(index, task))
     {
-        event = device->getEvent(stop);
-
-        // Ensure we have a good event and we don't have to stop
-        if (stop) break;
-        if (!event) continue;
+        Event *event = task.event;
 
         // Get info about the event and its command queue
         Event::Type t = event->type();
         Coal::CommandQueue * queue = NULL;
         cl_command_queue d_queue = 0;
         cl_command_queue_properties queue_props = 0;
+        bool finished = true;
 
         errcode = CL_SUCCESS;
 
@@ -82,8 +79,13 @@ void *worker(void *data)
             queue->info(CL_QUEUE_PROPERTIES, sizeof(cl_command_queue_properties),
                         &queue_props, 0);
 
+        // A kernel starts with the first of its work-group ranges
         if (queue_props & CL_QUEUE_PROFILING_ENABLE)
-            event->updateTiming(Event::Start);
+        {
+            if ((t != Event::NDRangeKernel && t != Event::TaskKernel) ||
+                ((CPUKernelEvent *)event->deviceData())->start())
+                event->updateTiming(Event::Start);
+        }
 
         // Execute the action
         switch (t)
@@ -219,15 +221,29 @@ void *worker(void *data)
             {
                 KernelEvent *e = (KernelEvent *)event;
                 CPUKernelEvent *ke = (CPUKernelEvent *)e->deviceData();
+                CPUKernel *kernel = (CPUKernel *)e->deviceKernel();
+                size_t work_group_index[MAX_WORK_DIMS];
+
+                // Run the range of work-groups, unless another one failed
+                for (size_t i=0; i<task.num_work_groups &&
+                                 ke->status() == CL_SUCCESS; ++i)
+                {
+                    ke->workGroupIndex(task.first_work_group + i,
+                                       work_group_index);
 
-                // Take an instance
-                CPUKernelWorkGroup *instance = ke->takeInstance();
-                ke = 0;     // Unlocked, don't use anymore
+                    CPUKernelWorkGroup instance(kernel, e, ke, work_group_index);
 
-                if (!instance->run())
-                    errcode = CL_INVALID_PROGRAM_EXECUTABLE;
+                    if (!instance.run())
+                    {
+                        errcode = CL_INVALID_PROGRAM_EXECUTABLE;
+                        break;
+                    }
+                }
 
-                delete instance;
+                // The last range to finish completes the event, the others
+                // must not use it anymore
+                finished = ke->workGroupsFinished(task.num_work_groups, errcode);
+                if (finished) errcode = ke->status();
 
                 break;
             }
@@ -236,32 +252,16 @@ void *worker(void *data)
         }
 
         // Cleanups
-        if (errcode == CL_SUCCESS)
-        {
-            bool finished = true;
-
-            if (event->type() == Event::NDRangeKernel ||
-                event->type() == Event::TaskKernel)
-            {
-                CPUKernelEvent *ke = (CPUKernelEvent *)event->deviceData();
-                finished = ke->finished();
-            }
-
-            if (finished)
-            {
-                // an event may be released once it is Complete
-                if (queue_props & CL_QUEUE_PROFILING_ENABLE)
-                    event->updateTiming(Event::End);
-                event->setStatus(Event::Complete);
-            }
-        }
-        else
+        if (finished)
         {
             // an event may be released once it is Complete
             if (queue_props & CL_QUEUE_PROFILING_ENABLE)
-                    event->updateTiming(Event::End);
-            // The event failed
-            event->setStatus((Event::Status)errcode);
+                event->updateTiming(Event::End);
+
+            if (errcode == CL_SUCCESS)
+                event->setStatus(Event::Complete);
+            else
+                event->setStatus((Event::Status)errcode); // The event failed
         }
     }
 
@@ -210,6 +210,47 @@ class DeviceInterface : public _cl_device_id, public Object
          */
         virtual void freeEventDeviceData(Event *event) = 0;
 
+        /**
+         * \brief Keep what is needed to push \p event again
+         *
+         * Called once \p event, already initialized with
+         * \c initEventDeviceData(), is recorded in a \c Coal::CommandGraph.
+         */
+        virtual cl_int recordEventDeviceData(Event *event);
+
+        /**
+         * \brief Prepare a recorded event to be pushed again
+         *
+         * Called before each replay of a \c Coal::CommandGraph but the first.
+         * The default frees and initializes the device-specific data again.
+         */
+        virtual cl_int rearmEventDeviceData(Event *event);
+
+        /**
+         * \brief Change an argument of a recorded kernel event
+         *
+         * \p value is the argument as \c Coal::Kernel::Arg stores it: a
+         * \c Coal::MemObject pointer for buffers, the size as a \c size_t
+         * for \c __local arguments. The default does not support it.
+         */
+        virtual cl_int patchEventKernelArg(Event *event, cl_uint index,
+                                           const void *value, size_t size);
+
+        /**
+         * \brief Let \p event follow \p predecessor on the device
+         *
+         * Called by an in-order \c Coal::CommandQueue, with its lock held,
+         * for an event whose only unmet wait is \p predecessor, already
+         * pushed on this device and not complete. If the device itself can
+         * start \p event once \p predecessor is done, it records the
+         * dependency and returns true: \p event is then pushed right away.
+         * The default does not support it.
+         */
+        virtual bool chainEvents(Event *predecessor, Event *event)
+        {
+            return false;
+        }
+
         virtual std::string builtinsHeader(void) const = 0;
 
         virtual void init() = 0;
@@ -283,6 +324,12 @@ class DeviceBuffer
          * \return A memory pointer usable by a host native kernel
          */
         virtual void *nativeGlobalPointer() const = 0;
+
+        /**
+         * \brief Whether the buffer currently lives in on-chip memory
+         * \return true when in MSMC, false otherwise
+         */
+        virtual bool onChip() const { return false; }
 };
 
 /**
@@ -26,10 +26,13 @@
  *   THE POSSIBILITY OF SUCH DAMAGE.
  *****************************************************************************/
 #include "buffer.h"
+#include "buffer_pool.h"
+#include "placement.h"
 #include "device.h"
 
 #include "CL/cl_ext.h"
 #include "../memobject.h"
+#include "../context.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -37,10 +40,14 @@
 
 using namespace Coal;
 
-DSPBuffer::DSPBuffer(tiocl::SharedMemory *shm, MemObject *buffer, cl_int *rs)
+DSPBuffer::DSPBuffer(tiocl::SharedMemory *shm, MemObject *buffer, cl_int *rs,
+                     MsmcPlacement *placement)
      : DeviceBuffer(), p_shm_(shm), p_buffer(buffer), p_data(0),
-       p_data_malloced(false), p_buffer_idx(0)
+       p_data_malloced(false), p_pool(0), p_buffer_idx(0),
+       p_placement(placement), p_pins(0), p_launches(0), p_promoted(false)
 {
+    pthread_mutex_init(&p_pin_mutex, 0);
+
     if (buffer->type() != MemObject::SubBuffer &&
         buffer->flags() & CL_MEM_USE_HOST_PTR)
     {
@@ -64,12 +71,18 @@ DSPBuffer::DSPBuffer(tiocl::SharedMemory *shm, MemObject *buffer, cl_int *rs)
 
 DSPBuffer::~DSPBuffer()
 {
+    if (p_promoted) p_placement->Forget(this);
+
     if (p_data_malloced)
     {
-        if (p_buffer->flags() & CL_MEM_USE_MSMC_TI)
+        if (p_pool)
+             p_pool->Free(p_data, p_buffer->size());
+        else if (p_promoted || p_buffer->flags() & CL_MEM_USE_MSMC_TI)
              p_shm_->FreeMSMC(p_data);
         else p_shm_->FreeGlobal(p_data);
     }
+
+    pthread_mutex_destroy(&p_pin_mutex);
 }
 
 DSPDevicePtr64 DSPBuffer::data() const
@@ -132,8 +145,17 @@ bool DSPBuffer::allocate()
     *------------------------------------------------------------------------*/
     if (!p_data)
     {
+        /*---------------------------------------------------------------------
+        * Small global buffers come from the context's pool when it has room
+        *--------------------------------------------------------------------*/
+        tiocl::BufferPool *pool = ((Context *)p_buffer->parent())
+                                                     ->bufferPool(p_shm_);
+
         if (p_buffer->flags() & CL_MEM_USE_MSMC_TI)
-            p_data = p_shm_->AllocateMSMC(buf_size);
+            p_data = p_placement ? p_placement->AllocateMSMC(buf_size)
+                                 : p_shm_->AllocateMSMC(buf_size);
+        else if (pool && (p_data = pool->Allocate(buf_size)) != 0)
+            p_pool = pool;
         else
             p_data = p_shm_->AllocateGlobal(buf_size, false);
 
@@ -156,3 +178,32 @@ bool DSPBuffer::allocated() const
 {
     return p_data != 0;
 }
+
+bool DSPBuffer::onChip() const
+{
+    if (p_buffer->type() == MemObject::SubBuffer)
+    {
+        MemObject *parent = ((SubBuffer *)p_buffer)->parent();
+        return ((DSPBuffer *)parent->deviceBuffer(p_shm_))->onChip();
+    }
+
+    return p_promoted || (p_buffer->flags() & CL_MEM_USE_MSMC_TI);
+}
+
+void DSPBuffer::pin()
+{
+    if (!p_placement) return;
+
+    pthread_mutex_lock(&p_pin_mutex);
+    p_pins++;
+    pthread_mutex_unlock(&p_pin_mutex);
+}
+
+void DSPBuffer::unpin()
+{
+    if (!p_placement) return;
+
+    pthread_mutex_lock(&p_pin_mutex);
+    p_pins--;
+    pthread_mutex_unlock(&p_pin_mutex);
+}
@@ -32,16 +32,23 @@
 #include "../deviceinterface.h"
 #include "device.h"
 
+namespace tiocl
+{
+class BufferPool;
+}
+
 namespace Coal
 {
 
 class DSPDevice;
 class MemObject;
+class MsmcPlacement;
 
 class DSPBuffer : public DeviceBuffer
 {
     public:
-        DSPBuffer(tiocl::SharedMemory *shm, MemObject *buffer, cl_int *rs);
+        DSPBuffer(tiocl::SharedMemory *shm, MemObject *buffer, cl_int *rs,
+                  MsmcPlacement *placement = NULL);
         ~DSPBuffer();
 
         bool allocate();
@@ -49,13 +56,31 @@ class DSPBuffer : public DeviceBuffer
         DSPDevicePtr64 data() const ;
         void *nativeGlobalPointer() const ;
         bool allocated() const;
+        bool onChip() const;
+
+        /*---------------------------------------------------------------------
+        * Commands holding the address returned by data() pin the buffer, so
+        * that the MsmcPlacement policy does not move it meanwhile. No-ops
+        * when the placement policy is disabled.
+        *--------------------------------------------------------------------*/
+        void pin();
+        void unpin();
 
     private:
+        friend class MsmcPlacement;
+
         tiocl::SharedMemory * p_shm_;
         MemObject *           p_buffer;
         DSPDevicePtr64        p_data;
         bool                  p_data_malloced;
+        tiocl::BufferPool *   p_pool;
         unsigned int          p_buffer_idx;
+
+        MsmcPlacement *       p_placement;
+        pthread_mutex_t       p_pin_mutex;
+        unsigned int          p_pins;
+        unsigned int          p_launches;   // Protected by the placement mutex
+        bool                  p_promoted;   // Moved to MSMC by the placement
 };
 }
 #endif
@@ -0,0 +1,206 @@
+/******************************************************************************
+ * Copyright (c) 2013-2018, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include "buffer_pool.h"
+#include "../error_report.h"
+
+#include <algorithm>
+
+using namespace tiocl;
+
+BufferPool::BufferPool(SharedMemory* shm, size_t max_size)
+    : shm_(shm), 
+      max_size_(std::min(max_size, (size_t)BUFFER_POOL_MAX_POOLED_SIZE)),
+      requests_(0), hits_(0), slab_bytes_(0), slot_bytes_(0), used_bytes_(0)
+{
+    for (auto& c : classes_)
+    {
+        c.num_slabs.store(0);
+        for (auto& s : c.slabs) s.store(nullptr);
+    }
+}
+
+BufferPool::~BufferPool()
+{
+    for (auto& c : classes_)
+        for (uint32_t i = 0; i < c.num_slabs.load(); i++)
+        {
+            Slab* slab = c.slabs[i].load();
+            shm_->FreeGlobal(slab->base);
+            delete slab;
+        }
+}
+
+/******************************************************************************
+* BufferPool::SizeClassOf - index of the smallest slot that holds size bytes
+******************************************************************************/
+uint32_t BufferPool::SizeClassOf(size_t size) const
+{
+    uint32_t shift = BUFFER_POOL_MIN_SLOT_SHIFT;
+    while (((size_t)1 << shift) < size) shift++;
+    return shift - BUFFER_POOL_MIN_SLOT_SHIFT;
+}
+
+/******************************************************************************
+* BufferPool::Claim - atomically take a free slot from a slab, 0 if it is full
+******************************************************************************/
+uint64_t BufferPool::Claim(Slab* slab, uint32_t slot_shift)
+{
+    if (slab->num_free.load(std::memory_order_relaxed) <= 0) return 0;
+
+    uint32_t num_words = (slab->num_slots + 63) / 64;
+    for (uint32_t w = 0; w < num_words; w++)
+    {
+        uint64_t mask = slab->free_mask[w].load(std::memory_order_relaxed);
+        while (mask != 0)
+        {
+            uint32_t bit = __builtin_ctzll(mask);
+            if (slab->free_mask[w].compare_exchange_weak(mask,
+                                              mask & ~((uint64_t)1 << bit),
+                                              std::memory_order_acquire,
+                                              std::memory_order_relaxed))
+            {
+                slab->num_free.fetch_sub(1, std::memory_order_relaxed);
+                return slab->base + ((uint64_t)(w * 64 + bit) << slot_shift);
+            }
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************
+* BufferPool::Grow - add a slab to a size class.  Returns nullptr if another
+*   thread added one since seen_slabs was read (the caller retries), or if the
+*   class is full or the shared heap is exhausted.
+******************************************************************************/
+BufferPool::Slab* BufferPool::Grow(uint32_t cls, uint32_t seen_slabs)
+{
+    Lock lock(this);
+
+    SizeClass& c = classes_[cls];
+    uint32_t   n = c.num_slabs.load();
+    if (n != seen_slabs || n == BUFFER_POOL_MAX_SLABS) return nullptr;
+
+    uint64_t base = shm_->AllocateGlobal(BUFFER_POOL_SLAB_SIZE, false);
+    if (base == 0) return nullptr;
+
+    Slab* slab      = new Slab;
+    slab->base      = base;
+    slab->num_slots = BUFFER_POOL_SLAB_SIZE >> 
+                      (cls + BUFFER_POOL_MIN_SLOT_SHIFT);
+    slab->num_free.store(slab->num_slots);
+    for (uint32_t w = 0; w < BUFFER_POOL_SLAB_WORDS; w++)
+    {
+        uint32_t first = w * 64;
+        uint64_t mask  = 0;
+        if      (first + 64 <= slab->num_slots) mask = ~(uint64_t)0;
+        else if (first < slab->num_slots) 
+            mask = ((uint64_t)1 << (slab->num_slots - first)) - 1;
+        slab->free_mask[w].store(mask);
+    }
+
+    c.slabs[n].store(slab, std::memory_order_release);
+    c.num_slabs.store(n + 1, std::memory_order_release);
+    slab_bytes_ += BUFFER_POOL_SLAB_SIZE;
+
+    ReportTrace("BufferPool: slab 0x%llx for %d byte slots\n", base,
+                1 << (cls + BUFFER_POOL_MIN_SLOT_SHIFT));
+    return slab;
+}
+
+uint64_t BufferPool::Allocate(size_t size)
+{
+    if (!Pooled(size)) return 0;
+
+    uint32_t   cls        = SizeClassOf(size);
+    uint32_t   slot_shift = cls + BUFFER_POOL_MIN_SLOT_SHIFT;
+    SizeClass& c          = classes_[cls];
+    bool       grew       = false;
+
+    requests_.fetch_add(1, std::memory_order_relaxed);
+
+    while (true)
+    {
+        uint32_t n = c.num_slabs.load(std::memory_order_acquire);
+
+        /*---------------------------------------------------------------------
+        * Newest slabs first, they are the most likely to have free slots
+        *--------------------------------------------------------------------*/
+        for (uint32_t i = n; i > 0; i--)
+        {
+            uint64_t addr = Claim(c.slabs[i-1].load(std::memory_order_acquire),
+                                  slot_shift);
+            if (addr == 0) continue;
+
+            if (!grew) hits_.fetch_add(1, std::memory_order_relaxed);
+            slot_bytes_.fetch_add((uint64_t)1 << slot_shift,
+                                  std::memory_order_relaxed);
+            used_bytes_.fetch_add(size, std::memory_order_relaxed);
+            return addr;
+        }
+
+        if (Grow(cls, n) != nullptr) grew = true;
+        else if (c.num_slabs.load() == n) return 0;
+    }
+}
+
+bool BufferPool::Free(uint64_t addr, size_t size)
+{
+    if (!Pooled(size)) return false;
+
+    uint32_t   cls        = SizeClassOf(size);
+    uint32_t   slot_shift = cls + BUFFER_POOL_MIN_SLOT_SHIFT;
+    SizeClass& c          = classes_[cls];
+    uint32_t   n          = c.num_slabs.load(std::memory_order_acquire);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Slab* slab = c.slabs[i].load(std::memory_order_acquire);
+        if (addr < slab->base || addr >= slab->base + BUFFER_POOL_SLAB_SIZE)
+            continue;
+
+        uint32_t slot = (addr - slab->base) >> slot_shift;
+        slab->free_mask[slot / 64].fetch_or((uint64_t)1 << (slot % 64),
+                                            std::memory_order_release);
+        slab->num_free.fetch_add(1, std::memory_order_relaxed);
+
+        slot_bytes_.fetch_sub((uint64_t)1 << slot_shift,
+                              std::memory_order_relaxed);
+        used_bytes_.fetch_sub(size, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void BufferPool::GetStats(Stats& stats) const
+{
+    stats.requests   = requests_.load();
+    stats.hits       = hits_.load();
+    stats.slab_bytes = slab_bytes_.load();
+    stats.slot_bytes = slot_bytes_.load();
+    stats.used_bytes = used_bytes_.load();
+}
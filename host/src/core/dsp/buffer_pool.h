@@ -0,0 +1,129 @@
+/******************************************************************************
+ * Copyright (c) 2013-2018, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#ifndef _BUFFER_POOL_H
+#define _BUFFER_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "u_lockable.h"
+#include "../shared_memory_interface.h"
+
+/*-----------------------------------------------------------------------------
+* Slots are powers of two from one DSP L2 cache line up to the largest pooled
+* buffer size, so a CacheWb/CacheInv of one buffer never touches a line that
+* belongs to another.
+*----------------------------------------------------------------------------*/
+#define BUFFER_POOL_MIN_SLOT_SHIFT      7
+#define BUFFER_POOL_MAX_SLOT_SHIFT      20
+#define BUFFER_POOL_NUM_CLASSES         (BUFFER_POOL_MAX_SLOT_SHIFT - \
+                                         BUFFER_POOL_MIN_SLOT_SHIFT + 1)
+#define BUFFER_POOL_SLAB_SIZE           (1 << BUFFER_POOL_MAX_SLOT_SHIFT)
+#define BUFFER_POOL_SLAB_WORDS          (BUFFER_POOL_SLAB_SIZE >>          \
+                                         (BUFFER_POOL_MIN_SLOT_SHIFT + 6))
+#define BUFFER_POOL_MAX_SLABS           64
+#define BUFFER_POOL_DEFAULT_MAX_SIZE    (64 << 10)
+#define BUFFER_POOL_MAX_POOLED_SIZE     (BUFFER_POOL_SLAB_SIZE >> 2)
+
+namespace tiocl {
+
+/******************************************************************************
+* BufferPool : suballocates small device buffers for one context.
+*   Slabs of BUFFER_POOL_SLAB_SIZE bytes are taken from the shared heap with
+*   AllocateGlobal and split into equal slots, one slot size per size class.
+*   Free slots are tracked in a bitmap per slab that is claimed and released 
+*   with atomic operations, so allocating and freeing from an existing slab
+*   takes no lock.  The pool lock is only taken to add a slab to a class.
+*   Slabs are returned to the shared heap when the pool is destroyed.
+******************************************************************************/
+class BufferPool : public Lockable
+{
+public:
+    struct Stats
+    {
+        uint64_t requests;      // allocations routed to the pool
+        uint64_t hits;          // allocations served from an existing slab
+        uint64_t slab_bytes;    // bytes held from the shared heap
+        uint64_t slot_bytes;    // bytes in slots currently handed out
+        uint64_t used_bytes;    // bytes requested by live buffers
+    };
+
+    BufferPool(SharedMemory* shm, size_t max_size);
+    ~BufferPool();
+
+    /*-------------------------------------------------------------------------
+    * Returns 0 if size is not pooled or no slab could be obtained; the 
+    * caller then allocates from the shared heap directly.
+    *------------------------------------------------------------------------*/
+    uint64_t Allocate(size_t size);
+
+    /*-------------------------------------------------------------------------
+    * Returns false if addr was not allocated from this pool.
+    *------------------------------------------------------------------------*/
+    bool     Free(uint64_t addr, size_t size);
+
+    bool     Pooled(size_t size) const { return size > 0 && size <= max_size_; }
+    void     GetStats(Stats& stats) const;
+
+private:
+    struct Slab
+    {
+        uint64_t              base;
+        uint32_t              num_slots;
+        std::atomic<int32_t>  num_free;
+        std::atomic<uint64_t> free_mask[BUFFER_POOL_SLAB_WORDS];
+    };
+
+    struct SizeClass
+    {
+        std::atomic<uint32_t> num_slabs;
+        std::atomic<Slab*>    slabs[BUFFER_POOL_MAX_SLABS];
+    };
+
+    uint32_t SizeClassOf(size_t size) const;
+    uint64_t Claim(Slab* slab, uint32_t slot_shift);
+    Slab*    Grow(uint32_t cls, uint32_t seen_slabs);
+
+    SharedMemory*         shm_;
+    size_t                max_size_;
+    SizeClass             classes_[BUFFER_POOL_NUM_CLASSES];
+
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> slab_bytes_;
+    std::atomic<uint64_t> slot_bytes_;
+    std::atomic<uint64_t> used_bytes_;
+
+    BufferPool(const BufferPool&) =delete;
+    BufferPool& operator=(const BufferPool&) =delete;
+};
+
+}
+
+#endif // _BUFFER_POOL_H
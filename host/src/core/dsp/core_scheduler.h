@@ -30,8 +30,10 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <time.h>
 
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <iostream>
 
@@ -41,18 +43,30 @@
 
 #define CORE_SCHEDULER_DEFAULT_DEPTH    4
 
+/*-----------------------------------------------------------------------------
+* Moving average weight of a new runtime sample is 1/2^SHIFT
+*----------------------------------------------------------------------------*/
+#define CORE_SCHEDULER_AVERAGE_SHIFT    3
+
 /******************************************************************************
-* CoreScheduler :
+* CoreScheduler : places out-of-order tasks on the cores of a device.
+*   LEAST_LOADED    : core with the fewest outstanding tasks
+*   EARLIEST_FINISH : core with the earliest projected finish time, based on
+*                     a moving average of the runtime of each kernel
 ******************************************************************************/
 class CoreScheduler : public Lockable
 {
 public:
-    CoreScheduler(DSPCoreSet& compute_units, uint32_t depth)
-        : depth_(depth)
+    enum class Policy { LEAST_LOADED = 0, EARLIEST_FINISH = 1 };
+
+    CoreScheduler(DSPCoreSet& compute_units, uint32_t depth,
+                  Policy policy = Policy::LEAST_LOADED)
+        : depth_(depth), policy_(policy)
     {
         for (auto & core : compute_units)
         {
             count_[uint32_t(core)] = 0;
+            last_done_us_[uint32_t(core)] = 0;
         }
     }
 
@@ -76,6 +90,38 @@ public:
         return core;
     }
 
+    /*-------------------------------------------------------------------------
+    * allocate a core for task trans_id running kernel kernel_key. The task
+    * must be returned with free(core, trans_id) so that its runtime is
+    * accounted for.
+    *------------------------------------------------------------------------*/
+    uint32_t allocate(const DSPCoreSet& compute_units,
+                      uint32_t kernel_key, uint32_t trans_id)
+    {
+        Lock lock(this);
+        assert(compute_units.size() > 0);
+        while (!any_core_available(compute_units)) cv_.wait(lock.raw());
+
+        uint64_t now = now_us();
+        uint32_t core = (policy_ == Policy::EARLIEST_FINISH)
+                        ? core_select_earliest_finish(compute_units, now)
+                        : core_select(compute_units);
+        core_reserve(core);
+
+        Task task = { trans_id, kernel_key, estimate(kernel_key), now };
+        tasks_[core].push_back(task);
+        return core;
+    }
+
+    /*-------------------------------------------------------------------------
+    * whether allocate(compute_units, ...) can return without waiting
+    *------------------------------------------------------------------------*/
+    bool available(const DSPCoreSet& compute_units)
+    {
+        Lock lock(this);
+        return any_core_available(compute_units);
+    }
+
     /*-------------------------------------------------------------------------
     * allocate a particular core
     *------------------------------------------------------------------------*/
@@ -99,14 +145,60 @@ public:
         cv_.notify_one();
     }
 
+    /*-------------------------------------------------------------------------
+    * free a core after task trans_id completed on it, and update the runtime
+    * average of its kernel
+    *------------------------------------------------------------------------*/
+    void free(uint32_t core, uint32_t trans_id)
+    {
+        Lock lock(this);
+        assert(count_.find(core) != count_.end());
+        task_done(core, trans_id, now_us());
+        core_release(core);
+        cv_.notify_one();
+    }
+
+    /*-------------------------------------------------------------------------
+    * Change the policy and the number of outstanding tasks per core
+    *------------------------------------------------------------------------*/
+    void configure(Policy policy, uint32_t depth)
+    {
+        Lock lock(this);
+        assert(depth > 0);
+        policy_ = policy;
+        depth_  = depth;
+        cv_.notify_all();
+    }
+
+    Policy   policy()   { Lock lock(this); return policy_; }
+    uint32_t depth()    { Lock lock(this); return depth_;  }
+
     /*-------------------------------------------------------------------------
     * Class private data and functions
     *------------------------------------------------------------------------*/
 private:
+    struct Task
+    {
+        uint32_t trans_id;
+        uint32_t kernel_key;
+        uint64_t estimate_us;
+        uint64_t dispatch_us;
+    };
+
     uint32_t                  depth_;
+    Policy                    policy_;
     std::map<uint32_t, int>   count_;
     CondVar                   cv_;
 
+    /*------------------------------------------------------------------------
+    * Outstanding tasks per core in dispatch order (a core runs the tasks in
+    * its mailbox in order), completion time of the last task on each core,
+    * and runtime average per kernel
+    *-----------------------------------------------------------------------*/
+    std::map<uint32_t, std::deque<Task>> tasks_;
+    std::map<uint32_t, uint64_t>         last_done_us_;
+    std::map<uint32_t, uint64_t>         average_us_;
+
     /*------------------------------------------------------------------------
     * These are only called from public member functions who have already
     * locked a mutex, so no mutex locking is needed here.
@@ -138,6 +230,87 @@ private:
         }
         return min_core;
     }
+
+    /*------------------------------------------------------------------------
+    * Pick the available core whose outstanding tasks are projected to finish
+    * first. The task at the head of a core started when it was dispatched
+    * or when the previous task on that core completed, whichever is later.
+    * Ties go to the core with the fewest outstanding tasks.
+    *-----------------------------------------------------------------------*/
+    uint32_t core_select_earliest_finish(const DSPCoreSet& compute_units,
+                                         uint64_t now)
+    {
+        uint32_t min_core   = core_select(compute_units);
+        uint64_t min_finish = UINT64_MAX;
+        for (auto & c : compute_units)
+        {
+            uint32_t core = (uint32_t) c;
+            if (!core_available(core))  continue;
+
+            uint64_t finish = now;
+            std::deque<Task>& tasks = tasks_[core];
+            if (!tasks.empty())
+            {
+                uint64_t start = std::max(tasks.front().dispatch_us,
+                                          last_done_us_[core]);
+                finish = std::max(start + tasks.front().estimate_us, now);
+                for (size_t i = 1; i < tasks.size(); i++)
+                    finish += tasks[i].estimate_us;
+            }
+
+            if (finish < min_finish ||
+                (finish == min_finish && count_[core] < count_[min_core]))
+            {
+                min_finish = finish;
+                min_core   = core;
+            }
+        }
+        return min_core;
+    }
+
+    /*------------------------------------------------------------------------
+    * Unknown kernels are assumed to take as long as the average known kernel
+    *-----------------------------------------------------------------------*/
+    uint64_t estimate(uint32_t kernel_key)
+    {
+        auto it = average_us_.find(kernel_key);
+        if (it != average_us_.end())  return it->second;
+        if (average_us_.empty())      return 0;
+
+        uint64_t sum = 0;
+        for (auto & avg : average_us_)  sum += avg.second;
+        return sum / average_us_.size();
+    }
+
+    void task_done(uint32_t core, uint32_t trans_id, uint64_t now)
+    {
+        std::deque<Task>& tasks = tasks_[core];
+        auto it = std::find_if(tasks.begin(), tasks.end(),
+                           [trans_id](const Task& t)
+                           { return t.trans_id == trans_id; });
+        if (it == tasks.end())  return;
+
+        uint64_t start   = std::max(it->dispatch_us, last_done_us_[core]);
+        uint64_t runtime = (now > start) ? now - start : 0;
+        last_done_us_[core] = now;
+
+        auto avg = average_us_.find(it->kernel_key);
+        if (avg == average_us_.end())
+            average_us_[it->kernel_key] = runtime;
+        else
+            avg->second += ((int64_t) runtime - (int64_t) avg->second)
+                           / (1 << CORE_SCHEDULER_AVERAGE_SHIFT);
+
+        tasks.erase(it);
+    }
+
+    static uint64_t now_us()
+    {
+        struct timespec tp;
+        if (clock_gettime(CLOCK_MONOTONIC, &tp) != 0)
+            clock_gettime(CLOCK_REALTIME, &tp);
+        return (uint64_t) tp.tv_sec * 1000000 + tp.tv_nsec / 1000;
+    }
 };
 
 #endif //_CORE_SCHEDULER_H
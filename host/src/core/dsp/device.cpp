@@ -153,7 +153,8 @@ DSPDevice::~DSPDevice()
 * DeviceBuffer *DSPDevice::createDeviceBuffer(MemObject *buffer)
 ******************************************************************************/
 DeviceBuffer *DSPDevice::createDeviceBuffer(MemObject *buffer, cl_int *rs)
-    { return (DeviceBuffer *)new DSPBuffer(p_shmHandler, buffer, rs); }
+    { return (DeviceBuffer *)new DSPBuffer(p_shmHandler, buffer, rs,
+                                           placement()); }
 
 /******************************************************************************
 * DeviceProgram *DSPDevice::createDeviceProgram(Program *program)
@@ -189,6 +190,8 @@ cl_int DSPDevice::initEventDeviceData(Event* event)
                     break;
                 }
                 DSPBuffer*      buf  = (DSPBuffer*) e->buffer()->deviceBuffer(this);
+                // Pinned until UnmapMemObject, host_addr aliases the buffer
+                buf->pin();
                 DSPDevicePtr64  data = buf->data() + e->offset();
                 // DO NOT INVALIDATE! Here only initializes host_addr, it cannot
                 // be used before MapBuffer event is scheduled and processed!
@@ -198,7 +201,7 @@ cl_int DSPDevice::initEventDeviceData(Event* event)
                 // (main thread) Retain this event, to be saved in buffer mapped
                 // events, and later to be released by UnmapMemObject()
                 if (host_addr != NULL) clRetainEvent(desc(e));
-                else                   ret_code = CL_MAP_FAILURE;
+                else { buf->unpin();   ret_code = CL_MAP_FAILURE; }
                 break;
             }
         case Event::MapImage: break;
@@ -245,6 +248,83 @@ void DSPDevice::freeEventDeviceData(Event* event)
     }
 }
 
+/******************************************************************************
+* bool DSPDevice::chainEvents(Event *predecessor, Event *event)
+*   Two NDRange kernels sent to the same cores, which receive them in order.
+*   The cores start event once all of them are done with predecessor, see
+*   wait_for_chained_kernel() in the monitor.
+******************************************************************************/
+bool DSPDevice::chainEvents(Event* predecessor, Event* event)
+{
+    if (chain_flags() == 0 ||
+        predecessor->type() != Event::NDRangeKernel ||
+        event->type()       != Event::NDRangeKernel)
+        return false;
+
+    // The monitor waits on cores master_core .. master_core + num_cores - 1
+    if (*p_compute_units.rbegin() - *p_compute_units.begin() + 1 !=
+        (int) p_compute_units.size())
+        return false;
+
+    DSPKernelEvent* pred = (DSPKernelEvent*)predecessor->deviceData();
+    DSPKernelEvent* ke   = (DSPKernelEvent*)event->deviceData();
+    if (pred == NULL || ke == NULL || !pred->chainable() || !ke->chainable())
+        return false;
+
+    ke->chain_after(pred);
+    return true;
+}
+
+/******************************************************************************
+* cl_int DSPDevice::recordEventDeviceData(Event *event)
+******************************************************************************/
+cl_int DSPDevice::recordEventDeviceData(Event* event)
+{
+    switch (event->type())
+    {
+        case Event::NDRangeKernel:
+        case Event::TaskKernel:
+            ((DSPKernelEvent*)event->deviceData())->record();
+            break;
+        default: break;
+    }
+    return CL_SUCCESS;
+}
+
+/******************************************************************************
+* cl_int DSPDevice::rearmEventDeviceData(Event *event)
+*   Kernel events keep their marshalled arguments, no need to build them again
+******************************************************************************/
+cl_int DSPDevice::rearmEventDeviceData(Event* event)
+{
+    switch (event->type())
+    {
+        case Event::NDRangeKernel:
+        case Event::TaskKernel:
+            ((DSPKernelEvent*)event->deviceData())->rearm();
+            return CL_SUCCESS;
+        default:
+            return DeviceInterface::rearmEventDeviceData(event);
+    }
+}
+
+/******************************************************************************
+* cl_int DSPDevice::patchEventKernelArg(Event *event, ...)
+******************************************************************************/
+cl_int DSPDevice::patchEventKernelArg(Event* event, cl_uint index,
+                                      const void* value, size_t size)
+{
+    switch (event->type())
+    {
+        case Event::NDRangeKernel:
+        case Event::TaskKernel:
+            return ((DSPKernelEvent*)event->deviceData())->patch_arg(index,
+                                                                 value, size);
+        default:
+            return CL_INVALID_OPERATION;
+    }
+}
+
 /******************************************************************************
 * Getter functions
 ******************************************************************************/
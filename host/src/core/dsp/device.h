@@ -48,6 +48,7 @@ class MemObject;
 class Event;
 class Program;
 class Kernel;
+class MsmcPlacement;
 
 using tiocl::SharedMemory;
 using tiocl::MemoryRange;
@@ -88,6 +89,7 @@ public:
                                        int* retcode = nullptr) = 0;
     virtual void             mail_to(Msg_t& msg,
                                      const DSPCoreSet& compute_units) = 0;
+    virtual void             mail_flush()            = 0;
     virtual int              num_complete_pending()     = 0;
     virtual void             dump_complete_pending()    = 0;
     virtual bool             any_complete_pending()     = 0;
@@ -96,6 +98,13 @@ public:
                                                    unsigned int cnt = 1) = 0;
     virtual bool             get_complete_pending(uint32_t idx,
                                                   class Event*& data) = 0;
+    virtual void             setCoreScheduler(CoreScheduler::Policy policy,
+                                              uint32_t depth) = 0;
+    virtual DSPVirtPtr       chain_flags()              = 0;
+    virtual int              chain_acquire()            = 0;
+    virtual void             chain_retain(int slot)     = 0;
+    virtual void             chain_release(int slot)    = 0;
+    virtual MsmcPlacement*   placement()                = 0;
     virtual pthread_cond_t*  get_worker_cond()          = 0;
     virtual pthread_mutex_t* get_worker_mutex()         = 0;
     virtual float            dspMhz()            const  { return p_dsp_mhz; }
@@ -135,6 +144,11 @@ public:
     void                     recordProfilingData(command_retcode_t*, uint32_t core);
     cl_int                   initEventDeviceData(Event* event);
     void                     freeEventDeviceData(Event* event);
+    bool                     chainEvents(Event* predecessor, Event* event);
+    cl_int                   recordEventDeviceData(Event* event);
+    cl_int                   rearmEventDeviceData(Event* event);
+    cl_int                   patchEventKernelArg(Event* event, cl_uint index,
+                                                 const void* value, size_t size);
     DSPDevicePtr             get_L2_extent(uint32_t& size);
     bool                     isInClMallocedRegion(void* ptr);
 
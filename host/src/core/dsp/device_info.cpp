@@ -37,6 +37,7 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include <sys/stat.h>
 
 #include "../tiocl_thread.h"
@@ -50,6 +51,8 @@
 #include "../error_report.h"
 #include "../oclenv.h"
 #include "device_info.h"
+#include "message.h"
+#include "tal/dsp_emulation.h"
 #ifndef _SYS_BIOS
 #include "../../../mct-daemon/mctd_config.h"
 #endif
@@ -73,13 +76,31 @@ const DeviceInfo& DeviceInfo::Instance ()
 }
 
 DeviceInfo::DeviceInfo()
-:symbol_lookup_(nullptr)
+:emulated_cores_(0), symbol_lookup_(nullptr)
 {
     num_devices_ = 1;
 
+    #if defined(DSP_EMULATION_SUPPORTED)
+    // TI_OCL_DSP_EMULATION is set to the number of DSP cores to emulate.
+    // Emulation only builds have no other DSP, all its cores by default.
+    #if defined(DSP_EMULATION_ONLY)
+    int cores = EnvVar::Instance().GetEnv<
+                         EnvVar::Var::TI_OCL_DSP_EMULATION>(MAX_NUM_CORES);
+    emulated_cores_ = std::max(1, std::min(cores, MAX_NUM_CORES));
+    #else
+    int cores = EnvVar::Instance().GetEnv<
+                                 EnvVar::Var::TI_OCL_DSP_EMULATION>(0);
+    emulated_cores_ = std::max(0, std::min(cores, MAX_NUM_CORES));
+    #endif
+    #endif
+
     #if !defined(_SYS_BIOS)
     // EVE device/program will not use this for symbol lookup
-    symbol_lookup_ = CreateSymbolAddressLookup(FullyQualifiedPathToDspMonitor());
+    if (IsEmulated())
+        symbol_lookup_ = CreateEmulatedSymbolAddressLookup();
+    else
+        symbol_lookup_ = CreateSymbolAddressLookup(
+                                            FullyQualifiedPathToDspMonitor());
     #endif
 
     ComputeUnits_CmemBlocks_Available();
@@ -131,13 +152,28 @@ void DeviceInfo::ComputeUnits_CmemBlocks_Available()
 
     // Linux: from system wide OpenCL configuration,
     //        get cmem blocks, update user compute unit list
+    //        The emulated DSP has neither CMEM blocks nor EVEs
     #if !defined (_SYS_BIOS)
-    MctDaemonConfig oclcfg;
-    cmem_block_offchip_ = oclcfg.GetCmemBlockOffChip();
-    cmem_block_onchip_  = oclcfg.GetCmemBlockOnChip();
-    eve_devices_disable_ = oclcfg.GetEVEDevicesDisable();
+    DSPCoreSet sysdsps;
+    if (IsEmulated())
+    {
+        cmem_block_offchip_  = 0;
+        cmem_block_onchip_   = 0;
+        eve_devices_disable_ = true;
+
+        for (int i = 0; i < emulated_cores_; i++)
+            sysdsps.insert(i);
+    }
+    else
+    {
+        MctDaemonConfig oclcfg;
+        cmem_block_offchip_  = oclcfg.GetCmemBlockOffChip();
+        cmem_block_onchip_   = oclcfg.GetCmemBlockOnChip();
+        eve_devices_disable_ = oclcfg.GetEVEDevicesDisable();
+
+        sysdsps = oclcfg.GetCompUnits();
+    }
 
-    DSPCoreSet sysdsps = oclcfg.GetCompUnits();
     if (comp_unit)
     {
       DSPCoreSet userdsps = available_compute_units_;
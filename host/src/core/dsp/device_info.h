@@ -56,6 +56,9 @@ public:
 
     const DSPCoreSet& GetComputeUnits() const { return available_compute_units_; }
 
+    // True when the DSP is emulated on the host, see tal/dsp_emulation.h
+    bool         IsEmulated() const { return emulated_cores_ > 0; }
+
     static const DeviceInfo& Instance();
 
 private:
@@ -66,6 +69,7 @@ private:
     uint8_t num_devices_;
     uint8_t num_eve_devices_;
     uint8_t num_compute_units_;
+    uint8_t emulated_cores_;
     int32_t cmem_block_offchip_;
     int32_t cmem_block_onchip_;
     bool    eve_devices_disable_;
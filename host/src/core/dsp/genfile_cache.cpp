@@ -26,84 +26,414 @@
  *   THE POSSIBILITY OF SUCH DAMAGE.
  *****************************************************************************/
 #include "genfile_cache.h"
+#include "../oclenv.h"
 
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/IR/Module.h>
 #include <llvm/Bitcode/ReaderWriter.h>
 
-std::string genfile_cache::lookup(const llvm::Module *module,
-                                  const std::string &options)
+#include <boost/uuid/detail/sha1.hpp>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace tiocl;
+
+/*-----------------------------------------------------------------------------
+* Bump GENFILE_CACHE_FORMAT whenever the key or the entry layout changes
+*----------------------------------------------------------------------------*/
+#define GENFILE_CACHE_FORMAT        "3"
+#define GENFILE_CACHE_DEFAULT_SIZE  (64ULL << 20)
+#define GENFILE_CACHE_SUFFIX        ".out"
+#define GENFILE_CACHE_IMAGE_SUFFIX  ".img"
+#define GENFILE_CACHE_STALE_TMP_SEC (60 * 60)
+#define GENFILE_CACHE_PIN_PREFIX    ".pin"
+
+#define STRINGIZE(x) #x
+#define STRINGIZE2(x) STRINGIZE(x)
+
+#if defined(DEVICE_AM57)
+#define GENFILE_CACHE_TARGET "am57"
+#elif defined(DEVICE_K2H)
+#define GENFILE_CACHE_TARGET "k2h"
+#elif defined(DEVICE_K2L)
+#define GENFILE_CACHE_TARGET "k2l"
+#elif defined(DEVICE_K2E)
+#define GENFILE_CACHE_TARGET "k2e"
+#elif defined(DEVICE_K2G)
+#define GENFILE_CACHE_TARGET "k2g"
+#else
+#define GENFILE_CACHE_TARGET "c66x"
+#endif
+
+/******************************************************************************
+* Create dir and any missing parent directories
+******************************************************************************/
+static bool make_dirs(const std::string &dir)
 {
-    uint32_t hash = convert_mod2crc(module, options);
-    return lookup(hash);
+    for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1))
+    {
+        std::string prefix = dir.substr(0, pos);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST)
+            return false;
+        if (pos == std::string::npos) break;
+    }
+    return true;
 }
 
-std::string genfile_cache::lookup(const std::string &source,
-                                  const std::string &options)
+/******************************************************************************
+* $TI_OCL_CACHE_KERNELS_DIR, or the user's cache directory, which unlike
+* /tmp survives a reboot
+******************************************************************************/
+static std::string default_cache_dir()
 {
-    uint32_t hash = convert_src2crc(source, options);
-    return lookup(hash);
+    EnvVar& env = EnvVar::Instance();
+    const char *dir = env.GetEnv<EnvVar::Var::TI_OCL_CACHE_KERNELS_DIR>(
+                                                                    nullptr);
+    if (dir != nullptr && dir[0] != '\0') return std::string(dir);
+
+    const char *xdg  = getenv("XDG_CACHE_HOME");
+    if (xdg  != nullptr && xdg[0] == '/')
+        return std::string(xdg) + "/ti-opencl";
+
+    const char *home = getenv("HOME");
+    if (home != nullptr && home[0] == '/')
+        return std::string(home) + "/.cache/ti-opencl";
+
+    const char *user = getenv("USER");
+    return std::string("/tmp/opencl_cache_") + (user ? user : "");
 }
 
-std::string genfile_cache::lookup(uint32_t hash)
+/******************************************************************************
+* Identity of what the kernels are compiled and linked against, besides the
+* runtime itself: the cl6x version, the C6000 CGT install and the builtins
+* headers and monitor symbols in the OpenCL DSP directory. Files are
+* identified by size and modification time, an update changes either.
+******************************************************************************/
+static std::string file_identity(const std::string &path)
 {
-    std::vector<std::vector<std::string> > result;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return path + ":-;";
 
-    std::string query("select value from programs where hash = " +
-              boost::lexical_cast<std::string>(hash));
+    std::ostringstream id;
+    id << path << ':' << st.st_size << ':' << st.st_mtime << ';';
+    return id.str();
+}
 
-    result = p_database.query(query.c_str());
+static std::string toolchain_identity()
+{
+    std::string id;
 
-    if (!result.empty())
+    FILE *version = popen("cl6x --tool_version 2>/dev/null", "r");
+    if (version != nullptr)
     {
-        string &filename = result[0][0];
+        char buf[256];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), version)) > 0)
+            id.append(buf, n);
+        pclose(version);
+    }
 
-        struct stat statbuf;
-        if (stat(filename.c_str(), &statbuf) == 0)
-            return filename;
-        /*-----------------------------------------------------------------
-        * if (the cached filename no longer exists, remove it from the DB
-        *----------------------------------------------------------------*/
-        else
-        {
-            std::string q2("delete from programs where hash = " +
-                  boost::lexical_cast<std::string>(hash));
+    const char *cgt = getenv("TI_OCL_CGT_INSTALL");
+    id += std::string("cgt:") + (cgt ? cgt : "") + ";";
 
-            p_database.query(q2.c_str());
-            return std::string();
-        }
+    // Same directory as clocl's, see get_ocl_dsp() in clocl/program.cpp
+    EnvVar& env = EnvVar::Instance();
+    const char *ocl_install    = env.GetEnv<
+                                         EnvVar::Var::TI_OCL_INSTALL>(nullptr);
+    const char *target_rootdir = env.GetEnv<
+                                         EnvVar::Var::TARGET_ROOTDIR>(nullptr);
+    std::string ocl_dsp;
+    if (ocl_install)         ocl_dsp = ocl_install;
+    else if (target_rootdir) ocl_dsp = target_rootdir;
+    ocl_dsp += "/usr/share/ti/opencl/";
+
+    static const char *builtins[] = { "clc.h", "clc.h.pch", "dsp.h",
+                                       "dsp_c.h", "dsp.syms" };
+    for (const char *file : builtins)
+        id += file_identity(ocl_dsp + file);
+
+    return id;
+}
+
+genfile_cache::genfile_cache() : p_dir(default_cache_dir()), p_enabled(true)
+{
+    EnvVar& env  = EnvVar::Instance();
+    p_size_limit = env.GetEnv<EnvVar::Var::TI_OCL_CACHE_KERNELS_SIZE>(
+                                                 GENFILE_CACHE_DEFAULT_SIZE);
+
+    if (!make_dirs(p_dir))
+    {
+        std::cerr << "TI_OCL_CACHE_KERNELS: unable to create " << p_dir
+                  << ", kernels are not cached" << std::endl;
+        p_enabled = false;
     }
     else
+        p_toolchain = toolchain_identity();
+}
+
+std::string genfile_cache::lookup(const llvm::Module *module,
+                                  const std::string  &options,
+                                  const std::string  &device)
+{
+    if (!p_enabled) return std::string();
+    return lookup(convert_mod2key(module, options, device),
+                  GENFILE_CACHE_SUFFIX);
+}
+
+std::string genfile_cache::lookup(const std::string &source,
+                                  const std::string &options,
+                                  const std::string &device)
+{
+    if (!p_enabled) return std::string();
+    return lookup(convert_src2key(source, options, device),
+                  GENFILE_CACHE_SUFFIX);
+}
+
+/******************************************************************************
+* A hit refreshes the modification time of the entry, which is what LRU
+* eviction orders by. Binaries are returned pinned, images are opened and
+* mapped right away by the loader, which treats a vanished image as a miss.
+* An entry evicted between the two steps is a miss as well.
+******************************************************************************/
+std::string genfile_cache::lookup(const std::string &key, const char *suffix)
+{
+    std::string filename = entry_path(key, suffix);
+
+    if (utime(filename.c_str(), nullptr) != 0)
         return std::string();
+    if (strcmp(suffix, GENFILE_CACHE_SUFFIX) != 0)
+        return filename;
+    return pin(filename);
 }
 
-void genfile_cache::remember(const char *outfile, const llvm::Module *module,
-                             const std::string &options)
+std::string genfile_cache::remember(const char         *outfile,
+                                    const llvm::Module *module,
+                                    const std::string  &options,
+                                    const std::string  &device)
 {
-    uint32_t hash = convert_mod2crc(module, options);
-    remember(outfile, hash);
+    if (!p_enabled) return std::string(outfile);
+    return remember(outfile, convert_mod2key(module, options, device));
 }
 
-void genfile_cache::remember(const char *outfile, const std::string &source,
-                             const std::string &options)
+std::string genfile_cache::remember(const char        *outfile,
+                                    const std::string &source,
+                                    const std::string &options,
+                                    const std::string &device)
 {
-    uint32_t hash = convert_src2crc(source, options);
-    remember(outfile, hash);
+    if (!p_enabled) return std::string(outfile);
+    return remember(outfile, convert_src2key(source, options, device));
 }
 
-void genfile_cache::remember(const char *outfile, uint32_t hash)
+/******************************************************************************
+* Copy outfile to a temporary file in the cache directory and rename it to
+* its entry. rename() is atomic, so a concurrent lookup finds either the old
+* entry, no entry, or the complete new one.
+******************************************************************************/
+std::string genfile_cache::remember(const char *outfile, const std::string &key)
 {
-    std::string query("insert into programs(hash, value) values("
-                  + boost::lexical_cast<std::string>(hash)
-                  + ", \""
-                  + string(outfile)
-                  + "\");");
+    std::string tmpname = tmpfile();
+    if (tmpname.empty()) return std::string(outfile);
+
+    bool copied = false;
+    {
+        std::ifstream src(outfile, std::ios::binary);
+        std::ofstream dst(tmpname.c_str(), std::ios::binary | std::ios::trunc);
+        if (src.is_open() && dst.is_open())
+        {
+            dst << src.rdbuf();
+            dst.flush();
+            copied = dst.good();
+        }
+    }
 
-    p_database.query(query.c_str());
+    std::string filename = entry_path(key, GENFILE_CACHE_SUFFIX);
+    if (!copied)
+    {
+        unlink(tmpname.c_str());
+        return std::string(outfile);
+    }
+    if (!publish(tmpname, filename)) return std::string(outfile);
+
+    std::string pinned = pin(filename);
+    return pinned.empty() ? std::string(outfile) : pinned;
+}
+
+/******************************************************************************
+* Images are keyed by the binary alone: where its segments were loaded is
+* recorded in the image, and checked by the loader
+******************************************************************************/
+std::string genfile_cache::lookup_image(const std::string &binary)
+{
+    if (!p_enabled) return std::string();
+    return lookup(get_key("img:" + binary, "", ""), GENFILE_CACHE_IMAGE_SUFFIX);
 }
 
-uint32_t genfile_cache::convert_mod2crc(const llvm::Module *module,
-                                        const std::string  &options)
+std::string genfile_cache::image_tmpfile()
+{
+    if (!p_enabled) return std::string();
+    return tmpfile();
+}
+
+bool genfile_cache::remember_image(const std::string &tmpname,
+                                   const std::string &binary)
+{
+    std::string filename = entry_path(get_key("img:" + binary, "", ""),
+                                      GENFILE_CACHE_IMAGE_SUFFIX);
+    return publish(tmpname, filename);
+}
+
+/******************************************************************************
+* Temporary files are created in the cache directory so that rename() can
+* publish them
+******************************************************************************/
+std::string genfile_cache::tmpfile()
+{
+    std::string tmpname(p_dir + "/.tmpXXXXXX");
+    std::vector<char> tmpl(tmpname.begin(), tmpname.end());
+    tmpl.push_back('\0');
+
+    int fd = mkstemp(tmpl.data());
+    if (fd < 0) return std::string();
+    close(fd);
+    return std::string(tmpl.data());
+}
+
+/******************************************************************************
+* Hard link filename to a name private to this process. The pid in the name
+* tells eviction whether the owner is still alive. A pin with the same name
+* can only be left by an exited process whose pid was reused.
+******************************************************************************/
+std::string genfile_cache::pin(const std::string &filename)
+{
+    static unsigned int counter = 0;
+
+    std::ostringstream name;
+    name << p_dir << "/" GENFILE_CACHE_PIN_PREFIX << getpid() << "-"
+         << __sync_fetch_and_add(&counter, 1);
+    std::string pinname = name.str();
+
+    if (link(filename.c_str(), pinname.c_str()) != 0)
+    {
+        if (errno != EEXIST) return std::string();
+        unlink(pinname.c_str());
+        if (link(filename.c_str(), pinname.c_str()) != 0)
+            return std::string();
+    }
+    return pinname;
+}
+
+bool genfile_cache::publish(const std::string &tmpname,
+                            const std::string &filename)
+{
+    if (rename(tmpname.c_str(), filename.c_str()) != 0)
+    {
+        unlink(tmpname.c_str());
+        return false;
+    }
+
+    evict(filename);
+    return true;
+}
+
+/******************************************************************************
+* Remove least recently used entries until the cache fits in its size limit.
+* Other processes may be evicting at the same time, so entries that are
+* already gone are simply skipped. Temporary files left behind by processes
+* that died while copying are removed once they are old enough, pins once
+* their process has exited. Pins are not counted: they only share the data
+* of entries. The entry that was just added is kept even if it alone exceeds
+* the limit.
+******************************************************************************/
+void genfile_cache::evict(const std::string &keep)
+{
+    DIR *dir = opendir(p_dir.c_str());
+    if (dir == nullptr) return;
+
+    typedef std::pair<time_t, std::pair<std::string, uint64_t> > Entry;
+    std::vector<Entry> entries;
+    uint64_t           total = 0;
+    time_t             now   = time(nullptr);
+    size_t             suffix_len = sizeof(GENFILE_CACHE_SUFFIX) - 1;
+    static_assert(sizeof(GENFILE_CACHE_SUFFIX) ==
+                  sizeof(GENFILE_CACHE_IMAGE_SUFFIX),
+                  "entry suffixes must have the same length");
+
+    while (struct dirent *dent = readdir(dir))
+    {
+        std::string name(dent->d_name);
+        std::string path(p_dir + "/" + name);
+        struct stat statbuf;
+        if (stat(path.c_str(), &statbuf) != 0 || !S_ISREG(statbuf.st_mode))
+            continue;
+
+        if (name.compare(0, sizeof(GENFILE_CACHE_PIN_PREFIX) - 1,
+                         GENFILE_CACHE_PIN_PREFIX) == 0)
+        {
+            pid_t pid = (pid_t) strtol(name.c_str() +
+                               sizeof(GENFILE_CACHE_PIN_PREFIX) - 1, nullptr, 10);
+            if (pid > 0 && kill(pid, 0) != 0 && errno == ESRCH)
+                unlink(path.c_str());
+            continue;
+        }
+
+        if (name.compare(0, 4, ".tmp") == 0)
+        {
+            if (now - statbuf.st_mtime > GENFILE_CACHE_STALE_TMP_SEC)
+                unlink(path.c_str());
+            continue;
+        }
+
+        if (name.size() <= suffix_len ||
+            (name.compare(name.size() - suffix_len, suffix_len,
+                          GENFILE_CACHE_SUFFIX) != 0 &&
+             name.compare(name.size() - suffix_len, suffix_len,
+                          GENFILE_CACHE_IMAGE_SUFFIX) != 0))
+            continue;
+
+        entries.push_back(Entry(statbuf.st_mtime,
+                                std::make_pair(path, statbuf.st_size)));
+        total += statbuf.st_size;
+    }
+    closedir(dir);
+
+    if (total <= p_size_limit) return;
+
+    std::sort(entries.begin(), entries.end());
+    for (auto &entry : entries)
+    {
+        if (total <= p_size_limit) break;
+        if (entry.second.first == keep) continue;
+        unlink(entry.second.first.c_str());
+        total -= entry.second.second;
+    }
+}
+
+std::string genfile_cache::entry_path(const std::string &key,
+                                      const char *suffix) const
+{
+    return p_dir + "/" + key + suffix;
+}
+
+std::string genfile_cache::convert_mod2key(const llvm::Module *module,
+                                           const std::string  &options,
+                                           const std::string  &device)
 {
     std::string llvm_ir;
 
@@ -111,22 +441,47 @@ uint32_t genfile_cache::convert_mod2crc(const llvm::Module *module,
     llvm::WriteBitcodeToFile(module, ostream);
     ostream.str();
 
-    llvm_ir += options;
-
-    return get_crc(llvm_ir);
+    return get_key("bc:" + llvm_ir, options, device);
 }
 
-uint32_t genfile_cache::convert_src2crc(const std::string &source,
-                                        const std::string &options)
+std::string genfile_cache::convert_src2key(const std::string &source,
+                                           const std::string &options,
+                                           const std::string &device)
 {
-    std::string source_options = source + options;
-    return get_crc(source_options);
+    return get_key("cl:" + source, options, device);
 }
 
-uint32_t genfile_cache::get_crc(const std::string& my_string)
+/******************************************************************************
+* SHA-1 over the length prefixed fields, so that moving text between fields
+* cannot produce the same key
+******************************************************************************/
+static void hash_field(boost::uuids::detail::sha1 &sha,
+                       const std::string &field)
 {
-    boost::crc_32_type result;
-    result.process_bytes(my_string.data(), my_string.length());
-    return result.checksum();
+    uint64_t size = field.size();
+    sha.process_bytes(&size, sizeof(size));
+    sha.process_bytes(field.data(), field.size());
 }
 
+std::string genfile_cache::get_key(const std::string &content,
+                                   const std::string &options,
+                                   const std::string &device)
+{
+    boost::uuids::detail::sha1 sha;
+    hash_field(sha, GENFILE_CACHE_FORMAT);
+    hash_field(sha, STRINGIZE2(_PRODUCT_VERSION));
+    hash_field(sha, p_toolchain);
+    hash_field(sha, GENFILE_CACHE_TARGET);
+    hash_field(sha, device);
+    hash_field(sha, options);
+    hash_field(sha, content);
+
+    boost::uuids::detail::sha1::digest_type digest;
+    sha.get_digest(digest);
+
+    std::ostringstream key;
+    key << std::hex << std::setfill('0');
+    for (size_t i = 0; i < sizeof(digest) / sizeof(digest[0]); i++)
+        key << std::setw(2 * sizeof(digest[0])) << (uint32_t) digest[i];
+    return key.str();
+}
@@ -33,31 +33,71 @@ namespace llvm
     class Module;
 }
 
-#include <boost/lexical_cast.hpp>
-#include <boost/crc.hpp>
-
-#include <sys/stat.h>
-
 #include <string>
-#include <iostream>
-#include <sstream>
-#include <vector>
 #include <stdint.h>
 #include "u_locks_pthread.h"
-#include "database.h"
 
+/******************************************************************************
+* genfile_cache : persistent cache of compiled program binaries.
+*   Each binary is a file named after the SHA-1 of everything that determines
+*   it: the source or bitcode, the options, the device, the runtime and
+*   cl6x versions, and the builtins headers. Entries are published with
+*   rename() so that processes sharing the directory never see partial
+*   files. The last use of an entry is its modification time, and the least
+*   recently used entries are evicted when the cache grows beyond its size
+*   limit.
+*
+*   Relocated program images (see tal/program_image.h) are kept alongside,
+*   named after the SHA-1 of the binary they were loaded from, and share the
+*   size limit.
+*
+*   Another process may evict an entry between its lookup and its use, so
+*   binaries are handed out as private hard links to their entries (pins).
+*   A pin keeps the file alive until its owner removes it. Pins left behind
+*   by processes that exited are removed by eviction.
+******************************************************************************/
 class genfile_cache
 {
   public:
+    /*-------------------------------------------------------------------------
+    * Pin of the cached binary, or an empty string on a miss. The caller owns
+    * the returned file and removes it when done with it.
+    *------------------------------------------------------------------------*/
     std::string lookup   (const llvm::Module *module,
-                          const std::string &options);
+                          const std::string  &options,
+                          const std::string  &device);
     std::string lookup   (const std::string  &source,
-                          const std::string &options);
+                          const std::string  &options,
+                          const std::string  &device);
+
+    /*-------------------------------------------------------------------------
+    * Copy outfile into the cache, returns a pin of the cached copy or
+    * outfile if it could not be cached. As with lookup, the caller owns the
+    * returned file.
+    *------------------------------------------------------------------------*/
+    std::string remember (const char         *outfile,
+                          const llvm::Module *module,
+                          const std::string  &options,
+                          const std::string  &device);
+    std::string remember (const char         *outfile,
+                          const std::string  &source,
+                          const std::string  &options,
+                          const std::string  &device);
 
-    void        remember (const char   *outfile, const llvm::Module *module,
-                          const std::string  &options);
-    void        remember (const char   *outfile, const std::string  &source,
-                          const std::string &options);
+    /*-------------------------------------------------------------------------
+    * Path of the relocated image of binary, or an empty string if there is
+    * none
+    *------------------------------------------------------------------------*/
+    std::string lookup_image  (const std::string  &binary);
+
+    /*-------------------------------------------------------------------------
+    * Create an empty temporary file in the cache directory to write an image
+    * into, returns its path or an empty string. remember_image publishes the
+    * complete file as the image of binary, or removes it.
+    *------------------------------------------------------------------------*/
+    std::string image_tmpfile ();
+    bool        remember_image(const std::string  &tmpname,
+                               const std::string  &binary);
 
     /*-------------------------------------------------------------------------
     * Thread safe instance function for singleton behavior
@@ -76,8 +116,7 @@ class genfile_cache
             tmp = pInstance;
             if (tmp == 0)
             {
-                char *user = getenv("USER");
-                tmp = new genfile_cache("/tmp/opencl_ofdb_" + string(user));
+                tmp = new genfile_cache();
                 __sync_synchronize();
                 pInstance = tmp;
             }
@@ -88,24 +127,33 @@ class genfile_cache
 
   private:
     static genfile_cache* pInstance;
-    std::string p_dbname;
-    Database    p_database;
+    std::string p_dir;
+    std::string p_toolchain;     // see toolchain_identity()
+    uint64_t    p_size_limit;
+    bool        p_enabled;
 
   private:
-    genfile_cache(std::string db_name) :
-                            p_dbname(db_name), p_database(db_name.c_str())
-    {
-        p_database.query("create table if not exists "
-                "programs(hash integer, value string);");
-    }
-
-    std::string lookup          (uint32_t hash);
-    void        remember        (const char *outfile, uint32_t hash);
-    uint32_t    convert_mod2crc (const llvm::Module *module,
-                                 const std::string &options);
-    uint32_t    convert_src2crc (const std::string  &source,
-                                 const std::string &options);
-    uint32_t    get_crc         (const std::string& my_string);
+    genfile_cache();
+
+    std::string lookup          (const std::string &key,
+                                 const char *suffix);
+    std::string remember        (const char *outfile, const std::string &key);
+    std::string tmpfile         ();
+    std::string pin             (const std::string &filename);
+    bool        publish         (const std::string &tmpname,
+                                 const std::string &filename);
+    void        evict           (const std::string &keep);
+    std::string entry_path      (const std::string &key,
+                                 const char *suffix) const;
+    std::string convert_mod2key (const llvm::Module *module,
+                                 const std::string  &options,
+                                 const std::string  &device);
+    std::string convert_src2key (const std::string  &source,
+                                 const std::string  &options,
+                                 const std::string  &device);
+    std::string get_key         (const std::string  &content,
+                                 const std::string  &options,
+                                 const std::string  &device);
 
     genfile_cache(const genfile_cache&);              // copy ctor disallowed
     genfile_cache& operator=(const genfile_cache&);   // assignment disallowed
@@ -44,6 +44,7 @@
 #include <unordered_set>
 #include <iostream>
 #include <iomanip>
+#include "heap_manager_fit.h"
 
 const size_t HEAP_MANAGER_DEFAULT_SIZE = (128 << 10);
 
@@ -72,9 +73,21 @@ namespace utility {
 *
 *    typedef HeapManager<Address, Length, MultiThread<Address,Length>> DdrHeap;
 *    DdrHeap* ddr_heap= new DdrHeap;
+*
+* The optional Fit argument selects how a free block is found for an 
+* allocation, FirstFit (the default) or SegregatedFit.  See heap_manager_fit.h.
+*
+*    typedef HeapManager<Address, Length, MultiThread<Address,Length>,
+*                        SegregatedFit> DdrHeap;
+*
+* The free block index of the Fit policy is a private base class.  FirstFit's
+* is empty, so a FirstFit HeapManager has the same layout as one without the
+* Fit argument; heaps in shared memory are also used by ti-mctd.
 * 
 *----------------------------------------------------------------------------*/
-template <typename Address, typename Length, typename Scope> class HeapManager
+template <typename Address, typename Length, typename Scope, 
+          typename Fit = FirstFit> class HeapManager :
+    private Fit::template Index<Address, Length, Scope>
 {
   public:
 
@@ -86,11 +99,13 @@ template <typename Address, typename Length, typename Scope> class HeapManager
     typedef typename Scope::FreeMapAllocator  FreeMapAllocator;
     typedef typename Scope::AllocBlockList    AllocBlockList;
     typedef typename Scope::FreeBlockList     FreeBlockList;
+    typedef typename Fit::template Index<Address, Length, Scope> FreeIndex;
   
     /*-------------------------------------------------------------------------
     * CTOR - Used for Scope = MultiProcess
     *------------------------------------------------------------------------*/
     HeapManager (const ManagedMemory& segment) :
+       FreeIndex                   (segment.get_segment_manager()),
        alloc_map_allocator_        (segment.get_segment_manager()),
        free_map_allocator_         (segment.get_segment_manager()),
        free_list_                  (std::less<Address>(), free_map_allocator_),
@@ -106,6 +121,7 @@ template <typename Address, typename Length, typename Scope> class HeapManager
     * CTOR - Used for Scope = MultiThread
     *------------------------------------------------------------------------*/
     HeapManager () :
+       FreeIndex                       (),
        alloc_map_allocator_            (),
        free_map_allocator_             (),
        free_list_                      (),
@@ -147,10 +163,12 @@ template <typename Address, typename Length, typename Scope> class HeapManager
             /*-----------------------------------------------------------------
             * Find a free block large enough to accomodate this allocation 
             *----------------------------------------------------------------*/
-            for (auto& kv : free_list_)
+            auto kv = free_index().find(free_list_, size, align);
+
+            if (kv != free_list_.end())
             {
-                Address avail_addr = kv.first;
-                Length  avail_size = kv.second;
+                Address avail_addr = kv->first;
+                Length  avail_size = kv->second;
 
                 Address align_addr = roundup(avail_addr, (Address)align);
                 Length  align_gap  = align_addr - avail_addr;
@@ -158,23 +176,21 @@ template <typename Address, typename Length, typename Scope> class HeapManager
                 /*-------------------------------------------------------------
                 * Adjust avail_size for any alignment gap
                 *------------------------------------------------------------*/
-                if (align_gap < avail_size) avail_size -= align_gap;
-                else                        avail_size = 0;
-
+                avail_size -= align_gap;
                 avail_addr  = align_addr;
 
-                /*-------------------------------------------------------------
-                * if this free block will not satisfy the request, keep looking
-                *------------------------------------------------------------*/
-                if (avail_size < size) continue;
-
                 /*-------------------------------------------------------------
                 * if there is unused space at the beginning of this free block
                 * due to alignment restrictions, then update this free block,
                 * otherwise remove this free block from the list.
                 *------------------------------------------------------------*/
-                if (align_gap) kv.second = align_gap;
-                else           free_list_.erase(kv.first);
+                free_index().erase(kv->first, kv->second);
+                if (align_gap) 
+                {
+                    kv->second = align_gap;
+                    free_index().insert(kv->first, align_gap);
+                }
+                else free_list_.erase(kv);
 
                 /*-------------------------------------------------------------
                 * add the allocated block to the alloc_list
@@ -187,7 +203,10 @@ template <typename Address, typename Length, typename Scope> class HeapManager
                 * Add that back to the free list.
                 *------------------------------------------------------------*/
                 if (avail_size > size)
+                {
                     free_list_[avail_addr + size] = avail_size - size;
+                    free_index().insert(avail_addr + size, avail_size - size);
+                }
 
                 available_ -= size;
 
@@ -259,13 +278,30 @@ template <typename Address, typename Length, typename Scope> class HeapManager
             * a separate block in the free list and no space indicates a merged
             * block
             *----------------------------------------------------------------*/
-            bool can_merge_prior = ((prior_block->first + prior_block->second)
+            bool can_merge_prior = (prior_block != free_list_.end() &&
+                                    (prior_block->first + prior_block->second)
                                      == addr);
-            bool can_merge_after = (addr + size == after_block->first);
+            bool can_merge_after = (after_block != free_list_.end() &&
+                                    addr + size == after_block->first);
+
+            if (can_merge_after) 
+            {
+                size += after_block->second;
+                free_index().erase(after_block->first, after_block->second);
+            }
+
+            if (can_merge_prior) 
+            {
+                free_index().erase(prior_block->first, prior_block->second);
+                prior_block->second += size;
+                free_index().insert(prior_block->first, prior_block->second);
+            }
+            else 
+            {
+                free_list_[addr] = size;
+                free_index().insert(addr, size);
+            }
 
-            if (can_merge_after) size += after_block->second;
-            if (can_merge_prior) prior_block->second += size;
-            else                 free_list_[addr] = size;
             if (can_merge_after) free_list_.erase(after_block);
 
             return 0;
@@ -302,16 +338,11 @@ template <typename Address, typename Length, typename Scope> class HeapManager
         {
             ScopedLock lock(mutex_);
 
-            for (const auto& kv : free_list_)
+            auto kv = free_index().largest(free_list_);
+            if (kv != free_list_.end())
             {
-                Address avail_addr = kv.first;
-                Length  avail_size = kv.second;
-
-                if (avail_size >= max_avail_size)
-                {
-                    max_avail_addr = avail_addr;
-                    max_avail_size = avail_size;
-                }
+                max_avail_addr = kv->first;
+                max_avail_size = kv->second;
             }
 
             size = max_avail_size;
@@ -371,6 +402,7 @@ template <typename Address, typename Length, typename Scope> class HeapManager
                 start_addr_            = start_addr;
                 min_block_size_        = min_block_size;
                 free_list_[start_addr] = length;
+                free_index().insert(start_addr, length);
             }
         }
 
@@ -514,6 +546,11 @@ template <typename Address, typename Length, typename Scope> class HeapManager
     Length            max_pow2_size_alignment_;
     Mutex             mutex_;
 
+    /*-------------------------------------------------------------------------
+    * free_index - the free block index of the Fit policy
+    *------------------------------------------------------------------------*/
+    FreeIndex& free_index() { return *this; }
+
     /*-------------------------------------------------------------------------
     * min_block_size - all allocations are at least the minimum block size
     *------------------------------------------------------------------------*/
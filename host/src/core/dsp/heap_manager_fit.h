@@ -0,0 +1,160 @@
+/******************************************************************************
+ * Copyright (c) 2013-2016, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+/**************************************************************************//**
+*  @file    heap_manager_fit.h
+*
+*  @brief   Defines the free block search engines used by HeapManager.
+*           FirstFit walks the address ordered free list.  SegregatedFit
+*           additionally keeps the free blocks binned by size so that an
+*           allocation does not need to visit every free block.
+*
+*  @version 2.00.00
+*
+******************************************************************************/
+#ifndef HEAP_MANAGER_FIT_H_
+#define HEAP_MANAGER_FIT_H_
+
+#include <utility>
+
+namespace utility { 
+
+/*-----------------------------------------------------------------------------
+* fits - Can a free block at addr of length avail hold size bytes aligned 
+*    to align?  align must be a power of two.
+*----------------------------------------------------------------------------*/
+template <typename Address, typename Length> 
+inline bool fits(Address addr, Length avail, Length size, Length align)
+{
+    Address align_addr = (addr + align - 1) & ~((Address)align - 1);
+    Length  align_gap  = align_addr - addr;
+
+    return (align_gap < avail && avail - align_gap >= size);
+}
+
+/*-----------------------------------------------------------------------------
+* FirstFit - Engine policy for HeapManager. Allocations are satisfied from 
+*    the lowest addressed free block that is large enough.  No additional 
+*    state is kept, so the cost of an allocation grows with the number of 
+*    free blocks.
+*----------------------------------------------------------------------------*/
+struct FirstFit
+{
+    template <typename Address, typename Length, typename Scope> class Index
+    {
+      public:
+        typedef typename Scope::FreeBlockList FreeBlockList;
+        typedef typename FreeBlockList::iterator iterator;
+
+        template <typename SegmentManager> Index(SegmentManager) {}
+        Index() {}
+
+        void insert(Address, Length) {}
+        void erase (Address, Length) {}
+
+        iterator find(FreeBlockList& free_list, Length size, Length align)
+        {
+            for (auto it = free_list.begin(); it != free_list.end(); ++it)
+                if (fits(it->first, it->second, size, align)) return it;
+
+            return free_list.end();
+        }
+
+        iterator largest(FreeBlockList& free_list)
+        {
+            auto max_it = free_list.end();
+            for (auto it = free_list.begin(); it != free_list.end(); ++it)
+                if (max_it == free_list.end() || it->second >= max_it->second)
+                    max_it = it;
+
+            return max_it;
+        }
+    };
+};
+
+/*-----------------------------------------------------------------------------
+* SegregatedFit - Engine policy for HeapManager. Free blocks are additionally
+*    kept in an index ordered by (size, address).  Since all block sizes are
+*    multiples of the heap's minimum block size, each distinct size is its 
+*    own size class bin and the blocks of a bin are ordered by address.  An 
+*    allocation starts at the smallest bin that can hold the request and 
+*    takes the lowest addressed block that fits, so small requests are 
+*    satisfied from small holes and large blocks are kept whole.
+*
+*    The address ordered free list is still maintained by HeapManager, so 
+*    coalescing on free is unchanged; the index only needs to be told about
+*    blocks entering and leaving the free list.
+*----------------------------------------------------------------------------*/
+struct SegregatedFit
+{
+    template <typename Address, typename Length, typename Scope> class Index
+    {
+      public:
+        typedef typename Scope::FreeBlockList FreeBlockList;
+        typedef typename FreeBlockList::iterator iterator;
+        typedef typename Scope::SizeIndexAllocator SizeIndexAllocator;
+        typedef typename Scope::SizeIndex SizeIndex;
+        typedef std::pair<Length, Address> Entry;
+
+        template <typename SegmentManager> Index(SegmentManager segment) :
+            size_index_(std::less<Entry>(), SizeIndexAllocator(segment)) {}
+        Index() : size_index_() {}
+
+        void insert(Address addr, Length size) 
+            { size_index_.insert(Entry(size, addr)); }
+
+        void erase(Address addr, Length size)  
+            { size_index_.erase(Entry(size, addr)); }
+
+        iterator find(FreeBlockList& free_list, Length size, Length align)
+        {
+            /*-----------------------------------------------------------------
+            * Walk up from the smallest bin that can hold size bytes.  The 
+            * first block is taken unless an alignment gap makes it too small.
+            *----------------------------------------------------------------*/
+            for (auto it  = size_index_.lower_bound(Entry(size, 0));
+                      it != size_index_.end(); ++it)
+                if (fits(it->second, it->first, size, align))
+                    return free_list.find(it->second);
+
+            return free_list.end();
+        }
+
+        iterator largest(FreeBlockList& free_list)
+        {
+            if (size_index_.empty()) return free_list.end();
+            return free_list.find(size_index_.rbegin()->second);
+        }
+
+      private:
+        SizeIndex size_index_;
+    };
+};
+
+} // end namespace utility
+
+#endif // HEAP_MANAGER_FIT_H_
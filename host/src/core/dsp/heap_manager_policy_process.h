@@ -43,6 +43,7 @@
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/allocators/allocator.hpp>
 #include <boost/interprocess/containers/map.hpp>
+#include <boost/interprocess/containers/set.hpp>
 
 namespace utility { 
 
@@ -52,6 +53,15 @@ namespace utility {
 *----------------------------------------------------------------------------*/
 namespace { namespace BIP = boost::interprocess; }
 
+/*-----------------------------------------------------------------------------
+* Name of the shared memory segment that holds the heap managers created by
+* ti-mctd and used by the OpenCL runtime.  Bump the version whenever the 
+* layout of a HeapManager in the segment changes, so that a runtime and a 
+* daemon from different releases cannot attach to each other's heaps.
+*----------------------------------------------------------------------------*/
+#define HEAP_MANAGER_SHM_VERSION "2"
+#define HEAP_MANAGER_SHM_NAME    "HeapManager.v" HEAP_MANAGER_SHM_VERSION
+
 /*-----------------------------------------------------------------------------
 * Policy class for HeapManager, when cross inter-process usage is required
 *----------------------------------------------------------------------------*/
@@ -75,6 +85,12 @@ template <typename Address, typename Length> struct MultiProcess
     typedef BIP::map<Address, FreeMapElementVal, 
               std::less<Address>, const FreeMapAllocator>   FreeBlockList;
 
+    typedef std::pair<Length, Address>                      SizeIndexElement;
+    typedef BIP::allocator<SizeIndexElement, SegmentManager>
+                                                            SizeIndexAllocator;
+    typedef BIP::set<SizeIndexElement, 
+              std::less<SizeIndexElement>, SizeIndexAllocator> SizeIndex;
+
     static inline Length length(AllocMapElementVal& val) { return val.first;  }
     static inline Length pid   (AllocMapElementVal& val) { return val.second; }
     static inline AllocMapElementVal alloc_entry (Length& val) 
@@ -29,6 +29,7 @@
 #define HEAP_MANAGER_POLICY_THREAD_H_
 
 #include <map>
+#include <set>
 #include "u_locks_pthread.h"
 
 namespace utility { 
@@ -49,6 +50,9 @@ template <typename Address, typename Length> struct MultiThread
     typedef std::map<Address, Length>           BlockList;
     typedef BlockList                           AllocBlockList;
     typedef BlockList                           FreeBlockList;
+    typedef std::pair<Length, Address>          SizeIndexElement;
+    typedef std::allocator<SizeIndexElement>    SizeIndexAllocator;
+    typedef std::set<SizeIndexElement>          SizeIndex;
 
     struct managed_memory
     {
@@ -29,6 +29,7 @@
 #include "device.h"
 #include "subdevice.h"
 #include "buffer.h"
+#include "placement.h"
 #include "program.h"
 #include "utils.h"
 #include "u_locks_pthread.h"
@@ -42,6 +43,8 @@
 #include "../builtinprogram.h"
 #include "../oclenv.h"
 #include "../error_report.h"
+#include "../object_pool.h"
+#include "../trace.h"
 
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Constants.h>
@@ -51,6 +54,7 @@
 #include <llvm/IR/Module.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -89,6 +93,7 @@ DSPKernel::DSPKernel(DSPDevice *device, Kernel *kernel, llvm::Function *function
     p_data_page_ptr  ((DSPDevicePtr)0xffffffff),
     p_function(function)
 {
+    pthread_mutex_init(&p_arg_cache_mutex, 0);
 }
 
 DSPKernel::DSPKernel(DSPDevice *device, Kernel *kernel,
@@ -98,10 +103,12 @@ DSPKernel::DSPKernel(DSPDevice *device, Kernel *kernel,
     p_function(nullptr)
 {
     p_device_entry_pt = kernel_entry->index;
+    pthread_mutex_init(&p_arg_cache_mutex, 0);
 }
 
 DSPKernel::~DSPKernel()
 {
+    pthread_mutex_destroy(&p_arg_cache_mutex);
 }
 
 
@@ -416,6 +423,7 @@ size_t DSPKernel::typeOffset(size_t &offset, size_t type_len)
 }
 
 static int kernelID = 0;
+static pthread_mutex_t chain_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /*=============================================================================
 * DSPKernelEvent
@@ -424,8 +432,10 @@ DSPKernelEvent::DSPKernelEvent(DSPDevice *device, KernelEvent *event)
 : p_ret_code(CL_SUCCESS),
   p_device(device), p_event(event), p_kernel((DSPKernel*)event->deviceKernel()),
   p_debug_kernel(NODEBUG), p_num_arg_words(0), p_timeout_ms(0),
-  p_WG_alloca_start(0),
-  argref_offset(0)
+  p_WG_alloca_start(0), p_wg_counter(0),
+  argref_offset(0),
+  p_chain_pred(NULL), p_chain_next(NULL),
+  p_chain_slot(-1), p_chain_wait_slot(-1), p_keep_pins(false)
 {
     p_kernel_id = __sync_fetch_and_add(&kernelID, 1);
 
@@ -443,7 +453,20 @@ DSPKernelEvent::DSPKernelEvent(DSPDevice *device, KernelEvent *event)
         if (env_timeout > 0)  p_timeout_ms = env_timeout;
     }
 
-    p_ret_code = callArgs(MAX_ARGS_TOTAL_SIZE);
+    /*-------------------------------------------------------------------------
+    * Buffer addresses must not move once marshalled
+    *------------------------------------------------------------------------*/
+    pin_bufs();
+
+    /*-------------------------------------------------------------------------
+    * Reuse the arguments marshalled for an earlier launch of this kernel if
+    * clSetKernelArg has not changed them since, otherwise marshal afresh.
+    *------------------------------------------------------------------------*/
+    if (!restore_cached_args())
+    {
+        p_ret_code = callArgs(MAX_ARGS_TOTAL_SIZE);
+        if (p_ret_code == CL_SUCCESS) save_cached_args();
+    }
 
     /*-------------------------------------------------------------------------
     * Populate some of the kernel_msg_t structure.
@@ -473,7 +496,45 @@ DSPKernelEvent::DSPKernelEvent(DSPDevice *device, KernelEvent *event)
     }
 }
 
-DSPKernelEvent::~DSPKernelEvent() { }
+DSPKernelEvent::~DSPKernelEvent() { chain_done(); unpin_bufs(); }
+
+/******************************************************************************
+* DSPKernelEvent::pin_bufs
+*   Count this launch for the MSMC placement of the global buffer arguments,
+*   which may move them, then pin them until unpin_bufs.
+******************************************************************************/
+void DSPKernelEvent::pin_bufs()
+{
+    MsmcPlacement *placement = p_device->placement();
+    if (placement == NULL) return;
+
+    for (int i = 0; i < p_kernel->kernel()->numArgs(); ++i)
+    {
+        const Kernel::Arg &arg = p_kernel->kernel()->arg(i);
+        if (arg.kind() != Kernel::Arg::Buffer ||
+            arg.file() == Kernel::Arg::Local  || arg.data() == NULL)
+            continue;
+
+        MemObject *buffer = *(MemObject **)arg.data();
+        if (buffer == NULL ||
+            ((buffer->flags() & CL_MEM_USE_HOST_PTR) &&
+             ! buffer->get_host_ptr_clMalloced()))
+            continue;
+
+        if (!buffer->allocate(p_device)) continue;
+
+        DSPBuffer *dspbuf = (DSPBuffer *)buffer->deviceBuffer(p_device);
+        placement->Launched(dspbuf);
+        dspbuf->pin();
+        p_pinned_bufs.push_back(dspbuf);
+    }
+}
+
+void DSPKernelEvent::unpin_bufs()
+{
+    for (DSPBuffer *dspbuf : p_pinned_bufs) dspbuf->unpin();
+    p_pinned_bufs.clear();
+}
 
 #define DEVICE_READ_ONLY(buffer)  (buffer->flags() & CL_MEM_READ_ONLY)
 #define DEVICE_WRITE_ONLY(buffer) (buffer->flags() & CL_MEM_WRITE_ONLY)
@@ -550,6 +611,45 @@ void setarg_inreg(int index, int sz, unsigned int *args_in_reg, void *pval)
     }
 }
 
+/*-----------------------------------------------------------------------------
+* Place a scalar argument in registers. Sub-word integers are promoted to a
+* full word according to their signedness. The whole word is written, so the
+* same slot can be patched later with a different value.
+*----------------------------------------------------------------------------*/
+static void setarg_scalar_inreg(int index, const void *data, size_t size,
+                                bool is_uns, unsigned int *args_in_reg)
+{
+    if (size >= 4)
+    {
+        setarg_inreg(index, size, args_in_reg, (void *)data);
+        return;
+    }
+
+    int promoted = 0;
+    if (is_uns)
+    {
+        if (size == 1)
+            promoted = (unsigned) *((unsigned char*)data);
+        else if (size == 2)
+            promoted = (unsigned) *((unsigned short*)data);
+    }
+    else
+    {
+        if (size == 1)
+            promoted = (int) *((signed char*)data);
+        else if (size == 2)
+            promoted = (int) *((short*)data);
+    }
+    setarg_inreg(index, 4, args_in_reg, &promoted);
+}
+
+static void setarg_scalar_inreg(int index, const Kernel::Arg &arg,
+                                unsigned int *args_in_reg)
+{
+    setarg_scalar_inreg(index, arg.data(), arg.vecValueSize(),
+                        arg.is_subword_int_uns(), args_in_reg);
+}
+
 /******************************************************************************
 * DSPKernelEvent::callArgs
 ******************************************************************************/
@@ -609,6 +709,10 @@ cl_int DSPKernelEvent::callArgs(unsigned max_args_size)
                               (DSPVirtPtr *)(&args_in_reg[args_in_reg_index]) :
                    (DSPVirtPtr *)(more_args_in_mem+ROUNDUP(more_arg_offset,4));
 
+                if (arg.file() != Kernel::Arg::Local)
+                    p_buffer_slots.push_back(DSPArgCache::BufferSlot(
+                                       (unsigned) i, arg_slot(buf_dspvirtptr)));
+
                 /*-------------------------------------------------------------
                 * Alloc a buffer and pass it to the kernel
                 *------------------------------------------------------------*/
@@ -634,6 +738,9 @@ cl_int DSPKernelEvent::callArgs(unsigned max_args_size)
                     {
                         p_hostptr_tmpbufs.push_back(
                            HostptrPair(buffer, DSPPtrPair(0, buf_dspvirtptr)));
+                        p_buffer_uses.push_back(DSPArgCache::BufferUse {
+                            (unsigned) i, buffer, 0, buffer->size(),
+                            buffer->flags(), false });
                     }
                     else
                     {
@@ -642,6 +749,10 @@ cl_int DSPKernelEvent::callArgs(unsigned max_args_size)
                         buffer->allocate(p_device);
                         DSPDevicePtr64 addr64 = dspbuf->data();
 
+                        p_buffer_uses.push_back(DSPArgCache::BufferUse {
+                            (unsigned) i, buffer, addr64, buffer->size(),
+                            buffer->flags(), buffer->get_host_ptr_clMalloced() });
+
                         if (addr64 < 0xFFFFFFFF)
                             buf_ptr = addr64;
                         else
@@ -651,6 +762,9 @@ cl_int DSPKernelEvent::callArgs(unsigned max_args_size)
                         if (buffer->get_host_ptr_clMalloced())
                             p_hostptr_clMalloced_bufs.push_back(buffer);
 
+                        if (! DEVICE_READ_ONLY(buffer))
+                            p_device_written_bufs.push_back(buffer);
+
                         if (! DEVICE_WRITE_ONLY(buffer))
                             p_flush_bufs.push_back(DSPMemRange(DSPPtrPair(
                                      addr64, buf_dspvirtptr), buffer->size()));
@@ -686,32 +800,16 @@ cl_int DSPKernelEvent::callArgs(unsigned max_args_size)
                 args_in_reg_index = getarg_inreg_index(size, AP, BP, AQ, BQ);
                 if (args_in_reg_index >= 0)  // args_in_reg
                 {
-                    int dummy = 0;
-
-                    if (arg.is_subword_int_uns())
-                    {
-                        if (size == 1)
-                            dummy = (unsigned) *((unsigned char*)arg.data());
-                        else if (size == 2)
-                            dummy = (unsigned) *((unsigned short*)arg.data());
-                    }
-                    else
-                    {
-                        if (size == 1)
-                            dummy = (int) *((signed char*)arg.data());
-                        else if (size == 2)
-                            dummy = (int) *((short*)arg.data());
-                    }
-
-                    void *p_data = (dummy == 0) ? (void*)arg.data()
-                                                : (void *) &dummy;
-                    size         = (dummy == 0) ? size : 4;
-
-                    setarg_inreg(args_in_reg_index, size, args_in_reg, p_data);
+                    setarg_scalar_inreg(args_in_reg_index, arg, args_in_reg);
+                    p_scalar_slots.push_back(DSPArgCache::Scalar {
+                        (unsigned) i, DSPArgCache::InReg, args_in_reg_index });
                 }
                 else if (size <= 16)         // args_on_stack
                 {
                     SETMOREARG(size, arg.data());
+                    p_scalar_slots.push_back(DSPArgCache::Scalar {
+                        (unsigned) i, DSPArgCache::OnStack,
+                        more_arg_offset - (int) size });
                 }
                 else                         // args_of_argref
                 {
@@ -735,6 +833,8 @@ cl_int DSPKernelEvent::callArgs(unsigned max_args_size)
 
                     // 4. copy data into args_of_argref[], increment offset
                     //    give everybody 8 byte alignment
+                    p_scalar_slots.push_back(DSPArgCache::Scalar {
+                        (unsigned) i, DSPArgCache::ArgRef, argref_offset });
                     memcpy(&args_of_argref[argref_offset], arg.data(), size);
                     argref_offset = ROUNDUP(argref_offset + size, 8);
                 }
@@ -758,6 +858,456 @@ cl_int DSPKernelEvent::callArgs(unsigned max_args_size)
     return CL_SUCCESS;
 }
 
+/******************************************************************************
+* DSPKernelEvent::arg_slot / arg_slot_ptr
+*   Convert between pointers into this event's argument image and slots that
+*   are independent of the event (see DSPArgSlot).
+******************************************************************************/
+DSPArgSlot DSPKernelEvent::arg_slot(DSPVirtPtr *ptr)
+{
+    char *p   = (char *) ptr;
+    char *reg = (char *) p_msg.u.k.kernel.args_in_reg;
+
+    if (p >= reg && p < reg + sizeof(p_msg.u.k.kernel.args_in_reg))
+        return (DSPArgSlot) (p - reg);
+    return -(DSPArgSlot) (p - args_on_stack) - 1;
+}
+
+DSPVirtPtr *DSPKernelEvent::arg_slot_ptr(DSPArgSlot slot)
+{
+    if (slot >= 0)
+        return (DSPVirtPtr *) ((char *) p_msg.u.k.kernel.args_in_reg + slot);
+    return (DSPVirtPtr *) (args_on_stack - slot - 1);
+}
+
+/******************************************************************************
+* DSPKernelEvent::save_args
+*   Copy the argument image just built by callArgs into cache, with pointers
+*   into the image converted to slots.
+******************************************************************************/
+void DSPKernelEvent::save_args(DSPArgCache &cache)
+{
+    cache.scalars      = p_scalar_slots;
+    cache.buffers      = p_buffer_uses;
+    cache.buffer_slots = p_buffer_slots;
+
+    memcpy(cache.args_in_reg, p_msg.u.k.kernel.args_in_reg,
+           sizeof(cache.args_in_reg));
+    cache.args_in_reg_size   = p_msg.u.k.kernel.args_in_reg_size;
+    cache.args_on_stack_size = p_msg.u.k.kernel.args_on_stack_size;
+    cache.args_on_stack.assign(args_on_stack,
+                               args_on_stack + cache.args_on_stack_size);
+    cache.args_of_argref.assign(args_of_argref,
+                                args_of_argref + argref_offset);
+    cache.argref_offset = argref_offset;
+
+    cache.flush_bufs.clear();
+    for (auto &r : p_flush_bufs)
+        cache.flush_bufs.push_back(DSPArgCache::MemRange(std::make_pair(
+                          r.first.first, arg_slot(r.first.second)), r.second));
+    cache.bufs_64bit.clear();
+    for (auto &r : p_64bit_bufs)
+        cache.bufs_64bit.push_back(DSPArgCache::MemRange(std::make_pair(
+                          r.first.first, arg_slot(r.first.second)), r.second));
+    cache.local_bufs.clear();
+    for (auto &l : p_local_bufs)
+        cache.local_bufs.push_back(DSPArgCache::Local(arg_slot(l.first),
+                                                      l.second));
+    cache.argrefs.clear();
+    for (auto &l : p_argrefs)
+        cache.argrefs.push_back(DSPArgCache::Local(arg_slot(l.first),
+                                                   l.second));
+    cache.hostptr_tmpbufs.clear();
+    for (auto &h : p_hostptr_tmpbufs)
+        cache.hostptr_tmpbufs.push_back(DSPArgCache::Hostptr(h.first,
+                                              arg_slot(h.second.second)));
+    cache.hostptr_clMalloced_bufs = p_hostptr_clMalloced_bufs;
+    cache.device_written_bufs     = p_device_written_bufs;
+    cache.valid = true;
+}
+
+/******************************************************************************
+* DSPKernelEvent::load_args
+*   Rebuild this event's argument image from cache. The event must not hold
+*   arguments yet: the bookkeeping vectors are appended to.
+******************************************************************************/
+void DSPKernelEvent::load_args(const DSPArgCache &cache)
+{
+    p_scalar_slots = cache.scalars;
+    p_buffer_uses  = cache.buffers;
+    p_buffer_slots = cache.buffer_slots;
+
+    memcpy(p_msg.u.k.kernel.args_in_reg, cache.args_in_reg,
+           sizeof(cache.args_in_reg));
+    p_msg.u.k.kernel.args_in_reg_size   = cache.args_in_reg_size;
+    p_msg.u.k.kernel.args_on_stack_addr = 0;
+    p_msg.u.k.kernel.args_on_stack_size = cache.args_on_stack_size;
+    if (!cache.args_on_stack.empty())
+        memcpy(args_on_stack, cache.args_on_stack.data(),
+               cache.args_on_stack.size());
+    if (!cache.args_of_argref.empty())
+        memcpy(args_of_argref, cache.args_of_argref.data(),
+               cache.args_of_argref.size());
+    argref_offset = cache.argref_offset;
+
+    for (auto &r : cache.flush_bufs)
+        p_flush_bufs.push_back(DSPMemRange(DSPPtrPair(r.first.first,
+                                   arg_slot_ptr(r.first.second)), r.second));
+    for (auto &r : cache.bufs_64bit)
+        p_64bit_bufs.push_back(DSPMemRange(DSPPtrPair(r.first.first,
+                                   arg_slot_ptr(r.first.second)), r.second));
+    for (auto &l : cache.local_bufs)
+        p_local_bufs.push_back(LocalPair(arg_slot_ptr(l.first), l.second));
+    for (auto &l : cache.argrefs)
+        p_argrefs.push_back(LocalPair(arg_slot_ptr(l.first), l.second));
+    for (auto &h : cache.hostptr_tmpbufs)
+        p_hostptr_tmpbufs.push_back(HostptrPair(h.first,
+                                    DSPPtrPair(0, arg_slot_ptr(h.second))));
+    p_hostptr_clMalloced_bufs = cache.hostptr_clMalloced_bufs;
+    p_device_written_bufs     = cache.device_written_bufs;
+}
+
+/******************************************************************************
+* DSPKernelEvent::save_cached_args
+*   Record the argument image just built by callArgs in the kernel's cache,
+*   along with the argument generations it reflects.
+******************************************************************************/
+void DSPKernelEvent::save_cached_args()
+{
+    Kernel      *kernel = p_kernel->kernel();
+    DSPArgCache &cache  = p_kernel->p_arg_cache;
+
+    pthread_mutex_lock(&p_kernel->p_arg_cache_mutex);
+
+    cache.generations.resize(kernel->numArgs());
+    for (unsigned int i = 0; i < kernel->numArgs(); ++i)
+        cache.generations[i] = kernel->arg(i).generation();
+
+    save_args(cache);
+
+    pthread_mutex_unlock(&p_kernel->p_arg_cache_mutex);
+}
+
+/*-----------------------------------------------------------------------------
+* Write a new value of a scalar argument in the image held by cache
+*----------------------------------------------------------------------------*/
+static void patch_scalar(DSPArgCache &cache, const DSPArgCache::Scalar &slot,
+                         const void *data, size_t size, bool is_uns)
+{
+    switch (slot.where)
+    {
+        case DSPArgCache::InReg:
+            setarg_scalar_inreg(slot.offset, data, size, is_uns,
+                                (unsigned *)cache.args_in_reg);
+            break;
+        case DSPArgCache::OnStack:
+            memcpy(&cache.args_on_stack[slot.offset], data, size);
+            break;
+        case DSPArgCache::ArgRef:
+            memcpy(&cache.args_of_argref[slot.offset], data, size);
+            break;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+* A cached argument image is usable if only scalar arguments changed since it
+* was built, and unchanged buffer arguments are still placed where they were:
+* a MemObject may have been released and another allocated at its address.
+*----------------------------------------------------------------------------*/
+static bool cached_args_usable(DSPArgCache &cache, Kernel *kernel,
+                               DSPDevice *device)
+{
+    if (!cache.valid || cache.generations.size() != kernel->numArgs())
+        return false;
+
+    for (unsigned int i = 0; i < kernel->numArgs(); ++i)
+    {
+        const Kernel::Arg &arg = kernel->arg(i);
+        if (arg.generation() == cache.generations[i]) continue;
+        if (arg.kind() == Kernel::Arg::Buffer  ||
+            arg.kind() == Kernel::Arg::Image2D ||
+            arg.kind() == Kernel::Arg::Image3D)
+            return false;
+    }
+
+    for (auto &use : cache.buffers)
+    {
+        MemObject *buffer = *(MemObject **)kernel->arg(use.index).data();
+        if (buffer          != use.buffer ||
+            buffer->size()  != use.size   ||
+            buffer->flags() != use.flags)
+            return false;
+
+        if (use.addr64 == 0) continue;   // use_host_ptr temporary buffer
+        if (buffer->get_host_ptr_clMalloced() != use.clMalloced)
+            return false;
+
+        DSPBuffer *dspbuf = (DSPBuffer *)buffer->deviceBuffer(device);
+        buffer->allocate(device);
+        if (dspbuf->data() != use.addr64) return false;
+    }
+
+    return true;
+}
+
+/******************************************************************************
+* DSPKernelEvent::restore_cached_args
+*   Rebuild this event's arguments from the kernel's cache, patching scalar
+*   arguments changed since the cached launch first. Returns false if the
+*   arguments must be marshalled again by callArgs.
+******************************************************************************/
+bool DSPKernelEvent::restore_cached_args()
+{
+    Kernel      *kernel = p_kernel->kernel();
+    DSPArgCache &cache  = p_kernel->p_arg_cache;
+
+    pthread_mutex_lock(&p_kernel->p_arg_cache_mutex);
+
+    if (!cached_args_usable(cache, kernel, p_device))
+    {
+        pthread_mutex_unlock(&p_kernel->p_arg_cache_mutex);
+        return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    * Patch changed scalars in the cache, then copy it to the event
+    *------------------------------------------------------------------------*/
+    for (auto &slot : cache.scalars)
+    {
+        const Kernel::Arg &arg = kernel->arg(slot.index);
+        if (arg.generation() == cache.generations[slot.index]) continue;
+
+        patch_scalar(cache, slot, arg.data(), arg.vecValueSize(),
+                     arg.is_subword_int_uns());
+    }
+
+    load_args(cache);
+
+    for (unsigned int i = 0; i < kernel->numArgs(); ++i)
+        cache.generations[i] = kernel->arg(i).generation();
+
+    pthread_mutex_unlock(&p_kernel->p_arg_cache_mutex);
+    return true;
+}
+
+/******************************************************************************
+* DSPKernelEvent::operator new / delete
+*   The argument arrays make DSPKernelEvent several KB large, keep freed ones
+*   for the next kernel enqueue.
+******************************************************************************/
+static ObjectPool &kernel_event_pool()
+{
+    static ObjectPool *pool = new ObjectPool(ObjectPool::DeviceData,
+                                             sizeof(DSPKernelEvent));
+    return *pool;
+}
+
+void *DSPKernelEvent::operator new(size_t size)
+{
+    return kernel_event_pool().allocate(size);
+}
+
+void DSPKernelEvent::operator delete(void *ptr, size_t size)
+{
+    kernel_event_pool().release(ptr, size);
+}
+
+/******************************************************************************
+* DSPKernelEvent::record
+*   Keep the arguments marshalled for this event, it is replayed by a command
+*   graph instead of being run once.
+******************************************************************************/
+void DSPKernelEvent::record()
+{
+    save_args(p_recorded);
+    p_keep_pins = true;  // Replays reuse the marshalled buffer addresses
+}
+
+/******************************************************************************
+* DSPKernelEvent::rearm
+*   Undo what run and free_tmp_bufs did to the event since it was recorded:
+*   restore the argument image and the buffers bookkeeping.
+******************************************************************************/
+void DSPKernelEvent::rearm()
+{
+    p_flush_bufs.clear();
+    p_local_bufs.clear();
+    p_hostptr_tmpbufs.clear();
+    p_hostptr_clMalloced_bufs.clear();
+    p_device_written_bufs.clear();
+    p_64bit_bufs.clear();
+    p_argrefs.clear();
+
+    load_args(p_recorded);
+    p_WG_alloca_start = 0;
+    p_wg_counter      = 0;
+}
+
+/******************************************************************************
+* DSPKernelEvent::patch_arg
+*   Change a by-value or global buffer argument of a recorded event, from the
+*   next rearm. The size of local arguments is fixed when recorded.
+******************************************************************************/
+cl_int DSPKernelEvent::patch_arg(cl_uint index, const void *value, size_t size)
+{
+    const Kernel::Arg &arg = p_kernel->kernel()->arg(index);
+
+    if (arg.kind() == Kernel::Arg::Buffer)
+    {
+        if (arg.file() == Kernel::Arg::Local) return CL_INVALID_OPERATION;
+        return patch_buffer(index, *(MemObject **)value);
+    }
+
+    for (auto &slot : p_recorded.scalars)
+    {
+        if (slot.index != index) continue;
+
+        patch_scalar(p_recorded, slot, value, size, arg.is_subword_int_uns());
+        return CL_SUCCESS;
+    }
+
+    return CL_INVALID_OPERATION;
+}
+
+/*-----------------------------------------------------------------------------
+* Remove one occurrence of value from v, a buffer bound to several arguments
+* appears once per argument
+*----------------------------------------------------------------------------*/
+template <typename T>
+static void erase_one(std::vector<T> &v, const T &value)
+{
+    auto it = std::find(v.begin(), v.end(), value);
+    if (it != v.end()) v.erase(it);
+}
+
+/******************************************************************************
+* DSPKernelEvent::patch_buffer
+*   Bind buffer to global buffer argument index of the recorded event: undo
+*   what callArgs recorded for the buffer bound so far, then record buffer the
+*   way callArgs does. The new buffer is allocated and pinned now, so that
+*   the address written in the argument image stays valid for the replays.
+******************************************************************************/
+cl_int DSPKernelEvent::patch_buffer(cl_uint index, MemObject *buffer)
+{
+    DSPArgCache &rec = p_recorded;
+
+    auto slot_it = std::find_if(rec.buffer_slots.begin(),
+                                rec.buffer_slots.end(),
+                        [index](const DSPArgCache::BufferSlot &buffer_slot)
+                        { return buffer_slot.first == index; });
+    if (slot_it == rec.buffer_slots.end()) return CL_INVALID_OPERATION;
+    DSPArgSlot slot = slot_it->second;
+
+    /*-------------------------------------------------------------------------
+    * Allocate the new buffer first, the recorded event is unchanged on error
+    *------------------------------------------------------------------------*/
+    bool use_tmpbuf = buffer != NULL &&
+                      (buffer->flags() & CL_MEM_USE_HOST_PTR) &&
+                      ! buffer->get_host_ptr_clMalloced();
+    DSPBuffer *dspbuf = NULL;
+    if (buffer != NULL && !use_tmpbuf)
+    {
+        if (!buffer->allocate(p_device))
+            return CL_MEM_OBJECT_ALLOCATION_FAILURE;
+
+        dspbuf = (DSPBuffer *)buffer->deviceBuffer(p_device);
+        if (p_device->placement() != NULL)
+        {
+            dspbuf->pin();
+            p_pinned_bufs.push_back(dspbuf);
+        }
+    }
+
+    /*-------------------------------------------------------------------------
+    * Forget the buffer bound so far
+    *------------------------------------------------------------------------*/
+    MemObject *old_buffer = NULL;
+    auto use_it = std::find_if(rec.buffers.begin(), rec.buffers.end(),
+                        [index](const DSPArgCache::BufferUse &use)
+                        { return use.index == index; });
+    if (use_it != rec.buffers.end())
+    {
+        old_buffer = use_it->buffer;
+        if (use_it->addr64 != 0)
+        {
+            if (use_it->clMalloced)
+                erase_one(rec.hostptr_clMalloced_bufs, old_buffer);
+            if (! (use_it->flags & CL_MEM_READ_ONLY))
+                erase_one(rec.device_written_bufs, old_buffer);
+
+            DSPBuffer *old_dspbuf =
+                           (DSPBuffer *)old_buffer->deviceBuffer(p_device);
+            auto pin_it = std::find(p_pinned_bufs.begin(),
+                                    p_pinned_bufs.end(), old_dspbuf);
+            if (pin_it != p_pinned_bufs.end())
+            {
+                p_pinned_bufs.erase(pin_it);
+                old_dspbuf->unpin();
+            }
+        }
+        rec.buffers.erase(use_it);
+    }
+
+    auto at_slot = [slot](const DSPArgCache::MemRange &r)
+                   { return r.first.second == slot; };
+    rec.flush_bufs.erase(std::remove_if(rec.flush_bufs.begin(),
+                         rec.flush_bufs.end(), at_slot), rec.flush_bufs.end());
+    rec.bufs_64bit.erase(std::remove_if(rec.bufs_64bit.begin(),
+                         rec.bufs_64bit.end(), at_slot), rec.bufs_64bit.end());
+    rec.hostptr_tmpbufs.erase(std::remove_if(rec.hostptr_tmpbufs.begin(),
+                         rec.hostptr_tmpbufs.end(),
+                         [slot](const DSPArgCache::Hostptr &h)
+                         { return h.second == slot; }),
+                         rec.hostptr_tmpbufs.end());
+
+    /*-------------------------------------------------------------------------
+    * Record the new buffer, as callArgs does
+    *------------------------------------------------------------------------*/
+    DSPDevicePtr buf_ptr = 0;
+    if (use_tmpbuf)
+    {
+        rec.hostptr_tmpbufs.push_back(DSPArgCache::Hostptr(buffer, slot));
+        rec.buffers.push_back(DSPArgCache::BufferUse {
+            index, buffer, 0, buffer->size(), buffer->flags(), false });
+    }
+    else if (buffer != NULL)
+    {
+        DSPDevicePtr64 addr64 = dspbuf->data();
+
+        rec.buffers.push_back(DSPArgCache::BufferUse {
+            index, buffer, addr64, buffer->size(), buffer->flags(),
+            buffer->get_host_ptr_clMalloced() });
+
+        DSPArgCache::MemRange range(std::make_pair(addr64, slot),
+                                    buffer->size());
+        if (addr64 < 0xFFFFFFFF)
+            buf_ptr = addr64;
+        else
+            rec.bufs_64bit.push_back(range);
+
+        if (buffer->get_host_ptr_clMalloced())
+            rec.hostptr_clMalloced_bufs.push_back(buffer);
+
+        if (! DEVICE_READ_ONLY(buffer))
+            rec.device_written_bufs.push_back(buffer);
+
+        if (! DEVICE_WRITE_ONLY(buffer))
+            rec.flush_bufs.push_back(range);
+    }
+
+    if (slot >= 0)
+        memcpy((char *) rec.args_in_reg + slot, &buf_ptr, sizeof(buf_ptr));
+    else
+        memcpy(&rec.args_on_stack[-slot - 1], &buf_ptr, sizeof(buf_ptr));
+
+    /*-------------------------------------------------------------------------
+    * The event keeps the buffers of its arguments alive
+    *------------------------------------------------------------------------*/
+    p_event->replaceMemObject(old_buffer, buffer);
+
+    return CL_SUCCESS;
+}
+
 /******************************************************************************
 * debug_pause
 ******************************************************************************/
@@ -798,6 +1348,10 @@ static void debug_pause(uint32_t entry, uint32_t dsp_id,
 ******************************************************************************/
 cl_int DSPKernelEvent::run(Event::Type evtype)
 {
+    TraceScope trace("dispatch kernel");
+    if (Trace::enabled())
+        Trace::nameKernel(p_kernel_id, p_event->kernel()->getName());
+
     // TODO perhaps ensure that prog is loaded.
     Program    *p    = (Program *)p_kernel->kernel()->parent();
     DSPProgram *prog = (DSPProgram *)(p->deviceDependentProgram(p_device));
@@ -844,6 +1398,11 @@ cl_int DSPKernelEvent::run(Event::Type evtype)
     err = setup_stack_based_arguments();
     if (err != CL_SUCCESS) return err;
 
+    /*-------------------------------------------------------------------------
+    * Shared counter the cores claim work-groups from, if dynamic
+    *------------------------------------------------------------------------*/
+    setup_wg_counter();
+
 #if 0
     /*-------------------------------------------------------------------------
     * Workaround for PSDK3.0/CMEM4.11: Flush ARM's cache for device execution
@@ -864,6 +1423,11 @@ cl_int DSPKernelEvent::run(Event::Type evtype)
     int ret = debug_kernel_dispatch();
     if (ret != CL_SUCCESS) return ret;
 
+    /*-------------------------------------------------------------------------
+    * Completion flags, for a kernel chained to this one or this one chained
+    *------------------------------------------------------------------------*/
+    chain_send();
+
     /*---------------------------------------------------------------------
     * For host scheduled devices, i.e. AM57, NDRkernels send to all cores.
     * The monitor will determine how to divide the work. Need to wait on
@@ -882,6 +1446,103 @@ cl_int DSPKernelEvent::run(Event::Type evtype)
     return CL_SUCCESS;
 }
 
+/******************************************************************************
+* bool DSPKernelEvent::chainable()
+*   An NDRange kernel the DSP cores can run without the host in between, i.e.
+*   not debugged, not turned into a task and without use_host_ptr temporary
+*   buffers, that are only copied in and out by the host.
+******************************************************************************/
+bool DSPKernelEvent::chainable() const
+{
+    bool effective_task = (p_event->global_work_size(0) == 1 &&
+                           p_event->global_work_size(1) == 1 &&
+                           p_event->global_work_size(2) == 1);
+
+    return p_ret_code == CL_SUCCESS && p_debug_kernel == NODEBUG &&
+           p_event->type() == Event::NDRangeKernel && !effective_task &&
+           p_hostptr_tmpbufs.empty();
+}
+
+/******************************************************************************
+* void DSPKernelEvent::chain_after(DSPKernelEvent *predecessor)
+*   Both are chainable and predecessor is ahead on the device. If it is done
+*   by the time this one is sent, there is nothing to wait for.
+******************************************************************************/
+void DSPKernelEvent::chain_after(DSPKernelEvent *predecessor)
+{
+    pthread_mutex_lock(&chain_mutex);
+    predecessor->p_chain_next = this;
+    p_chain_pred              = predecessor;
+    pthread_mutex_unlock(&chain_mutex);
+}
+
+/******************************************************************************
+* void DSPKernelEvent::chain_send()
+*   Every NDRKERNEL publishes its completion in a slot of flags. If the kernel
+*   this one is chained to is still running, the cores wait for its slot.
+*   The dispatch thread runs kernels in order, so the predecessor has its
+*   slot by now, unless it failed to run.
+******************************************************************************/
+void DSPKernelEvent::chain_send()
+{
+    kernel_msg_t& k = p_msg.u.k.kernel;
+
+    k.chain_flags   = p_device->chain_flags();
+    k.chain_publish = 0;
+    k.chain_wait    = 0;
+    k.chain_wait_id = 0;
+    if (k.chain_flags == 0) return;
+
+    int slot = -1;
+    if (p_msg.command == NDRKERNEL && p_debug_kernel == NODEBUG)
+        slot = p_device->chain_acquire();
+
+    pthread_mutex_lock(&chain_mutex);
+    p_chain_slot = slot;
+    if (p_chain_pred != NULL)
+    {
+        DSPKernelEvent *pred = p_chain_pred;
+        if (pred->p_chain_slot >= 0)
+        {
+            p_chain_wait_slot = pred->p_chain_slot;
+            p_device->chain_retain(p_chain_wait_slot);
+            k.chain_wait      = p_chain_wait_slot + 1;
+            k.chain_wait_id   = pred->p_kernel_id;
+        }
+        pred->p_chain_next = NULL;
+        p_chain_pred       = NULL;
+    }
+    pthread_mutex_unlock(&chain_mutex);
+
+    if (slot >= 0) k.chain_publish = slot + 1;
+}
+
+/******************************************************************************
+* void DSPKernelEvent::chain_done()
+*   The host is done with this kernel: a kernel chained to it and not sent
+*   yet has nothing to wait for, and the slots can be reused once the kernels
+*   waiting for them are done as well.
+******************************************************************************/
+void DSPKernelEvent::chain_done()
+{
+    pthread_mutex_lock(&chain_mutex);
+    if (p_chain_pred != NULL)
+    {
+        p_chain_pred->p_chain_next = NULL;
+        p_chain_pred               = NULL;
+    }
+    if (p_chain_next != NULL)
+    {
+        p_chain_next->p_chain_pred = NULL;
+        p_chain_next               = NULL;
+    }
+    if (p_chain_slot >= 0)      p_device->chain_release(p_chain_slot);
+    if (p_chain_wait_slot >= 0) p_device->chain_release(p_chain_wait_slot);
+    p_chain_slot      = -1;
+    p_chain_wait_slot = -1;
+    pthread_mutex_unlock(&chain_mutex);
+}
+
 /******************************************************************************
 * Allocating local buffer in L2 per kernel run instance
 ******************************************************************************/
@@ -1266,6 +1927,48 @@ int DSPKernelEvent::debug_kernel_dispatch()
     return CL_SUCCESS;
 }
 
+/******************************************************************************
+* DSPKernelEvent::setup_wg_counter
+*   For an NDRange kernel scheduled dynamically on several cores, allocate and
+*   zero the counter the cores claim work-groups from, see wg_claim(). Falls
+*   back to fixed chunks if there is no room for it.
+******************************************************************************/
+void DSPKernelEvent::setup_wg_counter()
+{
+    kernel_config_t *cfg = &p_msg.u.k.config;
+
+    p_msg.u.k.kernel.wg_counter = 0;
+
+    if (p_msg.command != NDRKERNEL || p_debug_kernel != NODEBUG ||
+        p_kernel->kernel()->getWgSchedule() != CL_WG_SCHEDULE_DYNAMIC_TI ||
+        p_device->dspCores() < 2)
+        return;
+
+    uint32_t num_wgs = 1;
+    for (int i = 0; i < MAX_NDR_DIMENSIONS; i++)
+        num_wgs *= cfg->global_size[i] / cfg->local_size[i];
+    if (num_wgs < 2) return;
+
+    SharedMemory *shm = p_device->GetSHMHandler();
+
+    p_wg_counter = shm->AllocateMSMC(WG_COUNTER_SIZE);
+    if (!p_wg_counter)
+        p_wg_counter = shm->AllocateGlobal(WG_COUNTER_SIZE, true);
+
+    if (p_wg_counter >= 0xFFFFFFFF)
+    {
+        shm->FreeMSMCorGlobal(p_wg_counter);
+        p_wg_counter = 0;
+    }
+    if (!p_wg_counter) return;
+
+    void *counter = shm->Map(p_wg_counter, WG_COUNTER_SIZE, false);
+    memset(counter, 0, WG_COUNTER_SIZE);
+    shm->Unmap(counter, p_wg_counter, WG_COUNTER_SIZE, true);
+
+    p_msg.u.k.kernel.wg_counter = (DSPVirtPtr) p_wg_counter;
+}
+
 /******************************************************************************
 * free_tmp_bufs allocated for kernel allocas, and for use_host_ptr
 ******************************************************************************/
@@ -1280,6 +1983,9 @@ void DSPKernelEvent::free_tmp_bufs()
     if (p_msg.u.k.kernel.args_on_stack_addr > 0)
         shm->FreeMSMCorGlobal(p_msg.u.k.kernel.args_on_stack_addr);
 
+    if (p_wg_counter > 0)
+        shm->FreeMSMCorGlobal(p_wg_counter);
+
     for (int i = 0; i < p_hostptr_tmpbufs.size(); ++i)
     {
         MemObject *buffer     = p_hostptr_tmpbufs[i].first;
@@ -1310,5 +2016,16 @@ void DSPKernelEvent::free_tmp_bufs()
         if (! DEVICE_READ_ONLY(buffer))
             shm->CacheInv(data, buffer->host_ptr(), buffer->size());
     }
+
+    /*-------------------------------------------------------------------------
+    * The kernel may have written these buffers, the host cache no longer
+    * holds any of their ranges coherently
+    *------------------------------------------------------------------------*/
+    for (int i = 0; i < p_device_written_bufs.size(); ++i)
+        p_device_written_bufs[i]->setDeviceOwned();
+
+    if (!p_keep_pins) unpin_bufs();
+
+    chain_done();
 }
 
@@ -61,9 +61,77 @@ typedef std::pair<Coal::MemObject *, DSPPtrPair> HostptrPair;
 namespace Coal
 {
 class DSPDevice;
+class DSPBuffer;
 class Kernel;
 class KernelEvent;
 
+/*-----------------------------------------------------------------------------
+* Pointers into the marshalled argument image are recorded as slots so that
+* they can be rebased onto another DSPKernelEvent: a slot >= 0 is a byte
+* offset into args_in_reg, a slot < 0 encodes byte offset -(slot+1) into
+* args_on_stack.
+*----------------------------------------------------------------------------*/
+typedef int32_t DSPArgSlot;
+
+/*-----------------------------------------------------------------------------
+* Marshalled kernel arguments of the last launch of a DSPKernel, together with
+* the Kernel::Arg generations and buffer placements it was built from.
+*----------------------------------------------------------------------------*/
+struct DSPArgCache
+{
+    enum Where { InReg, OnStack, ArgRef };
+
+    /* Placement of a scalar argument, so it can be patched in place */
+    struct Scalar
+    {
+        unsigned int index;     // kernel argument index
+        Where        where;
+        int          offset;    // args_in_reg index, or byte offset into
+                                // args_on_stack / args_of_argref
+    };
+
+    /* Global buffer bound to an argument and where it was placed on device */
+    struct BufferUse
+    {
+        unsigned int    index;
+        MemObject *     buffer;
+        DSPDevicePtr64  addr64;
+        size_t          size;
+        cl_mem_flags    flags;
+        bool            clMalloced;
+    };
+
+    typedef std::pair<std::pair<DSPDevicePtr64, DSPArgSlot>, uint32_t> MemRange;
+    typedef std::pair<DSPArgSlot, uint32_t>                             Local;
+    typedef std::pair<MemObject *, DSPArgSlot>                          Hostptr;
+    typedef std::pair<unsigned int, DSPArgSlot>                         BufferSlot;
+
+    DSPArgCache() : valid(false), args_in_reg_size(0), args_on_stack_size(0),
+                    argref_offset(0) {}
+
+    bool                       valid;
+    std::vector<unsigned int>  generations;
+    std::vector<Scalar>        scalars;
+    std::vector<BufferUse>     buffers;
+    std::vector<BufferSlot>    buffer_slots;   // address of each global
+                                               // buffer argument, even NULL
+
+    uint32_t                   args_in_reg[MAX_ARGS_IN_REG_SIZE];
+    uint32_t                   args_in_reg_size;
+    uint32_t                   args_on_stack_size;
+    std::vector<char>          args_on_stack;
+    std::vector<char>          args_of_argref;
+    int                        argref_offset;
+
+    std::vector<MemRange>      flush_bufs;
+    std::vector<Local>         local_bufs;
+    std::vector<Hostptr>       hostptr_tmpbufs;
+    std::vector<MemObject *>   hostptr_clMalloced_bufs;
+    std::vector<MemObject *>   device_written_bufs;
+    std::vector<MemRange>      bufs_64bit;
+    std::vector<Local>         argrefs;
+};
+
 class DSPKernel : public DeviceKernel
 {
     public:
@@ -103,6 +171,11 @@ class DSPKernel : public DeviceKernel
         DSPDevicePtr    p_device_entry_pt;
         DSPDevicePtr    p_data_page_ptr;
         llvm::Function *p_function;
+
+        // Marshalled arguments reused by DSPKernelEvents of later launches
+        friend class DSPKernelEvent;
+        DSPArgCache     p_arg_cache;
+        pthread_mutex_t p_arg_cache_mutex;
 };
 
 class DSPKernelEvent
@@ -113,6 +186,10 @@ class DSPKernelEvent
         DSPKernelEvent  (DSPDevice *device, KernelEvent *event);
         ~DSPKernelEvent ();
 
+        // Created for every kernel enqueue, recycled through an ObjectPool
+        static void *operator new   (size_t size);
+        static void  operator delete(void *ptr, size_t size);
+
         cl_int run      (Event::Type evtype);
         cl_int callArgs (unsigned rs_size);
 
@@ -122,6 +199,20 @@ class DSPKernelEvent
 
         void free_tmp_bufs();
 
+        /*---------------------------------------------------------------------
+        * Start on the device once predecessor is done there, see
+        * DSPDevice::chainEvents
+        *--------------------------------------------------------------------*/
+        bool   chainable () const;
+        void   chain_after(DSPKernelEvent *predecessor);
+
+        /*---------------------------------------------------------------------
+        * Replay by a command graph, see DeviceInterface::recordEventDeviceData
+        *--------------------------------------------------------------------*/
+        void   record   ();
+        void   rearm    ();
+        cl_int patch_arg(cl_uint index, const void *value, size_t size);
+
     private:
         cl_int                    p_ret_code;
         DSPDevice *               p_device;
@@ -133,10 +224,12 @@ class DSPKernelEvent
         uint32_t                  p_timeout_ms;
         Msg_t                     p_msg;
         DSPDevicePtr64            p_WG_alloca_start;
+        DSPDevicePtr64            p_wg_counter;
         std::vector<DSPMemRange>  p_flush_bufs;
         std::vector<LocalPair>    p_local_bufs;
         std::vector<HostptrPair>  p_hostptr_tmpbufs;
         std::vector<MemObject *>  p_hostptr_clMalloced_bufs;
+        std::vector<MemObject *>  p_device_written_bufs;
         std::vector<DSPMemRange>  p_64bit_bufs;
 
         char args_on_stack[ MAX_ARGS_TOTAL_SIZE*2];
@@ -144,6 +237,26 @@ class DSPKernelEvent
         int  argref_offset;
         std::vector<LocalPair>    p_argrefs;
 
+        // Recorded by callArgs for the argument cache of p_kernel
+        std::vector<DSPArgCache::Scalar>    p_scalar_slots;
+        std::vector<DSPArgCache::BufferUse> p_buffer_uses;
+        std::vector<DSPArgCache::BufferSlot> p_buffer_slots;
+
+        // Arguments as marshalled when recorded, restored by rearm()
+        DSPArgCache               p_recorded;
+
+        // Buffer arguments pinned against MSMC placement moves, until the
+        // event completes, or is destroyed once recorded in a graph
+        std::vector<DSPBuffer *>  p_pinned_bufs;
+        bool                      p_keep_pins;
+
+        // Chained kernels, protected by a mutex in kernel.cpp: p_chain_slot
+        // is published when done, p_chain_wait_slot is the one waited for
+        DSPKernelEvent *          p_chain_pred;
+        DSPKernelEvent *          p_chain_next;
+        int                       p_chain_slot;
+        int                       p_chain_wait_slot;
+
         /*---------------------------------------------------------------------
         * Helpers for run member function
         *--------------------------------------------------------------------*/
@@ -154,7 +267,23 @@ class DSPKernelEvent
         cl_int flush_special_use_host_ptr_buffers(void);
         cl_int setup_extended_memory_mappings(void);
         cl_int setup_stack_based_arguments(void);
+        void   setup_wg_counter(void);
         int debug_kernel_dispatch();
+        void chain_send();
+        void chain_done();
+        void pin_bufs();
+        void unpin_bufs();
+
+        /*---------------------------------------------------------------------
+        * Helpers for the marshalled argument cache of p_kernel
+        *--------------------------------------------------------------------*/
+        bool         restore_cached_args(void);
+        void         save_cached_args(void);
+        void         save_args(DSPArgCache &cache);
+        void         load_args(const DSPArgCache &cache);
+        DSPArgSlot   arg_slot(DSPVirtPtr *ptr);
+        DSPVirtPtr * arg_slot_ptr(DSPArgSlot slot);
+        cl_int       patch_buffer(cl_uint index, MemObject *buffer);
 
 };
 }
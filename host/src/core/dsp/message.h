@@ -34,7 +34,7 @@ typedef enum
 {
     EXIT, TASK, NDRKERNEL, CACHEINV,
     FREQUENCY, PRINT, CONFIGURE_MONITOR,
-    SETUP_DEBUG
+    SETUP_DEBUG, BATCH
 } command_codes;
 
 #define MAX_NUM_CORES        (8)
@@ -47,6 +47,7 @@ typedef enum
 #define DSP_MAX_NUM_BUILTIN_KERNELS 256
 
 #define MAX_ARGS_TOTAL_SIZE 1024
+#define MAX_BATCH_MSGS      8
 
 #define MAX_XMCSES_MPAXS	7
 #define FIRST_FREE_XMC_MPAX	4  // XMC MPAXs available: 4 - F
@@ -97,6 +98,49 @@ typedef struct
     int8_t          event_number2;
 } profiling_t;
 
+/*-----------------------------------------------------------------------------
+* Chained NDRKERNELs: a kernel that only waits for the previous NDRKERNEL sent
+* to the same cores starts once that kernel is done on each of them, without a
+* round trip through the host. chain_flags is the DSP address of CHAIN_SLOTS x
+* MAX_NUM_CORES completion flags in shared memory, one cache line each, or 0.
+* chain_publish: 1 + slot in which each core writes Kernel_id when done, or 0
+* chain_wait:    1 + slot in which cores master_core .. master_core+num_cores-1
+*                must all show chain_wait_id before the kernel starts, or 0
+*----------------------------------------------------------------------------*/
+#define CHAIN_SLOTS          (32)
+#define CHAIN_FLAG_SIZE      (128)
+#define CHAIN_FLAG_ADDR(flags, slot, core) \
+        ((flags) + ((slot) * MAX_NUM_CORES + (core)) * CHAIN_FLAG_SIZE)
+
+/*-----------------------------------------------------------------------------
+* Dynamic work-group distribution: instead of one fixed chunk each, the cores
+* of an NDRKERNEL claim work-groups, in flattened order, from a counter in
+* shared memory. wg_counter is the DSP address of that counter, a zeroed
+* cache line of WG_COUNTER_SIZE bytes, or 0 for fixed chunks.
+* Guided self-scheduling: a claim takes 1 / (WG_GUIDED_FACTOR * num_cores) of
+* the work-groups left, at least one, so the first claims are large and the
+* last ones even out the tail.
+*----------------------------------------------------------------------------*/
+#define WG_COUNTER_SIZE      (128)
+#define WG_GUIDED_FACTOR     (2)
+
+/*-----------------------------------------------------------------------------
+* Claim the next work-groups from *next, out of num_wgs. Returns how many,
+* starting at *first, 0 once all are claimed. The caller serializes claims.
+*----------------------------------------------------------------------------*/
+static inline uint32_t wg_claim(uint32_t* next, uint32_t num_wgs,
+                                uint32_t num_cores, uint32_t* first)
+{
+    uint32_t left  = (*next < num_wgs) ? num_wgs - *next : 0;
+    uint32_t count = left / (WG_GUIDED_FACTOR * num_cores);
+
+    if (count == 0 && left > 0) count = 1;
+
+    *first = *next;
+    *next += count;
+    return count;
+}
+
 /*-----------------------------------------------------------------------------
 * The dsp_rpc.asm file has a dependency on the exact order of the fields:
 * entry_point through args_in_reg. If they are changed, then dsp_rpc.asm will
@@ -116,6 +160,11 @@ typedef struct
     uint8_t         from_sub_device;
     uint8_t         num_cores;
     uint8_t         master_core;
+    uint8_t         chain_publish;
+    uint32_t        chain_flags;
+    uint32_t        chain_wait_id;
+    uint8_t         chain_wait;
+    uint32_t        wg_counter;
 } kernel_msg_t;
 
 typedef struct
@@ -133,8 +182,37 @@ typedef struct
     int8_t          profiling_status;
     uint32_t        profiling_counter0_val;
     uint32_t        profiling_counter1_val;
+
+    /* Core cycle counter (low, high) when the command started and ended */
+    uint32_t        cycles_start[2];
+    uint32_t        cycles_end[2];
 } command_retcode_t;
 
+/*-----------------------------------------------------------------------------
+* Batched kernel launches and completions.
+* Host -> DSP: msgs_addr points to num_msgs kernel messages (TASK or NDRKERNEL)
+*              in shared memory, which the monitor runs in order.
+* DSP -> Host: done lists the kernels of the batch with their Kernel_id,
+*              return code, original command and cycle counts; msgs_addr is
+*              passed back so the host can free the shared memory.
+*----------------------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t        trans_id;
+    int32_t         retcode;
+    uint16_t        command;
+    uint16_t        is_ooo_task;
+    uint32_t        cycles_start[2];
+    uint32_t        cycles_end[2];
+} batch_retcode_t;
+
+typedef struct
+{
+    uint32_t        num_msgs;
+    uint32_t        msgs_addr;
+    batch_retcode_t done[MAX_BATCH_MSGS];
+} batch_msg_t;
+
 /*-----------------------------------------------------------------------------
 * Kernel message to Eve
 *----------------------------------------------------------------------------*/
@@ -164,6 +242,7 @@ typedef struct
         kernel_eve_t        k_eve;
         configure_monitor_t configure_monitor;
         command_retcode_t   command_retcode;
+        batch_msg_t         batch;
         char message[sizeof(kernel_config_t) + sizeof(kernel_msg_t) + 
                      sizeof(flush_msg_t)];
     } u;
@@ -197,6 +276,15 @@ static const uint32_t mbox_payload         = sizeof(Msg_t);
 #define IS_OOO_TASK(msg) ((msg.command == TASK) && \
                           (msg.u.k.config.global_size[0] != IN_ORDER_TASK_SIZE))
 
+/*-----------------------------------------------------------------------------
+* Kernel messages that can ride in a BATCH: no debug, profiling or timeout
+* handling, which all need the message to themselves on the DSP side
+*----------------------------------------------------------------------------*/
+#define IS_BATCHABLE(msg) (((msg.command == NDRKERNEL) || IS_OOO_TASK(msg)) && \
+                 (msg.u.k.config.WG_gid_start[0] == NORMAL_MODE_WG_GID_START) && \
+                 (msg.u.k.kernel.profiling.event_type == 0) && \
+                 (msg.u.k.kernel.timeout_ms == 0))
+
 #define IS_DEBUG_MODE(msg) (msg.u.k.config.WG_gid_start[0] == \
                             DEBUG_MODE_WG_GID_START)
 #endif
@@ -0,0 +1,185 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include "placement.h"
+#include "buffer.h"
+#include "buffer_pool.h"
+
+#include "CL/cl_ext.h"
+#include "../memobject.h"
+
+#include <climits>
+#include <cstring>
+
+using namespace Coal;
+using namespace tiocl;
+
+MsmcPlacement::MsmcPlacement(SharedMemory *shm, unsigned int threshold,
+                             uint64_t msmc_size)
+    : p_shm(shm), p_threshold(threshold),
+      p_max_size(msmc_size >> MSMC_PLACEMENT_MAX_SIZE_SHIFT)
+{
+    pthread_mutex_init(&p_mutex, 0);
+}
+
+MsmcPlacement::~MsmcPlacement()
+{
+    pthread_mutex_destroy(&p_mutex);
+}
+
+/******************************************************************************
+* Only whole buffers the runtime allocated itself can move: the address of a
+* host pointer, of an explicit MSMC buffer, or of the parent of a sub-buffer
+* is known outside of the DSPBuffer.
+******************************************************************************/
+bool MsmcPlacement::Eligible(DSPBuffer *buffer) const
+{
+    MemObject *mem = buffer->p_buffer;
+
+    return buffer->p_data_malloced                                      &&
+           mem->type() == MemObject::Buffer                             &&
+           (mem->flags() & (CL_MEM_USE_HOST_PTR | CL_MEM_USE_MSMC_TI)) == 0 &&
+           !((Buffer *)mem)->hasSubBuffers()                            &&
+           mem->size() <= p_max_size;
+}
+
+void MsmcPlacement::Launched(DSPBuffer *buffer)
+{
+    pthread_mutex_lock(&p_mutex);
+
+    unsigned int launches = ++buffer->p_launches;
+
+    if (launches >= p_threshold && !buffer->p_promoted && Eligible(buffer))
+    {
+        MoveResult result;
+        while ((result = Move(buffer, true)) == NoRoom)
+        {
+            DSPBuffer *victim = Coldest(launches / MSMC_PLACEMENT_DEMOTE_RATIO);
+            if (victim == NULL || Move(victim, false) != Moved) break;
+        }
+    }
+
+    pthread_mutex_unlock(&p_mutex);
+}
+
+uint64_t MsmcPlacement::AllocateMSMC(size_t size)
+{
+    pthread_mutex_lock(&p_mutex);
+
+    uint64_t addr;
+    while ((addr = p_shm->AllocateMSMC(size)) == 0)
+    {
+        DSPBuffer *victim = Coldest(UINT_MAX);
+        if (victim == NULL || Move(victim, false) != Moved) break;
+    }
+
+    pthread_mutex_unlock(&p_mutex);
+    return addr;
+}
+
+void MsmcPlacement::Forget(DSPBuffer *buffer)
+{
+    pthread_mutex_lock(&p_mutex);
+    p_promoted.remove(buffer);
+    pthread_mutex_unlock(&p_mutex);
+}
+
+/******************************************************************************
+* Least launched promoted buffer with fewer than below launches and not
+* pinned at the moment, or NULL
+******************************************************************************/
+DSPBuffer *MsmcPlacement::Coldest(unsigned int below) const
+{
+    DSPBuffer *coldest = NULL;
+
+    for (DSPBuffer *buffer : p_promoted)
+    {
+        if (buffer->p_launches >= below || buffer->p_pins > 0) continue;
+        if (coldest == NULL || buffer->p_launches < coldest->p_launches)
+            coldest = buffer;
+    }
+
+    return coldest;
+}
+
+/******************************************************************************
+* Copy the content of buffer to a new allocation and free the old one.
+* Called with the placement mutex held.
+******************************************************************************/
+MsmcPlacement::MoveResult MsmcPlacement::Move(DSPBuffer *buffer,
+                                              bool to_msmc)
+{
+    size_t   size = buffer->p_buffer->size();
+    uint64_t to   = to_msmc ? p_shm->AllocateMSMC(size)
+                            : p_shm->AllocateGlobal(size, false);
+    if (to == 0) return NoRoom;
+
+    pthread_mutex_lock(&buffer->p_pin_mutex);
+
+    if (buffer->p_pins > 0)
+    {
+        pthread_mutex_unlock(&buffer->p_pin_mutex);
+        p_shm->FreeMSMCorGlobal(to);
+        return Pinned;
+    }
+
+    uint64_t from = buffer->p_data;
+    void *src = p_shm->Map(from, size, true);
+    void *dst = p_shm->Map(to,   size, false);
+    memcpy(dst, src, size);
+    p_shm->Unmap(dst, to,   size, true);
+    p_shm->Unmap(src, from, size, false);
+
+    if (buffer->p_pool)
+    {
+        buffer->p_pool->Free(from, size);
+        buffer->p_pool = NULL;
+    }
+    else
+        p_shm->FreeMSMCorGlobal(from);
+
+    buffer->p_data     = to;
+    buffer->p_promoted = to_msmc;
+
+    pthread_mutex_unlock(&buffer->p_pin_mutex);
+
+    /*-------------------------------------------------------------------------
+    * Host cache state recorded for the old address does not carry over
+    *------------------------------------------------------------------------*/
+    buffer->p_buffer->setDeviceOwned();
+
+    if (to_msmc)
+        p_promoted.push_back(buffer);
+    else
+    {
+        // A demoted buffer has to become hot again to come back
+        p_promoted.remove(buffer);
+        buffer->p_launches = 0;
+    }
+
+    return Moved;
+}
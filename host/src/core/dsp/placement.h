@@ -0,0 +1,104 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#ifndef _MSMC_PLACEMENT_H
+#define _MSMC_PLACEMENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <list>
+
+#include "../tiocl_thread.h"
+#include "../shared_memory_interface.h"
+
+/*-----------------------------------------------------------------------------
+* Only buffers up to a quarter of the MSMC heap are promoted, so that a few
+* hot buffers share it instead of one taking it all. A promoted buffer is only
+* demoted for a buffer launched at least twice as often, so two buffers of
+* similar heat do not keep trading places.
+*----------------------------------------------------------------------------*/
+#define MSMC_PLACEMENT_MAX_SIZE_SHIFT   2
+#define MSMC_PLACEMENT_DEMOTE_RATIO     2
+
+namespace Coal {
+
+class DSPBuffer;
+
+/******************************************************************************
+* MsmcPlacement : moves hot buffers of one device between DDR and MSMC.
+*   Each kernel launch counts one use of its global buffer arguments. A buffer
+*   used by TI_OCL_MSMC_AUTO_PLACEMENT launches is promoted to MSMC if it fits,
+*   demoting colder promoted buffers if needed. Buffers explicitly allocated in
+*   MSMC (CL_MEM_USE_MSMC_TI) demote promoted buffers when MSMC runs out.
+*
+*   A buffer is only moved while no command holds its device address, see
+*   DSPBuffer::pin(). Moving copies its content through the host and
+*   leaves it host owned.
+*
+*   Lock order: placement mutex, then DSPBuffer pin mutex.
+******************************************************************************/
+class MsmcPlacement
+{
+  public:
+    MsmcPlacement(tiocl::SharedMemory *shm, unsigned int threshold,
+                  uint64_t msmc_size);
+    ~MsmcPlacement();
+
+    /*-------------------------------------------------------------------------
+    * A kernel launch is about to pin buffer. Counts the use and promotes the
+    * buffer when it becomes hot.
+    *------------------------------------------------------------------------*/
+    void Launched(DSPBuffer *buffer);
+
+    /*-------------------------------------------------------------------------
+    * Allocate size bytes of MSMC for an explicit MSMC buffer, demoting
+    * promoted buffers, coldest first, when the heap is full. 0 on failure.
+    *------------------------------------------------------------------------*/
+    uint64_t AllocateMSMC(size_t size);
+
+    /*-------------------------------------------------------------------------
+    * buffer is being destroyed
+    *------------------------------------------------------------------------*/
+    void Forget(DSPBuffer *buffer);
+
+  private:
+    enum MoveResult { Moved, Pinned, NoRoom };
+
+    bool       Eligible(DSPBuffer *buffer) const;
+    MoveResult Move(DSPBuffer *buffer, bool to_msmc);
+    DSPBuffer *Coldest(unsigned int below) const;
+
+    tiocl::SharedMemory *  p_shm;
+    unsigned int           p_threshold;
+    size_t                 p_max_size;
+    std::list<DSPBuffer *> p_promoted;
+    pthread_mutex_t        p_mutex;
+};
+
+}
+
+#endif // _MSMC_PLACEMENT_H
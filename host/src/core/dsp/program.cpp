@@ -60,6 +60,7 @@ genfile_cache * genfile_cache::pInstance = 0;
 #include "tal/dload_impl.h"
 #include "../error_report.h"
 #include "../oclenv.h"
+#include "../trace.h"
 
 
 using namespace tiocl;
@@ -68,7 +69,7 @@ using namespace Coal;
 
 DSPProgram::DSPProgram(DSPDevice *device, Program *program)
 : DeviceProgram(), p_device(device), p_program(program), p_nativebin(nullptr),
-  p_loaded(false), p_keep_files(false), p_cache_kernels(false), p_debug(false),
+  p_loaded(false), p_keep_files(false), p_debug(false),
   p_info(false), p_ocl_local_overlay_start(0), p_dl(nullptr)
 {
     ReportTrace("DSPProgram()\n");
@@ -77,11 +78,8 @@ DSPProgram::DSPProgram(DSPDevice *device, Program *program)
     char *keep = env.GetEnv<EnvVar::Var::TI_OCL_KEEP_FILES>(nullptr);
     if (keep) p_keep_files = true;
 
-    char *cache = env.GetEnv<EnvVar::Var::TI_OCL_CACHE_KERNELS>(nullptr);
-    if (cache) p_cache_kernels = true;
-
     char *debug = env.GetEnv<EnvVar::Var::TI_OCL_DEBUG>(nullptr);
-    if (debug) { p_debug = true; p_cache_kernels = false; }
+    if (debug) p_debug = true;
 
     char *info = env.GetEnv<EnvVar::Var::TI_OCL_DEVICE_PROGRAM_INFO>(nullptr);
     if (info) { p_info = true; p_keep_files = true; }
@@ -99,7 +97,8 @@ DSPProgram::~DSPProgram()
     p_dl = nullptr;
 
 #ifndef _SYS_BIOS
-    if (!p_keep_files && !p_cache_kernels && !p_outfile.empty())
+    // Binaries from the kernel cache are private pins of the cache entries
+    if (!p_keep_files && !p_outfile.empty())
     {
         unlink(p_outfile.c_str());
     }
@@ -109,6 +108,7 @@ DSPProgram::~DSPProgram()
 bool DSPProgram::load()
 {
     if (p_dl == nullptr)  return true;
+    TraceScope trace("load program");
 #ifndef _SYS_BIOS
     if (!p_dl->LoadProgram(p_outfile))
 #else
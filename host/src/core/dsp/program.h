@@ -92,7 +92,6 @@ class DSPProgram : public DeviceProgram
         std::string  *p_nativebin;
         bool          p_loaded;
         bool          p_keep_files;
-        bool          p_cache_kernels;
         bool          p_debug;
         bool          p_info;
         DSPDevicePtr  p_ocl_local_overlay_start;
@@ -27,8 +27,13 @@
  *****************************************************************************/
 #include "rootdevice.h"
 #include "device_info.h"
+#include "placement.h"
 #include "core/error_report.h"
 #include "../oclenv.h"
+#include "../trace.h"
+
+#include <algorithm>
+#include <cstring>
 
 #ifdef _SYS_BIOS
 #include <ti/sysbios/knl/Task.h>
@@ -91,7 +96,56 @@ DSPRootDevice::DSPRootDevice(unsigned char dsp_id, SharedMemory* shm)
     /*-------------------------------------------------------------------------
     * Initialize Core Scheduler
     *------------------------------------------------------------------------*/
-    core_scheduler_ = new CoreScheduler(p_compute_units, CORE_SCHEDULER_DEFAULT_DEPTH);
+    const char *policy = env.GetEnv<EnvVar::Var::TI_OCL_CORE_SCHEDULER>(nullptr);
+    cl_int      depth  = env.GetEnv<EnvVar::Var::TI_OCL_CORE_SCHEDULER_DEPTH>(
+                                              CORE_SCHEDULER_DEFAULT_DEPTH);
+    if (depth <= 0)  depth = CORE_SCHEDULER_DEFAULT_DEPTH;
+    core_scheduler_ = new CoreScheduler(p_compute_units, depth,
+                            (policy != nullptr && strcmp(policy, "cost") == 0)
+                            ? CoreScheduler::Policy::EARLIEST_FINISH
+                            : CoreScheduler::Policy::LEAST_LOADED);
+
+    /*-------------------------------------------------------------------------
+    * Kernel messages are sent in batches of up to p_mail_batch_size per core.
+    * A batch size of 1 sends every message on its own.
+    *------------------------------------------------------------------------*/
+    cl_int batch_size = env.GetEnv<EnvVar::Var::TI_OCL_MAILBOX_BATCH_SIZE>(
+                                              MAX_BATCH_MSGS);
+    p_mail_batch_size = std::max(1, std::min(batch_size, MAX_BATCH_MSGS));
+    pthread_mutex_init(&p_mail_mutex, 0);
+
+    /*-------------------------------------------------------------------------
+    * In-order NDRange kernels can be chained on the device, see
+    * DSPDevice::chainEvents(). The flags start with an id no kernel has.
+    *------------------------------------------------------------------------*/
+    p_chain_flags     = 0;
+    p_chain_flags_dsp = 0;
+    memset(p_chain_refs, 0, sizeof(p_chain_refs));
+    pthread_mutex_init(&p_chain_mutex, 0);
+    pthread_cond_init(&p_chain_cond, 0);
+    if (env.GetEnv<EnvVar::Var::TI_OCL_EVENT_CHAINING>(1) != 0)
+    {
+        size_t size   = CHAIN_SLOTS * MAX_NUM_CORES * CHAIN_FLAG_SIZE;
+        p_chain_flags = shm->AllocateGlobal(size, true);
+        if (p_chain_flags != 0 && p_chain_flags < 0xFFFFFFFF)
+        {
+            void *flags = shm->Map(p_chain_flags, size, false);
+            memset(flags, 0xFF, size);
+            shm->Unmap(flags, p_chain_flags, size, true);
+            p_chain_flags_dsp = (DSPVirtPtr) p_chain_flags;
+        }
+    }
+
+    /*-------------------------------------------------------------------------
+    * Buffers launched TI_OCL_MSMC_AUTO_PLACEMENT times are moved to MSMC
+    *------------------------------------------------------------------------*/
+    p_placement = nullptr;
+    cl_int placement_threshold =
+        env.GetEnv<EnvVar::Var::TI_OCL_MSMC_AUTO_PLACEMENT>(0);
+    uint64_t msmc_size = shm->HeapSize(MemoryRange::Kind::CMEM_PERSISTENT,
+                                       MemoryRange::Location::ONCHIP);
+    if (placement_threshold > 0 && msmc_size > 0)
+        p_placement = new MsmcPlacement(shm, placement_threshold, msmc_size);
 
     /*-------------------------------------------------------------------------
     * Initialize the mailboxes on the cores, so they can receive an exit cmd
@@ -125,6 +179,7 @@ DSPRootDevice::DSPRootDevice(unsigned char dsp_id, SharedMemory* shm)
     * Query DSP frequency; monitor is in message loop task after this point.
     *------------------------------------------------------------------------*/
     setup_dsp_mhz();
+    Trace::setDeviceClock(p_dsp_id, p_dsp_mhz);
 
     /*-------------------------------------------------------------------------
     * Allocate p_complete_pending map
@@ -245,6 +300,11 @@ DSPRootDevice::~DSPRootDevice()
     mail_to(exitMsg, p_compute_units);
 
     delete p_mb;
+    pthread_mutex_destroy(&p_mail_mutex);
+    if (p_chain_flags != 0)  GetSHMHandler()->FreeGlobal(p_chain_flags);
+    pthread_mutex_destroy(&p_chain_mutex);
+    pthread_cond_destroy(&p_chain_cond);
+    delete p_placement;
     delete p_complete_pending;
 
     /*-------------------------------------------------------------------------
@@ -363,11 +423,31 @@ bool DSPRootDevice::mail_query()
     return p_mb->query();
 }
 
+/*-----------------------------------------------------------------------------
+* Cycle counter of a core, as (low, high) in a reply
+*----------------------------------------------------------------------------*/
+static inline uint64_t cycles(const uint32_t *c)
+{
+    return ((uint64_t) c[1] << 32) | c[0];
+}
+
 /******************************************************************************
 * DSPRootDevice::mail_query(int* retcode, const DSPCoreSet& compute_units)
 ******************************************************************************/
 int DSPRootDevice::mail_from(const DSPCoreSet& compute_units, int* retcode)
 {
+    /*-------------------------------------------------------------------------
+    * Return completions left over from an earlier BATCH reply first. Only
+    * the completion worker thread receives mail, so no locking is needed.
+    *------------------------------------------------------------------------*/
+    if (!p_mail_completions.empty())
+    {
+        std::pair<int32_t, int> done = p_mail_completions.front();
+        p_mail_completions.pop_front();
+        if (retcode != nullptr)  *retcode = done.second;
+        return done.first;
+    }
+
     uint32_t size_rx;
     int32_t  trans_id_rx;
     Msg_t    rxmsg;
@@ -403,13 +483,40 @@ int DSPRootDevice::mail_from(const DSPCoreSet& compute_units, int* retcode)
         {
             command_retcode_t* profiling_data = &(rxmsg.u.command_retcode);
             recordProfilingData(profiling_data, core);
+            Trace::deviceRun(p_dsp_id, core, trans_id_rx,
+                             cycles(profiling_data->cycles_start),
+                             cycles(profiling_data->cycles_end));
             if (rxmsg.command == TASK && IS_OOO_TASK(rxmsg))
             {
                 if (compute_units.find(core) != compute_units.end())
-                    core_scheduler_->free(core);
+                    core_scheduler_->free(core, trans_id_rx);
             }
             break;
         }
+
+        /*---------------------------------------------------------------------
+        * A BATCH reply reports several completed kernels. Queue them all and
+        * return the first.
+        *--------------------------------------------------------------------*/
+        case BATCH:
+        {
+            batch_msg_t* batch = &(rxmsg.u.batch);
+            GetSHMHandler()->FreeMSMCorGlobal(batch->msgs_addr);
+            for (uint32_t i = 0; i < batch->num_msgs; i++)
+            {
+                batch_retcode_t& done = batch->done[i];
+                Trace::deviceRun(p_dsp_id, core, done.trans_id,
+                                 cycles(done.cycles_start),
+                                 cycles(done.cycles_end));
+                if (done.is_ooo_task &&
+                    compute_units.find(core) != compute_units.end())
+                    core_scheduler_->free(core, done.trans_id);
+                p_mail_completions.push_back(
+                       std::make_pair((int32_t) done.trans_id, done.retcode));
+            }
+            if (p_mail_completions.empty())  return -1;
+            return mail_from(compute_units, retcode);
+        }
         default:
             break;
     }
@@ -425,6 +532,18 @@ void DSPRootDevice::mail_to(Msg_t& msg,
                             const DSPCoreSet& compute_units)
 {
     msg.pid = p_pid;
+
+    /*-------------------------------------------------------------------------
+    * Kernel launches are staged and go out with the next batch. Anything
+    * else must not overtake what has already been staged.
+    *------------------------------------------------------------------------*/
+    if (p_mail_batch_size > 1 && IS_BATCHABLE(msg))
+    {
+        mail_batch(msg, compute_units);
+        return;
+    }
+    mail_flush();
+
     switch (msg.command)
     {
         /*-----------------------------------------------------------------
@@ -465,7 +584,9 @@ void DSPRootDevice::mail_to(Msg_t& msg,
             {
                 if (IS_OOO_TASK(msg))
                 {
-                    int dsp_id = core_scheduler_->allocate(compute_units);
+                    int dsp_id = core_scheduler_->allocate(compute_units,
+                                               msg.u.k.kernel.entry_point,
+                                               msg.u.k.kernel.Kernel_id);
                     p_mb->to((uint8_t*)&msg, sizeof(Msg_t), dsp_id);
                 }
                 else
@@ -501,6 +622,153 @@ void DSPRootDevice::mail_to(Msg_t& msg,
     }
 }
 
+/******************************************************************************
+ * DSPRootDevice::mail_batch(Msg_t& msg, const DSPCoreSet& compute_units)
+ *   Stage a kernel message with the same core placement as mail_to
+******************************************************************************/
+void DSPRootDevice::mail_batch(Msg_t& msg, const DSPCoreSet& compute_units)
+{
+    pthread_mutex_lock(&p_mail_mutex);
+    if (IS_OOO_TASK(msg))
+    {
+        /*---------------------------------------------------------------------
+        * Tasks still staged hold their cores in the scheduler. Send them
+        * before allocate() waits for a core to become free.
+        *--------------------------------------------------------------------*/
+        if (!core_scheduler_->available(compute_units))
+            for (auto & compute_unit : p_compute_units)
+                mail_send_batch(compute_unit);
+
+        int dsp_id = core_scheduler_->allocate(compute_units,
+                                               msg.u.k.kernel.entry_point,
+                                               msg.u.k.kernel.Kernel_id);
+        mail_stage(msg, dsp_id);
+    }
+    else
+    {
+        for (auto & compute_unit : compute_units)
+            mail_stage(msg, compute_unit);
+    }
+    pthread_mutex_unlock(&p_mail_mutex);
+}
+
+/******************************************************************************
+ * DSPRootDevice::mail_stage(Msg_t& msg, uint8_t core)
+ *   Append msg to the batch for core, send the batch once it is full
+******************************************************************************/
+void DSPRootDevice::mail_stage(Msg_t& msg, uint8_t core)
+{
+    std::vector<Msg_t>& batch = p_mail_batch[core];
+    batch.push_back(msg);
+    if (batch.size() >= p_mail_batch_size)
+        mail_send_batch(core);
+}
+
+/******************************************************************************
+ * DSPRootDevice::mail_send_batch(uint8_t core)
+ *   Caller holds p_mail_mutex. The staged messages are copied to shared memory
+ *   and a single BATCH message points the monitor to them. A lone message, or
+ *   a batch that does not get shared memory, is sent as individual messages.
+******************************************************************************/
+void DSPRootDevice::mail_send_batch(uint8_t core)
+{
+    std::vector<Msg_t>& batch = p_mail_batch[core];
+    if (batch.empty())  return;
+
+    uint32_t       size = batch.size() * sizeof(Msg_t);
+    DSPDevicePtr64 addr = 0;
+    if (batch.size() > 1)
+    {
+        SharedMemory *shm = GetSHMHandler();
+        addr = shm->AllocateMSMC(size);
+        if (!addr)  addr = shm->AllocateGlobal(size, true);
+        if (addr)
+        {
+            void *mapped_addr = shm->Map(addr, size, false);
+            memcpy(mapped_addr, batch.data(), size);
+            shm->Unmap(mapped_addr, addr, size, true);
+        }
+    }
+
+    if (addr)
+    {
+        Msg_t msg = {BATCH};
+        msg.pid                 = p_pid;
+        msg.u.batch.num_msgs    = batch.size();
+        msg.u.batch.msgs_addr   = (DSPVirtPtr) addr;
+        p_mb->to((uint8_t*)&msg, sizeof(Msg_t), core);
+    }
+    else
+    {
+        for (auto & msg : batch)
+            p_mb->to((uint8_t*)&msg, sizeof(Msg_t), core);
+    }
+    batch.clear();
+}
+
+/******************************************************************************
+ * DSPRootDevice::mail_flush()
+ *   Send all staged kernel messages
+******************************************************************************/
+void DSPRootDevice::mail_flush()
+{
+    pthread_mutex_lock(&p_mail_mutex);
+    for (auto & compute_unit : p_compute_units)
+        mail_send_batch(compute_unit);
+    pthread_mutex_unlock(&p_mail_mutex);
+}
+
+/******************************************************************************
+ * DSPRootDevice::setCoreScheduler(CoreScheduler::Policy policy, uint32_t depth)
+******************************************************************************/
+void DSPRootDevice::setCoreScheduler(CoreScheduler::Policy policy,
+                                     uint32_t depth)
+{
+    core_scheduler_->configure(policy, depth);
+}
+
+/******************************************************************************
+ * DSPRootDevice::chain_acquire()
+ *   Reserve a slot of completion flags for a kernel about to be sent, with one
+ *   reference. Slots are released as kernels complete, so wait for one if
+ *   they are all in use, once the staged kernel messages are sent. With at
+ *   most MAX_NUM_COMPLETION_PENDING kernels in flight, each holding at most
+ *   two slots, this should not happen. Returns -1 if chaining is disabled.
+******************************************************************************/
+int DSPRootDevice::chain_acquire()
+{
+    if (p_chain_flags_dsp == 0) return -1;
+
+    pthread_mutex_lock(&p_chain_mutex);
+    int slot = -1;
+    while (true)
+    {
+        for (int i = 0; i < CHAIN_SLOTS && slot < 0; i++)
+            if (p_chain_refs[i] == 0) slot = i;
+        if (slot >= 0) break;
+        mail_flush();
+        pthread_cond_wait(&p_chain_cond, &p_chain_mutex);
+    }
+    p_chain_refs[slot] = 1;
+    pthread_mutex_unlock(&p_chain_mutex);
+    return slot;
+}
+
+void DSPRootDevice::chain_retain(int slot)
+{
+    pthread_mutex_lock(&p_chain_mutex);
+    p_chain_refs[slot] += 1;
+    pthread_mutex_unlock(&p_chain_mutex);
+}
+
+void DSPRootDevice::chain_release(int slot)
+{
+    pthread_mutex_lock(&p_chain_mutex);
+    if (--p_chain_refs[slot] == 0)
+        pthread_cond_signal(&p_chain_cond);
+    pthread_mutex_unlock(&p_chain_mutex);
+}
+
 /******************************************************************************
  * Complete Pending access functions
 ******************************************************************************/
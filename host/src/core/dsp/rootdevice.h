@@ -30,6 +30,8 @@
 
 #include "device.h"
 #include "../kernelentry.h"
+#include <deque>
+#include <vector>
 
 namespace Coal
 {
@@ -55,6 +57,7 @@ public:
                                int* retcode = nullptr)           override;
     void             mail_to(Msg_t& msg,
                              const DSPCoreSet& compute_units)    override;
+    void             mail_flush()                                override;
     int              num_complete_pending()                      override;
     void             dump_complete_pending()                     override;
     bool             any_complete_pending()                      override;
@@ -69,12 +72,26 @@ public:
     DeviceInterface* GetRootDevice()  override  { return this; }
     const DeviceInterface* GetRootDevice() const override { return this; }
 
+    void             setCoreScheduler(CoreScheduler::Policy policy,
+                                      uint32_t depth)            override;
+
+    DSPVirtPtr       chain_flags()  override { return p_chain_flags_dsp; }
+    int              chain_acquire()                             override;
+    void             chain_retain(int slot)                      override;
+    void             chain_release(int slot)                     override;
+    MsmcPlacement*   placement()    override { return p_placement; }
+
     void             init_ulm();
     void             setup_dsp_mhz();
     void             init_builtin_kernels();
     const std::vector<KernelEntry*>* getKernelEntries() const override
                                                  { return &p_kernel_entries; }
 
+private:
+    void             mail_batch(Msg_t& msg, const DSPCoreSet& compute_units);
+    void             mail_stage(Msg_t& msg, uint8_t core);
+    void             mail_send_batch(uint8_t core);
+
 private:
     std::list<Event*>               p_events;
     pthread_cond_t                  p_events_cond;
@@ -92,6 +109,30 @@ private:
     pthread_t                       p_worker_completion;
     std::vector<KernelEntry*>       p_kernel_entries;
     uint32_t                        p_printf_coreid_show;
+
+    /*-------------------------------------------------------------------------
+    * Kernel messages staged per core until they are sent as one BATCH, and
+    * completions unpacked from a BATCH reply not yet returned by mail_from
+    *------------------------------------------------------------------------*/
+    std::vector<Msg_t>              p_mail_batch[MAX_NUM_CORES];
+    pthread_mutex_t                 p_mail_mutex;
+    uint32_t                        p_mail_batch_size;
+    std::deque<std::pair<int32_t, int> > p_mail_completions;
+
+    /*-------------------------------------------------------------------------
+    * Completion flags of chained kernels: CHAIN_SLOTS slots of MAX_NUM_CORES
+    * flags, a slot is in use while p_chain_refs is not 0
+    *------------------------------------------------------------------------*/
+    DSPDevicePtr64                  p_chain_flags;
+    DSPVirtPtr                      p_chain_flags_dsp;
+    uint32_t                        p_chain_refs[CHAIN_SLOTS];
+    pthread_mutex_t                 p_chain_mutex;
+    pthread_cond_t                  p_chain_cond;
+
+    /*-------------------------------------------------------------------------
+    * Automatic MSMC placement of hot buffers, NULL when disabled
+    *------------------------------------------------------------------------*/
+    MsmcPlacement*                  p_placement;
 };
 
 }
@@ -53,6 +53,7 @@ public:
     Event*           getEvent(bool& stop)    override { return p_parent->getEvent(stop);         }
     bool             gotEnoughToWorkOn()     override { return p_parent->gotEnoughToWorkOn();    }
     bool             mail_query()            override { return p_parent->mail_query();           }
+    void             mail_flush()            override { p_parent->mail_flush();                  }
     float            dspMhz() const          override { return p_parent->dspMhz();               }
     unsigned char    dspID()  const          override { return p_parent->dspID();                }
     int              num_complete_pending()  override { return p_parent->num_complete_pending(); }
@@ -60,6 +61,13 @@ public:
     bool             any_complete_pending()  override { return p_parent->any_complete_pending(); }
     pthread_cond_t*  get_worker_cond()       override { return p_parent->get_worker_cond();      }
     pthread_mutex_t* get_worker_mutex()      override { return p_parent->get_worker_mutex();     }
+    void             setCoreScheduler(CoreScheduler::Policy policy, uint32_t depth) override
+                                              { p_parent->setCoreScheduler(policy, depth); }
+    DSPVirtPtr       chain_flags()           override { return p_parent->chain_flags();          }
+    int              chain_acquire()         override { return p_parent->chain_acquire();        }
+    void             chain_retain(int slot)  override { p_parent->chain_retain(slot);            }
+    void             chain_release(int slot) override { p_parent->chain_release(slot);           }
+    MsmcPlacement*   placement()             override { return p_parent->placement();            }
 
     DeviceInterface* GetRootDevice()   override { return p_root; }
     const DeviceInterface* GetRootDevice() const override { return p_root; }
@@ -41,4 +41,5 @@ public:
 };
 
 const SymbolAddressLookup* CreateSymbolAddressLookup(const std::string& binary_file);
+const SymbolAddressLookup* CreateEmulatedSymbolAddressLookup();
 }
@@ -31,22 +31,172 @@
 #include "program.h"
 #include "../../shared_memory_interface.h"
 #include "../../error_report.h"
+#include "../../oclenv.h"
+#ifndef _SYS_BIOS
+#include "../genfile_cache.h"
+#endif
 
 extern "C" {
 #include "dload_api.h"
 }
 
+#include <cstring>
+#ifndef _SYS_BIOS
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 
 using Coal::DSPDevice;
 using Coal::DSPProgram;
 
 using namespace tiocl;
 
+/*-----------------------------------------------------------------------------
+* Segment images
+*
+* DLIF_copy() hands the loader a host image of each segment to relocate in
+* place, DLIF_write() commits it. For segments in shared memory, the image is
+* the target memory itself, mapped into the host address space: the file bytes
+* are copied into it once and only the .bss tail is zero-filled. On Linux the
+* file bytes come from a read-only mapping of the ELF file.
+*
+* Initialized data in L2 is ignored, but the loader may still relocate it. Its
+* image is a private copy-on-write mapping of the file on Linux, a heap buffer
+* on SYS/BIOS.
+*----------------------------------------------------------------------------*/
+namespace
+{
+#ifndef _SYS_BIOS
+struct FileRange
+{
+    void   *base;   // page aligned mapping
+    size_t  size;
+    void   *data;   // file bytes at the requested offset
+};
+
+FileRange map_file_range(LOADER_FILE_DESC *f, int32_t offset, size_t size,
+                         bool writable)
+{
+    static const long page_size = sysconf(_SC_PAGESIZE);
+    size_t delta = offset % page_size;
+
+    FileRange range = { nullptr, size + delta, nullptr };
+    void *base = mmap(nullptr, range.size,
+                      writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                      MAP_PRIVATE, fileno(f), offset - delta);
+    if (base == MAP_FAILED) return range;
+
+    range.base = base;
+    range.data = (char *)base + delta;
+    return range;
+}
+
+void unmap_file_range(const FileRange &range)
+{
+    if (range.base) munmap(range.base, range.size);
+}
+#endif
+
+/*-----------------------------------------------------------------------------
+* Copy the size file bytes at offset to dst
+*----------------------------------------------------------------------------*/
+bool read_file_range(LOADER_FILE_DESC *f, int32_t offset, void *dst,
+                     size_t size)
+{
+#ifndef _SYS_BIOS
+    FileRange range = map_file_range(f, offset, size, false);
+    if (!range.data) return false;
+
+    memcpy(dst, range.data, size);
+    unmap_file_range(range);
+    return true;
+#else
+    DLIF_fseek(f, offset, SEEK_SET);
+    return DLIF_fread(dst, size, 1, f) == 1;
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+* Writable image of the file bytes of an L2 segment, and its release
+*----------------------------------------------------------------------------*/
+void *l2_image(LOADER_FILE_DESC *f, int32_t offset, size_t size)
+{
+#ifndef _SYS_BIOS
+    return map_file_range(f, offset, size, true).data;
+#else
+    void *buf = malloc(size);
+    if (buf && !read_file_range(f, offset, buf, size))
+    {
+        free(buf);
+        buf = nullptr;
+    }
+    return buf;
+#endif
+}
+
+void release_l2_image(void *image, int32_t offset, size_t size)
+{
+#ifndef _SYS_BIOS
+    static const long page_size = sysconf(_SC_PAGESIZE);
+    size_t delta = offset % page_size;
+
+    FileRange range = { (char *)image - delta, size + delta, image };
+    unmap_file_range(range);
+#else
+    free(image);
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+* Target memory of a segment linked at address. L2 is not allocated, the
+* segment stays where it was linked.
+*----------------------------------------------------------------------------*/
+DSPDevicePtr allocate_segment(DSPDevice *device, DSPDevicePtr address,
+                              uint32_t size)
+{
+    if (device->addr_is_l2(address)) return address;
+    return (DSPDevicePtr)device->GetSHMHandler()->AllocateGlobal(size, true);
+}
+
+void release_segment(DSPDevice *device, DSPDevicePtr address)
+{
+    if (!device->addr_is_l2(address))
+        device->GetSHMHandler()->FreeGlobal(address);
+}
+
+void print_segment_info(uint32_t flags, DSPDevicePtr address, uint32_t size)
+{
+    flags &= (DLOAD_SF_executable | DLOAD_SF_writable);
+
+    const char *seg_desc;
+    switch (flags)
+    {
+        case 0:                   seg_desc = "Read Only"; break;
+        case DLOAD_SF_executable: seg_desc = "Executable"; break;
+        case DLOAD_SF_writable:   seg_desc = "Writable"; break;
+        default:                  seg_desc = "Writable & Executable"; break;
+    }
+
+    printf("\t%s segment loaded to 0x%08x with size 0x%x\n",
+                   seg_desc, address, size);
+}
+}
+
 DLOAD::DLOAD(DSPProgram *program):
-                programLoadAddress(0), ph(-1)
+                program(program), programLoadAddress(0), ph(-1),
+                cacheImages(false), loadedFromImage(false), imageDataPage(0)
 {
     Lock lock(this);
     dloadHandle = DLOAD_create((void*)program);
+
+#ifndef _SYS_BIOS
+    EnvVar& env = EnvVar::Instance();
+    cacheImages = env.GetEnv<EnvVar::Var::TI_OCL_CACHE_IMAGES>(nullptr) &&
+                 !env.GetEnv<EnvVar::Var::TI_OCL_DEBUG>(nullptr);
+#endif
 }
 
 DLOAD::~DLOAD()
@@ -64,6 +214,31 @@ bool DLOAD::LoadProgram(const std::string &binary_str)
     Lock lock(this);
 
 #ifndef _SYS_BIOS
+    /*-------------------------------------------------------------------------
+    * Replay the image of a previous load of the same binary if there is one,
+    * otherwise record one while the target loader runs
+    *------------------------------------------------------------------------*/
+    std::string binary;
+    if (cacheImages)
+    {
+        std::ifstream     file(fileName.c_str(), std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        if (file.good()) binary = contents.str();
+    }
+
+    if (!binary.empty())
+    {
+        if (LoadImage(binary)) return true;
+
+        recordingFile = genfile_cache::instance()->image_tmpfile();
+        if (!recordingFile.empty())
+        {
+            recording.reset(new ProgramImage());
+            if (!recording->Create(recordingFile)) AbandonImage();
+        }
+    }
+
     FILE *fp = fopen(fileName.c_str(), "rb");
 
     //TODO: Can we propagate the error to DeviceProgram instead of exiting?
@@ -72,6 +247,12 @@ bool DLOAD::LoadProgram(const std::string &binary_str)
     ph = DLOAD_load(dloadHandle, fp);
 
     fclose(fp);
+
+    if (recording)
+    {
+        if (ph != 0) SaveImage(binary);
+        else         AbandonImage();
+    }
 #else
     LOADER_FILE_DESC f;
     f.binary = (int8_t*) binary_str.data();
@@ -93,6 +274,19 @@ bool DLOAD::LoadProgram(const std::string &binary_str)
 
 bool DLOAD::UnloadProgram()
 {
+    if (loadedFromImage)
+    {
+        Lock lock(this);
+        DSPDevice* device = program->GetDevice();
+        for (auto &segment : imageSegments)
+            release_segment(device, segment.address);
+
+        imageSegments.clear();
+        imageSymbols.clear();
+        loadedFromImage = false;
+        return true;
+    }
+
     if (dloadHandle)
     {
         assert (ph != 0);
@@ -106,6 +300,12 @@ bool DLOAD::UnloadProgram()
 
 DSPDevicePtr DLOAD::QuerySymbol(const std::string &symName) const
 {
+    if (loadedFromImage)
+    {
+        auto it = imageSymbols.find(symName);
+        return (it != imageSymbols.end()) ? it->second : 0;
+    }
+
     if (!dloadHandle || !ph)
         return 0;
 
@@ -119,6 +319,8 @@ DSPDevicePtr DLOAD::QuerySymbol(const std::string &symName) const
 
 DSPDevicePtr DLOAD::GetDataPagePointer() const
 {
+    if (loadedFromImage) return imageDataPage;
+
     if (!dloadHandle || !ph)
         return 0;
 
@@ -150,19 +352,16 @@ extern "C"
 /*****************************************************************************/
 BOOL DLIF_allocate(void* client_handle, struct DLOAD_MEMORY_REQUEST *targ_req)
 {
-   DSPDevice* device = ((DSPProgram*) client_handle)->GetDevice();
-   SharedMemory* shm = device->GetSHMHandler();
+   DSPProgram* program = (DSPProgram*) client_handle;
+   DSPDevice* device = program->GetDevice();
 
    /*------------------------------------------------------------------------*/
    /* Get pointers to API segment and file descriptors.                      */
    /*------------------------------------------------------------------------*/
    struct DLOAD_MEMORY_SEGMENT* obj_desc = targ_req->segment;
 
-   uint32_t addr;
-
-   if (device->addr_is_l2(obj_desc->target_address))
-        addr = obj_desc->target_address; // do not allocate L2
-   else addr = (uint32_t)shm->AllocateGlobal(obj_desc->memsz_in_bytes, true);
+   uint32_t addr = allocate_segment(device, obj_desc->target_address,
+                                    obj_desc->memsz_in_bytes);
 
 #if DEBUG
    printf("DLIF_allocate: %d bytes starting at 0x%x (relocated from 0x%x)\n",
@@ -172,6 +371,10 @@ BOOL DLIF_allocate(void* client_handle, struct DLOAD_MEMORY_REQUEST *targ_req)
 
    obj_desc->target_address = (TARGET_ADDRESS) addr;
 
+   if (addr != 0)
+       static_cast<DLOAD*>(program->GetDynamicLoader())->RecordSegment(
+                                          addr, obj_desc->memsz_in_bytes);
+
    /*------------------------------------------------------------------------*/
    /* Target memory request was successful.                                  */
    /*------------------------------------------------------------------------*/
@@ -187,11 +390,8 @@ BOOL DLIF_release(void* client_handle, struct DLOAD_MEMORY_SEGMENT* ptr)
    ReportTrace("DLIF_release()\n");
 
    DSPDevice* device = ((DSPProgram*) client_handle)->GetDevice();
-   SharedMemory* shm = device->GetSHMHandler();
 
-   if (device->addr_is_l2(ptr->target_address))
-        ; // local was not allocated
-   else shm->FreeGlobal((DSPDevicePtr)ptr->target_address);
+   release_segment(device, (DSPDevicePtr)ptr->target_address);
 
 #if DEBUG
    printf("DLIF_free: %d bytes starting at 0x%x\n",
@@ -218,26 +418,29 @@ BOOL DLIF_write(void* client_handle, struct DLOAD_MEMORY_REQUEST* req)
 
    SharedMemory*shm = device->GetSHMHandler();
 
+   static_cast<DLOAD*>(dl)->RecordSegmentData(
+                          (DSPDevicePtr)obj_desc->target_address,
+                          req->host_address, obj_desc->objsz_in_bytes,
+                          req->flags);
+
+   // release the image set up by DLIF_copy(), no more uses after DLIF_write
    if (device->addr_is_l2(obj_desc->target_address))
    {
        if (req->host_address)
+       {
            printf("Warning: Initialized data for objects in .mem_l2 sections will be ignored.\n");
+           release_l2_image(req->host_address, req->offset,
+                            obj_desc->objsz_in_bytes);
+       }
    }
    else if (req->host_address)
-       shm->WriteToShmem ((uint32_t)obj_desc->target_address,
-                             (uint8_t*)req->host_address,
-                             obj_desc->memsz_in_bytes);
+       shm->Unmap(req->host_address, (uint32_t)obj_desc->target_address,
+                  obj_desc->memsz_in_bytes, true);
+   req->host_address = nullptr;
 
     if (req->flags & DLOAD_SF_executable)
         dl->SetProgramLoadAddress((DSPDevicePtr)obj_desc->target_address);
 
-   // free space allocated in DLIF_copy(), no more uses after DLIF_write
-   if (req->host_address)
-   {
-       free(req->host_address);
-       req->host_address = nullptr;
-   }
-
 #if DEBUG
     printf("DLIF_write (dsp:%d): %d bytes starting at 0x%x\n",
                dsp_id, obj_desc->memsz_in_bytes,
@@ -245,22 +448,8 @@ BOOL DLIF_write(void* client_handle, struct DLOAD_MEMORY_REQUEST* req)
 #endif
 
     if (program->IsPrintInfoEnabled())
-    {
-        uint32_t flags = req->flags & (DLOAD_SF_executable | DLOAD_SF_writable);
-
-        const char *seg_desc;
-        switch (flags)
-        {
-            case 0:                   seg_desc = "Read Only"; break;
-            case DLOAD_SF_executable: seg_desc = "Executable"; break;
-            case DLOAD_SF_writable:   seg_desc = "Writable"; break;
-            default:                  seg_desc = "Writable & Executable"; break;
-        }
-
-        printf("\t%s segment loaded to 0x%08x with size 0x%x\n",
-                       seg_desc, obj_desc->target_address,
-                       obj_desc->memsz_in_bytes);
-    }
+        print_segment_info(req->flags, obj_desc->target_address,
+                           obj_desc->memsz_in_bytes);
 
     return 1;
 }
@@ -268,38 +457,53 @@ BOOL DLIF_write(void* client_handle, struct DLOAD_MEMORY_REQUEST* req)
 /*****************************************************************************/
 /* DLIF_COPY() - Copy data from file to host-accessible memory.              */
 /*      Returns a host pointer to the data in the host_address field of the  */
-/*      DLOAD_MEMORY_REQUEST object.                                         */
+/*      DLOAD_MEMORY_REQUEST object. Outside L2, the data is copied straight */
+/*      into the target memory, mapped until DLIF_write().                   */
 /*****************************************************************************/
 BOOL DLIF_copy(void* client_handle, struct DLOAD_MEMORY_REQUEST* targ_req)
 {
    struct DLOAD_MEMORY_SEGMENT* obj_desc = targ_req->segment;
    LOADER_FILE_DESC* f = targ_req->fp;
    DSPDevice* device = ((DSPProgram*) client_handle)->GetDevice();
+   SharedMemory* shm = device->GetSHMHandler();
+   size_t filesz = obj_desc->objsz_in_bytes;
+   size_t memsz  = obj_desc->memsz_in_bytes;
    void *buf = NULL;
 
-   int result = 1;
-   if (obj_desc->objsz_in_bytes)
-   {
-       buf = calloc(obj_desc->memsz_in_bytes, 1);
+   targ_req->host_address = NULL;
 
+   if (device->addr_is_l2(obj_desc->target_address))
+   {
+       if (filesz)
+       {
+           buf = l2_image(f, targ_req->offset, filesz);
+           if (buf == NULL)
+           {
+               DLIF_error(DLET_MEMORY, "DLIF allocation failure.\n");
+               return 0;
+           }
+       }
+   }
+   else if (memsz)
+   {
+       buf = shm->Map(obj_desc->target_address, memsz, false, true);
        if (buf == NULL)
        {
-           DLIF_error(DLET_MEMORY, "DLIF allocation failure.\n");
+           DLIF_error(DLET_MEMORY, "DLIF segment map failure.\n");
            return 0;
        }
 
-#ifndef _SYS_BIOS
-       fseek(f, targ_req->offset, SEEK_SET);
-       result = fread(buf, obj_desc->objsz_in_bytes, 1, f);
-#else
-       DLIF_fseek(f, targ_req->offset, SEEK_SET);
-       result = DLIF_fread(buf, obj_desc->objsz_in_bytes, 1, f);
-#endif
-   }
-   else  if (!device->addr_is_l2(obj_desc->target_address))
-       buf = calloc(obj_desc->memsz_in_bytes, 1);
+       if (filesz && !read_file_range(f, targ_req->offset, buf, filesz))
+       {
+           shm->Unmap(buf, obj_desc->target_address, memsz);
+           DLIF_error(DLET_FILE, "DLIF segment read failure.\n");
+           return 0;
+       }
 
-   assert(result == 1);
+       // zero-fill the .bss tail only
+       if (memsz > filesz)
+           memset((char *)buf + filesz, 0, memsz - filesz);
+   }
 
    targ_req->host_address = buf;
 
@@ -318,6 +522,9 @@ int DLIF_load_dependent(void* client_handle, const char* so_name)
 
    assert (dl != 0);
 
+   // The image of the program would not include the dependent file
+   static_cast<DLOAD*>(dl)->AbandonImage();
+
    FILE* fp = fopen(so_name, "rb");
 
    if (!fp)
@@ -352,3 +559,129 @@ void DLIF_unload_dependent(void* client_handle, uint32_t file_handle)
 }
 
 }
+
+/******************************************************************************
+* Program image cache
+******************************************************************************/
+void DLOAD::RecordSegment(DSPDevicePtr address, uint32_t memsz)
+{
+#ifndef _SYS_BIOS
+    if (recording) recording->AddSegment(address, memsz);
+#endif
+}
+
+void DLOAD::RecordSegmentData(DSPDevicePtr address, const void *data,
+                              uint32_t filesz, uint32_t flags)
+{
+#ifndef _SYS_BIOS
+    if (recording) recording->SetSegmentData(address, data, filesz, flags);
+#endif
+}
+
+void DLOAD::AbandonImage()
+{
+#ifndef _SYS_BIOS
+    if (!recording) return;
+
+    recording.reset();
+    unlink(recordingFile.c_str());
+    recordingFile.clear();
+#endif
+}
+
+#ifndef _SYS_BIOS
+/*-----------------------------------------------------------------------------
+* The relocated contents of an image are only valid at the addresses they
+* were relocated for. Its segments are allocated in the order of the load
+* that recorded it, with a heap in the same state they land at the same
+* addresses. If one does not, the image is of no use for this load.
+*----------------------------------------------------------------------------*/
+bool DLOAD::LoadImage(const std::string &binary)
+{
+    std::string filename = genfile_cache::instance()->lookup_image(binary);
+    if (filename.empty()) return false;
+
+    ProgramImage image;
+    if (!image.Open(filename)) return false;
+
+    DSPDevice    *device   = program->GetDevice();
+    SharedMemory *shm      = device->GetSHMHandler();
+    const std::vector<ProgramImage::Segment> &segments = image.Segments();
+
+    size_t allocated;
+    for (allocated = 0; allocated < segments.size(); allocated++)
+    {
+        const ProgramImage::Segment &segment = segments[allocated];
+        DSPDevicePtr addr = allocate_segment(device, segment.address,
+                                             segment.memsz);
+        if (addr == segment.address) continue;
+
+        if (addr != 0) release_segment(device, addr);
+        break;
+    }
+
+    if (allocated < segments.size())
+    {
+        while (allocated-- > 0)
+            release_segment(device, segments[allocated].address);
+        return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    * A segment that cannot be mapped is left to the target loader
+    *------------------------------------------------------------------------*/
+    for (auto &segment : segments)
+    {
+        if (device->addr_is_l2(segment.address) || !segment.memsz) continue;
+
+        void *dst = shm->Map(segment.address, segment.memsz, false, true);
+        if (dst == NULL)
+        {
+            for (auto &allocated_segment : segments)
+                release_segment(device, allocated_segment.address);
+            return false;
+        }
+
+        memcpy(dst, image.SegmentData(segment), segment.filesz);
+        memset((char *)dst + segment.filesz, 0,
+               segment.memsz - segment.filesz);
+        shm->Unmap(dst, segment.address, segment.memsz, true);
+    }
+
+    for (auto &segment : segments)
+    {
+        if (device->addr_is_l2(segment.address) && segment.filesz)
+            printf("Warning: Initialized data for objects in .mem_l2 sections will be ignored.\n");
+
+        if (program->IsPrintInfoEnabled())
+            print_segment_info(segment.flags, segment.address, segment.memsz);
+    }
+
+    imageSegments      = segments;
+    imageSymbols       = image.Symbols();
+    imageDataPage      = image.DataPage();
+    programLoadAddress = image.LoadAddress();
+    loadedFromImage    = true;
+    return true;
+}
+
+static void record_symbol(void *arg, const char *sym_name,
+                          TARGET_ADDRESS sym_val)
+{
+    static_cast<ProgramImage *>(arg)->AddSymbol(sym_name,
+                                                (DSPDevicePtr)sym_val);
+}
+
+void DLOAD::SaveImage(const std::string &binary)
+{
+    DLOAD_get_global_symbols(dloadHandle, ph, record_symbol, recording.get());
+
+    if (recording->Finish(GetDataPagePointer(), programLoadAddress))
+        genfile_cache::instance()->remember_image(recordingFile, binary);
+    else
+        unlink(recordingFile.c_str());
+
+    recording.reset();
+    recordingFile.clear();
+}
+#endif
@@ -30,6 +30,9 @@
 
 #include "dynamic_loader_interface.h"
 #include "u_lockable.h"
+#include "program_image.h"
+
+#include <memory>
 
 namespace Coal
 {
@@ -66,10 +69,38 @@ public:
     void SetProgramLoadAddress(DSPDevicePtr address);
     DLOAD_HANDLE GetDloadHandle() const { return dloadHandle; }
 
+    /*-------------------------------------------------------------------------
+    * Program image cache (TI_OCL_CACHE_IMAGES). While the target loader runs
+    * and an image is recorded, its callbacks report the segments it allocates
+    * and writes. A program that loads dependent files is not recorded.
+    *------------------------------------------------------------------------*/
+    void RecordSegment(DSPDevicePtr address, uint32_t memsz);
+    void RecordSegmentData(DSPDevicePtr address, const void *data,
+                           uint32_t filesz, uint32_t flags);
+    void AbandonImage();
+
 private:
+#ifndef _SYS_BIOS
+    bool LoadImage(const std::string &binary);
+    void SaveImage(const std::string &binary);
+#endif
+
+    Coal::DSPProgram *program;
     DLOAD_HANDLE dloadHandle;
     DSPDevicePtr programLoadAddress;
     ProgramHandle ph;
+
+    bool                          cacheImages;
+#ifndef _SYS_BIOS
+    std::unique_ptr<ProgramImage> recording;
+    std::string                   recordingFile;
+#endif
+
+    // Set when the program was loaded from an image instead of the loader
+    bool                               loadedFromImage;
+    std::vector<ProgramImage::Segment> imageSegments;
+    ProgramImage::SymbolMap            imageSymbols;
+    DSPDevicePtr                       imageDataPage;
 };
 
 }
@@ -0,0 +1,60 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#pragma once
+
+#include <stdint.h>
+
+/******************************************************************************
+* Host-side DSP emulation, selected with TI_OCL_DSP_EMULATION=<cores>
+*
+* The device is made of:
+* - an in-process mailbox, MBoxEmulation, with one host thread per DSP core
+*   that answers the monitor protocol after a modeled latency,
+* - shared memory in anonymous host mappings, laid out like the DSP address
+*   map below, see InitializationPolicyEmulation,
+* - fixed monitor symbols, see SymbolAddressLookupEmulation.
+* Kernel code does not run: the emulation measures the host runtime, from
+* enqueue to completion, on machines without a DSP. It is available in the
+* Linux builds that manage shared memory with CMEM, and is the only DSP in
+* DSP_EMULATION_ONLY builds, which need neither the IPC nor the CMEM library.
+******************************************************************************/
+#if !defined(_SYS_BIOS) && !defined(USE_ION)
+#define DSP_EMULATION_SUPPORTED
+#endif
+
+#define EMULATED_DSP_MHZ          (1000)
+
+/*-----------------------------------------------------------------------------
+* Emulated DSP address map
+*----------------------------------------------------------------------------*/
+#define EMULATED_L2_LOCAL_BASE    (0x00800000)
+#define EMULATED_L2_LOCAL_SIZE    (0x00020000)
+#define EMULATED_MSMC_BASE        (0x0C000000)
+#define EMULATED_MSMC_SIZE        (0x00400000)
+#define EMULATED_DDR_BASE         (0x80000000)
+#define EMULATED_DDR_SIZE         (0x20000000)
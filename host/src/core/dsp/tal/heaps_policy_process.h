@@ -61,9 +61,11 @@ public:
             utility::MultiProcess<DSPDevicePtr64, uint64_t> > Heap64Bit;
 
     /*-------------------------------------------------------------------------
-    * A shared memory segment named "HeapManager" will be opened and will
-    * contain the heap managers for all needed OpenCL buffer heaps. It will
-    * reside on the file system at /dev/shm/HeapManager. It is assumed this
+    * A shared memory segment named HEAP_MANAGER_SHM_NAME will be opened and
+    * will contain the heap managers for all needed OpenCL buffer heaps. It
+    * will reside on the file system at /dev/shm/HeapManager.v<version>. If a
+    * daemon from another release created a segment with another version, it
+    * is not found. It is assumed this
     * shared memory is created by a pre-existing daemon on Linux systems.
     *------------------------------------------------------------------------*/
     HeapsMultiProcessPolicy()
@@ -71,7 +73,7 @@ public:
         try
         {
             segment_ = new BIP::managed_shared_memory(BIP::open_only,
-                                                      "HeapManager");
+                                                      HEAP_MANAGER_SHM_NAME);
         }
         catch (BIP::interprocess_exception &ex)
         {
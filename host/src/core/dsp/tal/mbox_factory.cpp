@@ -25,14 +25,39 @@
  *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
  *   THE POSSIBILITY OF SUCH DAMAGE.
  *****************************************************************************/
+#include "dsp_emulation.h"
+#if !defined(DSP_EMULATION_ONLY)
 #include "mbox_impl_msgq.h"
+#else
+#include "core/error_report.h"
+#endif
+#if defined(DSP_EMULATION_SUPPORTED)
+#include "device_info.h"
+#include "mbox_impl_emulation.h"
+#endif
 
 MBox* MBoxFactory::CreateMailbox(Coal::DSPDevice* device)
 {
+#if defined(DSP_EMULATION_ONLY)
+    return new MBoxEmulation(device);
+#else
+#if defined(DSP_EMULATION_SUPPORTED)
+    if (tiocl::DeviceInfo::Instance().IsEmulated())
+        return new MBoxEmulation(device);
+#endif
+
     return new MBoxMsgQ(device);
+#endif
 }
 
 MBox* MBoxFactory::CreateMailbox(Coal::EVEDevice* device)
 {
+#if defined(DSP_EMULATION_ONLY)
+    // EVEs are not probed in emulation only builds
+    tiocl::ReportError(tiocl::ErrorType::Fatal,
+                       tiocl::ErrorKind::MailboxCreationFailed);
+    return nullptr;
+#else
     return new MBoxMsgQ(device);
+#endif
 }
@@ -0,0 +1,433 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <assert.h>
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+#include "device_info.h"
+#include "dsp_emulation.h"
+#include "mbox_impl_emulation.h"
+#include "core/error_report.h"
+#include "core/oclenv.h"
+#include "core/trace.h"
+
+using namespace Coal;
+using namespace tiocl;
+
+/*-----------------------------------------------------------------------------
+* Cycle counter of an emulated core, from the host monotonic clock
+*----------------------------------------------------------------------------*/
+static uint64_t cycles_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    return ns * EMULATED_DSP_MHZ / 1000;
+}
+
+/*-----------------------------------------------------------------------------
+* Modeled execution time: the core sleeps, leaving the host CPUs to the
+* runtime being measured
+*----------------------------------------------------------------------------*/
+static void delay(uint64_t us)
+{
+    if (us == 0) return;
+
+    struct timespec ts;
+    ts.tv_sec  = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) ;
+}
+
+MBoxEmulation::MBoxEmulation(Coal::DSPDevice *device)
+    : p_device(device), p_stop(false)
+{
+    EnvVar& env     = EnvVar::Instance();
+    p_latency_us    = std::max(0, env.GetEnv<
+                           EnvVar::Var::TI_OCL_DSP_EMULATION_LATENCY>(0));
+    p_wg_latency_us = std::max(0, env.GetEnv<
+                           EnvVar::Var::TI_OCL_DSP_EMULATION_WG_LATENCY>(0));
+
+    for (int i = 0; i < MAX_NUM_CORES; i++)
+        p_cores[i] = nullptr;
+
+    /*-------------------------------------------------------------------------
+    * One thread per compute unit stands in for the monitor on that core
+    *------------------------------------------------------------------------*/
+    const tiocl::DeviceInfo& device_info = tiocl::DeviceInfo::Instance();
+    for (int i : device_info.GetComputeUnits())
+    {
+        assert(i < MAX_NUM_CORES);
+
+        Core *core  = new Core;
+        core->mbox  = this;
+        core->id    = i;
+        core->stop  = false;
+        p_cores[i]  = core;
+
+        if (pthread_create(&core->thread, NULL, core_main, core) != 0)
+            ReportError(ErrorType::Fatal, ErrorKind::MailboxCreationFailed);
+    }
+}
+
+MBoxEmulation::~MBoxEmulation()
+{
+    /*-------------------------------------------------------------------------
+    * The cores finish what they have been sent, then exit
+    *------------------------------------------------------------------------*/
+    for (int i = 0; i < MAX_NUM_CORES; i++)
+    {
+        Core *core = p_cores[i];
+        if (core == nullptr) continue;
+
+        core->mutex.Lock();
+        core->stop = true;
+        core->cond.notify_one();
+        core->mutex.Unlock();
+
+        pthread_join(core->thread, NULL);
+        delete core;
+    }
+
+    /*-------------------------------------------------------------------------
+    * Unblock a reader waiting in from(), as MessageQ_unblock() does
+    *------------------------------------------------------------------------*/
+    Lock lock(this);
+    p_stop = true;
+    p_replies_cond.notify_all();
+}
+
+void MBoxEmulation::to(uint8_t *msg, uint32_t size, uint8_t id)
+{
+    static unsigned trans_id = TX_ID_START;
+
+    assert(id < MAX_NUM_CORES && p_cores[id] != nullptr);
+    assert(size <= sizeof(Msg_t));
+
+    Msg_t mail;
+    memset(&mail, 0, sizeof(Msg_t));
+    memcpy(&mail, msg, size);
+
+    Lock lock(this);
+    mail.trans_id = trans_id++;
+
+    Core *core = p_cores[id];
+    ScopedLock core_lock(core->mutex);
+    core->inbox.push_back(mail);
+    core->cond.notify_one();
+}
+
+int32_t MBoxEmulation::from(uint8_t *msg, uint32_t *size, uint8_t *id)
+{
+    Lock lock(this);
+    while (p_replies.empty() && !p_stop)
+        p_replies_cond.wait(lock.raw());
+
+    if (p_replies.empty())
+        return 0;
+
+    const std::pair<Msg_t, uint8_t>& reply = p_replies.front();
+    *size = sizeof(Msg_t);
+    memcpy(msg, &reply.first, *size);
+    if (id != nullptr)  *id = reply.second;
+
+    uint32_t trans_id = reply.first.trans_id;
+    p_replies.pop_front();
+
+    return trans_id;
+}
+
+bool MBoxEmulation::query(uint8_t id)
+{
+    return true;
+}
+
+/******************************************************************************
+* Emulated cores
+******************************************************************************/
+void *MBoxEmulation::core_main(void *data)
+{
+    Core *core = static_cast<Core *>(data);
+    Trace::nameThread("emulated DSP core");
+
+    core->mbox->run(core);
+    return nullptr;
+}
+
+bool MBoxEmulation::receive(Core *core, Msg_t &msg)
+{
+    ScopedLock lock(core->mutex);
+    while (core->inbox.empty() && !core->stop)
+        core->cond.wait(&core->mutex);
+
+    if (core->inbox.empty())
+        return false;
+
+    msg = core->inbox.front();
+    core->inbox.pop_front();
+    return true;
+}
+
+void MBoxEmulation::post(uint8_t core, const Msg_t &msg)
+{
+    Lock lock(this);
+    p_replies.push_back(std::make_pair(msg, core));
+    p_replies_cond.notify_one();
+}
+
+/*-----------------------------------------------------------------------------
+* The message loop of the monitor, see ocl_monitor()
+*----------------------------------------------------------------------------*/
+void MBoxEmulation::run(Core *core)
+{
+    Msg_t    msg;
+    uint64_t start;
+    uint64_t end;
+
+    while (receive(core, msg))
+    {
+        switch (msg.command)
+        {
+            case TASK:
+            case NDRKERNEL:
+            {
+                kernel_msg_t kernel  = msg.u.k.kernel;
+                int32_t      retcode = run_kernel(core->id, msg, &start, &end);
+                reply(core->id, msg, kernel.Kernel_id, retcode, start, end);
+                if (msg.command == NDRKERNEL)
+                    publish_chained_kernel(core->id, kernel);
+                break;
+            }
+
+            case BATCH:
+                run_batch(core->id, msg);
+                break;
+
+            case CACHEINV:
+                start = end = cycles_now();
+                reply(core->id, msg, (uint32_t) -1, CL_SUCCESS, start, end);
+                break;
+
+            case FREQUENCY:
+                start = end = cycles_now();
+                reply(core->id, msg, EMULATED_DSP_MHZ, CL_SUCCESS, start, end);
+                break;
+
+            // EXIT, CONFIGURE_MONITOR and SETUP_DEBUG are not answered
+            default:
+                break;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+* Run a TASK or NDRKERNEL on core: wait for the kernel it is chained to, then
+* take the modeled time of the core's share of the work
+*----------------------------------------------------------------------------*/
+int32_t MBoxEmulation::run_kernel(uint8_t core, Msg_t &msg,
+                                  uint64_t *start, uint64_t *end)
+{
+    kernel_config_t *cfg       = &msg.u.k.config;
+    kernel_msg_t    *kernel    = &msg.u.k.kernel;
+    uint32_t         num_cores = std::max<uint32_t>(kernel->num_cores, 1);
+    uint32_t         num_wgs   = 1;
+    uint32_t         share     = 0;
+    bool             dynamic   = false;
+
+    if (msg.command == TASK)
+    {
+        // Without OpenMP, only the master core runs an in-order task
+        if (!IS_OOO_TASK(msg) && core != kernel->master_core)
+            share = 0;
+        else
+            share = 1;
+    }
+    else
+    {
+        wait_for_chained_kernel(*kernel);
+
+        for (uint32_t i = 0; i < cfg->num_dims; i++)
+            num_wgs *= cfg->global_size[i] / std::max(cfg->local_size[i], 1u);
+
+        uint32_t index = core - kernel->master_core;
+        if (IS_DEBUG_MODE(msg))
+            share = (core == kernel->master_core) ? num_wgs : 0;
+        else if (kernel->wg_counter != 0)
+            dynamic = true;
+        else
+            share = num_wgs / num_cores + (index < num_wgs % num_cores ? 1 : 0);
+    }
+
+    *start = cycles_now();
+    if (dynamic)
+    {
+        delay(p_latency_us);
+        run_claimed_workgroups(*kernel, num_wgs, num_cores);
+    }
+    else if (share > 0)
+        delay(p_latency_us + (uint64_t) share * p_wg_latency_us);
+    *end = cycles_now();
+
+    return CL_SUCCESS;
+}
+
+/*-----------------------------------------------------------------------------
+* Dynamic work-group distribution: claim from the counter in shared memory
+* until every work-group is taken, see wg_claim()
+*----------------------------------------------------------------------------*/
+void MBoxEmulation::run_claimed_workgroups(const kernel_msg_t &kernel,
+                                           uint32_t num_wgs,
+                                           uint32_t num_cores)
+{
+    SharedMemory *shm  = p_device->GetSHMHandler();
+    uint32_t     *next = (uint32_t *) shm->Map(kernel.wg_counter,
+                                               WG_COUNTER_SIZE, true);
+    while (true)
+    {
+        uint32_t first;
+        uint32_t count;
+        {
+            ScopedLock lock(p_claim_mutex);
+            count = wg_claim(next, num_wgs, num_cores, &first);
+        }
+        if (count == 0) break;
+
+        delay((uint64_t) count * p_wg_latency_us);
+    }
+    shm->Unmap(next, kernel.wg_counter, WG_COUNTER_SIZE, true);
+}
+
+/*-----------------------------------------------------------------------------
+* Run the kernel messages of a BATCH in order and answer with one BATCH
+* message listing their completions, see process_batch_command()
+*----------------------------------------------------------------------------*/
+void MBoxEmulation::run_batch(uint8_t core, Msg_t &msg)
+{
+    batch_msg_t   *batch    = &msg.u.batch;
+    uint32_t       num_msgs = std::min<uint32_t>(batch->num_msgs,
+                                                 MAX_BATCH_MSGS);
+    size_t         size     = num_msgs * sizeof(Msg_t);
+    SharedMemory  *shm      = p_device->GetSHMHandler();
+    const Msg_t   *msgs     = (const Msg_t *) shm->Map(batch->msgs_addr,
+                                                       size, true);
+
+    batch->num_msgs = 0;
+    for (uint32_t i = 0; i < num_msgs; i++)
+    {
+        Msg_t    entry = msgs[i];
+        uint64_t start;
+        uint64_t end;
+        int32_t  retcode = run_kernel(core, entry, &start, &end);
+
+        batch_retcode_t *done = &batch->done[batch->num_msgs++];
+        done->trans_id        = entry.u.k.kernel.Kernel_id;
+        done->retcode         = retcode;
+        done->command         = entry.command;
+        done->is_ooo_task     = IS_OOO_TASK(entry);
+        done->cycles_start[0] = (uint32_t) start;
+        done->cycles_start[1] = (uint32_t) (start >> 32);
+        done->cycles_end[0]   = (uint32_t) end;
+        done->cycles_end[1]   = (uint32_t) (end >> 32);
+
+        if (entry.command == NDRKERNEL)
+            publish_chained_kernel(core, entry.u.k.kernel);
+    }
+    shm->Unmap((void *) msgs, batch->msgs_addr, size, false);
+
+    post(core, msg);
+}
+
+/*-----------------------------------------------------------------------------
+* Answer msg in place, see respond_to_host(). The emulated cores have no
+* event counters: profiling always reports a failure.
+*----------------------------------------------------------------------------*/
+void MBoxEmulation::reply(uint8_t core, Msg_t &msg, uint32_t trans_id,
+                          int32_t retcode, uint64_t start, uint64_t end)
+{
+    int8_t             event_type = msg.u.k.kernel.profiling.event_type;
+    command_retcode_t *ret        = &msg.u.command_retcode;
+
+    msg.trans_id = trans_id;
+    if (event_type >= 1 && event_type <= 2)
+    {
+        ret->profiling_status       = -1;
+        ret->profiling_counter0_val = 0;
+        ret->profiling_counter1_val = 0;
+    }
+    ret->cycles_start[0] = (uint32_t) start;
+    ret->cycles_start[1] = (uint32_t) (start >> 32);
+    ret->cycles_end[0]   = (uint32_t) end;
+    ret->cycles_end[1]   = (uint32_t) (end >> 32);
+    ret->retcode         = retcode;
+
+    post(core, msg);
+}
+
+/*-----------------------------------------------------------------------------
+* Chained NDRKERNELs, see wait_for_chained_kernel() in the monitor. The cores
+* are host threads, they sleep on a condition instead of polling the flags.
+*----------------------------------------------------------------------------*/
+void MBoxEmulation::wait_for_chained_kernel(const kernel_msg_t &kernel)
+{
+    if (kernel.chain_flags == 0 || kernel.chain_wait == 0) return;
+
+    SharedMemory *shm = p_device->GetSHMHandler();
+    ScopedLock lock(p_chain_mutex);
+    for (uint32_t core  = kernel.master_core;
+                  core  < (uint32_t) kernel.master_core + kernel.num_cores;
+                  core++)
+    {
+        DSPDevicePtr64 addr = CHAIN_FLAG_ADDR(kernel.chain_flags,
+                                              kernel.chain_wait - 1, core);
+        uint32_t *flag = (uint32_t *) shm->Map(addr, sizeof(uint32_t), true);
+        while (*flag != kernel.chain_wait_id)
+            p_chain_cond.wait(&p_chain_mutex);
+        shm->Unmap(flag, addr, sizeof(uint32_t), false);
+    }
+}
+
+void MBoxEmulation::publish_chained_kernel(uint8_t core,
+                                           const kernel_msg_t &kernel)
+{
+    if (kernel.chain_flags == 0 || kernel.chain_publish == 0) return;
+
+    SharedMemory  *shm  = p_device->GetSHMHandler();
+    DSPDevicePtr64 addr = CHAIN_FLAG_ADDR(kernel.chain_flags,
+                                          kernel.chain_publish - 1, core);
+    ScopedLock lock(p_chain_mutex);
+    uint32_t *flag = (uint32_t *) shm->Map(addr, sizeof(uint32_t), false);
+    *flag = kernel.Kernel_id;
+    shm->Unmap(flag, addr, sizeof(uint32_t), true);
+    p_chain_cond.notify_all();
+}
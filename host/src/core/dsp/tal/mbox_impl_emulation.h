@@ -0,0 +1,106 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#pragma once
+
+#include <deque>
+
+#include "u_locks_pthread.h"
+#include "u_lockable.h"
+#include "device.h"
+#include "message.h"
+
+#include "mbox_interface.h"
+
+/******************************************************************************
+* In-process mailbox of the emulated DSP, see dsp_emulation.h
+*
+* Every compute unit is a host thread with its own inbox, the pool of cores.
+* A core handles the messages sent to it in order, like the monitor: kernels
+* complete after the modeled latency, without running any code. Chained
+* NDRKERNELs wait for, and publish, their flags in shared memory and dynamic
+* work-groups are claimed from the shared counter, so the host sees the same
+* protocol as with real cores. Replies are queued for from().
+*
+* Modeled latency of a kernel, in microseconds:
+*   TI_OCL_DSP_EMULATION_LATENCY + work-groups * TI_OCL_DSP_EMULATION_WG_LATENCY
+* where work-groups is the core's share of the NDRange, 1 for a task.
+******************************************************************************/
+class MBoxEmulation : public MBox, public Lockable
+{
+    public:
+        MBoxEmulation(Coal::DSPDevice *device);
+        ~MBoxEmulation();
+        void     to   (uint8_t *msg, uint32_t  size, uint8_t  id=0);
+        int32_t  from (uint8_t *msg, uint32_t *size, uint8_t* id=nullptr);
+        bool     query(uint8_t id=0);
+
+    private:
+        struct Core
+        {
+            MBoxEmulation     *mbox;
+            uint8_t            id;
+            pthread_t          thread;
+            Mutex              mutex;
+            CondVar            cond;
+            std::deque<Msg_t>  inbox;
+            bool               stop;
+        };
+
+        static void *core_main(void *data);
+
+        bool     receive      (Core *core, Msg_t &msg);
+        void     post         (uint8_t core, const Msg_t &msg);
+        void     run          (Core *core);
+        int32_t  run_kernel   (uint8_t core, Msg_t &msg,
+                               uint64_t *start, uint64_t *end);
+        void     run_batch    (uint8_t core, Msg_t &msg);
+        void     reply        (uint8_t core, Msg_t &msg, uint32_t trans_id,
+                               int32_t retcode, uint64_t start, uint64_t end);
+
+        void     run_claimed_workgroups(const kernel_msg_t &kernel,
+                                        uint32_t num_wgs, uint32_t num_cores);
+        void     wait_for_chained_kernel(const kernel_msg_t &kernel);
+        void     publish_chained_kernel (uint8_t core,
+                                         const kernel_msg_t &kernel);
+
+    private:
+        Coal::DSPDevice          *p_device;
+        Core                     *p_cores[MAX_NUM_CORES];
+        uint32_t                  p_latency_us;
+        uint32_t                  p_wg_latency_us;
+
+        // Replies to the host, protected by the Lockable mutex
+        bool                      p_stop;
+        CondVar                   p_replies_cond;
+        std::deque<std::pair<Msg_t, uint8_t> > p_replies;
+
+        // Chained kernel flags and the dynamic work-group counters
+        Mutex                     p_chain_mutex;
+        CondVar                   p_chain_cond;
+        Mutex                     p_claim_mutex;
+};
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "memory_provider_emulation.h"
+#include "../error_report.h"
+
+using namespace tiocl;
+
+/*-----------------------------------------------------------------------------
+* The whole range is reserved up front, pages are only backed once touched
+*----------------------------------------------------------------------------*/
+EmulatedMem::EmulatedMem(const MemoryRange& r) :
+    MemoryProvider(r), dsp_addr_(r.GetBase()), size_(r.GetSize()),
+    host_addr_(nullptr)
+{
+    void *addr = mmap(NULL, size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (addr == MAP_FAILED)
+        ReportError(ErrorType::Fatal, ErrorKind::EmulatedMemoryMapFailed,
+                    dsp_addr_, size_ >> 20);
+
+    host_addr_ = (char *) addr;
+}
+
+EmulatedMem::~EmulatedMem()
+{
+    munmap(host_addr_, size_);
+}
+
+void *EmulatedMem::MapToHostAddressSpace(DSPDevicePtr64 dsp_addr,
+                                         size_t size, bool is_read) const
+{
+    if (dsp_addr < dsp_addr_ || dsp_addr + size > dsp_addr_ + size_)
+        ReportError(ErrorType::Fatal,
+                    ErrorKind::TranslateAddressOutsideMappedAddressRange,
+                    dsp_addr);
+
+    return host_addr_ + (dsp_addr - dsp_addr_);
+}
+
+void EmulatedMem::UnmapFromHostAddressSpace(void* host_addr, size_t size,
+                                            bool is_write) const
+{ }
+
+bool EmulatedMem::CacheInv(void *host_addr, size_t size) const
+{ return true; }
+
+bool EmulatedMem::CacheWb(void *host_addr, size_t size) const
+{ return true; }
+
+bool EmulatedMem::CacheWbInv(void *host_addr, size_t size) const
+{ return true; }
+
+size_t EmulatedMem::MinAllocationBlockSize() const
+{ return 4096; }
+
+size_t EmulatedMem::MinAllocationAlignment() const
+{ return 4096; }
@@ -0,0 +1,70 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdint.h>
+#include "core/tiocl_types.h"
+#include "memory_provider_interface.h"
+
+#pragma once
+
+namespace tiocl
+{
+
+/****************************************************************************
+ * Memory provider for the emulated DSP: the range is backed by an anonymous
+ * host mapping, reserved when the provider is created. DSP addresses
+ * translate to host addresses by a constant offset and host and "device"
+ * share the same cache, so cache operations have nothing to do.
+ ***************************************************************************/
+class EmulatedMem : public MemoryProvider
+{
+  public:
+    EmulatedMem(const MemoryRange &r);
+    virtual ~EmulatedMem();
+
+    virtual void *MapToHostAddressSpace (DSPDevicePtr64 dsp_addr, size_t size,
+                                                 bool is_read) const override;
+    virtual void  UnmapFromHostAddressSpace (void* host_addr, size_t size,
+                                                bool is_write) const override;
+
+    virtual size_t MinAllocationBlockSize() const override;
+    virtual size_t MinAllocationAlignment() const override;
+
+    virtual bool   CacheInv  (void *host_addr, size_t size) const override;
+    virtual bool   CacheWb   (void *host_addr, size_t size) const override;
+    virtual bool   CacheWbInv(void *host_addr, size_t size) const override;
+
+    EmulatedMem(const EmulatedMem&)            =delete;
+    EmulatedMem& operator=(const EmulatedMem&) =delete;
+
+private:
+    DSPDevicePtr64 dsp_addr_;
+    uint64_t       size_;
+    char*          host_addr_;
+};
+
+}
@@ -7,15 +7,19 @@
 #if defined (DEVICE_K2X) || defined (DEVICE_K2G)
     #include "memory_provider_cmem.h"
 #elif defined (DEVICE_AM57)
-  #if !defined(_SYS_BIOS)
+  #if !defined(_SYS_BIOS) && !defined(DSP_EMULATION_ONLY)
     #include "memory_provider_cmem.h"
-  #else
+  #elif defined(_SYS_BIOS)
     #include "memory_provider_rtos.h"
   #endif
 #else
     #error "Device not supported"
 #endif
 
+#if !defined(_SYS_BIOS)
+    #include "memory_provider_emulation.h"
+#endif
+
 using namespace tiocl;
 
 void
@@ -26,6 +30,7 @@ MemoryProviderFactory::CreateMemoryProvider(const MemoryRange &r)
     switch (r.GetKind())
     {
         #if !defined(_SYS_BIOS)
+        #if !defined(DSP_EMULATION_ONLY)
         case MemoryRange::Kind::CMEM_ONDEMAND:
         {
             mp = new CMEMOnDemand(r);
@@ -36,6 +41,12 @@ MemoryProviderFactory::CreateMemoryProvider(const MemoryRange &r)
             mp = new CMEMPersistent(r);
             break;
         }
+        #endif
+        case MemoryRange::Kind::EMULATED:
+        {
+            mp = new EmulatedMem(r);
+            break;
+        }
         #else
         case MemoryRange::Kind::RTOS_SHMEM:
         case MemoryRange::Kind::RTOS_HOSTMEM:
@@ -592,6 +592,8 @@ static void initialize_loaded_module(DLOAD_HANDLE handle,
    loaded_module->gsymtab = NULL;
    loaded_module->gstrtab = NULL;
    loaded_module->gsymnum = loaded_module->gstrsz = 0;
+   loaded_module->gsymhash = NULL;
+   loaded_module->gsymhash_mask = 0;
 
    /*------------------------------------------------------------------------*/
    /* Initialize the Array_List of dependencies.                             */
@@ -1152,6 +1154,8 @@ static void delete_DLIMP_Loaded_Module(DLOAD_HANDLE handle,
     loaded_module->gsymnum = 0;
     if (loaded_module->gstrtab) DLIF_free(loaded_module->gstrtab);
     loaded_module->gstrsz = 0;
+    if (loaded_module->gsymhash) DLIF_free(loaded_module->gsymhash);
+    loaded_module->gsymhash_mask = 0;
     AL_destroy(&(loaded_module->loaded_segments));
     AL_destroy(&(loaded_module->dependencies));
 
@@ -3081,9 +3085,10 @@ BOOL DLOAD_get_entry_point(DLOAD_HANDLE handle, uint32_t file_handle,
 /*****************************************************************************/
 /* DLOAD_query_symbol()                                                      */
 /*                                                                           */
-/*    Query the value of a global symbol from a specific file.  The value    */
-/*    result will be written to *sym_val.  The function returns TRUE if the  */
-/*    symbol was found, and FALSE if it wasn't.                              */
+/*    Query the value of a global symbol definition from a specific file.    */
+/*    The value result will be written to *sym_val.  The function returns    */
+/*    TRUE if the symbol was found, and FALSE if it wasn't, or if the file   */
+/*    only references it.                                                    */
 /*                                                                           */
 /*****************************************************************************/
 BOOL DLOAD_query_symbol(DLOAD_HANDLE handle,
@@ -3104,22 +3109,15 @@ BOOL DLOAD_query_symbol(DLOAD_HANDLE handle,
    {
       if (ptr->value->file_handle == file_handle)
       {
-         DLIMP_Loaded_Module *module = ptr->value;
-         struct Elf32_Sym *symtab;
-         int i;
-              
+         Elf32_Addr sym_value;
+
          /*------------------------------------------------------------------*/
-         /* Search through the symbol table by name.                         */
+         /* Look the symbol definition up by name.                           */
          /*------------------------------------------------------------------*/
-         symtab = (struct Elf32_Sym*)module->gsymtab;
-         for(i=0; i < module->gsymnum; i++)
+         if (DLSYM_lookup_loaded_module(sym_name, ptr->value, &sym_value))
          {
-            if (!strcmp(sym_name, (const char *)(module->gstrtab
-                                                 + symtab[i].st_name)))
-            {
-               *sym_val = (TARGET_ADDRESS) symtab[i].st_value;
-               return TRUE;
-            }
+            *sym_val = (TARGET_ADDRESS) sym_value;
+            return TRUE;
          }
       }
    }
@@ -3130,6 +3128,44 @@ BOOL DLOAD_query_symbol(DLOAD_HANDLE handle,
    return FALSE;
 }
 
+/*****************************************************************************/
+/* DLOAD_get_global_symbols()                                                */
+/*                                                                           */
+/*    Call sym_func for each global symbol definition of a specific file.    */
+/*    The function returns TRUE if the file was found, and FALSE if it       */
+/*    wasn't.                                                                */
+/*                                                                           */
+/*****************************************************************************/
+BOOL DLOAD_get_global_symbols(DLOAD_HANDLE handle,
+                              uint32_t file_handle,
+                              DLOAD_SYMBOL_FUNC sym_func,
+                              void *arg)
+{
+   loaded_module_ptr_Queue_Node* ptr;
+   LOADER_OBJECT *pHandle = (LOADER_OBJECT *)handle;
+
+   for (ptr = pHandle->DLIMP_loaded_objects.front_ptr; ptr != NULL;
+                                                          ptr = ptr->next_ptr)
+   {
+      if (ptr->value->file_handle == file_handle)
+      {
+         DLIMP_Loaded_Module *module = ptr->value;
+         struct Elf32_Sym *symtab = module->gsymtab;
+         Elf32_Word i;
+
+         for (i = 0; i < module->gsymnum; i++)
+            if (symtab[i].st_shndx != SHN_UNDEF &&
+                ELF32_ST_BIND(symtab[i].st_info) != STB_LOCAL)
+               sym_func(arg, module->gstrtab + symtab[i].st_name,
+                        (TARGET_ADDRESS)symtab[i].st_value);
+
+         return TRUE;
+      }
+   }
+
+   return FALSE;
+}
+
 
 
 /*****************************************************************************/
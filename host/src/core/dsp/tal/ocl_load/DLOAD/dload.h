@@ -73,6 +73,19 @@ typedef struct
    void *                       host_address;
 } DLIMP_Loaded_Segment;
 
+/*---------------------------------------------------------------------------*/
+/* DLSYM_Hash_Entry                                                          */
+/*                                                                           */
+/*    Entry of the open-addressing hash index of a loaded module's global    */
+/*    symbol definitions, built by DLSYM_copy_globals().  sym_index is 1 +   */
+/*    the index of the symbol in gsymtab, or 0 for an empty entry.           */
+/*---------------------------------------------------------------------------*/
+typedef struct
+{
+   Elf32_Word                   hash;
+   Elf32_Word                   sym_index;
+} DLSYM_Hash_Entry;
+
 /*---------------------------------------------------------------------------*/
 /* DLIMP_Loaded_Module                                                       */
 /*                                                                           */
@@ -96,6 +109,8 @@ typedef struct
    Elf32_Word           gsymnum;         /* # global symbols                */
    char                *gstrtab;         /* Module's global symbol names    */
    Elf32_Word           gstrsz;          /* Size of global string table     */
+   DLSYM_Hash_Entry    *gsymhash;        /* Hash index of gsymtab, or NULL  */
+   Elf32_Word           gsymhash_mask;   /* # gsymhash entries - 1          */
    Array_List           loaded_segments; /* List of DLIMP_Loaded_Segment(s) */
    Array_List           dependencies;    /* List of dependent file handles  */
    BOOL                 direct_dependent_only;
@@ -68,6 +68,10 @@ BOOL DLSYM_lookup_local_symtab(const char       *sym_name,
                                Elf32_Addr       *sym_value,
                                char             *strtab);
 
+BOOL DLSYM_lookup_loaded_module(const char          *sym_name,
+                                DLIMP_Loaded_Module *module,
+                                Elf32_Addr          *sym_value);
+
 void DLSYM_copy_globals(DLIMP_Dynamic_Module *dyn_module);
 
 #endif
@@ -196,13 +196,29 @@ BOOL     DLOAD_get_entry_names(DLOAD_HANDLE handle, uint32_t file_handle,
 /* DLOAD_query_symbol()                                                      */
 /*                                                                           */
 /*    Query the value of a symbol that is defined by an object file that     */
-/*    has previously been loaded.  Boolean return value will be false if     */
-/*    the symbol is not found.                                               */
+/*    has previously been loaded.  Only global and weak definitions are      */
+/*    found, not the file's undefined references.  Boolean return value      */
+/*    will be false if the symbol is not found.                              */
 /*                                                                           */
 /*---------------------------------------------------------------------------*/
 BOOL     DLOAD_query_symbol(DLOAD_HANDLE handle, uint32_t file_handle, 
                             const char *sym_name, TARGET_ADDRESS *sym_val);
 
+/*---------------------------------------------------------------------------*/
+/* DLOAD_get_global_symbols()                                                */
+/*                                                                           */
+/*    Given a file handle, call sym_func with the name and value of each     */
+/*    global symbol that is defined by the specified file, that is each      */
+/*    symbol DLOAD_query_symbol() can find.  The return value indicates      */
+/*    whether the file with the specified handle was found or not.           */
+/*                                                                           */
+/*---------------------------------------------------------------------------*/
+typedef void (*DLOAD_SYMBOL_FUNC)(void *arg, const char *sym_name,
+                                  TARGET_ADDRESS sym_val);
+
+BOOL     DLOAD_get_global_symbols(DLOAD_HANDLE handle, uint32_t file_handle,
+                                  DLOAD_SYMBOL_FUNC sym_func, void *arg);
+
 /*---------------------------------------------------------------------------*/
 /* DLOAD_get_entry_point()                                                   */
 /*                                                                           */
@@ -65,6 +65,7 @@ int32_t DLIMP_application_handle = 0;
 BOOL DLSYM_lookup_global_symtab(const char *sym_name, struct Elf32_Sym *symtab,
                                 Elf32_Word symnum, Elf32_Addr *sym_value,
                                 char *strtab);
+static void DLSYM_build_hash(DLIMP_Loaded_Module *module);
 
 /*****************************************************************************/
 /* DLSYM_COPY_GLOBALS() - Copy global symbols from the dynamic module's      */
@@ -149,6 +150,133 @@ void DLSYM_copy_globals(DLIMP_Dynamic_Module *dyn_module)
                             + dyn_module->symtab[i + global_index].st_name));
 #endif
    }
+
+   /*------------------------------------------------------------------------*/
+   /* Index the global symbol definitions by name, so that relocations do   */
+   /* not scan the whole table for each symbol they resolve.                 */
+   /*------------------------------------------------------------------------*/
+   DLSYM_build_hash(module);
+}
+
+/*****************************************************************************/
+/* DLSYM_HASH() - GNU-style hash of a symbol name: h = h * 33 + c.           */
+/*****************************************************************************/
+static Elf32_Word DLSYM_hash(const char *sym_name)
+{
+   Elf32_Word    h = 5381;
+   unsigned char c;
+
+   while ((c = (unsigned char)*sym_name++) != '\0')
+      h = h * 33 + c;
+
+   return h;
+}
+
+/*****************************************************************************/
+/* IS_GLOBAL_DEF() - Symbols DLSYM_lookup_global_symtab() can return.        */
+/*****************************************************************************/
+static BOOL is_global_def(struct Elf32_Sym *sym)
+{
+   return sym->st_shndx != SHN_UNDEF &&
+          ELF32_ST_BIND(sym->st_info) != STB_LOCAL;
+}
+
+/*****************************************************************************/
+/* DLSYM_BUILD_HASH() - Build the hash index of the global symbol            */
+/*      definitions of a loaded module: an open-addressing table, linearly   */
+/*      probed, at most half full.  When a name is defined more than once,   */
+/*      the first definition is indexed, as a scan of gsymtab would find.    */
+/*      Symbol values may still be relocated after this, only names and      */
+/*      indexes are kept in the table.                                       */
+/*****************************************************************************/
+static void DLSYM_build_hash(DLIMP_Loaded_Module *module)
+{
+   struct Elf32_Sym *symtab = module->gsymtab;
+   Elf32_Word        size   = 2;
+   Elf32_Word        mask, i;
+
+   if (module->gsymhash)
+   {
+      DLIF_free(module->gsymhash);
+      module->gsymhash = NULL;
+   }
+   module->gsymhash_mask = 0;
+
+   if (module->gsymnum == 0) return;
+
+   while (size < 2 * module->gsymnum) size <<= 1;
+
+   /*------------------------------------------------------------------------*/
+   /* Without an index, lookups scan the symbol table.                       */
+   /*------------------------------------------------------------------------*/
+   module->gsymhash = DLIF_malloc(size * sizeof(DLSYM_Hash_Entry));
+   if (!module->gsymhash) return;
+
+   memset(module->gsymhash, 0, size * sizeof(DLSYM_Hash_Entry));
+   mask = module->gsymhash_mask = size - 1;
+
+   for (i = 0; i < module->gsymnum; i++)
+   {
+      const char *sym_name = module->gstrtab + symtab[i].st_name;
+      Elf32_Word  hash, slot;
+
+      if (!is_global_def(&symtab[i])) continue;
+
+      hash = DLSYM_hash(sym_name);
+      for (slot = hash & mask; module->gsymhash[slot].sym_index != 0;
+           slot = (slot + 1) & mask)
+      {
+         DLSYM_Hash_Entry *entry = &module->gsymhash[slot];
+         if (entry->hash == hash &&
+             !strcmp(sym_name,
+                     module->gstrtab + symtab[entry->sym_index - 1].st_name))
+            break;
+      }
+
+      if (module->gsymhash[slot].sym_index == 0)
+      {
+         module->gsymhash[slot].hash      = hash;
+         module->gsymhash[slot].sym_index = i + 1;
+      }
+   }
+}
+
+/*****************************************************************************/
+/* DLSYM_lookup_loaded_module() - Lookup the symbol name among the global    */
+/*      symbol definitions of a loaded module, through its hash index.       */
+/*      Return the value in sym_value and return TRUE if the lookup          */
+/*      succeeds.                                                            */
+/*****************************************************************************/
+BOOL DLSYM_lookup_loaded_module(const char *sym_name,
+                                DLIMP_Loaded_Module *module,
+                                Elf32_Addr *sym_value)
+{
+   struct Elf32_Sym *symtab = module->gsymtab;
+   Elf32_Word        mask   = module->gsymhash_mask;
+   Elf32_Word        hash, slot;
+
+   if (!module->gsymhash)
+      return DLSYM_lookup_global_symtab(sym_name, module->gsymtab,
+                                        module->gsymnum, sym_value,
+                                        module->gstrtab);
+
+   hash = DLSYM_hash(sym_name);
+   for (slot = hash & mask; module->gsymhash[slot].sym_index != 0;
+        slot = (slot + 1) & mask)
+   {
+      DLSYM_Hash_Entry *entry = &module->gsymhash[slot];
+      struct Elf32_Sym *sym   = &symtab[entry->sym_index - 1];
+
+      if (entry->hash == hash &&
+          !strcmp(sym_name, module->gstrtab + sym->st_name))
+      {
+         if (sym_value) *sym_value = sym->st_value;
+         return TRUE;
+      }
+   }
+
+   if (sym_value) *sym_value = 0;
+   return FALSE;
 }
 
 /*****************************************************************************/
@@ -198,11 +326,7 @@ static BOOL breadth_first_lookup(DLOAD_HANDLE phandle,
       /* Search the symbol table of the current file handle's Module.        */
       /* If the symbol was found, then we're finished.                       */
       /*---------------------------------------------------------------------*/
-      if (DLSYM_lookup_global_symtab(sym_name, 
-                                     mod_node->value->gsymtab, 
-                                     mod_node->value->gsymnum, 
-                                     sym_value,
-                                     mod_node->value->gstrtab))
+      if (DLSYM_lookup_loaded_module(sym_name, mod_node->value, sym_value))
          return TRUE;
 
       /*---------------------------------------------------------------------*/
@@ -261,11 +385,7 @@ BOOL DLSYM_global_lookup(DLOAD_HANDLE handle,
          /*------------------------------------------------------------------*/
          /* Return true if we find the symbol.                               */
          /*------------------------------------------------------------------*/
-         if (DLSYM_lookup_global_symtab(sym_name, 
-                                        node->value->gsymtab, 
-                                        node->value->gsymnum,
-                                        sym_value,
-                                        node->value->gstrtab))
+         if (DLSYM_lookup_loaded_module(sym_name, node->value, sym_value))
             return TRUE;
       }
    }
@@ -424,3 +544,35 @@ BOOL DLSYM_canonical_lookup(DLOAD_HANDLE handle, int32_t sym_index,
    }
 }
 
+
+#ifdef UNIT_TEST
+/*****************************************************************************/
+/* UNIT_DLSYM_QUERY_SYMBOL() - Lookup the symbol name among the global       */
+/*      symbol definitions of a loaded file, through the module's hash index */
+/*      (use_hash) or by scanning its gsymtab, as before the index existed.  */
+/*****************************************************************************/
+BOOL unit_DLSYM_query_symbol(DLOAD_HANDLE handle, uint32_t file_handle,
+                             const char *sym_name, BOOL use_hash,
+                             Elf32_Addr *sym_value)
+{
+   LOADER_OBJECT *dHandle = (LOADER_OBJECT *)handle;
+   loaded_module_ptr_Queue_Node *node;
+
+   for (node = dHandle->DLIMP_loaded_objects.front_ptr; node != NULL;
+        node = node->next_ptr)
+   {
+      DLIMP_Loaded_Module *module = node->value;
+
+      if (module->file_handle != file_handle) continue;
+
+      if (use_hash)
+         return DLSYM_lookup_loaded_module(sym_name, module, sym_value);
+
+      return DLSYM_lookup_global_symtab(sym_name, module->gsymtab,
+                                        module->gsymnum, sym_value,
+                                        module->gstrtab);
+   }
+
+   return FALSE;
+}
+#endif
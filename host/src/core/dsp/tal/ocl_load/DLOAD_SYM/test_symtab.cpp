@@ -0,0 +1,296 @@
+/*
+* test_symtab.cpp
+*
+* Global Symbol Lookup Unit Tests.
+*
+* Copyright (C) 2026 Texas Instruments Incorporated - http://www.ti.com/
+*
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* Redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the
+* distribution.
+*
+* Neither the name of Texas Instruments Incorporated nor the names of
+* its contributors may be used to endorse or promote products derived
+* from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+#include "test_symtab.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*****************************************************************************/
+/* DLSYM_TestLookup                                                          */
+/*                                                                           */
+/* Loads OpenCL DSP binaries through DLOAD_load() into host memory and looks */
+/* their global symbols up through the hash index of the loaded module and   */
+/* by scanning its global symbol table, as lookups did before the index.     */
+/*                                                                           */
+/* The binaries are those of the offline examples, built with clocl by make  */
+/* in examples/, relative to the current directory.  Set DLSYM_TEST_FILES to */
+/* a space separated list of .out files to use others.                       */
+/*                                                                           */
+/*****************************************************************************/
+static const char *default_files =
+    "examples/offline/vadd.out "
+    "examples/float_compute/dsp_compute.out "
+    "examples/matmpy/kernel.out";
+
+typedef std::vector<std::pair<std::string, TARGET_ADDRESS> > Symbols;
+
+/*****************************************************************************/
+/* Loader client: segments live in host memory, relocatable ones placed one  */
+/* after the other from TEST_LOAD_BASE.                                      */
+/*****************************************************************************/
+#define TEST_LOAD_BASE 0x80000000
+
+struct TestClient
+{
+   DLOAD_HANDLE                                       handle;
+   TARGET_ADDRESS                                     next;
+   std::map<TARGET_ADDRESS, std::vector<uint8_t> >    segments;
+};
+
+extern "C"
+{
+
+BOOL DLIF_allocate(void* client_handle, struct DLOAD_MEMORY_REQUEST *req)
+{
+   TestClient                  *client  = (TestClient *)client_handle;
+   struct DLOAD_MEMORY_SEGMENT *segment = req->segment;
+
+   if (req->flags & DLOAD_SF_relocatable)
+   {
+      uint32_t align = req->align ? req->align : 8;
+      client->next = (client->next + align - 1) & ~(align - 1);
+      segment->target_address = client->next;
+      client->next += segment->memsz_in_bytes;
+   }
+
+   client->segments[segment->target_address].assign(
+                                          segment->memsz_in_bytes + 1, 0);
+   return TRUE;
+}
+
+BOOL DLIF_release(void* client_handle, struct DLOAD_MEMORY_SEGMENT* ptr)
+{
+   ((TestClient *)client_handle)->segments.erase(ptr->target_address);
+   return TRUE;
+}
+
+BOOL DLIF_copy(void* client_handle, struct DLOAD_MEMORY_REQUEST* req)
+{
+   TestClient                  *client  = (TestClient *)client_handle;
+   struct DLOAD_MEMORY_SEGMENT *segment = req->segment;
+   uint8_t *buf = client->segments[segment->target_address].data();
+
+   req->host_address = buf;
+   if (segment->objsz_in_bytes == 0) return TRUE;
+
+   return DLIF_fseek(req->fp, req->offset, SEEK_SET) == 0 &&
+          DLIF_fread(buf, segment->objsz_in_bytes, 1, req->fp) == 1;
+}
+
+BOOL DLIF_write(void* client_handle, struct DLOAD_MEMORY_REQUEST* req)
+{
+   req->host_address = NULL;
+   return TRUE;
+}
+
+int DLIF_load_dependent(void* client_handle, const char* so_name)
+{
+   DLIF_error(DLET_FILE, "Dependent file '%s' not supported.\n", so_name);
+   return 0;
+}
+
+void DLIF_unload_dependent(void* client_handle, uint32_t file_handle)
+{
+   DLOAD_unload(((TestClient *)client_handle)->handle, file_handle);
+}
+
+static void record_symbol(void *arg, const char *sym_name,
+                          TARGET_ADDRESS sym_val)
+{
+   ((Symbols *)arg)->push_back(std::make_pair(std::string(sym_name), sym_val));
+}
+
+}
+
+/*****************************************************************************/
+/* Call test_func with each binary loaded and its global symbols.  Binaries  */
+/* that are missing are reported and skipped.                                */
+/*****************************************************************************/
+template <typename Func>
+static int for_each_binary(Func test_func)
+{
+   const char *env = getenv("DLSYM_TEST_FILES");
+   std::istringstream files(env ? env : default_files);
+   std::string        file;
+   int                num_loaded = 0;
+
+   while (files >> file)
+   {
+      TestClient client;
+      client.next   = TEST_LOAD_BASE;
+      client.handle = DLOAD_create(&client);
+
+      FILE *fp = fopen(file.c_str(), "rb");
+      if (!fp)
+      {
+         TS_WARN(("Cannot open " + file).c_str());
+         DLOAD_destroy(client.handle);
+         continue;
+      }
+
+      int file_handle = DLOAD_load(client.handle, fp);
+      fclose(fp);
+      TS_ASSERT(file_handle != 0);
+
+      if (file_handle != 0)
+      {
+         Symbols symbols;
+         DLOAD_get_global_symbols(client.handle, file_handle,
+                                  record_symbol, &symbols);
+         test_func(file, client.handle, file_handle, symbols);
+         DLOAD_unload(client.handle, file_handle);
+         num_loaded++;
+      }
+
+      DLOAD_destroy(client.handle);
+   }
+
+   if (num_loaded == 0) TS_WARN("No binaries loaded, nothing tested");
+   return num_loaded;
+}
+
+/*****************************************************************************/
+/* The hash index finds every global definition, with the value the scan     */
+/* finds, and does not find names that are not defined.                      */
+/*****************************************************************************/
+static void check_hash_matches_scan(const std::string& file,
+                                    DLOAD_HANDLE handle, int file_handle,
+                                    const Symbols& symbols)
+{
+   TS_ASSERT(!symbols.empty());
+
+   for (size_t i = 0; i < symbols.size(); i++)
+   {
+      const char *name = symbols[i].first.c_str();
+      uint32_t    hash_value = 0, scan_value = 0;
+
+      TS_ASSERT(unit_DLSYM_query_symbol(handle, file_handle, name, TRUE,
+                                        &hash_value));
+      TS_ASSERT(unit_DLSYM_query_symbol(handle, file_handle, name, FALSE,
+                                        &scan_value));
+      TS_ASSERT_EQUALS(hash_value, scan_value);
+   }
+
+   uint32_t value;
+   TS_ASSERT(!unit_DLSYM_query_symbol(handle, file_handle,
+                                      "__no_such_symbol__", TRUE, &value));
+   TS_ASSERT(!unit_DLSYM_query_symbol(handle, file_handle,
+                                      "__no_such_symbol__", FALSE, &value));
+}
+
+void DLSYM_TestLookup::test_hash_matches_scan()
+{
+   for_each_binary(check_hash_matches_scan);
+}
+
+/*****************************************************************************/
+/* DLOAD_query_symbol() returns the global definitions, which is what the    */
+/* runtime queries: kernel entry points and _ocl_local_overlay_start.        */
+/*****************************************************************************/
+static void check_query_symbol(const std::string& file,
+                               DLOAD_HANDLE handle, int file_handle,
+                               const Symbols& symbols)
+{
+   bool found_overlay_start = false;
+
+   for (size_t i = 0; i < symbols.size(); i++)
+   {
+      TARGET_ADDRESS value = 0;
+
+      TS_ASSERT(DLOAD_query_symbol(handle, file_handle,
+                                   symbols[i].first.c_str(), &value));
+      if (symbols[i].first == "_ocl_local_overlay_start")
+         found_overlay_start = true;
+   }
+
+   TS_ASSERT(found_overlay_start);
+}
+
+void DLSYM_TestLookup::test_query_symbol()
+{
+   for_each_binary(check_query_symbol);
+}
+
+/*****************************************************************************/
+/* Not a pass/fail check: reports the time per lookup of the module's global */
+/* symbols through the hash index and by the scan.                           */
+/*****************************************************************************/
+static double time_lookups(DLOAD_HANDLE handle, int file_handle,
+                           const Symbols& symbols, BOOL use_hash, int rounds)
+{
+   auto start = std::chrono::steady_clock::now();
+
+   for (int r = 0; r < rounds; r++)
+      for (size_t i = 0; i < symbols.size(); i++)
+      {
+         uint32_t value;
+         unit_DLSYM_query_symbol(handle, file_handle,
+                                 symbols[i].first.c_str(), use_hash, &value);
+      }
+
+   std::chrono::duration<double> elapsed =
+                                     std::chrono::steady_clock::now() - start;
+   return elapsed.count() * 1e9 / (rounds * symbols.size());
+}
+
+static void report_lookup_time(const std::string& file,
+                               DLOAD_HANDLE handle, int file_handle,
+                               const Symbols& symbols)
+{
+   const int rounds = 1000;
+
+   if (symbols.empty()) return;
+
+   double scan_ns = time_lookups(handle, file_handle, symbols, FALSE, rounds);
+   double hash_ns = time_lookups(handle, file_handle, symbols, TRUE,  rounds);
+
+   printf("\n%s: %u global symbols, scan %.1f ns/lookup, "
+          "hash %.1f ns/lookup\n", file.c_str(), (unsigned)symbols.size(),
+          scan_ns, hash_ns);
+}
+
+void DLSYM_TestLookup::test_lookup_time()
+{
+   for_each_binary(report_lookup_time);
+}
@@ -0,0 +1,267 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include "program_image.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace tiocl;
+
+/*-----------------------------------------------------------------------------
+* Bump the last character of PROGRAM_IMAGE_MAGIC whenever the layout changes
+*----------------------------------------------------------------------------*/
+#define PROGRAM_IMAGE_MAGIC "TIOCLIM1"
+
+namespace
+{
+struct FileSegment
+{
+    uint32_t address;
+    uint32_t memsz;
+    uint32_t filesz;
+    uint32_t flags;
+    uint64_t data_offset;
+};
+
+struct FileSymbol
+{
+    uint32_t value;
+    uint32_t name_offset;
+};
+
+struct Footer
+{
+    char     magic[8];
+    uint32_t num_segments;
+    uint32_t num_symbols;
+    uint32_t names_size;
+    uint32_t data_page;
+    uint32_t load_address;
+    uint32_t reserved;
+    uint64_t tables_offset;
+};
+}
+
+ProgramImage::ProgramImage() :
+    dataPage(0), loadAddress(0), file(nullptr), failed(false),
+    mapping(nullptr), mappingSize(0)
+{ }
+
+ProgramImage::~ProgramImage()
+{
+    Close();
+}
+
+void ProgramImage::Close()
+{
+    if (file) fclose(file);
+    file = nullptr;
+
+    if (mapping) munmap((void *)mapping, mappingSize);
+    mapping = nullptr;
+}
+
+/******************************************************************************
+* Recording
+******************************************************************************/
+bool ProgramImage::Create(const std::string &filename)
+{
+    file = fopen(filename.c_str(), "wb");
+    return file != nullptr;
+}
+
+void ProgramImage::AddSegment(DSPDevicePtr address, uint32_t memsz)
+{
+    Segment segment = { address, memsz, 0, 0, 0 };
+    segments.push_back(segment);
+}
+
+/*-----------------------------------------------------------------------------
+* data is the relocated segment, about to be written to target memory. An
+* unknown address means the segment was not allocated through the image.
+*----------------------------------------------------------------------------*/
+void ProgramImage::SetSegmentData(DSPDevicePtr address, const void *data,
+                                  uint32_t filesz, uint32_t flags)
+{
+    if (!file || failed) return;
+
+    for (auto &segment : segments)
+    {
+        if (segment.address != address) continue;
+
+        long offset = ftell(file);
+        segment.flags = flags;
+        segment.data_offset = offset;
+        segment.filesz = data ? filesz : 0;
+
+        if (offset < 0 ||
+            (segment.filesz && fwrite(data, segment.filesz, 1, file) != 1))
+            failed = true;
+        return;
+    }
+
+    failed = true;
+}
+
+/*-----------------------------------------------------------------------------
+* The first definition of a name wins, as in the loader's lookups
+*----------------------------------------------------------------------------*/
+void ProgramImage::AddSymbol(const char *name, DSPDevicePtr value)
+{
+    symbols.emplace(name, value);
+}
+
+bool ProgramImage::Finish(DSPDevicePtr data_page, DSPDevicePtr load_address)
+{
+    if (!file || failed) return false;
+
+    std::vector<FileSegment> file_segments;
+    for (auto &segment : segments)
+    {
+        FileSegment s = { segment.address, segment.memsz, segment.filesz,
+                          segment.flags, segment.data_offset };
+        file_segments.push_back(s);
+    }
+
+    std::vector<FileSymbol> file_symbols;
+    std::string             names;
+    for (auto &symbol : symbols)
+    {
+        FileSymbol s = { symbol.second, (uint32_t)names.size() };
+        file_symbols.push_back(s);
+        names.append(symbol.first.c_str(), symbol.first.size() + 1);
+    }
+
+    Footer footer;
+    memcpy(footer.magic, PROGRAM_IMAGE_MAGIC, sizeof(footer.magic));
+    footer.num_segments  = file_segments.size();
+    footer.num_symbols   = file_symbols.size();
+    footer.names_size    = names.size();
+    footer.data_page     = data_page;
+    footer.load_address  = load_address;
+    footer.reserved      = 0;
+    footer.tables_offset = ftell(file);
+
+    bool ok =
+        (file_segments.empty() ||
+         fwrite(file_segments.data(), sizeof(FileSegment),
+                file_segments.size(), file) == file_segments.size()) &&
+        (file_symbols.empty() ||
+         fwrite(file_symbols.data(), sizeof(FileSymbol),
+                file_symbols.size(), file) == file_symbols.size()) &&
+        (names.empty() ||
+         fwrite(names.data(), names.size(), 1, file) == 1) &&
+        fwrite(&footer, sizeof(footer), 1, file) == 1;
+
+    ok = (fclose(file) == 0) && ok;
+    file = nullptr;
+    return ok;
+}
+
+/******************************************************************************
+* Replay. The file is validated against its own footer only: a truncated or
+* foreign file is rejected, the key it was found under vouches for the rest.
+******************************************************************************/
+bool ProgramImage::Open(const std::string &filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) != 0 || (size_t)statbuf.st_size < sizeof(Footer))
+    {
+        close(fd);
+        return false;
+    }
+
+    mappingSize = statbuf.st_size;
+    void *base  = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    mapping = (const char *)base;
+
+    Footer footer;
+    memcpy(&footer, mapping + mappingSize - sizeof(footer), sizeof(footer));
+
+    uint64_t tables_size = (uint64_t)footer.num_segments * sizeof(FileSegment)
+                         + (uint64_t)footer.num_symbols  * sizeof(FileSymbol)
+                         + footer.names_size;
+
+    if (memcmp(footer.magic, PROGRAM_IMAGE_MAGIC, sizeof(footer.magic)) != 0
+        || footer.tables_offset + tables_size + sizeof(footer) != mappingSize)
+    {
+        Close();
+        return false;
+    }
+
+    const char *tables = mapping + footer.tables_offset;
+    const char *names  = tables + footer.num_segments * sizeof(FileSegment)
+                                + footer.num_symbols  * sizeof(FileSymbol);
+
+    for (uint32_t i = 0; i < footer.num_segments; i++)
+    {
+        FileSegment s;
+        memcpy(&s, tables + i * sizeof(s), sizeof(s));
+        if (s.data_offset + s.filesz > footer.tables_offset || s.filesz > s.memsz)
+        {
+            Close();
+            return false;
+        }
+
+        Segment segment = { s.address, s.memsz, s.filesz, s.flags,
+                            s.data_offset };
+        segments.push_back(segment);
+    }
+
+    tables += footer.num_segments * sizeof(FileSegment);
+    for (uint32_t i = 0; i < footer.num_symbols; i++)
+    {
+        FileSymbol s;
+        memcpy(&s, tables + i * sizeof(s), sizeof(s));
+        if (s.name_offset >= footer.names_size ||
+            memchr(names + s.name_offset, '\0',
+                   footer.names_size - s.name_offset) == nullptr)
+        {
+            Close();
+            return false;
+        }
+        symbols.emplace(names + s.name_offset, s.value);
+    }
+
+    dataPage    = footer.data_page;
+    loadAddress = footer.load_address;
+    return true;
+}
+
+const void *ProgramImage::SegmentData(const Segment &segment) const
+{
+    return mapping ? mapping + segment.data_offset : nullptr;
+}
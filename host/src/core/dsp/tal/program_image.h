@@ -0,0 +1,108 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdio.h>
+#include "../../tiocl_types.h"
+
+namespace tiocl {
+
+/******************************************************************************
+* ProgramImage : final state of a program load, recorded to be replayed when
+*   the same binary is loaded again at the same addresses.
+*
+*   An image holds, in load order, the target memory segments of the program
+*   with their contents after relocation, and the global symbols, data page
+*   pointer and load address of the program. It is recorded while the dynamic
+*   loader runs, streamed to a file:
+*
+*     segment contents | segment table | symbol table | names | footer
+*
+*   and read back from a read-only mapping of that file.
+******************************************************************************/
+class ProgramImage
+{
+public:
+    struct Segment
+    {
+        DSPDevicePtr address;
+        uint32_t     memsz;
+        uint32_t     filesz;       // initialized bytes, the rest is zeroed
+        uint32_t     flags;        // DLOAD_SF_* of the segment
+        uint64_t     data_offset;  // of the initialized bytes in the file
+    };
+
+    typedef std::unordered_map<std::string, DSPDevicePtr> SymbolMap;
+
+    ProgramImage();
+    ~ProgramImage();
+
+    ProgramImage(const ProgramImage&)            =delete;
+    ProgramImage& operator=(const ProgramImage&) =delete;
+
+    /*-------------------------------------------------------------------------
+    * Recording. Segments are added when they are allocated, their contents
+    * when the loader writes them. Finish() completes the file, which is left
+    * to the caller either way.
+    *------------------------------------------------------------------------*/
+    bool Create(const std::string &filename);
+    void AddSegment(DSPDevicePtr address, uint32_t memsz);
+    void SetSegmentData(DSPDevicePtr address, const void *data,
+                        uint32_t filesz, uint32_t flags);
+    void AddSymbol(const char *name, DSPDevicePtr value);
+    bool Finish(DSPDevicePtr data_page, DSPDevicePtr load_address);
+
+    /*-------------------------------------------------------------------------
+    * Replay
+    *------------------------------------------------------------------------*/
+    bool Open(const std::string &filename);
+    const void *SegmentData(const Segment &segment) const;
+
+    const std::vector<Segment> &Segments() const { return segments; }
+    const SymbolMap            &Symbols()  const { return symbols;  }
+    DSPDevicePtr DataPage()                const { return dataPage; }
+    DSPDevicePtr LoadAddress()             const { return loadAddress; }
+
+private:
+    void Close();
+
+    std::vector<Segment> segments;
+    SymbolMap            symbols;
+    DSPDevicePtr         dataPage;
+    DSPDevicePtr         loadAddress;
+
+    FILE                *file;              // recording
+    bool                 failed;
+    const char          *mapping;           // replay
+    size_t               mappingSize;
+};
+
+}
@@ -42,7 +42,8 @@ SharedMemoryProvider(uint8_t device_id) :
         else if (r.GetLocation() == MemoryRange::Location::OFFCHIP)
         {
             if (r.GetKind() == MemoryRange::Kind::CMEM_PERSISTENT ||
-                r.GetKind() == MemoryRange::Kind::RTOS_SHMEM)
+                r.GetKind() == MemoryRange::Kind::RTOS_SHMEM      ||
+                r.GetKind() == MemoryRange::Kind::EMULATED)
             {
                 HeapPolicy::ddr_heap1_->configure(r.GetBase(), r.GetSize(), 
                                                   MIN_BLOCK_SIZE);
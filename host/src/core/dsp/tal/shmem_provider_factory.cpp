@@ -31,23 +31,44 @@
 #include "ion_memory_provider.h"
 #else
 #include "shared_memory_provider.h"
+#if !defined(DSP_EMULATION_ONLY)
 #include "shmem_rw_policy_cmem.h"
 #include "shmem_init_policy_cmem.h"
 #include "heaps_policy_process.h"
 #endif
+#include "shmem_rw_policy_emulation.h"
+#include "shmem_init_policy_emulation.h"
+#include "heaps_policy_thread.h"
+#endif
+#include "dsp_emulation.h"
+#include "../device_info.h"
 
 using namespace tiocl;
 
 SharedMemory* SharedMemoryProviderFactory::CreateSharedMemoryProvider
            (uint8_t device_id)
 {
+    SharedMemory* shm = nullptr;
+
+    #if defined(DSP_EMULATION_SUPPORTED)
+    // Emulated DSP: shared memory is private host memory
+    if (DeviceInfo::Instance().IsEmulated())
+        shm = new SharedMemoryProvider<InitializationPolicyEmulation,
+                                       ReadWritePolicyEmulation,
+                                       HeapsMultiThreadedPolicy> (device_id);
+    #endif
+
     // Create a CMEM based shared memory implementation
-    SharedMemory* shm =
-    #if defined(USE_ION)
-        new SharedMemoryProvider(device_id);
-    #else
-        new SharedMemoryProvider<InitializationPolicyCMEM, ReadWritePolicyCMEM,
-                                 HeapsMultiProcessPolicy> (device_id);
+    #if !defined(DSP_EMULATION_ONLY)
+    if (shm == nullptr)
+        shm =
+        #if defined(USE_ION)
+            new SharedMemoryProvider(device_id);
+        #else
+            new SharedMemoryProvider<InitializationPolicyCMEM,
+                                     ReadWritePolicyCMEM,
+                                     HeapsMultiProcessPolicy> (device_id);
+        #endif
     #endif
 
     assert (shm != nullptr);
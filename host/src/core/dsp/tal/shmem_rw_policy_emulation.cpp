@@ -0,0 +1,94 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <cstring>
+#include "shmem_rw_policy_emulation.h"
+#include "core/error_report.h"
+
+using namespace tiocl;
+
+void
+ReadWritePolicyEmulation::Configure(int32_t device_id,
+                                    const tiocl::MemoryProviderFactory* mpf)
+{
+    device_id_ = device_id;
+    mp_factory_ = mpf;
+}
+
+int32_t
+ReadWritePolicyEmulation::Write(uint64_t dst, uint8_t *src, size_t size)
+{
+    const MemoryProvider* region = mp_factory_->GetMemoryProvider(dst);
+    void* dst_host_addr = region->MapToHostAddressSpace(dst, size, false);
+    if (dst_host_addr) memcpy((char*)dst_host_addr, src, size);
+    else
+        ReportError(ErrorType::Fatal,
+                    ErrorKind::UnableToMapDSPAddress, "for write");
+    region->UnmapFromHostAddressSpace(dst_host_addr, size, true);
+
+    return 0;
+}
+
+int32_t
+ReadWritePolicyEmulation::Read(uint64_t src, uint8_t *dst, size_t size)
+{
+    const MemoryProvider* region = mp_factory_->GetMemoryProvider(src);
+    void* src_host_addr = region->MapToHostAddressSpace(src, size, true);
+    if (src_host_addr) memcpy(dst, (char*)src_host_addr, size);
+    else
+        ReportError(ErrorType::Fatal,
+                    ErrorKind::UnableToMapDSPAddress, "for read");
+    region->UnmapFromHostAddressSpace(src_host_addr, size, false);
+
+    return 0;
+}
+
+void*
+ReadWritePolicyEmulation::Map(uint64_t addr, size_t sz,
+                              bool is_read, bool allow_fail)
+{
+    const MemoryProvider* region = mp_factory_->GetMemoryProvider(addr);
+    void* host_addr = region->MapToHostAddressSpace(addr, sz, is_read);
+    if (host_addr == NULL && !allow_fail)
+        ReportError(ErrorType::Fatal,
+                    ErrorKind::UnableToMapDSPAddress, "");
+    return host_addr;
+}
+
+int32_t
+ReadWritePolicyEmulation::Unmap(void *host_addr, uint64_t buf_addr, size_t sz,
+                                bool is_write)
+{
+    const MemoryProvider* region = mp_factory_->GetMemoryProvider(buf_addr);
+    region->UnmapFromHostAddressSpace(host_addr, sz, is_write);
+    return 0;
+}
+
+bool ReadWritePolicyEmulation::CacheWbInvAll()
+{
+    return true;
+}
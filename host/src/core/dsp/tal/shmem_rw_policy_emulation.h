@@ -0,0 +1,60 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include "memory_provider_factory.h"
+
+using tiocl::MemoryProviderFactory;
+
+
+/****************************************************************************
+ * Policy class implementing read/write and map/unmap for the emulated DSP.
+ * Its memory is host memory, there is no cache to maintain.
+ ***************************************************************************/
+class ReadWritePolicyEmulation
+{
+public:
+    void    Configure(int32_t device_id,
+                      const MemoryProviderFactory* mpFactory);
+
+    int32_t Write(uint64_t dst, uint8_t *src, size_t sz);
+    int32_t Read (uint64_t src, uint8_t *dst, size_t sz);
+
+    void*   Map  (uint64_t addr, size_t sz, bool is_read = false,
+                                  bool allow_fail = false);
+    int32_t Unmap(void *host_addr, uint64_t buf_addr,
+                                  size_t sz, bool is_write = false);
+
+    bool CacheWbInvAll();
+
+private:
+    int32_t                      device_id_;
+    const MemoryProviderFactory* mp_factory_;
+};
@@ -0,0 +1,58 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include "dsp_emulation.h"
+#include "symbol_address_emulation.h"
+#include "../error_report.h"
+
+using namespace tiocl;
+
+SymbolAddressLookupEmulation::SymbolAddressLookupEmulation()
+{
+    name_to_address_ = { {"ocl_local_mem_start",    EMULATED_L2_LOCAL_BASE},
+                         {"ocl_local_mem_size",     EMULATED_L2_LOCAL_SIZE} };
+}
+
+SymbolAddressLookupEmulation::~SymbolAddressLookupEmulation()
+{ }
+
+DSPDevicePtr SymbolAddressLookupEmulation::GetAddress(const std::string &symbol_name) const
+{
+    std::map<std::string, DSPDevicePtr>::const_iterator cit =
+        name_to_address_.find(symbol_name);
+
+    if (cit == name_to_address_.end())
+        ReportError(ErrorType::Fatal, ErrorKind::ELFSymbolAddressNotCached,
+                    symbol_name.c_str());
+
+    return cit->second;
+}
+
+const SymbolAddressLookup* tiocl::CreateEmulatedSymbolAddressLookup()
+{
+    return new SymbolAddressLookupEmulation();
+}
@@ -36,7 +36,8 @@
 using namespace tiocl;
 
 const char* tiocl::command_code_string[] =
-{ "EXIT", "TASK", "NDR", "CINV", "FREQ", "PRINT", "CONFIGURE", "DEBUG" };
+{ "EXIT", "TASK", "NDR", "CINV", "FREQ", "PRINT", "CONFIGURE", "DEBUG",
+  "BATCH" };
 
 static const std::map<const ErrorKind, const std::string> ErrorStrings =
 {
@@ -97,6 +98,9 @@ static const std::map<const ErrorKind, const std::string> ErrorStrings =
 
     {ErrorKind::IonPtrNotAlloced, "pointer %p not allocated from ION heap"},
 
+    {ErrorKind::EmulatedMemoryMapFailed,
+     "Cannot reserve host memory for the emulated DSP memory (0x%llx, %lld MB)"},
+
     {ErrorKind::InvalidPointerToClFree,
      "Invalid pointer %p to clFree"},
 
@@ -147,10 +151,10 @@ static const std::map<const ErrorKind, const std::string> ErrorStrings =
      "Communication to a DSP has been lost (likely due to an MMU fault).%s"},
 
     {ErrorKind::DaemonNotRunning,
-     "The TI Multicore Tools daemon (/usr/bin/ti-mctd) is not running. To start daemon, rm /dev/shm/HeapManager (if exists); ti-mctd. Re-run application. Refer User Guide for details."},
+     "The TI Multicore Tools daemon (/usr/bin/ti-mctd) is not running, or is from another OpenCL release. To start daemon, pkill ti-mctd; rm /dev/shm/HeapManager* (if exists); ti-mctd. Re-run application. Refer User Guide for details."},
 
     {ErrorKind::DaemonAlreadyRunning,
-     "The TI Multicore Tools daemon (/usr/bin/ti-mctd) is already running. If a restart is needed, pkill ti-mctd; rm /dev/shm/HeapManager (if exists); ti-mctd. Refer User Guide for details."},
+     "The TI Multicore Tools daemon (/usr/bin/ti-mctd) is already running. If a restart is needed, pkill ti-mctd; rm /dev/shm/HeapManager* (if exists); ti-mctd. Refer User Guide for details."},
 
     {ErrorKind::DaemonConfigOpenError,
      "Cannot parse mctd config file /etc/ti-mctd/ti_mctd_config.json. It is either missing or incorrect. Please check."},
@@ -53,6 +53,7 @@ enum class ErrorKind
     IonFreeFailed,
     IonCacheOpFailed,
     IonPtrNotAlloced,
+    EmulatedMemoryMapFailed,
     InvalidPointerToClFree,
     InvalidPointerToFree,
     ELFLibraryInitFailed,
@@ -276,6 +276,8 @@ cl_int EVEDevice::initEventDeviceData(Event *event)
             }
 
             DSPBuffer      *buf  = (DSPBuffer*) e->buffer()->deviceBuffer(this);
+            // Pinned until UnmapMemObject, host_addr aliases the buffer
+            buf->pin();
             DSPDevicePtr64  data = buf->data() + e->offset();
 
             // DO NOT INVALIDATE! Here only initializes host_addr, it cannot
@@ -287,7 +289,7 @@ cl_int EVEDevice::initEventDeviceData(Event *event)
             // (main thread) Retain this event, to be saved in buffer mapped
             // events, and later to be released by UnmapMemObject()
             if (host_addr != NULL) clRetainEvent(desc(e));
-            else                   ret_code = CL_MAP_FAILURE;
+            else { buf->unpin();   ret_code = CL_MAP_FAILURE; }
             break;
         }
 
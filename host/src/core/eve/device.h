@@ -90,6 +90,7 @@ class EVEDevice : public DeviceInterface, public Lockable
 
         int  numHostMails(Msg_t& msg) const;
         void mail_to   (Msg_t& msg, unsigned core = 0);
+        void mail_flush() {}   // EVE messages are not batched
         bool mail_query();
         int  mail_from(const DSPCoreSet& compute_units,
                                        int* retcode = nullptr);
@@ -232,6 +232,9 @@ cl_int EVEKernelEvent::callArgs(unsigned max_args_size)
 
                         if (buffer->get_host_ptr_clMalloced())
                             p_hostptr_clMalloced_bufs.push_back(buffer);
+
+                        if (! DEVICE_READ_ONLY(buffer))
+                            p_device_written_bufs.push_back(buffer);
                     }
                 }
 
@@ -463,5 +466,12 @@ void EVEKernelEvent::free_tmp_bufs()
             shm->CacheInv(data, buffer->host_ptr(), buffer->size());
     }
     // ***/
+
+    /*-------------------------------------------------------------------------
+    * The kernel may have written these buffers, the host cache no longer
+    * holds any of their ranges coherently
+    *------------------------------------------------------------------------*/
+    for (int i = 0; i < p_device_written_bufs.size(); ++i)
+        p_device_written_bufs[i]->setDeviceOwned();
 }
 
@@ -112,6 +112,7 @@ class EVEKernelEvent
         Msg_t                     p_msg;
         std::vector<HostptrPair>  p_hostptr_tmpbufs;
         std::vector<MemObject *>  p_hostptr_clMalloced_bufs;
+        std::vector<MemObject *>  p_device_written_bufs;
 
         /*---------------------------------------------------------------------
         * Helpers for run member function
@@ -38,6 +38,7 @@
 #include "deviceinterface.h"
 #include "context.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -1074,6 +1075,18 @@ KernelEvent::KernelEvent(CommandQueue *parent,
         }
     }
 
+    // Launches matching the specialization constants of the kernel run the
+    // variant built for their values, see Kernel::specialized(). Only valid
+    // launches get there, the variant comes retained.
+    if (Kernel *variant = kernel->specialized(device, work_dim, local_work_size))
+    {
+        clReleaseKernel(desc(p_kernel));
+
+        kernel       = variant;
+        p_kernel     = variant;
+        p_dev_kernel = variant->deviceDependentKernel(device);
+    }
+
     // Check if kernel has timeout specified and CommandQueue allows it
     if (kernel->getTimeout() > 0)
     {
@@ -1095,6 +1108,21 @@ KernelEvent::~KernelEvent()
     clReleaseKernel(desc(p_kernel));
 }
 
+void KernelEvent::replaceMemObject(MemObject *old_object,
+                                   MemObject *new_object)
+{
+    if (new_object != NULL) clRetainMemObject(desc(new_object));
+
+    auto it = std::find(p_mem_objects.begin(), p_mem_objects.end(),
+                        old_object);
+    if (it != p_mem_objects.end())
+    {
+        if (old_object != NULL) clReleaseMemObject(desc(old_object));
+        p_mem_objects.erase(it);
+    }
+    p_mem_objects.push_back(new_object);
+}
+
 cl_uint KernelEvent::work_dim() const
 {
     return p_work_dim;
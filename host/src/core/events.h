@@ -676,6 +676,14 @@ class KernelEvent : public Event
 
         cl_uint getTimeout() const { return p_timeout_ms; }
 
+        /**
+         * \brief Hold \p new_object instead of \p old_object
+         *
+         * Used when an argument of a recorded event is bound to another
+         * buffer, see \c Coal::CommandGraph::setKernelArg().
+         */
+        void replaceMemObject(MemObject *old_object, MemObject *new_object);
+
     private:
         cl_uint p_work_dim;
         cl_uint p_timeout_ms;
@@ -42,6 +42,9 @@
 
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
@@ -55,10 +58,15 @@
 #include <llvm/IR/Metadata.h>
 
 
+// Variants kept by a kernel, and built by it at most
+#define MAX_KERNEL_VARIANTS       8
+#define MAX_KERNEL_VARIANT_BUILDS 32
+
 using namespace Coal;
 Kernel::Kernel(Program *program)
 : Object(Object::T_Kernel, program), p_has_locals(false), wi_alloca_size(0),
-  p_timeout_ms(0)
+  p_timeout_ms(0), p_wg_schedule(CL_WG_SCHEDULE_STATIC_TI),
+  p_spec_work_dim(0), p_variant_builds(0), p_variant_clock(0)
 {
     // TODO: Say a kernel is attached to the program (that becomes unalterable)
 
@@ -66,10 +74,18 @@ Kernel::Kernel(Program *program)
     null_dep.kernel   = 0;
     null_dep.function = 0;
     null_dep.module   = 0;
+
+    p_spec_local_size[0] = p_spec_local_size[1] = p_spec_local_size[2] = 0;
+    pthread_mutex_init(&p_variants_mutex, 0);
 }
 
 Kernel::~Kernel()
 {
+    for (auto &variant : p_variants)
+        if (variant.second.kernel) clReleaseKernel(desc(variant.second.kernel));
+
+    pthread_mutex_destroy(&p_variants_mutex);
+
     while (p_device_dependent.size())
     {
         DeviceDependent &dep = p_device_dependent.back();
@@ -460,6 +476,238 @@ cl_int Kernel::setArg(cl_uint index, size_t size, const void *value)
     return CL_SUCCESS;
 }
 
+/******************************************************************************
+* cl_int Kernel::setArgSpecialized(cl_uint index, bool specialized)
+******************************************************************************/
+cl_int Kernel::setArgSpecialized(cl_uint index, bool specialized)
+{
+    if (index >= p_args.size())
+        return CL_INVALID_ARG_INDEX;
+
+    const Arg &arg = p_args[index];
+
+    /*-------------------------------------------------------------------------
+    * Only values known to the host can be folded
+    *------------------------------------------------------------------------*/
+    if (arg.file() == Arg::Local || arg.kind() == Arg::Buffer ||
+        arg.kind() == Arg::Image2D || arg.kind() == Arg::Image3D)
+        return CL_INVALID_ARG_VALUE;
+
+    p_arg_specialized.resize(p_args.size(), false);
+    p_arg_specialized[index] = specialized;
+
+    return CL_SUCCESS;
+}
+
+/******************************************************************************
+* cl_int Kernel::setSpecializedShape(cl_uint work_dim,
+*                                    const size_t *local_work_size)
+******************************************************************************/
+cl_int Kernel::setSpecializedShape(cl_uint work_dim,
+                                   const size_t *local_work_size)
+{
+    if (!local_work_size)
+    {
+        p_spec_work_dim = 0;
+        return CL_SUCCESS;
+    }
+
+    if (work_dim == 0 || work_dim > 3)
+        return CL_INVALID_WORK_DIMENSION;
+
+    for (cl_uint i = 0; i < 3; ++i)
+    {
+        p_spec_local_size[i] = (i < work_dim) ? local_work_size[i] : 1;
+        if (p_spec_local_size[i] == 0)
+        {
+            p_spec_work_dim = 0;
+            return CL_INVALID_WORK_GROUP_SIZE;
+        }
+    }
+    p_spec_work_dim = work_dim;
+
+    return CL_SUCCESS;
+}
+
+/******************************************************************************
+* Kernel *Kernel::specialized(DeviceInterface *device, cl_uint work_dim,
+*                             const size_t *local_work_size)
+*
+* The variant is described to clocl as
+*     <kernel>:<x>,<y>,<z>[:<arg index>=<hex bytes>]...
+* with a zero work-group size when the shape is not specialized. The same
+* string, prefixed by the root device, is the key of the variant cache. A
+* variant that fails to build is cached as NULL, the launch then runs this
+* kernel. The cache keeps the MAX_KERNEL_VARIANTS most recently used variants
+* and builds at most MAX_KERNEL_VARIANT_BUILDS of them over the life of the
+* kernel, later new values run this kernel.
+******************************************************************************/
+Kernel *Kernel::specialized(DeviceInterface *device, cl_uint work_dim,
+                            const size_t *local_work_size)
+{
+#ifdef _SYS_BIOS
+    return NULL;
+#else
+    bool has_args = std::find(p_arg_specialized.begin(),
+                              p_arg_specialized.end(), true)
+                                                  != p_arg_specialized.end();
+    if (!has_args && p_spec_work_dim == 0) return NULL;
+
+    size_t local_size[3] = { 0, 0, 0 };
+    if (p_spec_work_dim != 0)
+    {
+        if (work_dim != p_spec_work_dim || !local_work_size) return NULL;
+
+        for (cl_uint i = 0; i < work_dim; ++i)
+            if (local_work_size[i] != p_spec_local_size[i]) return NULL;
+
+        std::copy(p_spec_local_size, p_spec_local_size + 3, local_size);
+    }
+
+    Program *program = (Program *)parent();
+    if (program->type() != Program::Source) return NULL;
+
+    std::ostringstream spec;
+    spec << p_name << ':' << local_size[0] << ',' << local_size[1] << ','
+         << local_size[2];
+
+    for (size_t i = 0; i < p_arg_specialized.size(); ++i)
+    {
+        if (!p_arg_specialized[i]) continue;
+
+        const Arg &arg = p_args[i];
+        const unsigned char *bytes = (const unsigned char *)arg.data();
+
+        spec << ':' << i << '=' << std::hex << std::setfill('0');
+        for (size_t b = 0; b < arg.vecDim() * arg.valueSize(); ++b)
+            spec << std::setw(2) << (unsigned int)bytes[b];
+        spec << std::dec;
+    }
+
+    std::ostringstream key;
+    key << (const void *)device->GetRootDevice() << ' ' << spec.str();
+
+    pthread_mutex_lock(&p_variants_mutex);
+
+    std::map<std::string, Variant>::iterator it = p_variants.find(key.str());
+    if (it == p_variants.end())
+    {
+        /*---------------------------------------------------------------------
+        * Values keep changing: stop building variants, run this kernel
+        *--------------------------------------------------------------------*/
+        if (p_variant_builds >= MAX_KERNEL_VARIANT_BUILDS)
+        {
+            pthread_mutex_unlock(&p_variants_mutex);
+            return NULL;
+        }
+        p_variant_builds++;
+
+        Variant &entry = p_variants[key.str()];
+        entry.kernel   = NULL;
+        entry.building = true;
+        entry.last_use = ++p_variant_clock;
+
+        pthread_mutex_unlock(&p_variants_mutex);
+
+        /*---------------------------------------------------------------------
+        * Build the variant in a program of its own, with the options of this
+        * one, synchronously: the launch needs it. Launches with the same
+        * values meanwhile run this kernel.
+        *--------------------------------------------------------------------*/
+        Kernel *variant = NULL;
+        Program *variant_program = new Program((Context *)program->parent());
+
+        std::string source  = program->source();
+        const char *strings = source.c_str();
+        cl_device_id d_device = desc(device);
+        std::string options = program->deviceDependentCompilerOptions(device) +
+                              " -specialize=" + spec.str();
+
+        cl_int rs = variant_program->loadSources(1, &strings, NULL);
+        if (rs == CL_SUCCESS)
+            rs = variant_program->build(options.c_str(), NULL, NULL,
+                                        1, &d_device);
+        if (rs == CL_SUCCESS)
+        {
+            variant = variant_program->createKernel(p_name, &rs);
+            if (rs != CL_SUCCESS)
+            {
+                delete variant;
+                variant = NULL;
+            }
+        }
+
+        // The variant kernel, if any, keeps its program alive
+        if (variant_program->dereference()) delete variant_program;
+
+        pthread_mutex_lock(&p_variants_mutex);
+
+        it = p_variants.find(key.str());
+        it->second.kernel   = variant;
+        it->second.building = false;
+
+        /*---------------------------------------------------------------------
+        * Evict the least recently used variants over the limit. Launches
+        * still running one hold their own reference.
+        *--------------------------------------------------------------------*/
+        while (p_variants.size() > MAX_KERNEL_VARIANTS)
+        {
+            std::map<std::string, Variant>::iterator lru = p_variants.end();
+            for (std::map<std::string, Variant>::iterator v =
+                     p_variants.begin(); v != p_variants.end(); ++v)
+                if (!v->second.building && v != it &&
+                    (lru == p_variants.end() ||
+                     v->second.last_use < lru->second.last_use))
+                    lru = v;
+
+            if (lru == p_variants.end()) break;
+
+            if (lru->second.kernel) clReleaseKernel(desc(lru->second.kernel));
+            p_variants.erase(lru);
+        }
+    }
+    else
+        it->second.last_use = ++p_variant_clock;
+
+    Kernel *variant = it->second.building ? NULL : it->second.kernel;
+    if (variant)
+    {
+        variant->copyArgs(this);
+        variant->p_timeout_ms  = p_timeout_ms;
+        variant->p_wg_schedule = p_wg_schedule;
+        clRetainKernel(desc(variant));
+    }
+
+    pthread_mutex_unlock(&p_variants_mutex);
+
+    return variant;
+#endif
+}
+
+/******************************************************************************
+* void Kernel::copyArgs(const Kernel *kernel)
+*
+* Give the arguments the values of those of kernel, of the same signature
+******************************************************************************/
+void Kernel::copyArgs(const Kernel *kernel)
+{
+    for (size_t i = 0; i < p_args.size() && i < kernel->p_args.size(); ++i)
+    {
+        Arg       &arg = p_args[i];
+        const Arg &src = kernel->p_args[i];
+
+        arg.refineKind(src.kind());
+
+        if (src.file() == Arg::Local)
+            arg.setAllocAtKernelRuntime(src.allocAtKernelRuntime());
+        else
+        {
+            arg.alloc();
+            arg.loadData(src.data());
+        }
+    }
+}
+
 unsigned int Kernel::numArgs() const
 {
     return p_args.size();
@@ -763,7 +1011,8 @@ cl_int Kernel::workGroupInfo(DeviceInterface *device,
  */
 Kernel::Arg::Arg(unsigned short vec_dim, File file, Kind kind, bool is_subword_int_uns)
 : p_vec_dim(vec_dim), p_file(file), p_kind(kind), p_data(0), p_defined(false),
-  p_runtime_alloc(0), p_is_subword_int_uns(is_subword_int_uns)
+  p_runtime_alloc(0), p_is_subword_int_uns(is_subword_int_uns),
+  p_generation(0)
 { }
 
 Kernel::Arg::~Arg()
@@ -778,18 +1027,27 @@ void Kernel::Arg::alloc()
 
 void Kernel::Arg::loadData(const void *data)
 {
-    std::memcpy(p_data, data, p_vec_dim * valueSize());
+    size_t size = p_vec_dim * valueSize();
+
+    // Only a real change in value invalidates marshalled copies of this arg
+    if (!p_defined || std::memcmp(p_data, data, size) != 0)
+    {
+        std::memcpy(p_data, data, size);
+        ++p_generation;
+    }
     p_defined = true;
 }
 
 void Kernel::Arg::setAllocAtKernelRuntime(size_t size)
 {
+    if (!p_defined || p_runtime_alloc != size) ++p_generation;
     p_runtime_alloc = size;
     p_defined       = true;
 }
 
 void Kernel::Arg::refineKind (Kernel::Arg::Kind kind)
 {
+    if (p_kind != kind) ++p_generation;
     p_kind = kind;
 }
 
@@ -43,6 +43,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <pthread.h>
 #include <llvm/IR/Metadata.h>
 
 namespace Coal
@@ -212,6 +213,16 @@ class Kernel : public _cl_kernel, public Object
                 const void *data() const;                      /*!< \brief Pointer to the data of this arg, equivalent to <tt>value(0)</tt> */
                 bool is_subword_int_uns() const ;
 
+                /**
+                 * \brief Generation of the value of this argument
+                 *
+                 * Bumped every time \c loadData(), \c setAllocAtKernelRuntime()
+                 * or \c refineKind() actually changes the argument, so that
+                 * devices can tell whether a value they marshalled for an
+                 * earlier launch is still current.
+                 */
+                unsigned int generation() const { return p_generation; }
+
                 /* Kernel ArgInfo Setters */
                 void SetName     (const std::string& name)  { p_name      = name;  }
                 void SetTypeName (const std::string& type)  { p_type_name = type;  }
@@ -238,6 +249,7 @@ class Kernel : public _cl_kernel, public Object
                 bool p_defined;
                 size_t p_runtime_alloc;
                 bool p_is_subword_int_uns;
+                unsigned int p_generation;
                 std::string                     p_name;
                 std::string                     p_type_name;
                 std::string                     p_base_type;
@@ -366,16 +378,70 @@ class Kernel : public _cl_kernel, public Object
         int          setTimeout(unsigned int timeout_in_ms)
                           { p_timeout_ms = timeout_in_ms;  return CL_SUCCESS; }
 
+        cl_uint getWgSchedule() { return p_wg_schedule; }
+        int     setWgSchedule(cl_uint schedule)
+                          { p_wg_schedule = schedule;  return CL_SUCCESS; }
+
         /**
         * \brief Get kernel name
         */
         std::string getName() { return p_name; }
 
+        /**
+         * \brief Mark argument \p index as a specialization constant
+         *
+         * Only by-value scalar and vector arguments can be specialized.
+         */
+        cl_int setArgSpecialized(cl_uint index, bool specialized);
+
+        /**
+         * \brief Specialize the kernel for a work-group size, or no longer if
+         *        \p local_work_size is NULL
+         */
+        cl_int setSpecializedShape(cl_uint work_dim,
+                                   const size_t *local_work_size);
+
+        /**
+         * \brief Variant of this kernel specialized for a launch
+         *
+         * If arguments or a work-group size were marked as specialization
+         * constants and the launch uses that work-group size, the kernel is
+         * rebuilt from the program source with the current values of the
+         * marked arguments and the work-group size folded in by clocl
+         * (\c -specialize). Variants are cached per root device and values,
+         * in a bounded least recently used cache, and built outside of its
+         * lock.
+         *
+         * \return the variant, retained for the caller and holding the
+         *         argument values, timeout and work-group schedule of this
+         *         kernel, or NULL if the launch runs this kernel
+         */
+        Kernel *specialized(DeviceInterface *device, cl_uint work_dim,
+                            const size_t *local_work_size);
+
     protected:
         std::string p_name;
         bool p_has_locals;
         int wi_alloca_size;
         unsigned int p_timeout_ms;
+        cl_uint p_wg_schedule;
+
+        // Specialization constants and the variants built for them
+        std::vector<bool>               p_arg_specialized;
+        cl_uint                         p_spec_work_dim;
+        size_t                          p_spec_local_size[3];
+        struct Variant
+        {
+            Kernel   *kernel;    /*!< NULL if the build failed */
+            bool      building;  /*!< built by a launch, not usable yet */
+            uint64_t  last_use;
+        };
+        std::map<std::string, Variant>  p_variants;
+        cl_uint                         p_variant_builds;
+        uint64_t                        p_variant_clock;
+        pthread_mutex_t                 p_variants_mutex;
+
+        void copyArgs(const Kernel *kernel);
 
         struct DeviceDependent
         {
@@ -41,6 +41,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <algorithm>
+#include <iterator>
 
 using namespace Coal;
 
@@ -52,8 +54,10 @@ MemObject::MemObject(Context *ctx, cl_mem_flags flags, void *host_ptr,
                      cl_int *errcode_ret)
 : Object(Object::T_MemObject, ctx), p_num_devices(0), p_flags(flags),
   p_host_ptr(host_ptr), p_host_ptr_clMalloced(false),
-  p_devicebuffers(0), p_dtor_callback_stack()
+  p_devicebuffers(0), p_dtor_callback_stack(), p_host_generation(0)
 {
+    pthread_mutex_init(&p_host_valid_mutex, 0);
+
     // Check the flags value
     const cl_mem_flags all_flags = CL_MEM_READ_WRITE | CL_MEM_WRITE_ONLY |
                                    CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR |
@@ -129,6 +133,105 @@ MemObject::~MemObject()
 
         std::free((void *)p_devicebuffers);
     }
+
+    pthread_mutex_destroy(&p_host_valid_mutex);
+}
+
+/******************************************************************************
+* Host cache ownership.  Ranges are kept on the buffer that owns the storage,
+* as [start, end) byte offsets, merged when they touch.
+******************************************************************************/
+MemObject *MemObject::ownershipRoot(size_t &offset)
+{
+    if (type() != SubBuffer) return this;
+
+    class SubBuffer *subbuf = (class SubBuffer *)this;
+    offset += subbuf->offset();
+    return subbuf->parent();
+}
+
+bool MemObject::isHostValid(size_t offset, size_t cb)
+{
+    MemObject *root = ownershipRoot(offset);
+    bool       valid = false;
+
+    pthread_mutex_lock(&root->p_host_valid_mutex);
+    auto it = root->p_host_valid.upper_bound(offset);
+    if (it != root->p_host_valid.begin())
+    {
+        --it;
+        valid = (it->first <= offset && offset + cb <= it->second);
+    }
+    pthread_mutex_unlock(&root->p_host_valid_mutex);
+
+    return valid;
+}
+
+unsigned int MemObject::hostGeneration()
+{
+    size_t     offset = 0;
+    MemObject *root   = ownershipRoot(offset);
+
+    pthread_mutex_lock(&root->p_host_valid_mutex);
+    unsigned int generation = root->p_host_generation;
+    pthread_mutex_unlock(&root->p_host_valid_mutex);
+
+    return generation;
+}
+
+void MemObject::setHostValid(size_t offset, size_t cb, unsigned int generation)
+{
+    MemObject *root  = ownershipRoot(offset);
+    size_t     start = offset;
+    size_t     end   = offset + cb;
+
+    pthread_mutex_lock(&root->p_host_valid_mutex);
+    if (generation == root->p_host_generation && cb > 0)
+    {
+        auto &ranges = root->p_host_valid;
+
+        // Absorb every range that overlaps or touches [start, end)
+        auto it = ranges.upper_bound(start);
+        if (it != ranges.begin() && std::prev(it)->second >= start) --it;
+
+        while (it != ranges.end() && it->first <= end)
+        {
+            start = std::min(start, it->first);
+            end   = std::max(end,   it->second);
+            it    = ranges.erase(it);
+        }
+        ranges[start] = end;
+    }
+    pthread_mutex_unlock(&root->p_host_valid_mutex);
+}
+
+void MemObject::setDeviceOwned()
+{
+    size_t     start = 0;
+    MemObject *root  = ownershipRoot(start);
+    size_t     end   = start + size();
+
+    pthread_mutex_lock(&root->p_host_valid_mutex);
+    root->p_host_generation++;
+
+    if (root == this)
+        root->p_host_valid.clear();
+    else
+    {
+        // Only the sub-buffer's range of the parent loses host ownership
+        auto &ranges = root->p_host_valid;
+        auto it = ranges.upper_bound(start);
+        if (it != ranges.begin() && std::prev(it)->second > start) --it;
+
+        while (it != ranges.end() && it->first < end)
+        {
+            size_t r_start = it->first, r_end = it->second;
+            it = ranges.erase(it);
+            if (r_start < start) ranges[r_start] = start;
+            if (r_end   > end)   ranges[end]     = r_end;
+        }
+    }
+    pthread_mutex_unlock(&root->p_host_valid_mutex);
 }
 
 cl_int MemObject::init()
@@ -422,7 +525,8 @@ cl_int MemObject::info(cl_mem_info param_name,
 
 Buffer::Buffer(Context *ctx, size_t size, void *host_ptr, cl_mem_flags flags,
                cl_int *errcode_ret)
-: MemObject(ctx, flags, host_ptr, errcode_ret), p_size(size)
+: MemObject(ctx, flags, host_ptr, errcode_ret), p_size(size),
+  p_has_sub_buffers(false)
 {
     if (size == 0)
     {
@@ -445,6 +549,16 @@ MemObject::Type Buffer::type() const
     return MemObject::Buffer;
 }
 
+bool Buffer::hasSubBuffers() const
+{
+    return p_has_sub_buffers;
+}
+
+void Buffer::subBufferCreated()
+{
+    p_has_sub_buffers = true;
+}
+
 /*----------------------------------------------------------------------------
  * mapped_event: MapBufferEvent when the Map is on a Buffer
  * RETURN: true if successful, false if fail
@@ -509,6 +623,7 @@ SubBuffer::SubBuffer(class Buffer *parent, size_t offset, size_t size,
   p_size(size), p_parent(parent)
 {
     clRetainMemObject(desc(p_parent));
+    p_parent->subBufferCreated();
 
     if (size == 0)
     {
@@ -38,6 +38,8 @@
 #include "icd.h"
 #include "dsp/u_concurrent_stack.h"
 #include <list>
+#include <map>
+#include <pthread.h>
 
 #include <CL/cl.h>
 
@@ -154,6 +156,26 @@ class MemObject : public _cl_mem, public Object
         void set_host_ptr_clMalloced() {  p_host_ptr_clMalloced = true;  }
         bool get_host_ptr_clMalloced() {  return p_host_ptr_clMalloced;  }
 
+        /**
+         * \brief Host cache ownership of byte ranges of this memory object
+         *
+         * A range is host valid when the host cache holds no stale lines for
+         * it: the host last invalidated it or wrote it back, and no device has
+         * written it since. Reads and read maps of host valid ranges do not
+         * need a cache invalidate. Host writes are always written back, so
+         * they keep a range valid. Sub-buffers share the ranges of their
+         * parent buffer.
+         *
+         * A host transfer reads \c hostGeneration() before its cache
+         * operation and passes it to \c setHostValid(), which ignores the
+         * range if a device wrote the object in between.
+         */
+        bool         isHostValid(size_t offset, size_t cb);
+        unsigned int hostGeneration();
+        void         setHostValid(size_t offset, size_t cb,
+                                  unsigned int generation);
+        void         setDeviceOwned(); /*!< \brief A device may have written this object */
+
     protected:
         cl_mem_flags             p_flags;
         std::list<BufferEvent *> p_mapped_events;
@@ -164,6 +186,12 @@ class MemObject : public _cl_mem, public Object
         bool           p_host_ptr_clMalloced;
         DeviceBuffer **p_devicebuffers;
 
+        std::map<size_t, size_t> p_host_valid;  /*!< start -> end of ranges */
+        unsigned int             p_host_generation;
+        pthread_mutex_t          p_host_valid_mutex;
+
+        MemObject *ownershipRoot(size_t &offset);
+
         typedef std::pair<void (CL_CALLBACK *)(cl_mem memobj, void *user_data), void*> dtor_callback_t;
         concurrent_stack<dtor_callback_t> p_dtor_callback_stack;
 
@@ -193,8 +221,12 @@ class Buffer : public MemObject
 
         bool            addMapEvent(BufferEvent *mapped_event);
         BufferEvent* removeMapEvent(void *mapped_ptr);
+
+        bool hasSubBuffers() const;  /*!< \brief A sub-buffer was created from this buffer */
+        void subBufferCreated();     /*!< \brief Called by the \c Coal::SubBuffer constructor */
     private:
         size_t p_size;
+        bool   p_has_sub_buffers;
 
 };
 
@@ -11,7 +11,7 @@ class MemoryRange
 {
 public:
     enum class Kind { CMEM_PERSISTENT, CMEM_ONDEMAND, DEVMEM, RTOS_SHMEM,
-                      RTOS_HOSTMEM };
+                      RTOS_HOSTMEM, EMULATED };
     enum class Location {ONCHIP, OFFCHIP};
 
     MemoryRange(DSPDevicePtr64 a, uint64_t sz, Kind k, Location l,
@@ -62,7 +62,9 @@ class Object
             T_Kernel,       /*!< \brief \c Coal::Kernel */
             T_MemObject,    /*!< \brief \c Coal::MemObject */
             T_Program,      /*!< \brief \c Coal::Program */
-            T_Sampler       /*!< \brief \c Coal::Sampler */
+            T_Sampler,      /*!< \brief \c Coal::Sampler */
+            T_CommandGraph, /*!< \brief \c Coal::CommandGraph */
+            T_Stream        /*!< \brief \c Coal::Stream */
         };
 
         /**
@@ -0,0 +1,160 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file object_pool.cpp
+ * \brief Free lists recycling the memory of short-lived objects
+ */
+
+#include "object_pool.h"
+#include "oclenv.h"
+
+#include <cstdlib>
+#include <new>
+
+using namespace Coal;
+
+/*-----------------------------------------------------------------------------
+* Registry of the pools, for statistics. Pools are never destroyed.
+*----------------------------------------------------------------------------*/
+static pthread_mutex_t           pools_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<ObjectPool *> pools;
+
+ObjectPool::ObjectPool(Kind kind, size_t max_size)
+: p_kind(kind), p_max_size(max_size), p_max_free(0),
+  p_lists((max_size + OBJECT_POOL_GRANULE - 1) / OBJECT_POOL_GRANULE),
+  p_hits(0), p_misses(0), p_free_blocks(0)
+{
+    tiocl::EnvVar& env = tiocl::EnvVar::Instance();
+    cl_int max_free = env.GetEnv<tiocl::EnvVar::Var::TI_OCL_EVENT_POOL_SIZE>(
+                                 OBJECT_POOL_DEFAULT_MAX_FREE);
+    if (max_free > 0) p_max_free = max_free;
+
+    for (FreeList &list : p_lists)
+    {
+        pthread_mutex_init(&list.mutex, 0);
+        list.head  = NULL;
+        list.count = 0;
+    }
+
+    pthread_mutex_lock(&pools_mutex);
+    pools.push_back(this);
+    pthread_mutex_unlock(&pools_mutex);
+}
+
+/******************************************************************************
+* void *ObjectPool::allocate(size_t size)
+******************************************************************************/
+void *ObjectPool::allocate(size_t size)
+{
+    if (size > 0 && size <= p_max_size && p_max_free > 0)
+    {
+        FreeList &list = p_lists[(size - 1) / OBJECT_POOL_GRANULE];
+
+        pthread_mutex_lock(&list.mutex);
+        Block *block = list.head;
+        if (block != NULL)
+        {
+            list.head = block->next;
+            list.count--;
+        }
+        pthread_mutex_unlock(&list.mutex);
+
+        if (block != NULL)
+        {
+            __sync_fetch_and_add(&p_hits, 1);
+            __sync_fetch_and_sub(&p_free_blocks, 1);
+            return block;
+        }
+
+        // Allocate the whole size class, the block may be reused for a
+        // larger object of the same class
+        size = ((size - 1) / OBJECT_POOL_GRANULE + 1) * OBJECT_POOL_GRANULE;
+    }
+
+    __sync_fetch_and_add(&p_misses, 1);
+
+    void *block = std::malloc(size);
+    if (block == NULL) throw std::bad_alloc();
+    return block;
+}
+
+/******************************************************************************
+* void ObjectPool::release(void *block, size_t size)
+******************************************************************************/
+void ObjectPool::release(void *block, size_t size)
+{
+    if (block == NULL) return;
+
+    if (size > 0 && size <= p_max_size)
+    {
+        FreeList &list = p_lists[(size - 1) / OBJECT_POOL_GRANULE];
+        bool kept = false;
+
+        pthread_mutex_lock(&list.mutex);
+        if (list.count < p_max_free)
+        {
+            ((Block *) block)->next = list.head;
+            list.head = (Block *) block;
+            list.count++;
+            kept = true;
+        }
+        pthread_mutex_unlock(&list.mutex);
+
+        if (kept)
+        {
+            __sync_fetch_and_add(&p_free_blocks, 1);
+            return;
+        }
+    }
+
+    std::free(block);
+}
+
+/******************************************************************************
+* void ObjectPool::stats(Kind kind, Stats &stats)
+******************************************************************************/
+void ObjectPool::stats(Kind kind, Stats &stats)
+{
+    stats.hits = stats.misses = stats.free_blocks = stats.free_bytes = 0;
+
+    pthread_mutex_lock(&pools_mutex);
+    for (ObjectPool *pool : pools)
+    {
+        if (pool->p_kind != kind) continue;
+
+        stats.hits        += pool->p_hits;
+        stats.misses      += pool->p_misses;
+        stats.free_blocks += pool->p_free_blocks;
+
+        for (unsigned int i = 0; i < pool->p_lists.size(); ++i)
+            stats.free_bytes += (uint64_t) pool->p_lists[i].count *
+                                (i + 1) * OBJECT_POOL_GRANULE;
+    }
+    pthread_mutex_unlock(&pools_mutex);
+}
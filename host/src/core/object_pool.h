@@ -0,0 +1,125 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file object_pool.h
+ * \brief Free lists recycling the memory of short-lived objects
+ */
+
+#ifndef __OBJECT_POOL_H__
+#define __OBJECT_POOL_H__
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#define OBJECT_POOL_GRANULE             16
+#define OBJECT_POOL_DEFAULT_MAX_FREE    256
+
+namespace Coal
+{
+
+/**
+ * \brief Free lists of memory blocks, one for each block size
+ *
+ * Used by class-specific <tt>operator new</tt> and <tt>operator delete</tt> of
+ * objects created and destroyed at every enqueue, events and their device
+ * data. A class hierarchy shares one pool: sizes are rounded up to
+ * \c OBJECT_POOL_GRANULE bytes and each rounded size has its own free list,
+ * so a block is only ever reused for an object of the same size class.
+ *
+ * Each list keeps at most \c TI_OCL_EVENT_POOL_SIZE free blocks, the others
+ * are returned to the heap. Pools live until the process exits: objects may
+ * be destroyed during static destruction, so they are never deleted.
+ */
+class ObjectPool
+{
+    public:
+        /**
+         * \brief What a pool holds, to add up statistics of pools of a kind
+         */
+        enum Kind
+        {
+            Events,
+            DeviceData
+        };
+
+        struct Stats
+        {
+            uint64_t hits;          /*!< \brief allocations from a free list */
+            uint64_t misses;        /*!< \brief allocations from the heap */
+            uint64_t free_blocks;   /*!< \brief blocks held in free lists */
+            uint64_t free_bytes;    /*!< \brief bytes held in free lists */
+        };
+
+        /**
+         * \brief Create a pool for objects of up to \p max_size bytes
+         *
+         * Larger objects are allocated from the heap and counted as misses.
+         */
+        ObjectPool(Kind kind, size_t max_size);
+
+        void *allocate(size_t size);
+        void  release(void *block, size_t size);
+
+        /**
+         * \brief Add up the statistics of every pool of \p kind
+         */
+        static void stats(Kind kind, Stats &stats);
+
+    private:
+        struct Block
+        {
+            Block *next;
+        };
+
+        struct FreeList
+        {
+            pthread_mutex_t mutex;
+            Block *         head;
+            unsigned int    count;
+        };
+
+        Kind                   p_kind;
+        size_t                 p_max_size;
+        unsigned int           p_max_free;
+        std::vector<FreeList>  p_lists;
+
+        uint64_t               p_hits;
+        uint64_t               p_misses;
+        uint64_t               p_free_blocks;
+
+        ObjectPool(const ObjectPool &);
+        ObjectPool &operator=(const ObjectPool &);
+};
+
+}
+
+#endif
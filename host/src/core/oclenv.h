@@ -31,21 +31,38 @@
 #include <CL/cl.h>
 
 #define __ENV_VAR_LIST(__FUNC) \
+  __FUNC(TI_OCL_BUFFER_POOL_SIZE,                       cl_int) \
+  __FUNC(TI_OCL_CACHE_IMAGES,                           char *) \
   __FUNC(TI_OCL_CACHE_KERNELS,                          char *) \
+  __FUNC(TI_OCL_CACHE_KERNELS_DIR,                      char *) \
+  __FUNC(TI_OCL_CACHE_KERNELS_SIZE,                   cl_ulong) \
   __FUNC(TI_OCL_COMPUTE_UNIT_LIST,                      char *) \
+  __FUNC(TI_OCL_COPY_ENGINE_THREADS,                    cl_int) \
+  __FUNC(TI_OCL_COPY_ENGINE_THRESHOLD,                  cl_int) \
+  __FUNC(TI_OCL_CORE_SCHEDULER,                         char *) \
+  __FUNC(TI_OCL_CORE_SCHEDULER_DEPTH,                   cl_int) \
   __FUNC(TI_OCL_CPU_DEVICE_ENABLE,                      char *) \
   __FUNC(TI_OCL_DEBUG,                                  char *) \
   __FUNC(TI_OCL_DEVICE_PROGRAM_INFO,                    char *) \
   __FUNC(TI_OCL_DSP_1_25GHZ,                            char *) \
+  __FUNC(TI_OCL_DSP_EMULATION,                          cl_int) \
+  __FUNC(TI_OCL_DSP_EMULATION_LATENCY,                  cl_int) \
+  __FUNC(TI_OCL_DSP_EMULATION_WG_LATENCY,               cl_int) \
   __FUNC(TI_OCL_ENABLE_FP64,                            char *) \
+  __FUNC(TI_OCL_EVENT_CHAINING,                         cl_int) \
+  __FUNC(TI_OCL_EVENT_POOL_SIZE,                        cl_int) \
   __FUNC(TI_OCL_INSTALL,                                char *) \
   __FUNC(TI_OCL_LIMIT_DEVICE_MAX_MEM_ALLOC_SIZE,      cl_ulong) \
   __FUNC(TI_OCL_KEEP_FILES,                             char *) \
   __FUNC(TI_OCL_KERNEL_TIMEOUT_COMPUTE_UNIT,            cl_int) \
+  __FUNC(TI_OCL_MAILBOX_BATCH_SIZE,                     cl_int) \
+  __FUNC(TI_OCL_MSMC_AUTO_PLACEMENT,                    cl_int) \
   __FUNC(TI_OCL_PROFILING_EVENT_TYPE,                   cl_int) \
   __FUNC(TI_OCL_PROFILING_EVENT_NUMBER1,                cl_int) \
   __FUNC(TI_OCL_PROFILING_EVENT_NUMBER2,                cl_int) \
   __FUNC(TI_OCL_PROFILING_STALL_CYCLE_THRESHOLD,        cl_int) \
+  __FUNC(TI_OCL_TRACE,                                  char *) \
+  __FUNC(TI_OCL_TRACE_BUFFER_SIZE,                      cl_int) \
   __FUNC(TI_OCL_WG_SIZE_LIMIT,                          cl_int) \
   __FUNC(TI_OCL_PRINTF_COREID,                          cl_int) \
   __FUNC(TARGET_ROOTDIR,                                char *) \
@@ -64,21 +81,38 @@ class EnvVar
 
     enum Var
     {
-      TI_OCL_CACHE_KERNELS = 0,
+      TI_OCL_BUFFER_POOL_SIZE = 0,
+      TI_OCL_CACHE_IMAGES,
+      TI_OCL_CACHE_KERNELS,
+      TI_OCL_CACHE_KERNELS_DIR,
+      TI_OCL_CACHE_KERNELS_SIZE,
       TI_OCL_COMPUTE_UNIT_LIST,
+      TI_OCL_COPY_ENGINE_THREADS,
+      TI_OCL_COPY_ENGINE_THRESHOLD,
+      TI_OCL_CORE_SCHEDULER,
+      TI_OCL_CORE_SCHEDULER_DEPTH,
       TI_OCL_CPU_DEVICE_ENABLE,
       TI_OCL_DEBUG,
       TI_OCL_DEVICE_PROGRAM_INFO,
       TI_OCL_DSP_1_25GHZ,
+      TI_OCL_DSP_EMULATION,
+      TI_OCL_DSP_EMULATION_LATENCY,
+      TI_OCL_DSP_EMULATION_WG_LATENCY,
       TI_OCL_ENABLE_FP64,
+      TI_OCL_EVENT_CHAINING,
+      TI_OCL_EVENT_POOL_SIZE,
       TI_OCL_INSTALL,
       TI_OCL_LIMIT_DEVICE_MAX_MEM_ALLOC_SIZE,
       TI_OCL_KEEP_FILES,
       TI_OCL_KERNEL_TIMEOUT_COMPUTE_UNIT,
+      TI_OCL_MAILBOX_BATCH_SIZE,
+      TI_OCL_MSMC_AUTO_PLACEMENT,
       TI_OCL_PROFILING_EVENT_TYPE,
       TI_OCL_PROFILING_EVENT_NUMBER1,
       TI_OCL_PROFILING_EVENT_NUMBER2,
       TI_OCL_PROFILING_STALL_CYCLE_THRESHOLD,
+      TI_OCL_TRACE,
+      TI_OCL_TRACE_BUFFER_SIZE,
       TI_OCL_WG_SIZE_LIMIT,
       TI_OCL_PRINTF_COREID,
       TARGET_ROOTDIR,
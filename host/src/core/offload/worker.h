@@ -38,6 +38,8 @@
 #include "core/kernel.h"
 #include "core/oclenv.h"
 #include "core/error_report.h"
+#include "core/trace.h"
+#include "core/copy_engine.h"
 
 
 using namespace Coal;
@@ -45,6 +47,20 @@ using namespace tiocl;
 
 #define MAX_NUM_COMPLETION_PENDING  (16)
 
+/******************************************************************************
+* CompleteHostEvent
+* Ends a command executed on the host, either by the handle_dispatch thread or
+* by the copy engine.
+******************************************************************************/
+static inline void CompleteHostEvent(Event *event, bool profiling,
+                                     cl_int errcode)
+{
+    // an event may be released once it is Complete
+    if (profiling) event->updateTiming(Event::End);
+    event->setStatus((errcode == CL_SUCCESS) ? Event::Complete :
+                                               (Event::Status)errcode);
+}
+
 /******************************************************************************
 * HandleEventCompletion
 * Blocks on: 1) worker_cond: not stop and no complete_pending is available
@@ -140,9 +156,11 @@ bool HandleEventCompletion(DeviceType *device)
 *                             (could wake up handle_completion thread)
 *             2) worker_cond: after an event is dispatch to device
 *                             (could wake up handle_completion thread)
+* Large buffer transfers are handed to the copy engine in \p copies, they
+* complete on a copy thread.
 ******************************************************************************/
 template<typename DeviceType, typename KernelEventType>
-bool HandleEventDispatch(DeviceType *device)
+bool HandleEventDispatch(DeviceType *device, CopyGroup *copies)
 {
     bool       stop = false;
     cl_int     errcode;
@@ -183,7 +201,13 @@ bool HandleEventDispatch(DeviceType *device)
     *    num_complete_pending >= MAX_NUM_COMPLETION_PENDING, handle_completion
     *    thread will NOT be waiting for this handle_dispatch thread
     *    and will be waiting for mails from DSP.
+    * Kernel messages still staged for a batch are sent first, both before
+    * waiting and before running anything else on the host.
     *--------------------------------------------------------------------*/
+    if ((t != Event::NDRangeKernel && t != Event::TaskKernel) ||
+        device->num_complete_pending() >= MAX_NUM_COMPLETION_PENDING)
+        device->mail_flush();
+
     pthread_mutex_lock(device->get_worker_mutex());
 
     if (t == Event::NDRangeKernel || t == Event::TaskKernel)
@@ -212,7 +236,8 @@ bool HandleEventDispatch(DeviceType *device)
         event->updateTiming(Event::Start);
     event->setStatus(Event::Running);
 
-    SharedMemory *shm = device->GetSHMHandler();
+    SharedMemory *shm       = device->GetSHMHandler();
+    bool          profiling = (queue_props & CL_QUEUE_PROFILING_ENABLE) != 0;
 
     /*---------------------------------------------------------------------
     * Execute the action
@@ -223,23 +248,75 @@ bool HandleEventDispatch(DeviceType *device)
         case Event::WriteBuffer:
         {
             ReadWriteBufferEvent *e = (ReadWriteBufferEvent *)event;
+            bool offload = CopyEngine::instance().offload(e->cb());
+            bool use_host_ptr = (e->buffer()->flags() & CL_MEM_USE_HOST_PTR);
 
-            if (e->buffer()->flags() & CL_MEM_USE_HOST_PTR)
+            DSPBuffer *    buf  = NULL;
+            DSPDevicePtr64 data = 0;
+            unsigned int   gen  = 0;
+            void *         mapped;
+
+            if (use_host_ptr)
+                mapped = (char *)e->buffer()->host_ptr() + e->offset();
+            else
             {
-                if (t == Event::ReadBuffer)
-                     memcpy(e->ptr(), e->buffer()->host_ptr(), e->cb());
-                else memcpy(e->buffer()->host_ptr(), e->ptr(), e->cb());
-                break;
+                buf = (DSPBuffer *)e->buffer()->deviceBuffer(device);
+                buf->pin();
+                data = (DSPDevicePtr64)buf->data() + e->offset();
+                gen  = e->buffer()->hostGeneration();
+
+                /*-------------------------------------------------------------
+                * Reading a range the host cache already holds coherently
+                * needs no invalidate.  Either way the range is host valid
+                * afterwards.
+                *------------------------------------------------------------*/
+                bool host_valid = (t == Event::ReadBuffer) &&
+                                  e->buffer()->isHostValid(e->offset(), e->cb());
+
+                if (!offload && !host_valid)
+                {
+                    if (t == Event::ReadBuffer)
+                         shm->ReadFromShmem(data, (uint8_t*)e->ptr(), e->cb());
+                    else
+                         shm->WriteToShmem(data, (uint8_t*)e->ptr(), e->cb());
+                    e->buffer()->setHostValid(e->offset(), e->cb(), gen);
+                    buf->unpin();
+                    break;
+                }
+
+                mapped = shm->Map(data, e->cb(),
+                                  t == Event::ReadBuffer && !host_valid);
             }
 
-            DSPBuffer *buf = (DSPBuffer *)e->buffer()->deviceBuffer(device);
-            DSPDevicePtr64 data = (DSPDevicePtr64)buf->data() + e->offset();
+            void *dst = (t == Event::ReadBuffer) ? e->ptr() : mapped;
+            void *src = (t == Event::ReadBuffer) ? mapped   : e->ptr();
 
-            if (t == Event::ReadBuffer)
-                 shm->ReadFromShmem(data, (uint8_t*)e->ptr(), e->cb());
-            else
-                 shm->WriteToShmem(data, (uint8_t*)e->ptr(), e->cb());
+            auto done = [=]()
+            {
+                if (!use_host_ptr)
+                {
+                    shm->Unmap(mapped, data, e->cb(), t == Event::WriteBuffer);
+                    e->buffer()->setHostValid(e->offset(), e->cb(), gen);
+                    buf->unpin();
+                }
+            };
+
+            /*-----------------------------------------------------------------
+            * Large transfers go to the copy engine: the next events are
+            * dispatched while it copies, this one completes after the copy.
+            *----------------------------------------------------------------*/
+            if (offload)
+            {
+                CopyEngine::instance().submit(dst, src, e->cb(), [=]()
+                    {
+                        done();
+                        CompleteHostEvent(event, profiling, CL_SUCCESS);
+                    }, copies);
+                return false;
+            }
 
+            memcpy(dst, src, e->cb());
+            done();
             break;
         }
 
@@ -250,6 +327,7 @@ bool HandleEventDispatch(DeviceType *device)
             void *pattern = e->pattern();
             size_t pattern_size = e->pattern_size();
             DSPDevicePtr64 dst_addr;
+            DSPBuffer *dst = NULL;
             void *pdst;
 
             if (e->buffer()->flags() & CL_MEM_USE_HOST_PTR)
@@ -258,7 +336,8 @@ bool HandleEventDispatch(DeviceType *device)
             }
             else
             {
-                DSPBuffer *dst = (DSPBuffer*)e->buffer()->deviceBuffer(device);
+                dst = (DSPBuffer*)e->buffer()->deviceBuffer(device);
+                dst->pin();
                 dst_addr = (DSPDevicePtr64)dst->data() + e->offset();
                 pdst = (char *)shm->Map(dst_addr, e->cb(), false);
             }
@@ -271,7 +350,10 @@ bool HandleEventDispatch(DeviceType *device)
                            pattern, pattern_size);
 
             if (! (e->buffer()->flags() & CL_MEM_USE_HOST_PTR))
+            {
                 shm->Unmap(pdst, dst_addr, e->cb(), true);
+                dst->unpin();
+            }
             break;
         }
 
@@ -279,8 +361,11 @@ bool HandleEventDispatch(DeviceType *device)
         {
             CopyBufferEvent *e = (CopyBufferEvent *)event;
 
-            DSPDevicePtr64 src_addr;
-            DSPDevicePtr64 dst_addr;
+            DSPDevicePtr64 src_addr = 0;
+            DSPDevicePtr64 dst_addr = 0;
+            unsigned int   src_gen = 0;
+            DSPBuffer *    src = NULL;
+            DSPBuffer *    dst = NULL;
 
             void *psrc;
             void *pdst;
@@ -289,27 +374,53 @@ bool HandleEventDispatch(DeviceType *device)
                  psrc = (char*)e->source()->host_ptr() + e->src_offset();
             else
             {
-                DSPBuffer *src = (DSPBuffer*)e->source()->deviceBuffer(device);
+                src = (DSPBuffer*)e->source()->deviceBuffer(device);
+                src->pin();
                 src_addr = (DSPDevicePtr64)src->data() + e->src_offset();
-                psrc = shm->Map(src_addr, e->cb(), true);
+                src_gen  = e->source()->hostGeneration();
+                psrc = shm->Map(src_addr, e->cb(), 
+                         !e->source()->isHostValid(e->src_offset(), e->cb()));
             }
 
             if (e->destination()->flags() & CL_MEM_USE_HOST_PTR)
                  pdst = (char *)e->destination()->host_ptr() + e->dst_offset();
             else
             {
-                DSPBuffer *dst = (DSPBuffer*)e->destination()->deviceBuffer(device);
+                dst = (DSPBuffer*)e->destination()->deviceBuffer(device);
+                dst->pin();
                 dst_addr = (DSPDevicePtr64)dst->data() + e->dst_offset();
                 pdst = shm->Map(dst_addr, e->cb(), false);
             }
 
-            memcpy(pdst, psrc, e->cb());
-
-            if (!(e->source()->flags() & CL_MEM_USE_HOST_PTR))
-                shm->Unmap(psrc, src_addr, e->cb(), false);
+            auto done = [=]()
+            {
+                if (!(e->source()->flags() & CL_MEM_USE_HOST_PTR))
+                {
+                    shm->Unmap(psrc, src_addr, e->cb(), false);
+                    e->source()->setHostValid(e->src_offset(), e->cb(),
+                                              src_gen);
+                    src->unpin();
+                }
+
+                if (!(e->destination()->flags() & CL_MEM_USE_HOST_PTR))
+                {
+                    shm->Unmap(pdst, dst_addr, e->cb(), true);
+                    dst->unpin();
+                }
+            };
+
+            if (CopyEngine::instance().offload(e->cb()))
+            {
+                CopyEngine::instance().submit(pdst, psrc, e->cb(), [=]()
+                    {
+                        done();
+                        CompleteHostEvent(event, profiling, CL_SUCCESS);
+                    }, copies);
+                return false;
+            }
 
-            if (!(e->destination()->flags() & CL_MEM_USE_HOST_PTR))
-                shm->Unmap(pdst, dst_addr, e->cb(), true);
+            memcpy(pdst, psrc, e->cb());
+            done();
             break;
         }
 
@@ -321,12 +432,16 @@ bool HandleEventDispatch(DeviceType *device)
 	   // Calculate the start points for each block of memory referenced
 	   DSPDevicePtr64 buf_start;
            uint8_t *      host_start;
+           DSPBuffer *    buf = NULL;
 
 	   if (e->buffer()->flags() & CL_MEM_USE_HOST_PTR)
 	      buf_start = (DSPDevicePtr64)e->buffer()->host_ptr();
 	   else
-	      buf_start = ((DSPBuffer *)e->source()->deviceBuffer(device))
-                                                                 ->data();
+           {
+	      buf = (DSPBuffer *)e->source()->deviceBuffer(device);
+              buf->pin();
+	      buf_start = buf->data();
+           }
 
 	   buf_start += e->src_origin(2) * e->src_slice_pitch() +
 	                e->src_origin(1) * e->src_row_pitch()   +
@@ -405,6 +520,7 @@ bool HandleEventDispatch(DeviceType *device)
 		src_cur_slice += src_slice_pitch;
 		dst_cur_slice += dst_slice_pitch;
 	    }
+            if (buf) buf->unpin();
             break;
 	}
 
@@ -426,12 +542,14 @@ bool HandleEventDispatch(DeviceType *device)
 	   // Set up start points for the copy. If it is a DSP buffer, we'll
 	   // need to map the buffer before copying (done in copy loop below)
 	   DSPDevicePtr64 src_start, dst_start;
+	   DSPBuffer *src = NULL, *dst = NULL;
 
 	   if (e->source()->flags() & CL_MEM_USE_HOST_PTR)
 	      src_start = (DSPDevicePtr64)e->source()->host_ptr() + src_offset;
 	   else
 	   {
-	      DSPBuffer *src = (DSPBuffer*)e->source()->deviceBuffer(device);
+	      src = (DSPBuffer*)e->source()->deviceBuffer(device);
+	      src->pin();
 	      src_start = src->data() + src_offset;
 	   }
 
@@ -439,7 +557,8 @@ bool HandleEventDispatch(DeviceType *device)
 	      dst_start = (DSPDevicePtr64)e->destination()->host_ptr() + dst_offset;
 	   else
 	   {
-	      DSPBuffer *dst=(DSPBuffer*)e->destination()->deviceBuffer(device);
+	      dst=(DSPBuffer*)e->destination()->deviceBuffer(device);
+	      dst->pin();
 	      dst_start = dst->data() + dst_offset;
 	   }
 
@@ -496,6 +615,8 @@ bool HandleEventDispatch(DeviceType *device)
 	      src_cur_slice += e->src_slice_pitch();
 	      dst_cur_slice += e->dst_slice_pitch();
 	    }
+	    if (src) src->unpin();
+	    if (dst) dst->unpin();
             break;
         }
 
@@ -524,11 +645,22 @@ bool HandleEventDispatch(DeviceType *device)
                 ReportError(ErrorType::Fatal, ErrorKind::InfoMessage,
                             "MapBuffer: Range conflicts with previous maps");
 
+            /*-----------------------------------------------------------
+            * Only invalidate if a device wrote the range since the host
+            * last owned it.
+            -----------------------------------------------------------*/
             if ((e->flags() & CL_MAP_READ) != 0)
             {
-                DSPBuffer *buf = (DSPBuffer *)e->buffer()->deviceBuffer(device);
-                DSPDevicePtr64 data = (DSPDevicePtr64)buf->data() + e->offset();
-                shm->CacheInv(data, e->ptr(), e->cb());
+                unsigned int gen = e->buffer()->hostGeneration();
+                if (! e->buffer()->isHostValid(e->offset(), e->cb()))
+                {
+                    DSPBuffer *buf = (DSPBuffer *)
+                                     e->buffer()->deviceBuffer(device);
+                    DSPDevicePtr64 data = (DSPDevicePtr64)buf->data()
+                                          + e->offset();
+                    shm->CacheInv(data, e->ptr(), e->cb());
+                }
+                e->buffer()->setHostValid(e->offset(), e->cb(), gen);
             }
             break;
         }
@@ -559,6 +691,7 @@ bool HandleEventDispatch(DeviceType *device)
             shm->Unmap(e->mapping(), map_dsp_addr, mbe->cb(),
                        ((mbe->flags() & CL_MAP_WRITE) != 0) ||
                        ((mbe->flags() & CL_MAP_WRITE_INVALIDATE_REGION) != 0));
+            buf->unpin();  // Pinned by initEventDeviceData of the map
 
             if (queue) queue->releaseEvent(mbe);
             break;
@@ -598,6 +731,14 @@ bool HandleEventDispatch(DeviceType *device)
             KernelEventType    *ke = (KernelEventType *)e->deviceData();
 
             errcode = ke->run(t);
+
+            /*-------------------------------------------------------------
+            * Keep staging kernel messages while more events are ready to
+            * dispatch, so that they share one mailbox transfer
+            *------------------------------------------------------------*/
+            if (errcode != CL_SUCCESS || !device->gotEnoughToWorkOn())
+                device->mail_flush();
+
             if (errcode == CL_SUCCESS)
             {
                /*-------------------------------------------------------------
@@ -617,12 +758,7 @@ bool HandleEventDispatch(DeviceType *device)
     /*---------------------------------------------------------------------
     * Cleanup
     *--------------------------------------------------------------------*/
-
-    // an event may be released once it is Complete
-    if (queue_props & CL_QUEUE_PROFILING_ENABLE)
-       event->updateTiming(Event::End);
-    event->setStatus((errcode == CL_SUCCESS) ?  Event::Complete :
-                                               (Event::Status)errcode);
+    CompleteHostEvent(event, profiling, errcode);
 
     return false;
 }
@@ -631,6 +767,7 @@ template<typename DeviceType, typename KernelEventType>
 void *WorkerEventCompletion(void *data)
 {
     DeviceType *device = static_cast<DeviceType *>(data);
+    Trace::nameThread("device completion");
 
     while (true)
     {
@@ -651,6 +788,8 @@ template<typename DeviceType, typename KernelEventType>
 void *WorkerEventDispatch(void *data)
 {
     DeviceType *device = static_cast<DeviceType *>(data);
+    CopyGroup   copies;
+    Trace::nameThread("device dispatch");
 
     while (true)
     {
@@ -665,9 +804,12 @@ void *WorkerEventDispatch(void *data)
         *    will push more events onto the device queue), or wait for stop
         *    command (will be woken up by application thread).
         *--------------------------------------------------------------------*/
-        if (HandleEventDispatch<DeviceType, KernelEventType>(device))
+        if (HandleEventDispatch<DeviceType, KernelEventType>(device, &copies))
             break;
     }
 
+    // Transfers still running complete their events before the device goes
+    copies.wait();
+
     return NULL;
 }
@@ -35,6 +35,7 @@
 #include "context.h"
 #ifndef _SYS_BIOS
 #include "compiler.h"
+#include "build_pool.h"
 #endif
 #include "kernel.h"
 #include "propertylist.h"
@@ -107,12 +108,19 @@ Program::Program(Context *ctx)
     p_null_device_dependent.linked_module = 0;
     p_null_device_dependent.program = 0;
     p_llvmcontext = new llvm::LLVMContext();
+
+    p_building = false;
+    pthread_mutex_init(&p_build_mutex, 0);
+    pthread_cond_init(&p_build_cond, 0);
 }
 
 Program::~Program()
 {
    resetDeviceDependent();
    delete p_llvmcontext;
+
+   pthread_mutex_destroy(&p_build_mutex);
+   pthread_cond_destroy(&p_build_cond);
 }
 
 void Program::resetDeviceDependent()
@@ -586,6 +594,85 @@ cl_int Program::loadBinaries(const unsigned char **data, const size_t *lengths,
     return CL_SUCCESS;
 }
 
+/******************************************************************************
+* Run build, a compilation, a link or a build of the program. With a callback,
+* it runs on a build thread and the callback is called when it completes, the
+* program keeps a reference on itself meanwhile. Otherwise it runs on the
+* calling thread.
+******************************************************************************/
+cl_int Program::runBuild(const std::function<cl_int()> &build,
+                         void (CL_CALLBACK *pfn_notify)(cl_program program,
+                                                        void *user_data),
+                         void *user_data)
+{
+#ifndef _SYS_BIOS
+    if (pfn_notify)
+    {
+        reference();
+
+        BuildPool::instance().submit([=]()
+        {
+            build();
+            buildDone();
+            pfn_notify((cl_program)this, user_data);
+
+            if (dereference()) delete this;
+        }, NULL);
+
+        return CL_SUCCESS;
+    }
+#endif
+
+    cl_int result = build();
+    buildDone();
+
+    if (pfn_notify)
+        pfn_notify((cl_program)this, user_data);
+
+    return result;
+}
+
+/******************************************************************************
+* A build, compilation or link claims the program before touching its device
+* dependent data and state, and releases it with buildDone. Only one can be in
+* progress: another one fails with CL_INVALID_OPERATION, as the OpenCL
+* specification requires, instead of racing with the build thread.
+******************************************************************************/
+bool Program::beginBuild()
+{
+    pthread_mutex_lock(&p_build_mutex);
+    bool building = p_building;
+    p_building = true;
+    pthread_mutex_unlock(&p_build_mutex);
+
+    return !building;
+}
+
+void Program::buildDone()
+{
+    pthread_mutex_lock(&p_build_mutex);
+    p_building = false;
+    pthread_cond_broadcast(&p_build_cond);
+    pthread_mutex_unlock(&p_build_mutex);
+}
+
+bool Program::isBuilding()
+{
+    pthread_mutex_lock(&p_build_mutex);
+    bool building = p_building;
+    pthread_mutex_unlock(&p_build_mutex);
+
+    return building;
+}
+
+void Program::waitBuild()
+{
+    pthread_mutex_lock(&p_build_mutex);
+    while (p_building)
+        pthread_cond_wait(&p_build_cond, &p_build_mutex);
+    pthread_mutex_unlock(&p_build_mutex);
+}
+
 #ifndef _SYS_BIOS
 cl_int Program::compile(const char*                 options,
                         void (CL_CALLBACK*          pfn_notify)(cl_program program,
@@ -595,8 +682,10 @@ cl_int Program::compile(const char*                 options,
                         cl_uint                     num_devices,
                         const cl_device_id          *device_list)
 {
+    if (!beginBuild()) return CL_INVALID_OPERATION;
+
     // If this program object was not created with source, return invalid
-    if (p_type != Source) return CL_INVALID_PROGRAM;
+    if (p_type != Source) { buildDone(); return CL_INVALID_PROGRAM; }
 
     // Source: If we've already compiled this program and are re-compiling
     // (for example, with different user options) then clear out the
@@ -611,14 +700,40 @@ cl_int Program::compile(const char*                 options,
         setDevices(num_devices, device_list);
     }
 
-    for (DeviceDependent& dep : p_device_dependent)
+    std::string opts(options ? options : "");
+
+    return runBuild([=]() { return compileDevices(opts, input_header_src); },
+                    pfn_notify, user_data);
+}
+
+cl_int Program::compileDevices(const std::string &opts,
+                      const std::map<std::string, std::string>& input_header_src)
+{
+    /*-------------------------------------------------------------------------
+    * Compile for the devices in parallel
+    *------------------------------------------------------------------------*/
+    size_t num_deps = p_device_dependent.size();
+    std::vector<std::string> objfiles(num_deps);
+    std::vector<std::string> bc_objfiles(num_deps);
+    std::vector<char>        compiled(num_deps, false);
+
+    BuildGroup group;
+    for (size_t i = 0; i < num_deps; ++i)
+        group.add([&, i]()
+        {
+            compiled[i] = p_device_dependent[i].compiler->Compile(
+                      p_source, input_header_src, opts,
+                      objfiles[i], bc_objfiles[i]);
+        });
+    group.wait();
+
+    for (size_t i = 0; i < num_deps; ++i)
     {
-        std::string opts(options ? options : "");
-        std::string objfile;
-        std::string bc_objfile;
+        DeviceDependent& dep        = p_device_dependent[i];
+        std::string&     objfile    = objfiles[i];
+        std::string&     bc_objfile = bc_objfiles[i];
 
-        if (!dep.compiler->Compile(p_source, input_header_src,
-                                   opts, objfile, bc_objfile))
+        if (!compiled[i])
         {
             p_state = Failed;
             return CL_BUILD_PROGRAM_FAILURE;
@@ -669,18 +784,12 @@ cl_int Program::compile(const char*                 options,
 
         if (!dep.program->compile(dep.linked_module, dep.unlinked_binary, dep.unlinked_bc_binary))
         {
-            if (pfn_notify)
-                pfn_notify((cl_program)this, user_data);
-
             p_state = Failed;
             return CL_COMPILE_PROGRAM_FAILURE;
         }
 
     }
 
-    if (pfn_notify)
-        pfn_notify((cl_program)this, user_data);
-
     p_state = Compiled;
     p_type  = CompiledObject;
 
@@ -700,6 +809,54 @@ cl_int Program::link(const char*                  options,
 {
     assert(input_program_list.empty() == false);
 
+    if (!beginBuild()) return CL_INVALID_OPERATION;
+
+    /* Inputs still being compiled are checked once the link has waited for
+     * them */
+    for (Program* pr : input_program_list)
+    {
+        if (!pr->isBuilding()          &&
+            pr->type() != CompiledObject &&
+            pr->type() != Library)
+        {
+            buildDone();
+            return CL_INVALID_PROGRAM;
+        }
+    }
+
+    p_state = InProgress;
+
+    /* Create deviceDependent structures only for the root devices */
+    if (!p_device_dependent.size())
+    {
+        setDevices(num_devices, device_list);
+    }
+
+    std::string opts(options ? options : "");
+
+    if (!pfn_notify)
+        return runBuild([&]() { return linkDevices(opts, input_program_list); },
+                        pfn_notify, user_data);
+
+    /* The inputs are kept until the link in the background completes */
+    for (Program* pr : input_program_list) pr->reference();
+
+    std::vector<Program*> inputs(input_program_list);
+
+    return runBuild([=]()
+    {
+        cl_int result = linkDevices(opts, inputs);
+
+        for (Program* pr : inputs)
+            if (pr->dereference()) delete pr;
+
+        return result;
+    }, pfn_notify, user_data);
+}
+
+cl_int Program::linkDevices(const std::string&           opts,
+                            const std::vector<Program*>& input_program_list)
+{
     std::vector<std::string>    input_obj_files;
     std::vector<std::string>    input_libs;
     std::vector<llvm::Module*>  input_llvm_modules;
@@ -709,17 +866,24 @@ cl_int Program::link(const char*                  options,
      * in the input programs to pass on for linking */
     for (Program* pr : input_program_list)
     {
+        /* Only wait for the inputs of this link */
+        pr->waitBuild();
+
         if (pr->type() != CompiledObject &&
             pr->type() != Library)
+        {
+            p_state = Failed;
             return CL_INVALID_PROGRAM;
+        }
 
         /* The device list is guaranteed to have at least 1 device */
-        const DeviceDependent& dep = pr->deviceDependent(pobj(device_list[0]));
+        const DeviceDependent& dep = pr->deviceDependent(p_device_list[0]);
         if (dep.linked_module != nullptr)
         {
             if (verifyModule(*dep.linked_module))
             {
                 std::cout << ">> ERROR: input_program module is broken " << std::endl;
+                p_state = Failed;
                 return CL_LINK_PROGRAM_FAILURE;
             }
             else
@@ -738,21 +902,29 @@ cl_int Program::link(const char*                  options,
         }
     }
 
-    p_state = InProgress;
+    /*-------------------------------------------------------------------------
+    * Link for the devices in parallel
+    *------------------------------------------------------------------------*/
+    size_t num_deps = p_device_dependent.size();
+    std::vector<std::string> outfiles(num_deps);
+    std::vector<char>        linked(num_deps, false);
 
-    /* Create deviceDependent structures only for the root devices */
-    if (!p_device_dependent.size())
-    {
-        setDevices(num_devices, device_list);
-    }
+    BuildGroup group;
+    for (size_t i = 0; i < num_deps; ++i)
+        group.add([&, i]()
+        {
+            linked[i] = p_device_dependent[i].compiler->Link(
+                      input_obj_files, input_libs, opts,
+                      export_symbols, outfiles[i]);
+        });
+    group.wait();
 
-    for (DeviceDependent& dep : p_device_dependent)
+    for (size_t i = 0; i < num_deps; ++i)
     {
-        std::string opts(options ? options : "");
-        std::string outfile;
+        DeviceDependent& dep     = p_device_dependent[i];
+        std::string&     outfile = outfiles[i];
 
-        if (!dep.compiler->Link(input_obj_files, input_libs, opts,
-                                export_symbols, outfile))
+        if (!linked[i])
         {
             p_state = Failed;
             return CL_BUILD_PROGRAM_FAILURE;
@@ -813,8 +985,6 @@ cl_int Program::link(const char*                  options,
             if (!dep.program->build(dep.linked_module, &dep.unlinked_binary,
                                     dep.native_binary_filename))
             {
-                if (pfn_notify)
-                    pfn_notify((cl_program)this, user_data);
                 p_state = Failed;
                 return CL_LINK_PROGRAM_FAILURE;
             }
@@ -824,9 +994,6 @@ cl_int Program::link(const char*                  options,
 
     }
 
-    if (pfn_notify)
-        pfn_notify((cl_program)this, user_data);
-
     PopulateKernelInfo();
 
     return CL_SUCCESS;
@@ -873,7 +1040,13 @@ cl_int Program::build(const char* options,
                       void* user_data, cl_uint num_devices,
                       const cl_device_id *device_list)
 {
-    if (p_type == Binary && p_state == Linked) return CL_SUCCESS;
+    if (!beginBuild()) return CL_INVALID_OPERATION;
+
+    if (p_type == Binary && p_state == Linked)
+    {
+        buildDone();
+        return CL_SUCCESS;
+    }
 
     // Source: If we've already built this program and are re-building
     // (for example, with different user options) then clear out the
@@ -888,7 +1061,10 @@ cl_int Program::build(const char* options,
         {
             if (std::find(p_device_list.begin(), p_device_list.end(),
                           pobj(device_list[i])) == p_device_list.end())
+            {
+                buildDone();
                 return CL_INVALID_DEVICE;
+            }
         }
     }
 
@@ -900,16 +1076,40 @@ cl_int Program::build(const char* options,
         setDevices(num_devices, device_list);
     }
 
-    for (DeviceDependent& dep : p_device_dependent)
-    {
+    std::string opts(options ? options : "");
+
+    return runBuild([=]() { return buildDevices(opts); },
+                    pfn_notify, user_data);
+}
+
+cl_int Program::buildDevices(const std::string &opts)
+{
 #ifndef _SYS_BIOS
-        // Do we need to compile the source for each device ?
-        if (p_type == Source)
+    // Do we need to compile the source for each device ?
+    if (p_type == Source)
+    {
+        /*---------------------------------------------------------------------
+        * Compile for the devices in parallel
+        *--------------------------------------------------------------------*/
+        size_t num_deps = p_device_dependent.size();
+        std::vector<std::string> outfiles(num_deps);
+        std::vector<char>        compiled(num_deps, false);
+
+        BuildGroup group;
+        for (size_t i = 0; i < num_deps; ++i)
+            group.add([&, i]()
+            {
+                compiled[i] = p_device_dependent[i].compiler->CompileAndLink(
+                                                  p_source, opts, outfiles[i]);
+            });
+        group.wait();
+
+        for (size_t i = 0; i < num_deps; ++i)
         {
-            std::string opts(options ? options : "");
-            std::string outfile;
+            DeviceDependent& dep     = p_device_dependent[i];
+            std::string&     outfile = outfiles[i];
 
-            if (!dep.compiler->CompileAndLink(p_source, opts, outfile))
+            if (!compiled[i])
             {
                 p_state = Failed;
                 return CL_BUILD_PROGRAM_FAILURE;
@@ -935,25 +1135,21 @@ cl_int Program::build(const char* options,
                 return CL_BUILD_PROGRAM_FAILURE;
             }
         }
+    }
 #endif
 
-
+    for (DeviceDependent& dep : p_device_dependent)
+    {
         // Now that the LLVM module is built, build the device-specific
         // representation
         if (!dep.program->build(dep.linked_module, &dep.unlinked_binary,
                                 dep.native_binary_filename))
         {
-            if (pfn_notify)
-                pfn_notify((cl_program)this, user_data);
-
             p_state = Failed;
             return CL_BUILD_PROGRAM_FAILURE;
         }
     }
 
-    if (pfn_notify)
-        pfn_notify((cl_program)this, user_data);
-
     p_state = Built;
 
     PopulateKernelInfo();
@@ -1175,6 +1371,13 @@ cl_int Program::buildInfo(DeviceInterface *device,
 
         case CL_PROGRAM_BUILD_OPTIONS:
 #ifndef _SYS_BIOS
+            // The compiler is in use by the build in progress
+            if (p_state == InProgress)
+            {
+                value = "";
+                value_length = 1;
+                break;
+            }
             value = dep.compiler->options().c_str();
             value_length = dep.compiler->options().size() + 1;
 #endif
@@ -1182,6 +1385,12 @@ cl_int Program::buildInfo(DeviceInterface *device,
 
         case CL_PROGRAM_BUILD_LOG:
 #ifndef _SYS_BIOS
+            if (p_state == InProgress)
+            {
+                value = "";
+                value_length = 1;
+                break;
+            }
             value = dep.compiler->log().c_str();
             value_length = dep.compiler->log().size() + 1;
 #endif
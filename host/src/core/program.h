@@ -42,6 +42,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <functional>
+#include "tiocl_thread.h"
 #include <llvm/IR/Metadata.h>
 
 namespace Coal
@@ -235,6 +237,15 @@ class Program : public _cl_program, public Object
         Type type() const;   /*!< \brief Type of the program */
         State state() const; /*!< \brief State of the program */
 
+        /**
+         * \brief Wait for the build, compilation or link in progress
+         *
+         * Builds given a callback run in the background (see
+         * \c Coal::BuildPool), their program is \c InProgress until then.
+         */
+        void waitBuild();
+        bool isBuilding();   /*!< \brief A build has not completed yet */
+
         /**
          * \brief Create a kernel given a \p name
          * \param name name of the kernel to be created
@@ -328,6 +339,24 @@ class Program : public _cl_program, public Object
 
     private:
         std::vector<DeviceInterface*> p_device_list;
+
+        cl_int runBuild(const std::function<cl_int()> &build,
+                        void (CL_CALLBACK *pfn_notify)(cl_program program,
+                                                       void *user_data),
+                        void *user_data);
+        bool   beginBuild();
+        void   buildDone();
+        cl_int buildDevices(const std::string &options);
+#ifndef _SYS_BIOS
+        cl_int compileDevices(const std::string &options,
+                      const std::map<std::string, std::string>& input_header_src);
+        cl_int linkDevices(const std::string &options,
+                           const std::vector<Program*>& input_program_list);
+#endif
+
+        pthread_mutex_t p_build_mutex;
+        pthread_cond_t  p_build_cond;
+        bool            p_building;   // Protected by p_build_mutex
 };
 
 }
@@ -0,0 +1,305 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file stream.cpp
+ * \brief Streams of data through a kernel, double-buffered by the runtime
+ */
+
+#include "stream.h"
+#include "commandqueue.h"
+#include "context.h"
+#include "deviceinterface.h"
+#include "events.h"
+#include "kernel.h"
+#include "memobject.h"
+
+using namespace Coal;
+
+/******************************************************************************
+* Stream::Stream
+******************************************************************************/
+Stream::Stream(CommandQueue *queue, Kernel *kernel,
+               cl_uint input_arg, size_t input_size,
+               cl_uint output_arg, size_t output_size,
+               cl_uint depth, cl_int *errcode_ret)
+: Object(Object::T_Stream, queue), p_queue(NULL), p_kernel(kernel),
+  p_input_arg(input_arg), p_output_arg(output_arg),
+  p_input_size(input_size), p_output_size(output_size),
+  p_next(0), p_last_kernel(NULL)
+{
+    pthread_mutex_init(&p_mutex, 0);
+    clRetainKernel(desc(p_kernel));
+
+    cl_context                  d_context = 0;
+    cl_device_id                d_device  = 0;
+    cl_command_queue_properties props     = 0;
+
+    queue->info(CL_QUEUE_CONTEXT, sizeof(d_context), &d_context, 0);
+    queue->info(CL_QUEUE_DEVICE, sizeof(d_device), &d_device, 0);
+    queue->info(CL_QUEUE_PROPERTIES, sizeof(props), &props, 0);
+
+    Context *context = pobj(d_context);
+
+    /*-------------------------------------------------------------------------
+    * The input and output must be distinct global buffer arguments
+    *------------------------------------------------------------------------*/
+    if (depth == 0 || input_arg == output_arg)
+    {
+        *errcode_ret = CL_INVALID_VALUE;
+        return;
+    }
+
+    if (input_size == 0 || output_size == 0)
+    {
+        *errcode_ret = CL_INVALID_BUFFER_SIZE;
+        return;
+    }
+
+    if (input_arg >= kernel->numArgs() || output_arg >= kernel->numArgs())
+    {
+        *errcode_ret = CL_INVALID_ARG_INDEX;
+        return;
+    }
+
+    for (cl_uint index : { input_arg, output_arg })
+    {
+        const Kernel::Arg &arg = kernel->arg(index);
+        if (arg.kind() != Kernel::Arg::Buffer ||
+            arg.file() == Kernel::Arg::Local)
+        {
+            *errcode_ret = CL_INVALID_ARG_INDEX;
+            return;
+        }
+    }
+
+    if ((Context *)kernel->parent()->parent() != context)
+    {
+        *errcode_ret = CL_INVALID_CONTEXT;
+        return;
+    }
+
+    /*-------------------------------------------------------------------------
+    * Commands of different submissions overlap, their order is given by the
+    * wait lists
+    *------------------------------------------------------------------------*/
+    p_queue = new CommandQueue(context, pobj(d_device),
+                               CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE |
+                               (props & CL_QUEUE_PROFILING_ENABLE),
+                               errcode_ret);
+    if (*errcode_ret != CL_SUCCESS)
+        return;
+
+    for (cl_uint i = 0; i < depth; ++i)
+    {
+        Slot slot = { NULL, NULL, NULL, NULL };
+
+        Buffer *input = new Buffer(context, input_size, NULL,
+                                   CL_MEM_READ_ONLY, errcode_ret);
+        if (*errcode_ret == CL_SUCCESS) *errcode_ret = input->init();
+        if (*errcode_ret != CL_SUCCESS)
+        {
+            delete input;
+            return;
+        }
+        slot.input = input;
+
+        Buffer *output = new Buffer(context, output_size, NULL,
+                                    CL_MEM_WRITE_ONLY, errcode_ret);
+        if (*errcode_ret == CL_SUCCESS) *errcode_ret = output->init();
+        if (*errcode_ret != CL_SUCCESS)
+        {
+            delete output;
+            clReleaseMemObject(desc(input));
+            return;
+        }
+        slot.output = output;
+
+        p_slots.push_back(slot);
+    }
+}
+
+/******************************************************************************
+* Stream::~Stream
+******************************************************************************/
+Stream::~Stream()
+{
+    for (Slot &slot : p_slots)
+    {
+        // The read of a slot completes after its kernel
+        if (slot.read != NULL)
+        {
+            slot.read->waitForStatus(Event::Complete);
+            clReleaseEvent(desc(slot.read));
+        }
+        else if (slot.kernel != NULL)
+            slot.kernel->waitForStatus(Event::Complete);
+
+        if (slot.kernel != NULL)
+            clReleaseEvent(desc(slot.kernel));
+
+        clReleaseMemObject(desc(slot.input));
+        clReleaseMemObject(desc(slot.output));
+    }
+
+    if (p_queue != NULL)
+        clReleaseCommandQueue(desc(p_queue));
+
+    clReleaseKernel(desc(p_kernel));
+    pthread_mutex_destroy(&p_mutex);
+}
+
+/******************************************************************************
+* cl_int Stream::enqueue(Event *command)
+* Queue command, the caller keeps a reference on it
+******************************************************************************/
+cl_int Stream::enqueue(Event *command)
+{
+    command->reference();
+
+    cl_int rs = p_queue->queueEvent(command);
+    if (rs != CL_SUCCESS)
+        delete command;
+
+    return rs;
+}
+
+/******************************************************************************
+* cl_int Stream::submit
+******************************************************************************/
+cl_int Stream::submit(const void *input, void *output,
+                      cl_uint work_dim,
+                      const size_t *global_work_offset,
+                      const size_t *global_work_size,
+                      const size_t *local_work_size,
+                      Event **event)
+{
+    if (input == NULL || output == NULL)
+        return CL_INVALID_VALUE;
+
+    pthread_mutex_lock(&p_mutex);
+
+    Slot &slot = p_slots[p_next];
+    cl_int rs  = CL_SUCCESS;
+
+    /*-------------------------------------------------------------------------
+    * Input: the last kernel reading the buffer of this slot must be done
+    *------------------------------------------------------------------------*/
+    cl_event write_waits[1] = { slot.kernel ? desc(slot.kernel) : 0 };
+
+    WriteBufferEvent *write = new WriteBufferEvent(p_queue, slot.input,
+                                   0, p_input_size, (void *)input,
+                                   slot.kernel ? 1 : 0,
+                                   slot.kernel ? write_waits : NULL, &rs);
+    if (rs != CL_SUCCESS)
+    {
+        delete write;
+        pthread_mutex_unlock(&p_mutex);
+        return rs;
+    }
+
+    if ((rs = enqueue(write)) != CL_SUCCESS)
+    {
+        pthread_mutex_unlock(&p_mutex);
+        return rs;
+    }
+
+    /*-------------------------------------------------------------------------
+    * Kernel: after its input, the previous kernel, and the read of the last
+    * output of this slot.  The arguments are marshalled when the kernel is
+    * queued, so the kernel object can be rebound for the next submission
+    * right after.
+    *------------------------------------------------------------------------*/
+    std::vector<cl_event> kernel_waits(1, desc((Event *)write));
+    if (p_last_kernel != NULL) kernel_waits.push_back(desc(p_last_kernel));
+    if (slot.read     != NULL) kernel_waits.push_back(desc(slot.read));
+
+    cl_mem d_input  = desc(slot.input);
+    cl_mem d_output = desc(slot.output);
+
+    rs = p_kernel->setArg(p_input_arg, sizeof(cl_mem), &d_input);
+    if (rs == CL_SUCCESS)
+        rs = p_kernel->setArg(p_output_arg, sizeof(cl_mem), &d_output);
+
+    KernelEvent *kernel = NULL;
+    if (rs == CL_SUCCESS)
+    {
+        kernel = new KernelEvent(p_queue, p_kernel, work_dim,
+                                 global_work_offset, global_work_size,
+                                 local_work_size, kernel_waits.size(),
+                                 kernel_waits.data(), &rs);
+        if (rs != CL_SUCCESS)
+            delete kernel;
+        else
+            rs = enqueue(kernel);
+    }
+
+    /*-------------------------------------------------------------------------
+    * Output: read back once the kernel is done.  The commands of this
+    * submission replace those of the last use of the slot in the wait lists
+    * of the next ones.
+    *------------------------------------------------------------------------*/
+    if (rs == CL_SUCCESS)
+    {
+        cl_event read_waits[1] = { desc((Event *)kernel) };
+
+        ReadBufferEvent *read = new ReadBufferEvent(p_queue, slot.output,
+                                      0, p_output_size, output,
+                                      1, read_waits, &rs);
+        if (rs != CL_SUCCESS)
+            delete read;
+        else
+            rs = enqueue(read);
+
+        if (slot.kernel != NULL) clReleaseEvent(desc(slot.kernel));
+        if (slot.read   != NULL) clReleaseEvent(desc(slot.read));
+
+        slot.kernel   = kernel;
+        slot.read     = (rs == CL_SUCCESS) ? read : NULL;
+        p_last_kernel = kernel;
+        p_next        = (p_next + 1) % p_slots.size();
+
+        if (rs == CL_SUCCESS && event != NULL)
+        {
+            read->reference();
+            *event = read;
+        }
+    }
+
+    pthread_mutex_unlock(&p_mutex);
+
+    /*-------------------------------------------------------------------------
+    * The application may reuse its input once it is copied
+    *------------------------------------------------------------------------*/
+    write->waitForStatus(Event::Complete);
+    if (write->status() < 0 && rs == CL_SUCCESS)
+        rs = CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST;
+    clReleaseEvent(desc((Event *)write));
+
+    return rs;
+}
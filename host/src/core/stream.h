@@ -0,0 +1,122 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file stream.h
+ * \brief Streams of data through a kernel, double-buffered by the runtime
+ */
+
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#include "object.h"
+#include "icd.h"
+#include "tiocl_thread.h"
+
+#include <CL/cl.h>
+#include <vector>
+
+namespace Coal
+{
+  class Stream;
+}
+struct _cl_stream_ti: public Coal::descriptor<Coal::Stream, _cl_stream_ti> {};
+
+namespace Coal
+{
+
+class CommandQueue;
+class Kernel;
+class MemObject;
+class Event;
+
+/**
+ * \brief Kernel fed with a sequence of inputs through rings of buffers
+ *
+ * A stream owns \c depth input and \c depth output buffers, used in turn by
+ * the successive submissions, and an out-of-order command queue on the
+ * device of the queue it is created for. Each \c submit() enqueues three
+ * commands on that queue:
+ *
+ * - a write of the input into the next input buffer, once the kernel that
+ *   last read this buffer has completed,
+ * - the kernel, its input and output arguments bound to the buffers of the
+ *   slot, once the write, the previous kernel of the stream and the read of
+ *   the last output of this slot have completed,
+ * - a read of the output buffer once the kernel has completed.
+ *
+ * Writes and reads perform the cache maintenance of the buffers, so the
+ * input of a submission is copied while the previous kernel runs and the
+ * output of the previous kernel is read back meanwhile. \c submit() returns
+ * once the input is copied, the application can reuse it, and the returned
+ * event completes when the output is available.
+ */
+class Stream : public _cl_stream_ti, public Object
+{
+    public:
+        Stream(CommandQueue *queue, Kernel *kernel,
+               cl_uint input_arg, size_t input_size,
+               cl_uint output_arg, size_t output_size,
+               cl_uint depth, cl_int *errcode_ret);
+        ~Stream();   /*!< \brief Waits for the submitted commands */
+
+        /**
+         * \brief Run the kernel on \p input, producing \p output
+         * \param event the read of \p output, retained, if not NULL
+         */
+        cl_int submit(const void *input, void *output,
+                      cl_uint work_dim,
+                      const size_t *global_work_offset,
+                      const size_t *global_work_size,
+                      const size_t *local_work_size,
+                      Event **event);
+
+    private:
+        struct Slot
+        {
+            MemObject *input;
+            MemObject *output;
+            Event *    kernel;   // Last kernel which used the slot, or NULL
+            Event *    read;     // Last read of its output, or NULL
+        };
+
+        cl_int enqueue(Event *command);
+
+        CommandQueue *     p_queue;
+        Kernel *           p_kernel;
+        cl_uint            p_input_arg, p_output_arg;
+        size_t             p_input_size, p_output_size;
+        std::vector<Slot>  p_slots;
+        unsigned int       p_next;      // Slot of the next submission
+        Event *            p_last_kernel;
+        pthread_mutex_t    p_mutex;     // Serializes the submissions
+};
+
+}
+
+#endif
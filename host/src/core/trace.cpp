@@ -0,0 +1,443 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file trace.cpp
+ * \brief Execution timeline of host threads, command queues and DSP cores
+ */
+
+#include "trace.h"
+#include "commandqueue.h"
+#include "events.h"
+#include "kernel.h"
+#include "oclenv.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+using namespace Coal;
+
+#define TRACE_DEFAULT_BUFFER_SIZE  (16384)
+#define TRACE_DSP_PID_BASE         (0x7fff0000)
+
+namespace
+{
+
+enum RecordKind
+{
+    Span,             // a: duration
+    ThreadName,
+    CommandQueued,    // a: event, b: queue
+    CommandSubmitted, // a: event
+    CommandCompleted, // a: event
+    KernelName,       // id: kernel id
+    DeviceRun         // a, b: start and end cycles, id: kernel id,
+                      // track: dsp_id << 8 | core
+};
+
+struct Record
+{
+    uint64_t    ts;
+    uint64_t    a;
+    uint64_t    b;
+    const char *name;
+    uint32_t    id;
+    uint16_t    kind;
+    uint16_t    track;
+};
+
+/*-----------------------------------------------------------------------------
+* Ring buffer of a thread. The mutex is only contended while exporting.
+*----------------------------------------------------------------------------*/
+struct Buffer
+{
+    pthread_mutex_t     mutex;
+    std::vector<Record> records;
+    size_t              next;
+    bool                full;
+    long                tid;
+};
+
+struct Collected
+{
+    Record r;
+    long   tid;
+    bool operator<(const Collected &o) const { return r.ts < o.r.ts; }
+};
+
+/*-----------------------------------------------------------------------------
+* Buffers are registered by their thread and never freed, the records of
+* threads that exited are still exported.
+*----------------------------------------------------------------------------*/
+pthread_mutex_t          buffers_mutex = PTHREAD_MUTEX_INITIALIZER;
+std::vector<Buffer *>    buffers;
+size_t                   buffer_size   = TRACE_DEFAULT_BUFFER_SIZE;
+const char *             exit_file     = NULL;
+__thread Buffer *        thread_buffer = NULL;
+
+pthread_mutex_t          names_mutex   = PTHREAD_MUTEX_INITIALIZER;
+std::set<std::string>    names;
+float                    dsp_mhz[256];
+
+/*-----------------------------------------------------------------------------
+* Nanoseconds of a cycle count, in double: large counts do not fit a float
+*----------------------------------------------------------------------------*/
+int64_t cycles_to_ns(uint64_t cycles, float mhz)
+{
+    return (int64_t) ((double) cycles * 1000.0 / (double) mhz + 0.5);
+}
+
+const char *intern(const std::string &name)
+{
+    pthread_mutex_lock(&names_mutex);
+    const char *rs = names.insert(name).first->c_str();
+    pthread_mutex_unlock(&names_mutex);
+    return rs;
+}
+
+void record(uint16_t kind, const char *name, uint64_t a, uint64_t b = 0,
+            uint32_t id = 0, uint16_t track = 0, uint64_t ts = 0)
+{
+    Buffer *buffer = thread_buffer;
+    if (buffer == NULL)
+    {
+        buffer = new Buffer;
+        pthread_mutex_init(&buffer->mutex, 0);
+        buffer->records.resize(buffer_size);
+        buffer->next = 0;
+        buffer->full = false;
+        buffer->tid  = syscall(SYS_gettid);
+
+        pthread_mutex_lock(&buffers_mutex);
+        buffers.push_back(buffer);
+        pthread_mutex_unlock(&buffers_mutex);
+        thread_buffer = buffer;
+    }
+
+    Record r = { ts != 0 ? ts : Trace::now(), a, b, name, id, kind, track };
+
+    pthread_mutex_lock(&buffer->mutex);
+    buffer->records[buffer->next] = r;
+    if (++buffer->next == buffer->records.size())
+    {
+        buffer->next = 0;
+        buffer->full = true;
+    }
+    pthread_mutex_unlock(&buffer->mutex);
+}
+
+void export_at_exit()
+{
+    if (!Trace::exportJson(exit_file))
+        fprintf(stderr, "TI_OCL_TRACE: cannot write %s\n", exit_file);
+}
+
+}
+
+/******************************************************************************
+* bool Trace::init()
+******************************************************************************/
+bool Trace::init()
+{
+#if defined(_SYS_BIOS)
+    return false;
+#else
+    tiocl::EnvVar& env = tiocl::EnvVar::Instance();
+    exit_file = env.GetEnv<tiocl::EnvVar::Var::TI_OCL_TRACE>(nullptr);
+    if (exit_file == NULL || *exit_file == '\0') return false;
+
+    cl_int size = env.GetEnv<tiocl::EnvVar::Var::TI_OCL_TRACE_BUFFER_SIZE>(
+                                              TRACE_DEFAULT_BUFFER_SIZE);
+    if (size > 0) buffer_size = size;
+
+    atexit(export_at_exit);
+    return true;
+#endif
+}
+
+bool Trace::p_enabled = Trace::init();
+
+/******************************************************************************
+* uint64_t Trace::now()
+******************************************************************************/
+uint64_t Trace::now()
+{
+#if defined(_SYS_BIOS)
+    return 0;
+#else
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t) tp.tv_sec * 1000000000 + tp.tv_nsec;
+#endif
+}
+
+/******************************************************************************
+* Recording
+******************************************************************************/
+void Trace::span(const char *name, uint64_t start)
+{
+    if (!p_enabled) return;
+    record(Span, name, now() - start, 0, 0, 0, start);
+}
+
+void Trace::nameThread(const char *name)
+{
+    if (!p_enabled) return;
+    record(ThreadName, name, 0);
+}
+
+void Trace::commandQueued(Event *event)
+{
+    if (!p_enabled) return;
+
+    const char *name = event->name();
+    if (event->type() == Event::NDRangeKernel ||
+        event->type() == Event::TaskKernel)
+        name = intern(((KernelEvent *) event)->kernel()->getName());
+
+    record(CommandQueued, name, (uint64_t) event, (uint64_t) event->parent());
+}
+
+void Trace::commandSubmitted(Event *event)
+{
+    if (!p_enabled) return;
+    record(CommandSubmitted, NULL, (uint64_t) event);
+}
+
+void Trace::commandCompleted(Event *event)
+{
+    if (!p_enabled) return;
+    record(CommandCompleted, NULL, (uint64_t) event);
+}
+
+void Trace::nameKernel(uint32_t kernel_id, const std::string &name)
+{
+    if (!p_enabled) return;
+    record(KernelName, intern(name), 0, 0, kernel_id);
+}
+
+void Trace::setDeviceClock(uint8_t dsp_id, float mhz)
+{
+    dsp_mhz[dsp_id] = mhz;
+}
+
+void Trace::deviceRun(uint8_t dsp_id, uint8_t core, uint32_t kernel_id,
+                      uint64_t start, uint64_t end)
+{
+    if (!p_enabled) return;
+    record(DeviceRun, NULL, start, end, kernel_id, (dsp_id << 8) | core);
+}
+
+/******************************************************************************
+* bool Trace::exportJson(const char *file_name)
+*   Commands are async events of the host process: the command, and nested
+*   in it the time it was queued then submitted. Each DSP is a process with a
+*   thread per core. The cycle counters of the cores are not related to the
+*   host clock: a core is placed so that no kernel ends after the host got
+*   its completion, which is as close as the trace can tell.
+******************************************************************************/
+bool Trace::exportJson(const char *file_name)
+{
+    if (!p_enabled || file_name == NULL) return false;
+
+    /*-------------------------------------------------------------------------
+    * Collect the records of all threads, in time order
+    *------------------------------------------------------------------------*/
+    std::vector<Collected> all;
+
+    pthread_mutex_lock(&buffers_mutex);
+    for (Buffer *buffer : buffers)
+    {
+        pthread_mutex_lock(&buffer->mutex);
+        size_t count = buffer->full ? buffer->records.size() : buffer->next;
+        size_t first = buffer->full ? buffer->next : 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            Collected c = { buffer->records[(first + i) % buffer->records.size()],
+                            buffer->tid };
+            all.push_back(c);
+        }
+        pthread_mutex_unlock(&buffer->mutex);
+    }
+    pthread_mutex_unlock(&buffers_mutex);
+
+    std::stable_sort(all.begin(), all.end());
+
+    /*-------------------------------------------------------------------------
+    * Clock offset of each DSP core and names of the kernels
+    *------------------------------------------------------------------------*/
+    std::map<uint16_t, int64_t>      offsets;
+    std::map<uint32_t, const char *> kernel_names;
+
+    for (Collected &c : all)
+    {
+        float mhz = dsp_mhz[c.r.track >> 8];
+        if (c.r.kind == KernelName)
+            kernel_names[c.r.id] = c.r.name;
+        else if (c.r.kind == DeviceRun && mhz > 0)
+        {
+            int64_t offset = (int64_t) c.r.ts - cycles_to_ns(c.r.b, mhz);
+            auto it = offsets.find(c.r.track);
+            if (it == offsets.end() || offset < it->second)
+                offsets[c.r.track] = offset;
+        }
+    }
+
+    FILE *f = fopen(file_name, "w");
+    if (f == NULL) return false;
+
+    long pid   = getpid();
+    bool first = true;
+    auto next  = [&]() { fputs(first ? "\n" : ",\n", f); first = false; };
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    next();
+    fprintf(f, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%ld,"
+               "\"args\":{\"name\":\"OpenCL host\"}}", pid);
+    for (auto &o : offsets)
+    {
+        next();
+        fprintf(f, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,"
+                   "\"args\":{\"name\":\"DSP %d\"}}",
+                   TRACE_DSP_PID_BASE + (o.first >> 8), o.first >> 8);
+        next();
+        fprintf(f, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+                   "\"tid\":%d,\"args\":{\"name\":\"core %d\"}}",
+                   TRACE_DSP_PID_BASE + (o.first >> 8), o.first & 0xff,
+                   o.first & 0xff);
+    }
+
+    /*-------------------------------------------------------------------------
+    * Commands whose queued record was overwritten are left out
+    *------------------------------------------------------------------------*/
+    std::map<uint64_t, std::pair<const char *, bool> > commands;
+
+    for (Collected &c : all)
+    {
+        double ts = c.r.ts / 1e3;
+
+        switch (c.r.kind)
+        {
+            case Span:
+                next();
+                fprintf(f, "{\"ph\":\"X\",\"cat\":\"api\",\"name\":\"%s\","
+                           "\"pid\":%ld,\"tid\":%ld,\"ts\":%.3f,\"dur\":%.3f}",
+                           c.r.name, pid, c.tid, ts, c.r.a / 1e3);
+                break;
+
+            case ThreadName:
+                next();
+                fprintf(f, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%ld,"
+                           "\"tid\":%ld,\"args\":{\"name\":\"%s\"}}",
+                           pid, c.tid, c.r.name);
+                break;
+
+            case CommandQueued:
+                commands[c.r.a] = std::make_pair(c.r.name, false);
+                next();
+                fprintf(f, "{\"ph\":\"b\",\"cat\":\"command\",\"name\":\"%s\","
+                           "\"id\":\"0x%llx\",\"pid\":%ld,\"tid\":%ld,"
+                           "\"ts\":%.3f,\"args\":{\"queue\":\"0x%llx\"}}",
+                           c.r.name, (unsigned long long) c.r.a, pid, c.tid, ts,
+                           (unsigned long long) c.r.b);
+                next();
+                fprintf(f, "{\"ph\":\"b\",\"cat\":\"command\",\"name\":\"queued\","
+                           "\"id\":\"0x%llx\",\"pid\":%ld,\"tid\":%ld,"
+                           "\"ts\":%.3f}",
+                           (unsigned long long) c.r.a, pid, c.tid, ts);
+                break;
+
+            case CommandSubmitted:
+            case CommandCompleted:
+            {
+                auto it = commands.find(c.r.a);
+                if (it == commands.end()) break;
+
+                const char *stage = it->second.second ? "submitted" : "queued";
+                next();
+                fprintf(f, "{\"ph\":\"e\",\"cat\":\"command\",\"name\":\"%s\","
+                           "\"id\":\"0x%llx\",\"pid\":%ld,\"tid\":%ld,"
+                           "\"ts\":%.3f}",
+                           stage, (unsigned long long) c.r.a, pid, c.tid, ts);
+                next();
+                if (c.r.kind == CommandSubmitted)
+                {
+                    it->second.second = true;
+                    fprintf(f, "{\"ph\":\"b\",\"cat\":\"command\","
+                               "\"name\":\"submitted\",\"id\":\"0x%llx\","
+                               "\"pid\":%ld,\"tid\":%ld,\"ts\":%.3f}",
+                               (unsigned long long) c.r.a, pid, c.tid, ts);
+                }
+                else
+                {
+                    fprintf(f, "{\"ph\":\"e\",\"cat\":\"command\",\"name\":\"%s\","
+                               "\"id\":\"0x%llx\",\"pid\":%ld,\"tid\":%ld,"
+                               "\"ts\":%.3f}",
+                               it->second.first, (unsigned long long) c.r.a,
+                               pid, c.tid, ts);
+                    commands.erase(it);
+                }
+                break;
+            }
+
+            case DeviceRun:
+            {
+                auto it = offsets.find(c.r.track);
+                if (it == offsets.end()) break;
+
+                float  mhz   = dsp_mhz[c.r.track >> 8];
+                double start = (cycles_to_ns(c.r.a, mhz) + it->second) / 1e3;
+                double dur   = cycles_to_ns(c.r.b - c.r.a, mhz) / 1e3;
+                auto   name  = kernel_names.find(c.r.id);
+
+                next();
+                fprintf(f, "{\"ph\":\"X\",\"cat\":\"dsp\",\"name\":\"%s\","
+                           "\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                           "\"args\":{\"kernel_id\":%u}}",
+                           name != kernel_names.end() ? name->second : "kernel",
+                           TRACE_DSP_PID_BASE + (c.r.track >> 8),
+                           c.r.track & 0xff, start, dur, c.r.id);
+                break;
+            }
+
+            default: break;
+        }
+    }
+
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0;
+}
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/**
+ * \file trace.h
+ * \brief Execution timeline of host threads, command queues and DSP cores
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "tiocl_thread.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace Coal
+{
+
+class Event;
+
+/**
+ * \brief Timeline trace, exported in the Chrome trace event format
+ *
+ * Enabled by setting \c TI_OCL_TRACE to the name of the file written when
+ * the process exits, or by \c __ti_export_trace(). Each thread records into
+ * its own ring buffer of \c TI_OCL_TRACE_BUFFER_SIZE records, the oldest
+ * records are overwritten. Nothing is recorded when tracing is disabled,
+ * every recording function returns after testing \c enabled().
+ *
+ * Recorded are the API calls, the commands from the time they are queued to
+ * the time they are submitted to the device and then complete, the dispatch
+ * of kernels by the device worker threads and the time each DSP core spent
+ * in a kernel, as reported by the monitor. DSP cycle counters are placed on
+ * the host timeline when exported, see \c exportJson().
+ */
+class Trace
+{
+    public:
+        static bool enabled() { return p_enabled; }
+
+        /**
+         * \brief Host time in nanoseconds, on the clock of all records
+         */
+        static uint64_t now();
+
+        /**
+         * \brief Span of the calling thread, from \p start to now
+         * \param name static string
+         */
+        static void span(const char *name, uint64_t start);
+
+        /**
+         * \brief Name the calling thread in the exported trace
+         * \param name static string
+         */
+        static void nameThread(const char *name);
+
+        /**
+         * \brief \p event was queued, pushed to its device, completed
+         */
+        static void commandQueued   (Event *event);
+        static void commandSubmitted(Event *event);
+        static void commandCompleted(Event *event);
+
+        /**
+         * \brief Name the kernel the DSP knows as \p kernel_id
+         */
+        static void nameKernel(uint32_t kernel_id, const std::string &name);
+
+        /**
+         * \brief Set the clock of the cores of DSP \p dsp_id
+         */
+        static void setDeviceClock(uint8_t dsp_id, float mhz);
+
+        /**
+         * \brief Core \p core of DSP \p dsp_id ran kernel \p kernel_id
+         *
+         * Called as the completion is received, \p start and \p end are
+         * the cycle counter of the core.
+         */
+        static void deviceRun(uint8_t dsp_id, uint8_t core, uint32_t kernel_id,
+                              uint64_t start, uint64_t end);
+
+        /**
+         * \brief Write the records to \p file_name
+         * \return false if the file cannot be written
+         */
+        static bool exportJson(const char *file_name);
+
+    private:
+        static bool init();
+        static bool p_enabled;
+};
+
+/**
+ * \brief Record the lifetime of a scope as a span of the calling thread
+ */
+class TraceScope
+{
+    public:
+        TraceScope(const char *name)
+        : p_name(name), p_start(Trace::enabled() ? Trace::now() : 0) {}
+
+        ~TraceScope() { if (p_start != 0) Trace::span(p_name, p_start); }
+
+    private:
+        const char *p_name;
+        uint64_t    p_start;
+};
+
+}
+
+/**
+ * \brief Trace the API function it is placed in
+ */
+#define TRACE_API_CALL()  Coal::TraceScope trace_api_call_(__func__)
+
+#endif
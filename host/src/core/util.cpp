@@ -35,6 +35,9 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#if !defined (_MSC_VER) && !defined(_SYS_BIOS)
+#include <wordexp.h>
+#endif
 
 #include "util.h"
 
@@ -66,6 +69,28 @@ uint32_t parse_file_line_value(const char *fname, const char *sname,
     if (line != NULL) free(line);
     return val;
 }
+
+/******************************************************************************
+* Split args into words following the sh rules: quotes, escapes, variable and
+* tilde expansion. Fails on command substitution and on the characters that
+* sh treats as operators (| & ; < > ( ) { } and newline), which only a shell
+* can run.
+******************************************************************************/
+bool split_shell_words(const std::string &args,
+                       std::vector<std::string> &words)
+{
+    wordexp_t we;
+    int       rc = wordexp(args.c_str(), &we, WRDE_NOCMD);
+
+    if (rc == WRDE_NOSPACE) wordfree(&we);
+    if (rc != 0) return false;
+
+    for (size_t i = 0; i < we.we_wordc; i++)
+        words.push_back(we.we_wordv[i]);
+
+    wordfree(&we);
+    return true;
+}
 #endif
 
 /******************************************************************************
@@ -34,9 +34,16 @@
 #define _UTIL_H
 
 #ifndef _SYS_BIOS
+#include <string>
+#include <vector>
+
 // Parse first line in a file, read integer immediately following a string
 uint32_t parse_file_line_value(const char *fname, const char *sname,
                                uint32_t default_val);
+
+// Split a command line into words as sh does, false if sh would do more
+bool split_shell_words(const std::string &args,
+                       std::vector<std::string> &words);
 #endif
 
 // For OpenCL error reporting, number to meaning mapping
@@ -0,0 +1,227 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <CL/cl.h>
+#include <CL/cl_ext.h>
+
+/******************************************************************************
+* Commands run through the emulated DSP (TI_OCL_DSP_EMULATION, see
+* src/core/dsp/tal/dsp_emulation.h) from enqueue to completion: a task, and
+* NDRange kernels split in fixed chunks or claimed by the cores at run time.
+* The built-in kernels stand in for the DSP code, which the emulation does
+* not run, so only dispatch and completion are checked, not results.
+******************************************************************************/
+#define EMULATED_CORES  (4)
+#define NUM_ELEMENTS    (1 << 16)
+#define WG_SIZE         (256)
+#define NUM_LAUNCHES    (16)
+
+static cl_context       context;
+static cl_command_queue queue;
+static cl_program       program;
+static cl_mem           bufs[3];
+
+static void setup(void)
+{
+    cl_platform_id platform;
+    cl_device_id   device;
+    cl_uint        num_cus;
+    cl_int         err;
+    int            i;
+
+    err = clGetPlatformIDs(1, &platform, NULL);
+    ck_assert_int_eq(err, CL_SUCCESS);
+    err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ACCELERATOR, 1, &device,
+                         NULL);
+    ck_assert_int_eq(err, CL_SUCCESS);
+
+    err = clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS,
+                          sizeof(num_cus), &num_cus, NULL);
+    ck_assert_int_eq(err, CL_SUCCESS);
+    ck_assert_msg(num_cus == EMULATED_CORES,
+                  "%u compute units, %d emulated cores", num_cus,
+                  EMULATED_CORES);
+
+    context = clCreateContext(NULL, 1, &device, NULL, NULL, &err);
+    ck_assert_int_eq(err, CL_SUCCESS);
+    queue = clCreateCommandQueue(context, device, 0, &err);
+    ck_assert_int_eq(err, CL_SUCCESS);
+    program = clCreateProgramWithBuiltInKernels(context, 1, &device,
+                                    "tiocl_bik_memcpy_test;tiocl_bik_vecadd",
+                                    &err);
+    ck_assert_int_eq(err, CL_SUCCESS);
+
+    for (i = 0; i < 3; i++)
+    {
+        bufs[i] = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                                 NUM_ELEMENTS * sizeof(cl_int), NULL, &err);
+        ck_assert_int_eq(err, CL_SUCCESS);
+    }
+}
+
+static void teardown(void)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) clReleaseMemObject(bufs[i]);
+    clReleaseProgram(program);
+    clReleaseCommandQueue(queue);
+    clReleaseContext(context);
+}
+
+/*-----------------------------------------------------------------------------
+* wait_complete - Wait for the events, check that each one completed.
+*----------------------------------------------------------------------------*/
+static void wait_complete(cl_event *events, int num_events)
+{
+    cl_int status;
+    int    i;
+
+    ck_assert_int_eq(clWaitForEvents(num_events, events), CL_SUCCESS);
+
+    for (i = 0; i < num_events; i++)
+    {
+        ck_assert_int_eq(clGetEventInfo(events[i],
+                                        CL_EVENT_COMMAND_EXECUTION_STATUS,
+                                        sizeof(status), &status, NULL),
+                         CL_SUCCESS);
+        ck_assert_msg(status == CL_COMPLETE, "command %d status %d", i,
+                      status);
+        clReleaseEvent(events[i]);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+* run_vecadd - Launch vecadd NUM_LAUNCHES times with the given schedule.
+*----------------------------------------------------------------------------*/
+static void run_vecadd(cl_uint schedule)
+{
+    cl_event events[NUM_LAUNCHES];
+    size_t   global = NUM_ELEMENTS;
+    size_t   local  = WG_SIZE;
+    cl_int   n      = NUM_ELEMENTS;
+    cl_int   err;
+    int      i;
+
+    cl_kernel kernel = clCreateKernel(program, "tiocl_bik_vecadd", &err);
+    ck_assert_int_eq(err, CL_SUCCESS);
+
+    for (i = 0; i < 3; i++)
+        ck_assert_int_eq(clSetKernelArg(kernel, i, sizeof(cl_mem), &bufs[i]),
+                         CL_SUCCESS);
+    ck_assert_int_eq(clSetKernelArg(kernel, 3, sizeof(n), &n), CL_SUCCESS);
+    ck_assert_int_eq(__ti_set_kernel_wg_schedule(kernel, schedule),
+                     CL_SUCCESS);
+
+    for (i = 0; i < NUM_LAUNCHES; i++)
+    {
+        err = clEnqueueNDRangeKernel(queue, kernel, 1, NULL, &global, &local,
+                                     0, NULL, &events[i]);
+        ck_assert_int_eq(err, CL_SUCCESS);
+    }
+
+    wait_complete(events, NUM_LAUNCHES);
+    clReleaseKernel(kernel);
+}
+
+START_TEST(test_task)
+{
+    cl_event events[NUM_LAUNCHES];
+    cl_int   size = NUM_ELEMENTS * sizeof(cl_int);
+    cl_int   err;
+    int      i;
+
+    cl_kernel kernel = clCreateKernel(program, "tiocl_bik_memcpy_test", &err);
+    ck_assert_int_eq(err, CL_SUCCESS);
+
+    ck_assert_int_eq(clSetKernelArg(kernel, 0, sizeof(cl_mem), &bufs[0]),
+                     CL_SUCCESS);
+    ck_assert_int_eq(clSetKernelArg(kernel, 1, sizeof(cl_mem), &bufs[1]),
+                     CL_SUCCESS);
+    ck_assert_int_eq(clSetKernelArg(kernel, 2, sizeof(size), &size),
+                     CL_SUCCESS);
+
+    for (i = 0; i < NUM_LAUNCHES; i++)
+    {
+        err = clEnqueueTask(queue, kernel, 0, NULL, &events[i]);
+        ck_assert_int_eq(err, CL_SUCCESS);
+    }
+
+    wait_complete(events, NUM_LAUNCHES);
+    clReleaseKernel(kernel);
+}
+END_TEST
+
+START_TEST(test_ndrange_static)
+{
+    run_vecadd(CL_WG_SCHEDULE_STATIC_TI);
+}
+END_TEST
+
+START_TEST(test_ndrange_dynamic)
+{
+    run_vecadd(CL_WG_SCHEDULE_DYNAMIC_TI);
+}
+END_TEST
+
+static Suite* dsp_emulation_suite(void)
+{
+    Suite *s  = suite_create("dsp_emulation");
+    TCase *tc = tcase_create("dispatch");
+
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_task);
+    tcase_add_test(tc, test_ndrange_static);
+    tcase_add_test(tc, test_ndrange_dynamic);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void)
+{
+    SRunner *sr;
+    char     cores[8];
+    int      failed;
+
+    /*-------------------------------------------------------------------------
+    * Read once by the runtime, so set before the first OpenCL call.  A small
+    * per work-group latency keeps every core claiming work-groups.
+    *------------------------------------------------------------------------*/
+    snprintf(cores, sizeof(cores), "%d", EMULATED_CORES);
+    setenv("TI_OCL_DSP_EMULATION",            cores, 1);
+    setenv("TI_OCL_DSP_EMULATION_WG_LATENCY", "5",   0);
+
+    sr = srunner_create(dsp_emulation_suite());
+    srunner_run_all(sr, CK_NORMAL);
+    failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
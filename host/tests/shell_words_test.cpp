@@ -0,0 +1,112 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <check.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "util.h"
+
+/******************************************************************************
+* Splitting of the clocl options for the in-process compiler, which must give
+* clocl the same arguments as the shell of the clocl process would
+******************************************************************************/
+static std::vector<std::string> split(const char *args)
+{
+    std::vector<std::string> words;
+    ck_assert_msg(split_shell_words(args, words), "failed to split %s", args);
+    return words;
+}
+
+START_TEST(test_plain)
+{
+    std::vector<std::string> w = split("  -O3\t-DN=4  file.cl ");
+
+    ck_assert_int_eq(w.size(), 3);
+    ck_assert_str_eq(w[0].c_str(), "-O3");
+    ck_assert_str_eq(w[1].c_str(), "-DN=4");
+    ck_assert_str_eq(w[2].c_str(), "file.cl");
+}
+END_TEST
+
+START_TEST(test_quoted_define)
+{
+    std::vector<std::string> w = split("-DSTR=\"a b\" -DMSG='\"x y\"' "
+                                       "-DQ=\\\"c\\ d\\\"");
+
+    ck_assert_int_eq(w.size(), 3);
+    ck_assert_str_eq(w[0].c_str(), "-DSTR=a b");
+    ck_assert_str_eq(w[1].c_str(), "-DMSG=\"x y\"");
+    ck_assert_str_eq(w[2].c_str(), "-DQ=\"c d\"");
+}
+END_TEST
+
+START_TEST(test_quoted_path)
+{
+    std::vector<std::string> w = split("-I\"/path with space\" -I/usr/inc");
+
+    ck_assert_int_eq(w.size(), 2);
+    ck_assert_str_eq(w[0].c_str(), "-I/path with space");
+    ck_assert_str_eq(w[1].c_str(), "-I/usr/inc");
+}
+END_TEST
+
+START_TEST(test_needs_shell)
+{
+    std::vector<std::string> words;
+
+    ck_assert(!split_shell_words("-DX=$(id -u)", words));
+    ck_assert(!split_shell_words("-DX=`id -u`",  words));
+    ck_assert(!split_shell_words("-DX=1; true",  words));
+    ck_assert(!split_shell_words("-DX=\"a",      words));
+}
+END_TEST
+
+static Suite* shell_words_suite(void)
+{
+    Suite *s  = suite_create("shell_words");
+    TCase *tc = tcase_create("split");
+
+    tcase_add_test(tc, test_plain);
+    tcase_add_test(tc, test_quoted_define);
+    tcase_add_test(tc, test_quoted_path);
+    tcase_add_test(tc, test_needs_shell);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void)
+{
+    SRunner *sr = srunner_create(shell_words_suite());
+    int      failed;
+
+    srunner_run_all(sr, CK_NORMAL);
+    failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "trace.h"
+
+using namespace Coal;
+
+#define TRACE_TEST_FILE  "trace_test.json"
+
+/******************************************************************************
+* Placement of the DSP cycle counters on the host timeline. Run with
+* TI_OCL_TRACE set, the trace is only recorded then.
+******************************************************************************/
+static std::string read_file(const char *name)
+{
+    std::string contents;
+    char        buf[4096];
+    size_t      n;
+    FILE       *f = fopen(name, "r");
+
+    ck_assert_msg(f != NULL, "cannot read %s", name);
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        contents.append(buf, n);
+    fclose(f);
+    return contents;
+}
+
+START_TEST(test_large_cycles)
+{
+    ck_assert_msg(Trace::enabled(), "TI_OCL_TRACE is not set");
+
+    /*-------------------------------------------------------------------------
+    * Weeks of cycles at 750MHz, beyond the precision of a float: the kernel
+    * ends when the host got its completion, and lasts 4000.1us
+    *------------------------------------------------------------------------*/
+    uint64_t start = (1ULL << 50) + 123;
+    uint64_t end   = start + 750 * 4000 + 75;
+
+    Trace::setDeviceClock(0, 750.0f);
+    Trace::nameKernel(7, "large_cycles");
+
+    uint64_t before = Trace::now();
+    Trace::deviceRun(0, 1, 7, start, end);
+    uint64_t after  = Trace::now();
+
+    ck_assert(Trace::exportJson(TRACE_TEST_FILE));
+    std::string json = read_file(TRACE_TEST_FILE);
+
+    const char *run = strstr(json.c_str(), "\"name\":\"large_cycles\"");
+    ck_assert_msg(run != NULL, "no DeviceRun record exported");
+
+    double ts, dur;
+    const char *ts_field = strstr(run, "\"ts\":");
+    ck_assert(ts_field != NULL);
+    ck_assert_int_eq(sscanf(ts_field, "\"ts\":%lf,\"dur\":%lf", &ts, &dur), 2);
+
+    ck_assert_msg(dur > 4000.0995 && dur < 4000.1005, "dur %.3f", dur);
+    ck_assert_msg(ts + dur >= before / 1e3 - 0.002 &&
+                  ts + dur <= after  / 1e3 + 0.002,
+                  "kernel ends at %.3f, completion between %.3f and %.3f",
+                  ts + dur, before / 1e3, after / 1e3);
+
+    remove(TRACE_TEST_FILE);
+}
+END_TEST
+
+static Suite* trace_suite(void)
+{
+    Suite *s  = suite_create("trace");
+    TCase *tc = tcase_create("export");
+
+    tcase_add_test(tc, test_large_cycles);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void)
+{
+    SRunner *sr = srunner_create(trace_suite());
+    int      failed;
+
+    srunner_run_all(sr, CK_NORMAL);
+    failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,249 @@
+/******************************************************************************
+ * Copyright (c) 2026, Texas Instruments Incorporated - http://www.ti.com/
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are met:
+ *       * Redistributions of source code must retain the above copyright
+ *         notice, this list of conditions and the following disclaimer.
+ *       * Redistributions in binary form must reproduce the above copyright
+ *         notice, this list of conditions and the following disclaimer in the
+ *         documentation and/or other materials provided with the distribution.
+ *       * Neither the name of Texas Instruments Incorporated nor the
+ *         names of its contributors may be used to endorse or promote products
+ *         derived from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *   ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *   INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *   CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *   THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <check.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "message.h"
+
+/******************************************************************************
+* Work-group claims as made by the cores of an NDRKERNEL with a wg_counter
+* (see wg_claim in message.h): one thread per core claims from a shared
+* counter, each claim serialized by a mutex.  Checks that the claims cover
+* every work-group exactly once and that chunk sizes never increase, and
+* reports claims/sec against the static split, one fixed chunk per core,
+* claimed the same way.
+******************************************************************************/
+typedef uint32_t (*claim_fn_t)(uint32_t* next, uint32_t num_wgs,
+                               uint32_t num_cores, uint32_t* first);
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    claim_fn_t      claim;
+    uint32_t        next;
+    uint32_t        num_wgs;
+    uint32_t        num_cores;
+    uint32_t       *claimed;     /* times each work-group was claimed */
+    uint32_t        num_claims;
+    uint32_t        last_count;  /* size of the latest claim, all threads */
+    int             increased;   /* a claim was larger than the one before */
+    int             overrun;     /* a claim went past num_wgs */
+    uint64_t        claim_ns;    /* time spent claiming, all threads */
+} claim_state_t;
+
+/*-----------------------------------------------------------------------------
+* static_claim - The fixed chunk a core gets without a wg_counter.
+*----------------------------------------------------------------------------*/
+static uint32_t static_claim(uint32_t* next, uint32_t num_wgs,
+                             uint32_t num_cores, uint32_t* first)
+{
+    uint32_t left  = (*next < num_wgs) ? num_wgs - *next : 0;
+    uint32_t count = (num_wgs + num_cores - 1) / num_cores;
+
+    if (count > left) count = left;
+
+    *first = *next;
+    *next += count;
+    return count;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static void* claim_loop(void *arg)
+{
+    claim_state_t *s = (claim_state_t *)arg;
+    uint32_t first, count, i;
+
+    do
+    {
+        uint64_t start = now_ns();
+
+        pthread_mutex_lock(&s->lock);
+        count = s->claim(&s->next, s->num_wgs, s->num_cores, &first);
+        if (count > 0)
+        {
+            if (count > s->last_count)      s->increased = 1;
+            if (first + count > s->num_wgs) s->overrun   = 1;
+            s->last_count = count;
+            s->num_claims++;
+        }
+        pthread_mutex_unlock(&s->lock);
+
+        __sync_fetch_and_add(&s->claim_ns, now_ns() - start);
+
+        for (i = first; s->claimed && i < first + count && i < s->num_wgs; i++)
+            __sync_fetch_and_add(&s->claimed[i], 1);
+    } while (count > 0);
+
+    return NULL;
+}
+
+/*-----------------------------------------------------------------------------
+* run_claims - Claim all num_wgs work-groups from num_cores threads, recording
+*    which work-groups were claimed if mark is set.
+*----------------------------------------------------------------------------*/
+static void run_claims(claim_state_t *s, claim_fn_t claim, uint32_t num_wgs,
+                       uint32_t num_cores, int mark)
+{
+    pthread_t threads[num_cores];
+    uint32_t  i;
+
+    pthread_mutex_init(&s->lock, NULL);
+    s->claim      = claim;
+    s->next       = 0;
+    s->num_wgs    = num_wgs;
+    s->num_cores  = num_cores;
+    s->claimed    = mark ? calloc(num_wgs + 1, sizeof(uint32_t)) : NULL;
+    s->num_claims = 0;
+    s->last_count = UINT32_MAX;
+    s->increased  = 0;
+    s->overrun    = 0;
+    s->claim_ns   = 0;
+
+    for (i = 0; i < num_cores; i++)
+        pthread_create(&threads[i], NULL, claim_loop, s);
+    for (i = 0; i < num_cores; i++)
+        pthread_join(threads[i], NULL);
+
+    pthread_mutex_destroy(&s->lock);
+}
+
+static const uint32_t cores[] = { 1, 2, 4, 8 };
+static const uint32_t wgs[]   = { 0, 1, 7, 8, 31, 1000, 65537, 1 << 20 };
+
+#define NUM_ELEMS(a) (sizeof(a) / sizeof((a)[0]))
+
+START_TEST(test_claims_cover_once)
+{
+    uint32_t c, w, i;
+
+    for (c = 0; c < NUM_ELEMS(cores); c++)
+        for (w = 0; w < NUM_ELEMS(wgs); w++)
+        {
+            claim_state_t s;
+            run_claims(&s, wg_claim, wgs[w], cores[c], 1);
+
+            for (i = 0; i < wgs[w]; i++)
+                ck_assert_msg(s.claimed[i] == 1,
+                    "%u cores, %u work-groups: work-group %u claimed %u times",
+                    cores[c], wgs[w], i, s.claimed[i]);
+            ck_assert_msg(s.overrun == 0,
+                    "%u cores, %u work-groups: claim past the last one",
+                    cores[c], wgs[w]);
+            free(s.claimed);
+        }
+}
+END_TEST
+
+START_TEST(test_chunks_never_increase)
+{
+    uint32_t c, w;
+
+    for (c = 0; c < NUM_ELEMS(cores); c++)
+        for (w = 0; w < NUM_ELEMS(wgs); w++)
+        {
+            claim_state_t s;
+            run_claims(&s, wg_claim, wgs[w], cores[c], 0);
+
+            ck_assert_msg(s.increased == 0,
+                    "%u cores, %u work-groups: a claim was larger than the "
+                    "one before", cores[c], wgs[w]);
+        }
+}
+END_TEST
+
+/*-----------------------------------------------------------------------------
+* Not a pass/fail check: prints the cost of the guided claims per NDRange
+* next to the static split's one claim per core.
+*----------------------------------------------------------------------------*/
+START_TEST(test_claim_rate)
+{
+    const uint32_t num_wgs = 1 << 20;
+    const int      rounds  = 1000;
+    uint32_t c;
+    int r;
+
+    for (c = 0; c < NUM_ELEMS(cores); c++)
+    {
+        uint64_t guided_claims = 0, guided_ns = 0;
+        uint64_t static_claims = 0, static_ns = 0;
+
+        for (r = 0; r < rounds; r++)
+        {
+            claim_state_t s;
+
+            run_claims(&s, wg_claim, num_wgs, cores[c], 0);
+            guided_claims += s.num_claims;
+            guided_ns     += s.claim_ns;
+
+            run_claims(&s, static_claim, num_wgs, cores[c], 0);
+            static_claims += s.num_claims;
+            static_ns     += s.claim_ns;
+        }
+
+        printf("%u cores, %u work-groups: guided %llu claims/NDRange "
+               "%.0f claims/sec, static split %llu claims/NDRange "
+               "%.0f claims/sec\n", cores[c], num_wgs,
+               (unsigned long long)(guided_claims / rounds),
+               guided_claims * 1e9 / guided_ns,
+               (unsigned long long)(static_claims / rounds),
+               static_claims * 1e9 / static_ns);
+    }
+}
+END_TEST
+
+static Suite* wg_claim_suite(void)
+{
+    Suite *s  = suite_create("wg_claim");
+    TCase *tc = tcase_create("claims");
+
+    tcase_set_timeout(tc, 120);
+    tcase_add_test(tc, test_claims_cover_once);
+    tcase_add_test(tc, test_chunks_never_increase);
+    tcase_add_test(tc, test_claim_rate);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void)
+{
+    SRunner *sr = srunner_create(wg_claim_suite());
+    int      failed;
+
+    srunner_run_all(sr, CK_NORMAL);
+    failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
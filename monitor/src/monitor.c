@@ -117,6 +117,11 @@ PRIVATE_NOALIGN (Clock_Handle,        timeout_clock);
 PRIVATE_NOALIGN (Semaphore_Handle,    sem_timeout);
 PRIVATE_NOALIGN (ocl_msgq_message_t*, ocl_msgq_pkt)        = NULL;
 PRIVATE_NOALIGN (ocl_msgq_message_t*, omp_msgq_pkt)        = NULL;
+PRIVATE_NOALIGN (ocl_msgq_message_t*, batch_msgq_pkt)      = NULL;
+PRIVATE_NOALIGN (volatile uint32_t*,  chain_publish_flag)  = NULL;
+PRIVATE_NOALIGN (uint32_t,            chain_publish_id);
+PRIVATE_NOALIGN (uint64_t,            command_start_cycles);
+PRIVATE         (ocl_msgq_message_t,  batch_entry_pkt);
 PRIVATE_NOALIGN (char*,               omp_stack);
 
 
@@ -151,12 +156,18 @@ static void respond_to_host(ocl_msgq_message_t *msgq_pkt, uint32_t msgId);
 
 static void process_kernel_command(ocl_msgq_message_t* msgq_pkt);
 static void process_task_command  (ocl_msgq_message_t* msgq_msg);
+static void process_batch_command (ocl_msgq_message_t* msgq_pkt);
 static void process_cache_command (int pkt_id, ocl_msgq_message_t *msgq_pkt);
+static void wait_for_chained_kernel(kernel_msg_t* kernel);
+static void publish_chained_kernel (void);
 static void process_exit_command  (ocl_msgq_message_t* msgq_msg);
 static void process_setup_debug_command(ocl_msgq_message_t* msgq_pkt);
 static void service_workgroup     (Msg_t* msg);
 static bool setup_ndr_chunks      (int dims, uint32_t* limits, uint32_t* offsets,
                                    uint32_t *gsz, uint32_t* lsz, uint32_t n_cores);
+static void service_claimed_workgroups(Msg_t* msg, uint32_t n_cores);
+static uint32_t claim_workgroups  (uint32_t counter_addr, uint32_t num_wgs,
+                                   uint32_t n_cores, uint32_t* first);
 static void process_configuration_message(ocl_msgq_message_t* msgq_pkt);
 static void timeout_clock_handler(UArg arg);
 static inline void setup_extended_memory(flush_msg_t* flush_msg);
@@ -412,18 +423,27 @@ void ocl_monitor()
         {
             case TASK:
                 Log_print1(Diags_INFO, "TASK(%u)\n", pid);
+                command_start_cycles = __clock64();
                 process_task_command(ocl_msgq_pkt);
                 break;
 
             case NDRKERNEL:
                 Log_print1(Diags_INFO, "NDRKERNEL(%u)\n", pid);
+                wait_for_chained_kernel(&ocl_msg->u.k.kernel);
+                command_start_cycles = __clock64();
                 process_kernel_command(ocl_msgq_pkt);
                 process_cache_command(ocl_msg->u.k.kernel.Kernel_id,
                                       ocl_msgq_pkt);
+                publish_chained_kernel();
                 TRACE(ULM_OCL_NDR_CACHE_COHERENCE_COMPLETE,
                       ocl_msg->u.k.kernel.Kernel_id, 0);
                 break;
 
+            case BATCH:
+                Log_print1(Diags_INFO, "BATCH(%u)\n", pid);
+                process_batch_command(ocl_msgq_pkt);
+                break;
+
             case CACHEINV:
                 Log_print1(Diags_INFO, "CACHEINV(%u)\n", pid);
                 process_cache_command(-1, ocl_msgq_pkt);
@@ -617,6 +637,59 @@ static void process_task_command(ocl_msgq_message_t* msgq_pkt)
     return;
 }
 
+/******************************************************************************
+* process_batch_command
+*   The kernel messages of a batch are in shared memory at msgs_addr. They run
+*   in order, respond_to_host() records each completion in the BATCH message,
+*   and the BATCH message goes back to the host once the last kernel is done.
+*   The host only batches NDRKERNELs and out-of-order TASKs that use neither
+*   debug, profiling nor timeouts.
+******************************************************************************/
+static void process_batch_command(ocl_msgq_message_t* msgq_pkt)
+{
+    batch_msg_t* batch    = &(msgq_pkt->message.u.batch);
+    uint32_t     num_msgs = batch->num_msgs;
+    Msg_t*       msgs     = (Msg_t*) batch->msgs_addr;
+    Msg_t*       entry    = &(batch_entry_pkt.message);
+    uint32_t     i;
+
+    if (num_msgs > MAX_BATCH_MSGS) num_msgs = MAX_BATCH_MSGS;
+    cacheInvL2((uint8_t*) msgs, num_msgs * sizeof(Msg_t));
+
+    batch->num_msgs = 0;
+    batch_msgq_pkt  = msgq_pkt;
+
+    for (i = 0; i < num_msgs; i++)
+    {
+        memcpy(entry, &msgs[i], sizeof(Msg_t));
+        command_retcode = CL_SUCCESS;
+        command_start_cycles = __clock64();
+
+        if (entry->command == TASK)
+        {
+            Log_print1(Diags_INFO, "BATCH TASK(%u)\n", entry->pid);
+            process_task_command(&batch_entry_pkt);
+        }
+        else
+        {
+            Log_print1(Diags_INFO, "BATCH NDRKERNEL(%u)\n", entry->pid);
+            wait_for_chained_kernel(&entry->u.k.kernel);
+            process_kernel_command(&batch_entry_pkt);
+            process_cache_command(entry->u.k.kernel.Kernel_id,
+                                  &batch_entry_pkt);
+            publish_chained_kernel();
+            TRACE(ULM_OCL_NDR_CACHE_COHERENCE_COMPLETE,
+                  entry->u.k.kernel.Kernel_id, 0);
+        }
+    }
+
+    batch_msgq_pkt = NULL;
+
+    MessageQ_QueueId replyQ = MessageQ_getReplyQueue(msgq_pkt);
+    MessageQ_setReplyQueue(dspQue, (MessageQ_Msg)msgq_pkt);
+    MessageQ_put          (replyQ, (MessageQ_Msg)msgq_pkt);
+}
+
 #if defined(OMP_ENABLED)
 /******************************************************************************
 * ocl_service_omp - This is it's own task to switch the stack to DDR.
@@ -753,11 +826,12 @@ static void process_kernel_command(ocl_msgq_message_t *msgq_pkt)
     reset_intra_kernel_edma_channels();
 
     bool is_debug_mode = (cfg->WG_gid_start[0] == DEBUG_MODE_WG_GID_START);
+    bool is_dynamic    = !is_debug_mode && msg->u.k.kernel.wg_counter != 0;
     if (is_debug_mode)
     {
         if (!(MASTER_CORE)) return;
     }
-    else
+    else if (!is_dynamic)
     {
         bool any_work = setup_ndr_chunks(cfg->num_dims, limits, offsets,
                                          cfg->global_size, cfg->local_size,
@@ -800,9 +874,11 @@ static void process_kernel_command(ocl_msgq_message_t *msgq_pkt)
     setup_extended_memory(flushMsgPtr);
 
     /*---------------------------------------------------------
-    * Iterate over each Work Group
+    * Iterate over each Work Group, claimed or of the chunk
     *--------------------------------------------------------*/
-    do
+    if (is_dynamic)
+        service_claimed_workgroups(msg, n_execution_cores);
+    else do
     {
         cfg->WG_gid_start[0] = offsets[0] + WGid[0];
         cfg->WG_gid_start[1] = offsets[1] + WGid[1];
@@ -885,6 +961,79 @@ static bool setup_ndr_chunks(int dims, uint32_t* limits, uint32_t* offsets,
     return (MASTER_CORE);
 }
 
+/******************************************************************************
+* service_claimed_workgroups
+*   Dynamic alternative to setup_ndr_chunks: claim work-groups from the
+*   kernel's shared counter until none are left. Claimed work-groups are in
+*   flattened order, the first dimension varying fastest.
+******************************************************************************/
+static void service_claimed_workgroups(Msg_t* msg, uint32_t n_cores)
+{
+    kernel_config_t *cfg = &msg->u.k.config;
+    uint32_t         num_wgs[3];
+    uint32_t         total = 1;
+    uint32_t         first, count, wg;
+    int              i;
+
+    for (i = 0; i < 3; i++)
+    {
+        num_wgs[i] = cfg->global_size[i] / cfg->local_size[i];
+        total     *= num_wgs[i];
+    }
+
+    while ((count = claim_workgroups(msg->u.k.kernel.wg_counter, total,
+                                     n_cores, &first)) > 0)
+    {
+        for (wg = first; wg < first + count; wg++)
+        {
+            uint32_t x = wg % num_wgs[0];
+            uint32_t y = (wg / num_wgs[0]) % num_wgs[1];
+            uint32_t z = wg / (num_wgs[0] * num_wgs[1]);
+
+            cfg->WG_gid_start[0] = cfg->global_offset[0] + x * cfg->local_size[0];
+            cfg->WG_gid_start[1] = cfg->global_offset[1] + y * cfg->local_size[1];
+            cfg->WG_gid_start[2] = cfg->global_offset[2] + z * cfg->local_size[2];
+            cfg->WG_id           = wg;
+
+            TRACE(ULM_OCL_NDR_KERNEL_START, msg->u.k.kernel.Kernel_id,
+                  cfg->WG_id);
+
+            if (setjmp(monitor_jmp_buf))
+            {
+                printf("Abnormal termination of NDRange Kernel at 0x%08x\n",
+                       msg->u.k.kernel.entry_point);
+                TRACE(ULM_OCL_NDR_KERNEL_COMPLETE, msg->u.k.kernel.Kernel_id,
+                      cfg->WG_id);
+                return;
+            }
+            service_workgroup(msg);
+
+            TRACE(ULM_OCL_NDR_KERNEL_COMPLETE, msg->u.k.kernel.Kernel_id,
+                  cfg->WG_id);
+        }
+    }
+}
+
+/******************************************************************************
+* claim_workgroups
+*   The counter is in cached shared memory: it is read and written back
+*   under the hardware semaphore, see wg_claim() for the chunk size.
+******************************************************************************/
+static uint32_t claim_workgroups(uint32_t counter_addr, uint32_t num_wgs,
+                                 uint32_t n_cores, uint32_t* first)
+{
+    uint32_t* counter = (uint32_t*) counter_addr;
+    uint32_t  count;
+
+    uint32_t lvInt = __sem_lock(OCL_HW_SEM_IDX);
+    cacheInvL2((uint8_t*) counter, WG_COUNTER_SIZE);
+    count = wg_claim(counter, num_wgs, n_cores, first);
+    cacheWbInvL2((uint8_t*) counter, WG_COUNTER_SIZE);
+    __sem_unlock(OCL_HW_SEM_IDX, lvInt);
+
+    return count;
+}
+
 
 
 /******************************************************************************
@@ -915,6 +1064,56 @@ static void process_cache_command (int pkt_id, ocl_msgq_message_t *msgq_pkt)
     flush_buffers(flush_msg);
 }
 
+/******************************************************************************
+* wait_for_chained_kernel
+*   A chained NDRKERNEL was sent before the kernel it depends on completed.
+*   Every core of the kernel spins until all of them have published the
+*   Kernel_id of that kernel, i.e. are past its flush_buffers(). The cores
+*   receive both kernels in the same order, so the wait always ends.
+*   The flag this kernel publishes is noted now: the message goes back to the
+*   host before flush_buffers().
+******************************************************************************/
+static void wait_for_chained_kernel(kernel_msg_t* kernel)
+{
+    uint32_t core;
+
+    chain_publish_flag = NULL;
+    if (kernel->chain_flags == 0) return;
+
+    if (kernel->chain_publish != 0)
+    {
+        chain_publish_flag = (volatile uint32_t*) CHAIN_FLAG_ADDR(
+              kernel->chain_flags, kernel->chain_publish - 1, DNUM);
+        chain_publish_id   = kernel->Kernel_id;
+    }
+
+    if (kernel->chain_wait == 0) return;
+
+    for (core  = kernel->master_core;
+         core  < kernel->master_core + kernel->num_cores; core++)
+    {
+        volatile uint32_t* flag = (volatile uint32_t*)
+              CHAIN_FLAG_ADDR(kernel->chain_flags, kernel->chain_wait - 1, core);
+        do
+            cacheInvL2((uint8_t*) flag, CHAIN_FLAG_SIZE);
+        while (*flag != kernel->chain_wait_id);
+    }
+}
+
+/******************************************************************************
+* publish_chained_kernel
+*   Called once this core is done with an NDRKERNEL, results written back, so
+*   that a kernel chained to it may start. Each core owns its flag cache line.
+******************************************************************************/
+static void publish_chained_kernel(void)
+{
+    if (chain_publish_flag == NULL) return;
+
+    *chain_publish_flag = chain_publish_id;
+    cacheWbInvL2((uint8_t*) chain_publish_flag, CHAIN_FLAG_SIZE);
+    chain_publish_flag = NULL;
+}
+
 /******************************************************************************
 * process_exit_command
 ******************************************************************************/
@@ -1044,6 +1243,24 @@ static int incVec(unsigned dims, unsigned *vec, unsigned *inc, unsigned *maxs)
 ******************************************************************************/
 static void respond_to_host(ocl_msgq_message_t *msgq_pkt, uint32_t msgId)
 {
+    uint64_t end_cycles = __clock64();
+
+    /* Kernels in a batch are reported together when the batch completes */
+    if (batch_msgq_pkt != NULL)
+    {
+        batch_msg_t*     batch = &(batch_msgq_pkt->message.u.batch);
+        batch_retcode_t* done  = &(batch->done[batch->num_msgs++]);
+        done->trans_id        = msgId;
+        done->retcode         = command_retcode;
+        done->command         = msgq_pkt->message.command;
+        done->is_ooo_task     = IS_OOO_TASK(msgq_pkt->message);
+        done->cycles_start[0] = (uint32_t) command_start_cycles;
+        done->cycles_start[1] = (uint32_t) (command_start_cycles >> 32);
+        done->cycles_end[0]   = (uint32_t) end_cycles;
+        done->cycles_end[1]   = (uint32_t) (end_cycles >> 32);
+        return;
+    }
+
     msgq_pkt->message.trans_id = msgId;
 
     /* Profiling: Copy counter values and AET failure status into message */
@@ -1056,6 +1273,13 @@ static void respond_to_host(ocl_msgq_message_t *msgq_pkt, uint32_t msgId)
         retdata->profiling_counter1_val = profiling_counter1_val;
     }
 
+    /* Cycle counts, for the timeline trace of the host */
+    command_retcode_t *retcycles = &(msgq_pkt->message.u.command_retcode);
+    retcycles->cycles_start[0] = (uint32_t) command_start_cycles;
+    retcycles->cycles_start[1] = (uint32_t) (command_start_cycles >> 32);
+    retcycles->cycles_end[0]   = (uint32_t) end_cycles;
+    retcycles->cycles_end[1]   = (uint32_t) (end_cycles >> 32);
+
     msgq_pkt->message.u.command_retcode.retcode = command_retcode;
     MessageQ_QueueId replyQ = MessageQ_getReplyQueue(msgq_pkt);
     MessageQ_setReplyQueue(dspQue, (MessageQ_Msg)msgq_pkt);
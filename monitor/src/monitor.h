@@ -111,5 +111,7 @@ extern cregister volatile unsigned int DNUM;
 ******************************************************************************/
 void initialize_memory(void);
 EXPORT uint32_t __dsp_frequency();
+EXPORT uint32_t __sem_lock(int idx);
+EXPORT void     __sem_unlock(int idx, uint32_t lvInt);
 
 #endif  //_monitor_h_